@@ -166,6 +166,7 @@ namespace app {
 		{
 			using namespace gui;
 			widget_director& wd = director_.at().widget_director_;
+			wd.set_retained();
 			gl::core& core = gl::core::get_instance();
 
 			// digital font の読み込み
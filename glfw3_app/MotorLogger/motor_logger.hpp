@@ -53,6 +53,7 @@ namespace app {
 
 			using namespace gui;
 			widget_director& wd = director_.at().widget_director_;
+			wd.set_retained();
 
 
 			{	// ターミナルのテスト
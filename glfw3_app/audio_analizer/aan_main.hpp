@@ -555,13 +555,17 @@ namespace app {
 			if(csn > 0) {
 				cap_total_ += csn;
 				al::pcm16_s_waves ws;
-				if(sound.at_audio_io().get_capture(csn, ws)) {
-					for(const auto w : ws) {
-						waves_.at_units(0)[cap_position_] = w.l;
-						waves_.at_units(1)[cap_position_] = w.r;
-						++cap_position_;
-						cap_position_ %= CAP_BUFFER_N;
+				if(sound.at_audio_io().get_capture(csn, ws) && !ws.empty()) {
+					std::vector<int16_t> l(ws.size());
+					std::vector<int16_t> r(ws.size());
+					for(uint32_t i = 0; i < ws.size(); ++i) {
+						l[i] = ws[i].l;
+						r[i] = ws[i].r;
 					}
+					waves_.copy(0, &l[0], l.size(), cap_position_);
+					waves_.copy(1, &r[0], r.size(), cap_position_);
+					cap_position_ += ws.size();
+					cap_position_ %= CAP_BUFFER_N;
 				}
 			}
 
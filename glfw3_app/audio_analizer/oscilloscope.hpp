@@ -9,7 +9,10 @@
 */
 //=========================================================================//
 #include <vector>
+#include <algorithm>
 #include "gl_fw/glutils.hpp"
+#include "utils/capture_file.hpp"
+#include "utils/wave_pyramid.hpp"
 
 namespace view {
 
@@ -261,6 +264,8 @@ namespace view {
 
 	private:
 		typedef std::vector<UNIT> UNITS;
+		typedef utils::wave_pyramid<UNIT> PYRAMID;
+		typedef typename PYRAMID::acc_t acc_t;
 
 		double		sample_rate_;	///< サンプリング・レート
 		double		time_grid_;		///< 1 grid 辺りの時間[sec]
@@ -270,8 +275,9 @@ namespace view {
 			uint32_t	tstep_;
 			UNITS		units_;
 			vtx::fposs	lines_;
+			PYRAMID		pyramid_;	///< 列毎の min/max を求める為のピラミッド
 
-			ch_t() : param_(), tstep_(0), units_(), lines_()
+			ch_t() : param_(), tstep_(0), units_(), lines_(), pyramid_()
 			{ }
 		};
 
@@ -289,6 +295,14 @@ namespace view {
 		bool		smooth_before_;
 		bool		smooth_;
 
+		static constexpr UNIT BASE_ = static_cast<UNIT>(0);	///< 波形の無い所の値
+
+		static void invalidate_(ch_t& t) noexcept
+		{
+			t.pyramid_.invalidate();
+			t.param_.update_ = true;
+		}
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
@@ -386,10 +400,58 @@ namespace view {
 				static UNITS u;
 				return u;
 			}
+			invalidate_(ch_[ch]);
 			return ch_[ch].units_;
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  波形を直接書き換えた事を通知（ピラミッドを作り直す）
+			@param[in]	ch	チャネル
+		*/
+		//-----------------------------------------------------------------//
+		void invalidate(uint32_t ch) noexcept
+		{
+			if(ch >= CHN) return;
+			invalidate_(ch_[ch]);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  波形コピー（リング・バッファとして書き込む）
+			@param[in]	ch		チャネル
+			@param[in]	src		波形ソース
+			@param[in]	len		波形数
+			@param[in]	ofs		オフセット
+		*/
+		//-----------------------------------------------------------------//
+		void copy(uint32_t ch, const UNIT* src, uint32_t len, uint32_t ofs = 0) noexcept
+		{
+			if(ch >= CHN) return;
+
+			ch_t& t = ch_[ch];
+			uint32_t sz = t.units_.size();
+			if(sz == 0 || len == 0) return;
+
+			if(len > sz) {  // 収まらない分は古い方を捨てる
+				ofs += len - sz;
+				src += len - sz;
+				len = sz;
+			}
+			uint32_t org = ofs % sz;
+			uint32_t n = std::min(len, sz - org);
+			std::copy(src, src + n, t.units_.begin() + org);
+			std::copy(src + n, src + len, t.units_.begin());
+			t.param_.update_ = true;
+
+			// 書き込んだ範囲だけピラミッドを更新
+			t.pyramid_.update(t.units_, org, org + n);
+			if(len > n) t.pyramid_.update(t.units_, 0, len - n);
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief  情報パラメーターを取得
@@ -433,12 +495,15 @@ namespace view {
 				a += dt;
 				if(a >= 1.0) a -= 1.0;
 			}
+			invalidate_(ch_[ch]);
 		}
 
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief  レンダリング
+			@brief  レンダリング @n
+					１ピクセルに複数のサンプルが入る場合は、ピラミッドから @n
+					各列の最小、最大を求めて描画するので、スパイクを見落とさない。
 			@param[in]	size	描画サイズ（ピクセル）
 		*/
 		//-----------------------------------------------------------------//
@@ -477,7 +542,31 @@ namespace view {
 				}
 
 				int mod_x = 0;
-				if(update || t.param_.update_) {
+				if((update || t.param_.update_) && tstep > 65536) {
+					// 列毎に [min, max] を往復するストリップ（区間は列の間で重ならない）
+					float gain = t.param_.volt_scale_ / t.param_.volt_grid_ * static_cast<float>(info_.grid_step_) / static_cast<float>(t.param_.volt_max_);
+					int64_t sz = t.units_.size();
+					int64_t tsc = static_cast<int64_t>(t.param_.offset_.x) * tstep;
+					t.lines_.clear();
+					for(int32_t i = 0; i < size.x; ++i) {
+						int64_t org = std::max(tsc >> 16, -(sz / 2));
+						tsc += tstep;
+						int64_t end = std::min(tsc >> 16, sz / 2);
+						if(org >= end) continue;
+
+						acc_t a;
+						t.pyramid_.envelope(t.units_, org < 0 ? org + sz : org, end - org, a);
+						vtx::fpos hi(i, static_cast<float>(a.max_) * -gain);
+						vtx::fpos lo(i, static_cast<float>(a.min_) * -gain);
+						if(t.lines_.empty() || t.lines_.back() != hi) {
+							t.lines_.push_back(hi);
+						}
+						if(lo != hi) {
+							t.lines_.push_back(lo);
+						}
+					}
+					t.param_.update_ = false;
+				} else if(update || t.param_.update_) {
 					float gain = t.param_.volt_scale_ / t.param_.volt_grid_ * static_cast<float>(info_.grid_step_) / static_cast<float>(t.param_.volt_max_); 
 					int32_t tsc = t.param_.offset_.x * tstep;
 					t.lines_.clear();
@@ -630,6 +719,7 @@ namespace view {
 				v = a;
 				w = static_cast<UNIT>((a + d) * 32767.0f) + 32768;
 			}
+			invalidate_(ch_[ch]);
 		}
 
 
@@ -816,53 +906,46 @@ if(ch == 0) {
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief  セーブ
+			@brief  セーブ（utils::capture_file 形式）
 			@param[in]	path	ファイル・パス
+			@param[in]	rate	サンプリング周期 [秒]（記録用）
 			@return 成功なら「true」
 		*/
 		//-----------------------------------------------------------------//
-		bool save(const std::string& path) noexcept
+		bool save(const std::string& path, double rate = 0.0) noexcept
 		{
-			utils::file_io fio;
-
-			if(!fio.open(path, "wb")) {
-				return false;
-			}
-
+			const UNITS* src[CHN];
 			for(uint32_t ch = 0; ch < CHN; ++ch) {
-				for(auto w : ch_[ch].units_) {
-					fio.put(w);
-				}
+				src[ch] = &ch_[ch].units_;
 			}
-			fio.close();
-
-			return true;
+			return utils::capture_file::save_buffers(path, src, CHN, rate);
 		}
 
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief  ロード
+			@brief  ロード @n
+					バッファより大きなキャプチャーは、org を時間軸の０として、@n
+					その前後のバッファ分だけを読み込む（ファイルはマップするだけ）。@n
+					ヘッダーの無い旧形式のファイルも読める。
 			@param[in]	path	ファイル・パス
+			@param[in]	org		大きなキャプチャーの読み込み位置（サンプル）
 			@return 成功なら「true」
 		*/
 		//-----------------------------------------------------------------//
-		bool load(const std::string& path) noexcept
+		bool load(const std::string& path, uint64_t org = 0) noexcept
 		{
-			utils::file_io fio;
-
-			if(!fio.open(path, "rb")) {
+			UNITS* dst[CHN];
+			for(uint32_t ch = 0; ch < CHN; ++ch) {
+				dst[ch] = &ch_[ch].units_;
+			}
+			utils::capture_file cap;
+			if(!cap.load_buffers(path, dst, CHN, org, BASE_)) {
 				return false;
 			}
-
 			for(uint32_t ch = 0; ch < CHN; ++ch) {
-				for(auto& w : ch_[ch].units_) {
-					fio.get<UNIT>(w);
-				}
-				ch_[ch].param_.update_ = true;
+				invalidate_(ch_[ch]);
 			}
-			fio.close();
-
 			return true;
 		}
 	};
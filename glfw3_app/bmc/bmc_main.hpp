@@ -268,8 +268,8 @@ namespace app {
 				if(bdf_page_->get_select_pos() != bdf_page_no_) {
 					bdf_page_no_ = bdf_page_->get_select_pos();
 					bmc.create_bdf_image(bdf_page_no_);
-					mobj_.destroy();
-					mobj_.initialize();
+					mobj_.erase(dst_handle_);
+					mobj_.compact();
 					dst_handle_ = mobj_.install(&bmc.get_dst_image());
 					dst_image_->at_local_param().mobj_ = mobj_;
 					dst_image_->at_local_param().mobj_handle_ = dst_handle_;
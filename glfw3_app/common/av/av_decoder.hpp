@@ -1,7 +1,20 @@
 #pragma once
 //=====================================================================//
 /*!	@file
-	@brief	FFmpeg Library/decoder クラス
+	@brief	FFmpeg Library/decoder クラス @n
+			デマックス、ビデオ・デコード、オーディオ・デコードを、それぞれ @n
+			別スレッドで行い、デコード済みのフレームをキューに溜める。@n
+			ビデオは、コーデックのフレーム・スレッドも使う。@n
+			表示側は、update に時間（秒）を渡すと、その時間までに表示すべき @n
+			フレームを取り出す（間に合わなかったフレームは捨てる）。@n
+			イメージは RGBA（横幅 * 4 バイトのライン）で、そのまま GL に転送出来る。@n
+			出力を YUV420 にすると、Y、U、V のプレーンを詰めた I420 を返す @n
+			（RGB 変換は、GL 側（gl::texfb）のシェーダーで行う）。@n
+			seek は、キーフレームのインデックスから直前のキーフレームへ移動し、@n
+			目的のフレームまでデコードを進める（フレーム単位で正確）。@n
+			インデックスは、コンテナの物を使い、無ければ別スレッドで @n
+			パケットを走査して作る（ファイル名 + ".kidx" に保存も出来る）。@n
+			seek で表示したフレームは、少数を LRU でキャッシュする（スクラブ用）。
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
 				Released under the MIT license @n
@@ -10,6 +23,16 @@
 //=====================================================================//
 #include <string>
 #include <deque>
+#include <list>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
 extern "C" {
 	#include <libavcodec/avcodec.h>
 	#include <libavfilter/avfilter.h>
@@ -17,6 +40,7 @@ extern "C" {
 	#include <libswscale/swscale.h>
 };
 #include "utils/vtx.hpp"
+#include "utils/file_io.hpp"
 #include "snd_io/i_audio.hpp"
 #include "snd_io/pcm.hpp"
 
@@ -24,7 +48,8 @@ namespace av {
 
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	/*!
-		@brief	decoder クラス
+		@brief	decoder クラス @n
+				open, update, get_image, at_audio, close は、一つのスレッド（表示側）から呼ぶ事。
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	class decoder {
@@ -45,107 +70,607 @@ namespace av {
 
 		typedef std::deque<al::audio>  audio_deque;
 
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief	イメージの出力形式
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		enum class output {
+			RGBA,		///< RGBA 32 ビット
+			YUV420,		///< YUV 4:2:0 プレーナー（I420）
+		};
+
+
+		//=================================================================//
+		/*!
+			@brief	統計情報
+		*/
+		//=================================================================//
+		struct info_t {
+			uint32_t	decoded;	///< デコードしたビデオ・フレーム数
+			uint32_t	shown;		///< 表示したビデオ・フレーム数
+			uint32_t	dropped;	///< 間に合わずに捨てたビデオ・フレーム数
+			uint32_t	audio_drop;	///< 溢れて捨てたオーディオ・ブロック数
+			info_t() : decoded(0), shown(0), dropped(0), audio_drop(0) { }
+		};
+
 	private:
-		struct fb_t {
-			AVFrame* 	image_;
-			uint8_t*	buff_;
-			fb_t() : image_(nullptr), buff_(nullptr) { }
+		// スレッド間の制限付きキュー
+		template <class T>
+		class queue_t {
+			std::deque<T>	q_;
+			uint32_t		limit_;
+			std::mutex		sync_;
+			std::condition_variable	cond_;
+			bool			abort_;
+		public:
+			explicit queue_t(uint32_t limit) : q_(), limit_(limit), sync_(), cond_(), abort_(false) { }
+
+			void abort() {
+				std::lock_guard<std::mutex> lock(sync_);
+				abort_ = true;
+				cond_.notify_all();
+			}
+
+			template <class F>
+			void reset(F func) {
+				std::lock_guard<std::mutex> lock(sync_);
+				for(auto& t : q_) func(t);
+				q_.clear();
+				abort_ = false;
+			}
+
+			// 空きが出来るまで待つ（中断された場合「false」）
+			bool push(T t) {
+				std::unique_lock<std::mutex> lock(sync_);
+				cond_.wait(lock, [this] { return abort_ || q_.size() < limit_; });
+				if(abort_) return false;
+				q_.push_back(std::move(t));
+				cond_.notify_all();
+				return true;
+			}
+
+			// wait が「true」なら、データが来るまで待つ
+			bool pop(T& t, bool wait = true) {
+				std::unique_lock<std::mutex> lock(sync_);
+				if(wait) cond_.wait(lock, [this] { return abort_ || !q_.empty(); });
+				if(abort_ || q_.empty()) return false;
+				t = std::move(q_.front());
+				q_.pop_front();
+				cond_.notify_all();
+				return true;
+			}
+
+			// 先頭が条件を満たす場合だけ取り出す（待たない）
+			template <class F>
+			bool pop_if(T& t, F func) {
+				std::lock_guard<std::mutex> lock(sync_);
+				if(abort_ || q_.empty() || !func(q_.front())) return false;
+				t = std::move(q_.front());
+				q_.pop_front();
+				cond_.notify_all();
+				return true;
+			}
+		};
+
+		struct frame_t {
+			double					pts;
+			std::vector<uint8_t>	image;	///< RGBA
+			frame_t() : pts(0.0), image() { }
 		};
+		typedef std::unique_ptr<frame_t>	frame_ptr;
+
+		struct cache_t {
+			int64_t					no;		///< フレーム番号
+			std::vector<uint8_t>	image;
+			cache_t() : no(0), image() { }
+		};
+		typedef std::list<cache_t>	cache_list;
+
+		static const uint32_t	packet_limit_ = 256;	///< パケット・キューの段数
+		static const uint32_t	frame_num_ = 6;			///< デコード済みフレームの数
+		static const uint32_t	audio_limit_ = 128;		///< オーディオ・ブロックの段数
+		static const uint32_t	cache_num_ = 8;			///< seek フレーム・キャッシュの数
+		static const uint32_t	index_version_ = 1;		///< インデックス・ファイルのバージョン
 
 		std::string			path_;
 		AVFormatContext*	format_ctx_;
 		AVStream*			video_stream_;
+		AVStream*			audio_stream_;
 		AVCodecContext*		video_ctx_;
 		AVCodecContext*		audio_ctx_;
-///		int					video_idx_;
-///		int					audio_idx_;
-		AVFrame* 			frame_;
-		fb_t				fb_[2];
-		uint32_t			fb_put_;
-		uint32_t			fb_get_;
+		int					video_idx_;
+		int					audio_idx_;
 		vtx::ipos			size_;
-		SwsContext*			sws_ctx_;
+		SwsContext*			sws_ctx_;		///< ビデオ・スレッドだけが使う
+		output				output_;
 		uint32_t			vcount_;
 		uint32_t			acount_;
 		double				fps_;
+		double				start_;
 		double				video_sum_;
 		double				audio_sum_;
 		audio_deque			audio_deque_;
 
+		queue_t<AVPacket*>	vpkt_;
+		queue_t<AVPacket*>	apkt_;
+		queue_t<frame_ptr>	ready_;		///< デコード済み（nullptr は終端）
+		queue_t<frame_ptr>	pool_;		///< 空きフレーム
+		queue_t<al::audio>	audio_;		///< デコード済みオーディオ
+
+		std::thread			demux_thread_;
+		std::thread			video_thread_;
+		std::thread			audio_thread_;
+
+		frame_ptr			cur_;
+		bool				new_image_;
+		bool				video_eof_;
+
+		std::thread			index_thread_;
+		std::mutex			key_sync_;
+		std::vector<int64_t>	keys_;		///< キーフレームの時間（ストリームのタイムベース）
+		std::atomic<bool>	index_abort_;
+		std::atomic<bool>	index_done_;
+		bool				index_cache_;
+
+		std::atomic<double>	skip_;		///< この時間より前のフレームは捨てる（seek）
+		int64_t				seek_no_;	///< キャッシュ待ちのフレーム番号
+		cache_list			cache_;
+
+		std::atomic<double>		clock_;
+		std::atomic<uint32_t>	decoded_;
+		std::atomic<uint32_t>	late_;
+		info_t				info_;
+
 		bool				init_;
 
-#if 0
-		al::audio create_audio_() {
-			al::audio aif = al::audio(new al::audio_sto16);
-			if(aif) {
-				aif->create(audio_ctx_->sample_rate, frame_->nb_samples);
-				typedef std::function<void (al::audio aif, int idx, const void* right, const void* left) > 
-					fill_func;
-				fill_func func;
-				if(audio_ctx_->sample_fmt == AV_SAMPLE_FMT_FLTP
-				|| audio_ctx_->sample_fmt == AV_SAMPLE_FMT_FLT) {
-					func = [&] (al::audio aif, int idx, const void* right, const void* left) {
-						const float* r = static_cast<const float*>(right);
-						int ir = static_cast<int>(r[idx] * 32767.0f);
-						ir = std::max(ir, -32768);
-						ir = std::min(ir,  32767);
-						int il = ir;
-						if(left) {
-							const float* l = static_cast<const float*>(left);
-							il = static_cast<int>(l[idx] * 32767.0f);
-							il = std::max(il, -32768);
-							il = std::min(il,  32767);
-						}
-						al::pcm16_s w(il, ir);
-						aif->put(idx, w);
-					};
-				} else if(audio_ctx_->sample_fmt == AV_SAMPLE_FMT_S16P
-						|| audio_ctx_->sample_fmt == AV_SAMPLE_FMT_S16) {
-					func = [&] (al::audio aif, int idx, const void* left, const void* right) {
-						const int16_t* r = static_cast<const int16_t*>(right);
-						int16_t ir = r[idx];
-						int16_t il = ir;
-						if(left) {
-							const int16_t* l = static_cast<const int16_t*>(left);
-							il = l[idx];
-						}
-						al::pcm16_s w(il, ir);
-						aif->put(idx, w);
-					};
-				} else if(audio_ctx_->sample_fmt == AV_SAMPLE_FMT_U8P
-						|| audio_ctx_->sample_fmt == AV_SAMPLE_FMT_U8) {
-					func = [&] (al::audio aif, int idx, const void* left, const void* right) {
-						const uint8_t* r = static_cast<const uint8_t*>(right);
-						int16_t ir = static_cast<int16_t>(r[idx]);
-						ir |= ir << 8;
-						ir -= 32768;
-						int16_t il = ir;
-						if(left) {
-							const uint8_t* l = static_cast<const uint8_t*>(left);
-							il = static_cast<int16_t>(l[idx]);
-							il |= il << 8;
-							il -= 32768;
-						}
-						al::pcm16_s w(il, ir);
-						aif->put(idx, w);
-					};
+
+		static int channels_(const AVCodecContext* ctx)
+		{
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(59, 37, 100)
+			return ctx->ch_layout.nb_channels;
+#else
+			return ctx->channels;
+#endif
+		}
+
+
+		static int16_t sample_(const uint8_t* p, AVSampleFormat fmt, int idx)
+		{
+			switch(fmt) {
+			case AV_SAMPLE_FMT_U8:
+				return static_cast<int16_t>((static_cast<int>(p[idx]) - 128) << 8);
+			case AV_SAMPLE_FMT_S16:
+				return reinterpret_cast<const int16_t*>(p)[idx];
+			case AV_SAMPLE_FMT_S32:
+				return static_cast<int16_t>(reinterpret_cast<const int32_t*>(p)[idx] >> 16);
+			case AV_SAMPLE_FMT_FLT:
+				{
+					int v = static_cast<int>(reinterpret_cast<const float*>(p)[idx] * 32767.0f);
+					return static_cast<int16_t>(std::min(std::max(v, -32768), 32767));
+				}
+			case AV_SAMPLE_FMT_DBL:
+				{
+					int v = static_cast<int>(reinterpret_cast<const double*>(p)[idx] * 32767.0);
+					return static_cast<int16_t>(std::min(std::max(v, -32768), 32767));
+				}
+			default:
+				return 0;
+			}
+		}
+
+
+		// ステレオ 16 ビットに変換
+		al::audio create_audio_(const AVFrame* fr) const
+		{
+			AVSampleFormat fmt = static_cast<AVSampleFormat>(fr->format);
+			bool planar = av_sample_fmt_is_planar(fmt) != 0;
+			AVSampleFormat pfmt = av_get_packed_sample_fmt(fmt);
+			int ch = channels_(audio_ctx_);
+			if(ch < 1) ch = 1;
+
+			al::audio_sto16* pcm = new al::audio_sto16;
+			al::audio aif(pcm);
+			pcm->create(fr->sample_rate, fr->nb_samples);
+			al::pcm16_s* dst = static_cast<al::pcm16_s*>(pcm->at_wave());
+			for(int i = 0; i < fr->nb_samples; ++i) {
+				int16_t l;
+				int16_t r;
+				if(planar) {
+					l = sample_(fr->extended_data[0], pfmt, i);
+					r = ch > 1 ? sample_(fr->extended_data[1], pfmt, i) : l;
+				} else {
+					l = sample_(fr->extended_data[0], pfmt, i * ch);
+					r = ch > 1 ? sample_(fr->extended_data[0], pfmt, i * ch + 1) : l;
 				}
+				dst[i].l = l;
+				dst[i].r = r;
+			}
+			return aif;
+		}
+
+
+		static double pts_(const AVFrame* fr, const AVStream* st)
+		{
+			if(fr->best_effort_timestamp == AV_NOPTS_VALUE) return -1.0;
+			return static_cast<double>(fr->best_effort_timestamp) * av_q2d(st->time_base);
+		}
+
+
+		void demux_task_()
+		{
+			while(1) {
+				AVPacket* pkt = av_packet_alloc();
+				if(pkt == nullptr) break;
+				if(av_read_frame(format_ctx_, pkt) < 0) {
+					av_packet_free(&pkt);
+					break;
+				}
+				bool ok = true;
+				if(pkt->stream_index == video_idx_) {
+					ok = vpkt_.push(pkt);
+				} else if(pkt->stream_index == audio_idx_) {
+					ok = apkt_.push(pkt);
+				} else {
+					av_packet_free(&pkt);
+					continue;
+				}
+				if(!ok) {
+					av_packet_free(&pkt);
+					return;
+				}
+			}
+			// 終端（フラッシュ）
+			vpkt_.push(nullptr);
+			if(audio_ctx_ != nullptr) apkt_.push(nullptr);
+		}
+
+
+		// 受信したフレームを RGBA に変換してキューに積む
+		bool video_frame_(AVFrame* fr, double& last)
+		{
+			double pts = pts_(fr, video_stream_);
+			if(pts < 0.0) {
+				pts = last + (fps_ > 0.0 ? 1.0 / fps_ : 0.0);
+			}
+			last = pts;
+			pts -= start_;
+			++decoded_;
+
+			// seek の目的フレームより前は、変換せずに捨てる
+			if(pts < skip_.load()) {
+				return true;
+			}
+
+			// 既に表示時間を過ぎているフレームは、変換せずに捨てる
+			double next = pts + (fps_ > 0.0 ? 1.0 / fps_ : 0.0);
+			if(next < clock_.load()) {
+				++late_;
+				return true;
+			}
 
-				if(func) {
-					if(audio_ctx_->channels == 1) {
-						for(uint32_t i = 0; i < frame_->nb_samples; ++i) {
-							func(aif, i, frame_->extended_data[0], nullptr);
+			frame_ptr f;
+			if(!pool_.pop(f)) return false;
+			f->pts = pts;
+
+			AVPixelFormat fmt = static_cast<AVPixelFormat>(fr->format);
+			if(output_ == output::YUV420) {
+				int cw = (size_.x + 1) / 2;
+				int ch = (size_.y + 1) / 2;
+				uint8_t* dst[4] = { &f->image[0], &f->image[size_.x * size_.y],
+					&f->image[size_.x * size_.y + cw * ch], nullptr };
+				int dst_line[4] = { size_.x, cw, cw, 0 };
+				// 既に 4:2:0 プレーナーなら、プレーンをコピーするだけ
+				if((fmt == AV_PIX_FMT_YUV420P || fmt == AV_PIX_FMT_YUVJ420P)
+					&& fr->width == size_.x && fr->height == size_.y) {
+					for(int i = 0; i < 3; ++i) {
+						int w = i == 0 ? size_.x : cw;
+						int h = i == 0 ? size_.y : ch;
+						for(int y = 0; y < h; ++y) {
+							std::memcpy(dst[i] + y * w, fr->data[i] + y * fr->linesize[i], w);
 						}
+					}
+					return ready_.push(std::move(f));
+				}
+				sws_ctx_ = sws_getCachedContext(sws_ctx_, fr->width, fr->height, fmt, size_.x, size_.y,
+					AV_PIX_FMT_YUV420P, SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
+				if(sws_ctx_ == nullptr) {
+					pool_.push(std::move(f));
+					return true;
+				}
+				sws_scale(sws_ctx_, fr->data, fr->linesize, 0, fr->height, dst, dst_line);
+				return ready_.push(std::move(f));
+			}
+
+			sws_ctx_ = sws_getCachedContext(sws_ctx_, fr->width, fr->height, fmt, size_.x, size_.y,
+				AV_PIX_FMT_RGBA, SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
+			if(sws_ctx_ == nullptr) {
+				pool_.push(std::move(f));
+				return true;
+			}
+			uint8_t* dst[4] = { &f->image[0], nullptr, nullptr, nullptr };
+			int dst_line[4] = { size_.x * 4, 0, 0, 0 };
+			sws_scale(sws_ctx_, fr->data, fr->linesize, 0, fr->height, dst, dst_line);
+			return ready_.push(std::move(f));
+		}
+
+
+		void video_task_()
+		{
+			AVFrame* fr = av_frame_alloc();
+			double last = start_;
+			bool run = fr != nullptr;
+			while(run) {
+				AVPacket* pkt = nullptr;
+				if(!vpkt_.pop(pkt)) break;
+				int ret = avcodec_send_packet(video_ctx_, pkt);
+				av_packet_free(&pkt);
+				if(ret < 0 && ret != AVERROR(EAGAIN) && ret != AVERROR_EOF) continue;
+				while(run) {
+					ret = avcodec_receive_frame(video_ctx_, fr);
+					if(ret == AVERROR_EOF) {
+						run = false;
+					} else if(ret < 0) {
+						break;
 					} else {
-						for(uint32_t i = 0; i < frame_->nb_samples; ++i) {
-							func(aif, i, frame_->extended_data[0], frame_->extended_data[1]);
+						run = video_frame_(fr, last);
+						av_frame_unref(fr);
+					}
+				}
+				if(ret == AVERROR_EOF) {
+					ready_.push(frame_ptr());
+				}
+			}
+			av_frame_free(&fr);
+		}
+
+
+		void audio_task_()
+		{
+			AVFrame* fr = av_frame_alloc();
+			bool run = fr != nullptr;
+			while(run) {
+				AVPacket* pkt = nullptr;
+				if(!apkt_.pop(pkt)) break;
+				int ret = avcodec_send_packet(audio_ctx_, pkt);
+				av_packet_free(&pkt);
+				if(ret < 0 && ret != AVERROR(EAGAIN) && ret != AVERROR_EOF) continue;
+				while(run) {
+					ret = avcodec_receive_frame(audio_ctx_, fr);
+					if(ret == AVERROR_EOF) {
+						run = false;
+					} else if(ret < 0) {
+						break;
+					} else {
+						double pts = pts_(fr, audio_stream_);
+						double end = pts - start_ + static_cast<double>(fr->nb_samples)
+							/ static_cast<double>(fr->sample_rate > 0 ? fr->sample_rate : 1);
+						if(pts < 0.0 || end > skip_.load()) {
+							run = audio_.push(create_audio_(fr));
 						}
+						av_frame_unref(fr);
 					}
 				}
 			}
-			return aif;
+			av_frame_free(&fr);
+		}
+
+
+		// キーフレームを時間順に追加
+		void add_key_(int64_t ts)
+		{
+			std::lock_guard<std::mutex> lock(key_sync_);
+			auto it = std::lower_bound(keys_.begin(), keys_.end(), ts);
+			if(it == keys_.end() || *it != ts) keys_.insert(it, ts);
+		}
+
+
+		// ts 以前で最も近いキーフレーム（無い場合 AV_NOPTS_VALUE）
+		int64_t find_key_(int64_t ts)
+		{
+			std::lock_guard<std::mutex> lock(key_sync_);
+			auto it = std::upper_bound(keys_.begin(), keys_.end(), ts);
+			if(it == keys_.begin()) return AV_NOPTS_VALUE;
+			return *(--it);
+		}
+
+
+		std::string index_path_() const { return path_ + ".kidx"; }
+
+
+		bool load_index_()
+		{
+			utils::file_io fin;
+			if(!fin.open(index_path_(), "rb")) return false;
+			char magic[4];
+			uint32_t ver = 0;
+			uint64_t fsize = 0;
+			uint32_t idx = 0;
+			uint32_t num = 0;
+			if(fin.read(magic, 4) != 4 || std::memcmp(magic, "KIDX", 4) != 0) return false;
+			if(fin.read(ver) != sizeof(ver) || ver != index_version_) return false;
+			if(fin.read(fsize) != sizeof(fsize) || fsize != utils::get_file_size(path_)) return false;
+			if(fin.read(idx) != sizeof(idx) || static_cast<int>(idx) != video_idx_) return false;
+			if(fin.read(num) != sizeof(num) || num == 0) return false;
+			std::vector<int64_t> keys(num);
+			if(fin.read(&keys[0], sizeof(int64_t) * num) != sizeof(int64_t) * num) return false;
+			if(!std::is_sorted(keys.begin(), keys.end())) return false;
+			std::lock_guard<std::mutex> lock(key_sync_);
+			keys_.swap(keys);
+			return true;
+		}
+
+
+		void save_index_()
+		{
+			std::vector<int64_t> keys;
+			{
+				std::lock_guard<std::mutex> lock(key_sync_);
+				keys = keys_;
+			}
+			if(keys.empty()) return;
+			utils::file_io fout;
+			if(!fout.open(index_path_(), "wb")) return;
+			uint32_t ver = index_version_;
+			uint64_t fsize = utils::get_file_size(path_);
+			uint32_t idx = video_idx_;
+			uint32_t num = keys.size();
+			fout.write("KIDX", 4);
+			fout.write(ver);
+			fout.write(fsize);
+			fout.write(idx);
+			fout.write(num);
+			fout.write(&keys[0], sizeof(int64_t) * num);
 		}
+
+
+		// コンテナのインデックスからキーフレームを拾う
+		bool container_index_()
+		{
+#if LIBAVFORMAT_VERSION_INT >= AV_VERSION_INT(58, 78, 100)
+			int n = avformat_index_get_entries_count(video_stream_);
+			for(int i = 0; i < n; ++i) {
+				const AVIndexEntry* e = avformat_index_get_entry(video_stream_, i);
+				if(e != nullptr && (e->flags & AVINDEX_KEYFRAME) != 0) add_key_(e->timestamp);
+			}
+#else
+			for(int i = 0; i < video_stream_->nb_index_entries; ++i) {
+				const AVIndexEntry& e = video_stream_->index_entries[i];
+				if((e.flags & AVINDEX_KEYFRAME) != 0) add_key_(e.timestamp);
+			}
 #endif
+			std::lock_guard<std::mutex> lock(key_sync_);
+			return !keys_.empty();
+		}
+
+
+		// 別のコンテキストでパケットを走査して、インデックスを作る
+		void index_task_()
+		{
+			AVFormatContext* ctx = nullptr;
+			if(avformat_open_input(&ctx, path_.c_str(), NULL, NULL) != 0) return;
+			AVPacket* pkt = av_packet_alloc();
+			bool end = false;
+			while(pkt != nullptr && !index_abort_.load()) {
+				if(av_read_frame(ctx, pkt) < 0) {
+					end = true;
+					break;
+				}
+				if(pkt->stream_index == video_idx_ && (pkt->flags & AV_PKT_FLAG_KEY) != 0) {
+					int64_t ts = pkt->pts != AV_NOPTS_VALUE ? pkt->pts : pkt->dts;
+					if(ts != AV_NOPTS_VALUE) add_key_(ts);
+				}
+				av_packet_unref(pkt);
+			}
+			av_packet_free(&pkt);
+			avformat_close_input(&ctx);
+			if(end) {
+				index_done_ = true;
+				if(index_cache_) save_index_();
+			}
+		}
+
+
+		// フレームを全てプールに戻す（足りない分は作る）
+		void reset_frames_()
+		{
+			std::vector<frame_ptr> spare;
+			auto keep = [&spare](frame_ptr& f) { if(f) spare.push_back(std::move(f)); };
+			pool_.reset(keep);
+			ready_.reset(keep);
+			if(cur_) spare.push_back(std::move(cur_));
+			uint32_t fsize = size_.x * size_.y * 4;
+			if(output_ == output::YUV420) {
+				fsize = size_.x * size_.y + ((size_.x + 1) / 2) * ((size_.y + 1) / 2) * 2;
+			}
+			for(uint32_t i = 0; i < frame_num_; ++i) {
+				frame_ptr f;
+				if(i < spare.size() && spare[i]->image.size() == fsize) {
+					f = std::move(spare[i]);
+				} else {
+					f.reset(new frame_t);
+					f->image.resize(fsize);
+				}
+				pool_.push(std::move(f));
+			}
+		}
+
+
+		void start_threads_()
+		{
+			audio_.reset([](al::audio&) { });
+			auto free_pkt = [](AVPacket*& p) { av_packet_free(&p); };
+			vpkt_.reset(free_pkt);
+			apkt_.reset(free_pkt);
+
+			demux_thread_ = std::thread(&decoder::demux_task_, this);
+			video_thread_ = std::thread(&decoder::video_task_, this);
+			if(audio_ctx_ != nullptr) {
+				audio_thread_ = std::thread(&decoder::audio_task_, this);
+			}
+		}
+
+
+		void stop_threads_()
+		{
+			vpkt_.abort();
+			apkt_.abort();
+			ready_.abort();
+			pool_.abort();
+			audio_.abort();
+			if(demux_thread_.joinable()) demux_thread_.join();
+			if(video_thread_.joinable()) video_thread_.join();
+			if(audio_thread_.joinable()) audio_thread_.join();
+
+			auto free_pkt = [](AVPacket*& p) { av_packet_free(&p); };
+			vpkt_.reset(free_pkt);
+			apkt_.reset(free_pkt);
+		}
+
+
+		void cache_frame_(int64_t no, const frame_t& f)
+		{
+			auto it = std::find_if(cache_.begin(), cache_.end(),
+				[no](const cache_t& c) { return c.no == no; });
+			if(it == cache_.end()) {
+				if(cache_.size() >= cache_num_) {
+					cache_.splice(cache_.begin(), cache_, std::prev(cache_.end()));
+				} else {
+					cache_.emplace_front();
+				}
+				it = cache_.begin();
+			} else {
+				cache_.splice(cache_.begin(), cache_, it);
+			}
+			it->no = no;
+			it->image = f.image;
+		}
+
+
+		static AVCodecContext* open_codec_(const AVStream* st, bool threads)
+		{
+			const AVCodec* codec = avcodec_find_decoder(st->codecpar->codec_id);
+			if(codec == nullptr) return nullptr;
+
+			AVCodecContext* ctx = avcodec_alloc_context3(codec);
+			if(ctx == nullptr) return nullptr;
+
+			if(avcodec_parameters_to_context(ctx, st->codecpar) < 0) {
+				avcodec_free_context(&ctx);
+				return nullptr;
+			}
+			ctx->pkt_timebase = st->time_base;
+			if(threads) {
+				ctx->thread_count = 0;  // コア数に合わせる
+				ctx->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+			}
+			if(avcodec_open2(ctx, codec, nullptr) < 0) {
+				avcodec_free_context(&ctx);
+				return nullptr;
+			}
+			return ctx;
+		}
 
 	public:
 		//-----------------------------------------------------------------//
@@ -154,13 +679,21 @@ namespace av {
 		*/
 		//-----------------------------------------------------------------//
 		decoder() : path_(), format_ctx_(nullptr),
-					video_stream_(nullptr),
+					video_stream_(nullptr), audio_stream_(nullptr),
 					video_ctx_(nullptr), audio_ctx_(nullptr),
-					frame_(nullptr),
-					fb_(), fb_put_(0), fb_get_(0),
-					size_(0), sws_ctx_(nullptr),
+					video_idx_(-1), audio_idx_(-1),
+					size_(0), sws_ctx_(nullptr), output_(output::RGBA),
 					vcount_(0), acount_(0),
-					fps_(0.0), video_sum_(0.0), audio_sum_(0.0),
+					fps_(0.0), start_(0.0), video_sum_(0.0), audio_sum_(0.0),
+					audio_deque_(),
+					vpkt_(packet_limit_), apkt_(packet_limit_),
+					ready_(frame_num_ + 1), pool_(frame_num_), audio_(audio_limit_),
+					demux_thread_(), video_thread_(), audio_thread_(),
+					cur_(), new_image_(false), video_eof_(false),
+					index_thread_(), key_sync_(), keys_(),
+					index_abort_(false), index_done_(false), index_cache_(false),
+					skip_(0.0), seek_no_(-1), cache_(),
+					clock_(0.0), decoded_(0), late_(0), info_(),
 					init_(false) { }
 
 
@@ -192,24 +725,70 @@ namespace av {
 		*/
 		//-----------------------------------------------------------------//
 		void info() {
-			av_dump_format(format_ctx_, 0, path_.c_str(), 1);
+			av_dump_format(format_ctx_, 0, path_.c_str(), 0);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	イメージの出力形式を設定（open の前に設定する）
+			@param[in]	t	出力形式
+		*/
+		//-----------------------------------------------------------------//
+		void set_output(output t) { output_ = t; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	イメージの出力形式を取得
+			@return 出力形式
+		*/
+		//-----------------------------------------------------------------//
+		output get_output() const { return output_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	YUV の色空間が BT.709 か検査
+			@return BT.709 なら「true」（それ以外は BT.601 として扱う）
+		*/
+		//-----------------------------------------------------------------//
+		bool is_bt709() const {
+			if(video_ctx_ == nullptr) return false;
+			if(video_ctx_->colorspace == AVCOL_SPC_BT709) return true;
+			if(video_ctx_->colorspace == AVCOL_SPC_UNSPECIFIED) {
+				return video_ctx_->height >= 720;  // HD は BT.709 とみなす
+			}
+			return false;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	YUV がフルレンジ（0-255）か検査
+			@return フルレンジなら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool is_full_range() const {
+			if(video_ctx_ == nullptr) return false;
+			return video_ctx_->color_range == AVCOL_RANGE_JPEG
+				|| video_ctx_->pix_fmt == AV_PIX_FMT_YUVJ420P;
 		}
 
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief	オープン
+			@brief	オープン（デコード・スレッドを起動する）
 			@param[in]	path	ファイル名パス
 			@return エラーなら「false」
 		*/
 		//-----------------------------------------------------------------//
 		bool open(const std::string& path) {
+			close();
+
 			path_ = path;
-///			video_idx_ = -1;
-///			audio_idx_ = -1;
-///			video_ctx_ = nullptr;
-///			audio_ctx_ = nullptr;
 			fps_ = 0.0;
+			start_ = 0.0;
 			video_sum_ = 0.0;
 			audio_sum_ = 0.0;
 
@@ -217,143 +796,229 @@ namespace av {
 
 			// ビデオファイルを開く
 			if(avformat_open_input(&format_ctx_, path.c_str(), NULL, NULL) != 0) {
-				// std::cerr << "ERROR: avformat_open_input(): '" << file_name << '\'' << std::endl;
 				return false;
 			}
 
 			// ストリーム情報の取得
 			if(avformat_find_stream_info(format_ctx_, NULL) < 0) {
-				// std::cerr << "ERROR: avformat_find_stream_info(): '" << file_name << '\'' << std::endl;
 				close();
 				return false;
 			}
 
-			video_stream_ = nullptr;
-			for(int i = 0; i < format_ctx_->nb_streams; ++i) {
-				if(format_ctx_->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_VIDEO) {
-					video_stream_ = format_ctx_->streams[i];
-					break;
-				}
-			}
+			// ログ・レベルの設定
+			av_log_set_level(1);
 
-			// コーデックが見つかったか？
-			if(video_stream_ == nullptr) {
+			video_idx_ = av_find_best_stream(format_ctx_, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+			if(video_idx_ < 0) {
 				close();
 				return false;
 			}
-
-			// デコーダー作成
-			const AVCodec* codec = avcodec_find_decoder(video_stream_->codecpar->codec_id);
-			if(codec == nullptr) {
+			video_stream_ = format_ctx_->streams[video_idx_];
+			video_ctx_ = open_codec_(video_stream_, true);
+			if(video_ctx_ == nullptr) {
 				close();
 				return false;
 			}
 
-			video_ctx_ = avcodec_alloc_context3(codec);
-			if(video_ctx_ == nullptr) {
-				close();
-				return false;
+			// オーディオは無くても良い
+			audio_idx_ = av_find_best_stream(format_ctx_, AVMEDIA_TYPE_AUDIO, -1, video_idx_, nullptr, 0);
+			if(audio_idx_ >= 0) {
+				audio_stream_ = format_ctx_->streams[audio_idx_];
+				audio_ctx_ = open_codec_(audio_stream_, false);
+			}
+			if(audio_ctx_ == nullptr) {
+				audio_stream_ = nullptr;
+				audio_idx_ = -1;
 			}
 
-//			fps_ = av_q2d(format_ctx_->streams[video_idx_]->avg_frame_rate);
-//			std::cout << "FPS: " << fps << std::endl;
+			fps_ = av_q2d(video_stream_->avg_frame_rate);
+			if(fps_ <= 0.0) fps_ = av_q2d(video_stream_->r_frame_rate);
+			if(video_stream_->start_time != AV_NOPTS_VALUE) {
+				start_ = static_cast<double>(video_stream_->start_time) * av_q2d(video_stream_->time_base);
+			}
 
-			// ログ・レベルの設定
-			av_log_set_level(1);
+			size_.x = video_ctx_->width;
+			size_.y = video_ctx_->height;
 
-			// フレームの確保
-			frame_ = av_frame_alloc();
-
-			if(video_ctx_ != nullptr) {
-				size_.x = video_ctx_->width;
-				size_.y = video_ctx_->height;
-
-				for(int i = 0; i < 2; ++i) {
-					// イメージ格納バッファの確保
-					fb_[i].image_ = av_frame_alloc();
-					// イメージ用バッファの確保
-					fb_[i].buff_ = (unsigned char *)av_malloc(avpicture_get_size(AV_PIX_FMT_RGB24, size_.x, size_.y));
-					// バッファとフレームを関連付ける
-					avpicture_fill((AVPicture*)fb_[i].image_, fb_[i].buff_, AV_PIX_FMT_RGB24, size_.x, size_.y);
-				}
-				// スケーリング用コンテキストの取得
-				sws_ctx_ = sws_getContext(size_.x, size_.y, video_ctx_->pix_fmt, size_.x, size_.y,
-					AV_PIX_FMT_RGB24, SWS_FAST_BILINEAR, NULL, NULL, NULL);
-			}
+			reset_frames_();
 
 			vcount_ = 0;
 			acount_ = 0;
-			fb_put_ = 0;
-			fb_get_ = 0;
 			audio_deque_.clear();
+			cur_.reset();
+			new_image_ = false;
+			video_eof_ = false;
+			clock_ = 0.0;
+			skip_ = -1.0e9;
+			seek_no_ = -1;
+			cache_.clear();
+			decoded_ = 0;
+			late_ = 0;
+			info_ = info_t();
+
+			// キーフレーム・インデックス
+			{
+				std::lock_guard<std::mutex> lock(key_sync_);
+				keys_.clear();
+			}
+			index_abort_ = false;
+			index_done_ = container_index_() || (index_cache_ && load_index_());
+			if(!index_done_) {
+				index_thread_ = std::thread(&decoder::index_task_, this);
+			}
 
+			start_threads_();
 			return true;
 		}
 
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief	アップデート
+			@brief	インデックス・ファイルの使用を設定 @n
+					有効にすると、作ったインデックスを「ファイル名.kidx」に保存し、@n
+					次のオープンで読み込む（ファイル・サイズが違う場合は作り直す）。
+			@param[in]	ena	「true」で有効
+		*/
+		//-----------------------------------------------------------------//
+		void set_index_cache(bool ena = true) { index_cache_ = ena; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	キーフレーム・インデックスが完成しているか
+			@return 完成していれば「true」（作成中でも seek は出来る）
+		*/
+		//-----------------------------------------------------------------//
+		bool is_index_done() const { return index_done_.load(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	再生時間の長さを取得
+			@return 長さ（秒、不明な場合０）
+		*/
+		//-----------------------------------------------------------------//
+		double get_duration() const {
+			if(video_stream_ == nullptr) return 0.0;
+			if(video_stream_->duration != AV_NOPTS_VALUE && video_stream_->duration > 0) {
+				return static_cast<double>(video_stream_->duration) * av_q2d(video_stream_->time_base);
+			}
+			if(format_ctx_ != nullptr && format_ctx_->duration != AV_NOPTS_VALUE && format_ctx_->duration > 0) {
+				return static_cast<double>(format_ctx_->duration) / AV_TIME_BASE;
+			}
+			return 0.0;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	シーク @n
+					time 以前のキーフレームへ移動し、time のフレームまで @n
+					デコードを進める（time より前のフレーム、オーディオは捨てる）。@n
+					呼んだ後は、update に time から続く時間を渡す。
+			@param[in]	time	再生時間（秒、最初のフレームが０）
+			@return エラーなら「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool seek(double time) {
+			if(format_ctx_ == nullptr || video_ctx_ == nullptr) return false;
+			if(time < 0.0) time = 0.0;
+
+			stop_threads_();
+			avcodec_flush_buffers(video_ctx_);
+			if(audio_ctx_ != nullptr) avcodec_flush_buffers(audio_ctx_);
+
+			double tb = av_q2d(video_stream_->time_base);
+			int64_t ts = static_cast<int64_t>(std::floor((time + start_) / tb + 0.5));
+			int64_t key = find_key_(ts);
+			int ret = av_seek_frame(format_ctx_, video_idx_, key != AV_NOPTS_VALUE ? key : ts,
+				AVSEEK_FLAG_BACKWARD);
+			if(ret < 0) {  // 先頭からデコードを進める
+				int64_t top = video_stream_->start_time != AV_NOPTS_VALUE ? video_stream_->start_time : 0;
+				ret = av_seek_frame(format_ctx_, video_idx_, top, AVSEEK_FLAG_BACKWARD);
+			}
+
+			reset_frames_();
+			audio_deque_.clear();
+			new_image_ = false;
+			video_eof_ = false;
+			clock_ = time;
+			video_sum_ = time;
+			audio_sum_ = time;
+
+			double half = fps_ > 0.0 ? 0.5 / fps_ : 0.0;
+			int64_t no = static_cast<int64_t>(std::floor(time * fps_ + 0.5));
+			auto it = std::find_if(cache_.begin(), cache_.end(),
+				[no](const cache_t& c) { return c.no == no; });
+			if(it != cache_.end() && pool_.pop(cur_, false)) {
+				cache_.splice(cache_.begin(), cache_, it);
+				cur_->image = it->image;
+				cur_->pts = time;
+				new_image_ = true;
+				seek_no_ = -1;
+				skip_ = time + half;  // キャッシュしたフレームの次から
+			} else {
+				seek_no_ = no;
+				skip_ = time - half;
+			}
+
+			start_threads_();
+			return ret >= 0;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	アップデート @n
+					time までに表示すべきフレームを取り出す（複数ある場合、@n
+					最後のフレーム以外は捨てる）。@n
+					デコード済みのオーディオは、オーディオ・バッファへ移す。
+			@param[in]	time	再生時間（秒、最初のフレームが０）
 			@return フレーム終端なら「true」
 		*/
 		//-----------------------------------------------------------------//
-		bool update() {
+		bool update(double time) {
 			if(format_ctx_ == nullptr || video_ctx_ == nullptr) return true;
- 			if(video_idx_ < 0) return true;
-
-			// フレーム読み込みループ
-			AVPacket packet;
-			av_init_packet(&packet);
-//static int aa = 0;
-//static bool start = false;
-			while(av_read_frame(format_ctx_, &packet) >= 0) {
-
-//				if(aa > packet.pts) {
-//					start = true;
-//				}
-//				aa = packet.pts;
-//				std::cout << (int)packet.pts << std::endl << std::flush;
-
-				// デコード・ビデオ
-				if(packet.stream_index == video_idx_) {
-					int vstate;
-					int ret = avcodec_decode_video2(video_ctx_, frame_, &vstate, &packet);
-					if(ret >= 0 && vstate) {
-						// フレームを切り出し
-						fb_t& fb = fb_[fb_put_ & 1];
-						++fb_put_;
-						sws_scale(sws_ctx_, (const uint8_t **)frame_->data, frame_->linesize, 0,
-							video_ctx_->height, fb.image_->data, fb.image_->linesize);
-						++vcount_;
-						video_sum_ += 1.0 / fps_;
-						return false;
-//						std::cout << 'V';
-					}
-				}
 
-				// デコード・オーディオ
-				if(packet.stream_index == audio_idx_) {
-					int astate;
-					int ret = avcodec_decode_audio4(audio_ctx_, frame_, &astate, &packet);
-					if(ret >= 0 && astate) {
-						if(audio_deque_.size() < 128) { 
-							al::audio ai = create_audio_();
-							audio_deque_.push_back(ai);
-							++acount_;
-							double at = static_cast<double>(frame_->nb_samples)
-									  / static_cast<double>(audio_ctx_->sample_rate);
-							audio_sum_ += at;
-//							std::cout << 'A';
-						}
-					}
+			clock_ = time;
+
+			// オーディオ
+			al::audio a;
+			while(audio_.pop(a, false)) {
+				if(audio_deque_.size() < audio_limit_) {
+					audio_deque_.push_back(a);
+					++acount_;
+					audio_sum_ += static_cast<double>(a->get_samples())
+						/ static_cast<double>(a->get_rate());
+				} else {
+					++info_.audio_drop;
 				}
+			}
 
-				if((fb_put_ - fb_get_) == 2) {
-///					std::cout << std::endl << std::flush;
-//					return false;
+			// ビデオ
+			frame_ptr f;
+			while(!video_eof_ && ready_.pop_if(f, [time](const frame_ptr& t) {
+					return !t || t->pts <= time; })) {
+				if(!f) {
+					video_eof_ = true;
+					break;
 				}
+				if(new_image_) {  // 表示されなかったフレーム
+					++info_.dropped;
+				}
+				if(cur_) pool_.push(std::move(cur_));
+				cur_ = std::move(f);
+				new_image_ = true;
+				if(seek_no_ >= 0) {
+					cache_frame_(seek_no_, *cur_);
+					seek_no_ = -1;
+				}
+				++vcount_;
+				video_sum_ = cur_->pts;
 			}
-			return true;
+
+			info_.decoded = decoded_.load();
+			return video_eof_ && !new_image_;
 		}
 
 
@@ -369,7 +1034,7 @@ namespace av {
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	ビデオ時間を取得
-			@return ビデオ時間
+			@return ビデオ時間（表示中フレームの時間）
 		*/
 		//-----------------------------------------------------------------//
 		double get_video_time() const { return video_sum_; }
@@ -395,21 +1060,22 @@ namespace av {
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief	イメージを取得
-			@return RGB24 イメージ
+			@brief	イメージを取得 @n
+					次の update までは有効。
+			@return RGBA、又は I420 イメージ（新しいフレームが無い場合 nullptr）
 		*/
 		//-----------------------------------------------------------------//
 		const uint8_t* get_image() {
-			if(format_ctx_ == nullptr || video_ctx_ == nullptr || video_idx_ < 0) return nullptr;
-			const uint8_t* p = fb_[fb_get_ & 1].buff_;
-			++fb_get_;
-			return p; 
+			if(!new_image_ || !cur_) return nullptr;
+			new_image_ = false;
+			++info_.shown;
+			return &cur_->image[0];
 		}
 
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief	オーディオ・フォーマットを取得
+			@brief	オーディオ・フォーマットを取得（ソースのフォーマット）
 			@return オーディオ・フォーマット
 		*/
 		//-----------------------------------------------------------------//
@@ -450,13 +1116,13 @@ namespace av {
 		//-----------------------------------------------------------------//
 		uint32_t get_audio_chanel() const {
 			if(audio_ctx_ == nullptr || audio_idx_ < 0) return 0;
-			return audio_ctx_->channels;			
+			return channels_(audio_ctx_);
 		}
 
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief	オーディオ・バッファを参照
+			@brief	オーディオ・バッファを参照（ステレオ 16 ビット）
 			@return オーディオ・バッファ
 		*/
 		//-----------------------------------------------------------------//
@@ -475,26 +1141,33 @@ namespace av {
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief	クローズ
+			@brief	統計情報を取得
+			@return 統計情報
+		*/
+		//-----------------------------------------------------------------//
+		info_t get_info() const {
+			info_t t = info_;
+			t.dropped += late_.load();
+			return t;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	クローズ（デコード・スレッドを停止する）
 		*/
 		//-----------------------------------------------------------------//
 		void close() {
-//			std::cout << "Video: " << (int)vcount_ << std::endl;
-//			std::cout << "Audio: " << (int)acount_ << std::endl;
+			index_abort_ = true;
+			if(index_thread_.joinable()) index_thread_.join();
+			stop_threads_();
+			cur_.reset();
+			new_image_ = false;
+			cache_.clear();
 
 			sws_freeContext(sws_ctx_);
 			sws_ctx_ = nullptr;
 
-			for(int i = 0; i < 2; ++i) {
-				av_free(fb_[i].image_);
-				fb_[i].image_ = nullptr;
-				av_free(fb_[i].buff_);
-				fb_[i].buff_ = nullptr;
-			}
-
-			av_free(frame_);
-			frame_ = nullptr;
-
 			if(audio_ctx_ != nullptr) {
 				avcodec_free_context(&audio_ctx_);
 				audio_ctx_ = nullptr;
@@ -504,6 +1177,10 @@ namespace av {
 				avcodec_free_context(&video_ctx_);
 				video_ctx_ = nullptr;
 			}
+			video_stream_ = nullptr;
+			audio_stream_ = nullptr;
+			video_idx_ = -1;
+			audio_idx_ = -1;
 
 			avformat_close_input(&format_ctx_);
 			format_ctx_ = nullptr;
@@ -13,9 +13,14 @@
 #include "core/device.hpp"
 #include "utils/string_utils.hpp"
 #include "utils/drive_info.hpp"
+#include "utils/file_map.hpp"
 
 #ifdef WIN32
 #include <windows.h>
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
 #endif
 
 namespace utils {
@@ -153,6 +158,62 @@ namespace utils {
 	}
 
 
+	const void* map_file(const std::string& fn, uint64_t& size, void*& handle)
+	{
+		size = 0;
+		handle = nullptr;
+#ifdef WIN32
+		utils::wstring ws;
+		utf8_to_utf16(fn, ws);
+		HANDLE fh = CreateFileW((LPCWSTR)ws.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if(fh == INVALID_HANDLE_VALUE) return nullptr;
+		LARGE_INTEGER li;
+		if(!GetFileSizeEx(fh, &li) || li.QuadPart == 0) {
+			CloseHandle(fh);
+			return nullptr;
+		}
+		// マッピング・オブジェクトがファイルを保持するので、ファイル・ハンドルは閉じて良い
+		HANDLE mh = CreateFileMappingW(fh, NULL, PAGE_READONLY, 0, 0, NULL);
+		CloseHandle(fh);
+		if(mh == NULL) return nullptr;
+		const void* ptr = MapViewOfFile(mh, FILE_MAP_READ, 0, 0, 0);
+		if(ptr == nullptr) {
+			CloseHandle(mh);
+			return nullptr;
+		}
+		size = li.QuadPart;
+		handle = mh;
+		return ptr;
+#else
+		int fd = open(fn.c_str(), O_RDONLY);
+		if(fd < 0) return nullptr;
+		struct stat st;
+		if(fstat(fd, &st) != 0 || st.st_size == 0) {
+			close(fd);
+			return nullptr;
+		}
+		void* ptr = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+		close(fd);
+		if(ptr == MAP_FAILED) return nullptr;
+		size = st.st_size;
+		return ptr;
+#endif
+	}
+
+
+	void unmap_file(const void* ptr, uint64_t size, void* handle)
+	{
+		if(ptr == nullptr) return;
+#ifdef WIN32
+		UnmapViewOfFile(ptr);
+		if(handle != nullptr) CloseHandle(static_cast<HANDLE>(handle));
+#else
+		munmap(const_cast<void*>(ptr), size);
+#endif
+	}
+
+
 	void drive_info::initialize_()
 	{
 			infos_.clear();
@@ -50,23 +50,31 @@ namespace img {
 			float	vert_y;		///< 垂直基準 Y 軸オフセット
 		};
 
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			  @brief	サイズ毎の基準点情報
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct atr_t {
+			short	offset_;	///< ベースラインまでのオフセット
+			short	height_;	///< ビットマップの高さ
+			atr_t() : offset_(0), height_(0) { }
+		};
+
 	private:
 		std::string	root_path_;
 		std::string	home_path_;
 
 		FT_Library	library_;
 
-		struct atr_t {
-			short	offset_;
-			short	height_;
-			atr_t() : offset_(0), height_(0) { }
-		};
 		typedef std::map<int, atr_t>	atr_map;
 
 		struct face_t {
 			FT_Face		face_;
 			atr_map		atr_map_;
-			face_t(FT_Face face) : face_(face), atr_map_() { }
+			std::string	path_;
+			face_t(FT_Face face, const std::string& path) : face_(face), atr_map_(), path_(path) { }
 		};
 		typedef std::pair<std::string, face_t>	face_pair;
 		typedef boost::unordered_map<std::string, face_t>	face_map;
@@ -255,7 +263,7 @@ void get_metrics(uint32_t code)
 			}
 ///			cout << "ftimg install: " << path << ", " << static_cast<int>(face_) << endl;
 
-			face_t t(face);
+			face_t t(face, path);
 
 			FT_Vector pen;
 			pen.x = pen.y = 0;
@@ -300,6 +308,30 @@ void get_metrics(uint32_t code)
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	フォントファイルのパスを取得
+			@param[in]	alias	フォント名
+			@return フォントファイルのパス（無い場合は空）
+		 */
+		//-----------------------------------------------------------------//
+		const std::string& get_font_path(const std::string& alias) const {
+			static std::string tmp;
+			face_map_cit cit = face_map_.find(alias);
+			if(cit == face_map_.end()) return tmp;
+			return cit->second.path_;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	アンチエリアス設定を取得
+			@return アンチエリアスが有効なら「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool get_antialias() const { return antialias_; }
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	フォントの有無を検査
@@ -348,63 +380,71 @@ void get_metrics(uint32_t code)
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief	unicode に対応するビットマップを生成する。
+			@brief	サイズ毎の基準点情報を生成する（スレッドから利用可能）
+			@param[in]	face	FreeType フェース
 			@param[in]	size	生成するビットマップのサイズ
-			@param[in]	unicode	生成するビットマップの UNICODE
+			@return 基準点情報
 		 */
 		//-----------------------------------------------------------------//
-		void create_bitmap(int size, uint32_t unicode)
+		static atr_t create_atr(FT_Face face, int size)
 		{
-			if(current_face_ == face_map_.end()) return;
-
-			// 基準点へのオフセットが無い場合
-			face_t& t = current_face_->second;
-			if(t.atr_map_.find(size) == t.atr_map_.end()) {
-				struct met {
-					int	ofs;
-					int rows;
-				};
-				std::vector<met> mets;
-				int offset = 0;
-				for(int ch = 0x21; ch <= 0x7f; ++ch) {
-					if(ch == 0x3f) continue;
-					FT_Set_Pixel_Sizes(t.face_, size, size);
-					FT_Load_Char(t.face_, ch, FT_LOAD_RENDER);
-					FT_GlyphSlot slot = t.face_->glyph;
-					met m;
-					m.ofs = slot->metrics.horiBearingY / 64;
-					FT_Bitmap* bitmap = &slot->bitmap;
-					m.rows = bitmap->rows;
-					mets.push_back(m);
-					if(offset < m.ofs) offset = m.ofs;
-				}
-				int height = 0;
-				BOOST_FOREACH(const met& m, mets) {
-					int l = offset - m.ofs + m.rows + 1;
-					if(height < l) height = l;
-				}
-				atr_t at;
-				at.offset_ = offset;
-				if(height < size) height = size;
-				at.height_ = height;
-				std::pair<int, atr_t> v(size, at);
-/// std::cout << current_face_->first << ", Size: " << size << ", Height: " << at.height_ << std::endl;
-				t.atr_map_.insert(v);
+			struct met {
+				int	ofs;
+				int rows;
+			};
+			std::vector<met> mets;
+			int offset = 0;
+			for(int ch = 0x21; ch <= 0x7f; ++ch) {
+				if(ch == 0x3f) continue;
+				FT_Set_Pixel_Sizes(face, size, size);
+				FT_Load_Char(face, ch, FT_LOAD_RENDER);
+				FT_GlyphSlot slot = face->glyph;
+				met m;
+				m.ofs = slot->metrics.horiBearingY / 64;
+				FT_Bitmap* bitmap = &slot->bitmap;
+				m.rows = bitmap->rows;
+				mets.push_back(m);
+				if(offset < m.ofs) offset = m.ofs;
+			}
+			int height = 0;
+			BOOST_FOREACH(const met& m, mets) {
+				int l = offset - m.ofs + m.rows + 1;
+				if(height < l) height = l;
 			}
+			atr_t at;
+			at.offset_ = offset;
+			if(height < size) height = size;
+			at.height_ = height;
+			return at;
+		}
 
-			const atr_t& at = t.atr_map_[size];
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	unicode に対応するビットマップを生成する（スレッドから利用可能）
+			@param[in]	face	FreeType フェース
+			@param[in]	at		基準点情報
+			@param[in]	size	生成するビットマップのサイズ
+			@param[in]	unicode	生成するビットマップの UNICODE
+			@param[in]	antialias	アンチエリアスの場合「true」
+			@param[out]	gray	ビットマップ
+			@param[out]	met		メトリックス
+		 */
+		//-----------------------------------------------------------------//
+		static void render_bitmap(FT_Face face, const atr_t& at, int size, uint32_t unicode, bool antialias,
+			img_gray8& gray, metrics& met)
+		{
 			vtx::spos fs(size, at.height_);
-			gray_.create(fs);
-			gray_.fill(gray8(0));
+			gray.create(fs);
+			gray.fill(gray8(0));
 
-			FT_Error error = FT_Set_Pixel_Sizes(t.face_, size, size);
-			if(antialias_) {
-				error = FT_Load_Char(t.face_, unicode, FT_LOAD_RENDER);
+			FT_Set_Pixel_Sizes(face, size, size);
+			if(antialias) {
+				FT_Load_Char(face, unicode, FT_LOAD_RENDER);
 			} else {
-				error = FT_Load_Char(t.face_, unicode, FT_LOAD_MONOCHROME);
+				FT_Load_Char(face, unicode, FT_LOAD_MONOCHROME);
 			}
-			FT_GlyphSlot slot = t.face_->glyph;
+			FT_GlyphSlot slot = face->glyph;
 #if 0
 			if(slot->format == FT_GLYPH_FORMAT_OUTLINE) {
 				int strength = 2 << 6;
@@ -413,16 +453,16 @@ void get_metrics(uint32_t code)
 			}
 #endif
 			FT_Bitmap* bitmap = &slot->bitmap;
-			metrics_.bitmap_w = static_cast<float>(bitmap->width);
-			metrics_.bitmap_h = static_cast<float>(bitmap->rows);
-			metrics_.width    = static_cast<float>(slot->metrics.width)  / 64.0f;
-			metrics_.height   = static_cast<float>(slot->metrics.height) / 64.0f;
-			metrics_.hori_x   = static_cast<float>(slot->metrics.horiBearingX) / 64.0f;
-			metrics_.hori_y   = static_cast<float>(slot->metrics.horiBearingY) / 64.0f;
-			metrics_.vert_x   = static_cast<float>(slot->metrics.vertBearingX) / 64.0f;
-			metrics_.vert_y   = static_cast<float>(slot->metrics.vertBearingY) / 64.0f;
+			met.bitmap_w = static_cast<float>(bitmap->width);
+			met.bitmap_h = static_cast<float>(bitmap->rows);
+			met.width    = static_cast<float>(slot->metrics.width)  / 64.0f;
+			met.height   = static_cast<float>(slot->metrics.height) / 64.0f;
+			met.hori_x   = static_cast<float>(slot->metrics.horiBearingX) / 64.0f;
+			met.hori_y   = static_cast<float>(slot->metrics.horiBearingY) / 64.0f;
+			met.vert_x   = static_cast<float>(slot->metrics.vertBearingX) / 64.0f;
+			met.vert_y   = static_cast<float>(slot->metrics.vertBearingY) / 64.0f;
 
-			vtx::spos ofs(static_cast<short>(metrics_.hori_x), at.offset_ - static_cast<short>(metrics_.hori_y) + 1);
+			vtx::spos ofs(static_cast<short>(met.hori_x), at.offset_ - static_cast<short>(met.hori_y) + 1);
 
 		// グレイスケールでレンダリング出来なかった場合は、モノカラーとなる。
 			if(bitmap->pixel_mode != FT_PIXEL_MODE_MONO) {		// gray-scale 0 to 255
@@ -431,7 +471,7 @@ void get_metrics(uint32_t code)
 					for(p.x = 0; p.x < bitmap->width; p.x++) {
 						img::gray8 c;
 						c.g = bitmap->buffer[p.y * bitmap->width + p.x];
-						gray_.put_pixel(p + ofs, c);
+						gray.put_pixel(p + ofs, c);
 					}
 				}
 			} else {	// monochrome
@@ -442,7 +482,7 @@ void get_metrics(uint32_t code)
 						img::gray8 c;
 						if(bitmap->buffer[bitpos >> 3] & (1 << (~bitpos & 7))) c.g = 255; else c.g = 0;
 						bitpos++;
-						gray_.put_pixel(p + ofs, c);
+						gray.put_pixel(p + ofs, c);
 					}
 					if(bitpos & 7) {
 						bitpos |= 7;
@@ -453,6 +493,30 @@ void get_metrics(uint32_t code)
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	unicode に対応するビットマップを生成する。
+			@param[in]	size	生成するビットマップのサイズ
+			@param[in]	unicode	生成するビットマップの UNICODE
+		 */
+		//-----------------------------------------------------------------//
+		void create_bitmap(int size, uint32_t unicode)
+		{
+			if(current_face_ == face_map_.end()) return;
+
+			// 基準点へのオフセットが無い場合
+			face_t& t = current_face_->second;
+			if(t.atr_map_.find(size) == t.atr_map_.end()) {
+				std::pair<int, atr_t> v(size, create_atr(t.face_, size));
+/// std::cout << current_face_->first << ", Size: " << size << ", Height: " << v.second.height_ << std::endl;
+				t.atr_map_.insert(v);
+			}
+
+			const atr_t& at = t.atr_map_[size];
+			render_bitmap(t.face_, at, size, unicode, antialias_, gray_, metrics_);
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	フォントのビットマップイメージを得る。
@@ -0,0 +1,271 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	フォントビットマップを先行生成するワーカー・プール @n
+			FreeType はスレッド毎に FT_Library、FT_Face を持つ事で並列化する。@n
+			生成したビットマップはステージング・キューに積まれ、@n
+			OpenGL スレッドで取り出してテクスチャーへ転送する。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017, 2019 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/glfw3_app/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <string>
+#include <deque>
+#include <map>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "core/ftimg.hpp"
+
+namespace img {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	フォントビットマップ生成プール・クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class ftimg_pool {
+	public:
+
+		//=================================================================//
+		/*!
+			@brief	生成要求
+		*/
+		//=================================================================//
+		struct request_t {
+			std::string	alias;		///< フォントの別名
+			std::string	path;		///< フォントファイルのパス
+			int			size;		///< フォントサイズ
+			uint32_t	code;		///< UNICODE
+			bool		antialias;	///< アンチエリアス
+			request_t() : alias(), path(), size(0), code(0), antialias(true) { }
+		};
+
+
+		//=================================================================//
+		/*!
+			@brief	生成結果
+		*/
+		//=================================================================//
+		struct result_t {
+			std::string		alias;	///< フォントの別名
+			int				size;	///< フォントサイズ
+			uint32_t		code;	///< UNICODE
+			ftimg::metrics	met;	///< メトリックス
+			img_gray8		gray;	///< ビットマップ
+			result_t() : alias(), size(0), code(0), met(), gray() { }
+		};
+
+	private:
+		typedef std::deque<request_t>	requests;
+		typedef std::deque<result_t>	results;
+
+		std::vector<std::thread>	threads_;
+
+		std::mutex				sync_;
+		std::condition_variable	cond_;
+		requests				requests_;
+		results					results_;
+		uint32_t				busy_;
+		bool					stop_;
+
+		// スレッド毎のフェース（FreeType のオブジェクトはスレッド間で共有しない）
+		struct worker_t {
+			FT_Library	library_;
+			struct face_t {
+				FT_Face		face_;
+				std::map<int, ftimg::atr_t>	atr_map_;
+			};
+			typedef std::map<std::string, face_t>	face_map;
+			face_map	face_map_;
+
+			worker_t() : library_(nullptr), face_map_() { }
+
+			face_t* get_face(const std::string& path) {
+				face_map::iterator it = face_map_.find(path);
+				if(it != face_map_.end()) return &it->second;
+				FT_Face face;
+				if(FT_New_Face(library_, utils::system_path(path).c_str(), 0, &face)) {
+					return nullptr;
+				}
+				face_t t;
+				t.face_ = face;
+				return &face_map_.emplace(path, t).first->second;
+			}
+
+			void destroy() {
+				for(face_map::iterator it = face_map_.begin(); it != face_map_.end(); ++it) {
+					FT_Done_Face(it->second.face_);
+				}
+				face_map_.clear();
+				if(library_ != nullptr) {
+					FT_Done_FreeType(library_);
+					library_ = nullptr;
+				}
+			}
+		};
+
+		void task_()
+		{
+			worker_t wk;
+			if(FT_Init_FreeType(&wk.library_)) {
+				std::cerr << "FT Library init error (ftimg_pool)" << std::endl;
+				return;
+			}
+
+			while(1) {
+				request_t req;
+				{
+					std::unique_lock<std::mutex> lock(sync_);
+					cond_.wait(lock, [this] { return stop_ || !requests_.empty(); });
+					if(stop_) break;
+					req = requests_.front();
+					requests_.pop_front();
+					++busy_;
+				}
+
+				result_t res;
+				res.alias = req.alias;
+				res.size  = req.size;
+				res.code  = req.code;
+				bool ok = false;
+				worker_t::face_t* t = wk.get_face(req.path);
+				if(t != nullptr) {
+					std::map<int, ftimg::atr_t>::iterator it = t->atr_map_.find(req.size);
+					if(it == t->atr_map_.end()) {
+						it = t->atr_map_.emplace(req.size, ftimg::create_atr(t->face_, req.size)).first;
+					}
+					ftimg::render_bitmap(t->face_, it->second, req.size, req.code, req.antialias,
+						res.gray, res.met);
+					ok = true;
+				}
+
+				{
+					std::lock_guard<std::mutex> lock(sync_);
+					if(ok) results_.push_back(std::move(res));
+					--busy_;
+				}
+			}
+			wk.destroy();
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		 */
+		//-----------------------------------------------------------------//
+		ftimg_pool() : threads_(), requests_(), results_(), busy_(0), stop_(false) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	デストラクター
+		 */
+		//-----------------------------------------------------------------//
+		~ftimg_pool() { stop(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ワーカーを起動
+			@param[in]	num	スレッド数（０の場合、論理コア数から決定）
+		 */
+		//-----------------------------------------------------------------//
+		void start(uint32_t num = 0)
+		{
+			if(!threads_.empty()) return;
+			if(num == 0) {
+				num = std::thread::hardware_concurrency();
+				if(num > 1) --num;  // OpenGL スレッドの分を空ける
+				if(num > 4) num = 4;
+				if(num == 0) num = 1;
+			}
+			stop_ = false;
+			for(uint32_t i = 0; i < num; ++i) {
+				threads_.emplace_back(&ftimg_pool::task_, this);
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ワーカーを停止（未処理の要求、結果は破棄）
+		 */
+		//-----------------------------------------------------------------//
+		void stop()
+		{
+			if(threads_.empty()) return;
+			{
+				std::lock_guard<std::mutex> lock(sync_);
+				stop_ = true;
+			}
+			cond_.notify_all();
+			for(std::thread& th : threads_) {
+				th.join();
+			}
+			threads_.clear();
+			requests_.clear();
+			results_.clear();
+			busy_ = 0;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ワーカーが起動しているか
+			@return 起動していれば「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool is_running() const { return !threads_.empty(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	生成要求を積む
+			@param[in]	req	生成要求
+		 */
+		//-----------------------------------------------------------------//
+		void request(const request_t& req)
+		{
+			{
+				std::lock_guard<std::mutex> lock(sync_);
+				requests_.push_back(req);
+			}
+			cond_.notify_one();
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	生成結果を取り出す（ブロックしない）
+			@param[out]	res	生成結果
+			@return 結果があれば「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool fetch(result_t& res)
+		{
+			std::lock_guard<std::mutex> lock(sync_);
+			if(results_.empty()) return false;
+			res = std::move(results_.front());
+			results_.pop_front();
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	未処理の数を取得（要求、処理中、未転送の合計）
+			@return 未処理の数
+		 */
+		//-----------------------------------------------------------------//
+		uint32_t get_pending()
+		{
+			std::lock_guard<std::mutex> lock(sync_);
+			return requests_.size() + busy_ + results_.size();
+		}
+	};
+}
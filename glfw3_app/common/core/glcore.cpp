@@ -403,6 +403,8 @@ namespace gl {
 		if(f) {
 			fonts_.initialize(default_font_file_, default_font_face_);
 			fonts_.set_font_size(24);
+			// フォント・ビットマップの先行生成
+			fonts_.start_preload();
 		} else {
 			std::cerr << "FreeType initialize error..." << std::endl;
 		}
@@ -541,6 +543,9 @@ namespace gl {
 		device_.service(bits_, locator_);
 		locator_.reset_scroll();
 
+		// 先行生成されたフォントのテクスチャー転送
+		fonts_.service();
+
         /* Poll for and process events */
         glfwPollEvents();
 
@@ -603,6 +608,9 @@ namespace gl {
 	//-----------------------------------------------------------------//
 	void core::destroy() noexcept
 	{
+		// ワーカーが FreeType を使っている為、先に停止する
+		fonts_.stop_preload();
+
 		if(window_) {
 			glfwDestroyWindow(window_);
 			window_ = 0;
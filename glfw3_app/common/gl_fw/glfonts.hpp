@@ -12,8 +12,11 @@
 #include <map>
 #include <stack>
 #include <string>
+#include <chrono>
 #include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
 #include "core/ftimg.hpp"
+#include "core/ftimg_pool.hpp"
 #include "gl_fw/gl_info.hpp"
 #include "img_io/i_img.hpp"
 #include "utils/vtx.hpp"
@@ -52,8 +55,8 @@ namespace gl {
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	class fonts {
 
-		static const int texture_page_width  = 256;	///< テクスチャーページの幅
-		static const int texture_page_height = 256;	///< テクスチャーページの高さ
+		static const int texture_page_width  = 512;	///< テクスチャーページの幅
+		static const int texture_page_height = 512;	///< テクスチャーページの高さ
 
 		struct tex_map {
 			GLuint	id;		///< テクスチャー ID
@@ -65,6 +68,7 @@ namespace gl {
 		};
 
 		typedef boost::unordered_map<size_code_t, tex_map>	fcode_map;
+		typedef boost::unordered_set<size_code_t>	fcode_set;
 
 		// フォント基本環境
 		struct finfo_t {
@@ -79,6 +83,8 @@ namespace gl {
 		// コード・マップ構造体
 		struct face_t {
 			fcode_map	fcode_map_;
+			/// 先行生成を要求中のコード
+			fcode_set	pending_;
 			/// 各サイズ毎の、半角文字の最大固定サイズ
 			typedef std::map<int, int>	fix_width_map;
 			fix_width_map	fix_width_map_;
@@ -106,19 +112,44 @@ namespace gl {
 			return ret.first;
 		}
 
+		img::ftimg_pool		pool_;
+
+		// テクスチャーページ内の棚（同じ程度の高さのグリフを横に並べる）
+		struct shelf_t {
+			short	y;
+			short	h;
+			short	x;
+		};
+
+		// 全サイズで共有するテクスチャーページ（アトラス）
 		struct tex_page {
 			GLuint	id;
-			int	size;
-			int	x;
-			int	y;
+			short	next_y;
+			std::vector<shelf_t>	shelves;
 		};
-
-		// サイズ別のマップ（効率が落ちるので、一つのページに複数のサイズを登録しない）
-		typedef std::map<int, tex_page> tex_page_map;
-		tex_page_map		tex_page_map_;
+		typedef std::vector<tex_page>	tex_pages;
+		tex_pages			tex_pages_;
 
 		std::vector<GLuint>	pages_;
 
+		// バッチ描画用頂点
+		struct batch_vtx {
+			short		x, y;
+			short		u, v;
+			img::rgba8	c;
+		};
+		typedef std::vector<batch_vtx>	batch_vtxs;
+
+		struct batch_t {
+			GLuint		id;
+			batch_vtxs	vtxs;
+		};
+		typedef std::vector<batch_t>	batchs;
+		batchs		batchs_;
+		batch_vtxs	batch_back_;
+		uint32_t	batch_nest_;
+		uint32_t	draw_calls_;
+
 		struct tex_uv {
 			short	u, v;
 		};
@@ -163,58 +194,195 @@ namespace gl {
 		}
 
 
+		bool add_texture_page_()
+		{
+			tex_page tp;
+			tp.id = 0;
+			tp.next_y = 0;
+			// OpenGL テクスチャー ID を生成
+			glGenTextures(1, &tp.id);
+			if(tp.id == 0) return false;
+
+			glBindTexture(GL_TEXTURE_2D, tp.id);
+			std::vector<uint8_t> clrimg;
+			clrimg.resize(texture_page_width * texture_page_height);
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+			glTexImage2D(GL_TEXTURE_2D, 0,
+						 GL_ALPHA, texture_page_width, texture_page_height,
+						 0, GL_ALPHA, GL_UNSIGNED_BYTE, &clrimg[0]);
+
+			pages_.push_back(tp.id);
+			tex_pages_.push_back(tp);
+			return true;
+		}
+
+
 		bool allocate_font_texture_(int width, int height, tex_map& tmap)
 		{
-			int w;
-			if(width > height) w = width; else w = height;
-			if(w & 7) { w |= 7; ++w; }
-			int h = w;
-
-			tex_page_map::iterator it = tex_page_map_.find(h);
-			if(it == tex_page_map_.end()) {
-				tex_page tp;
-				tp.id = 0;
-				tp.size = h;
-				tp.x = 0;
-				tp.y = 0;
-				tex_page_map_.emplace(h, tp);
-				it = tex_page_map_.find(h);
+			// 隣接グリフのにじみを防ぐ為、１ピクセルの隙間を設ける
+			short w = width + 1;
+			short h = height + 1;
+			if(w > texture_page_width || h > texture_page_height) return false;
+
+			// 高さが近い棚の中から、最も無駄の少ない棚を探す
+			tex_page* page = nullptr;
+			shelf_t* best = nullptr;
+			for(tex_page& tp : tex_pages_) {
+				for(shelf_t& sh : tp.shelves) {
+					if(sh.h < h || sh.h > (h + h / 4 + 1)) continue;
+					if((texture_page_width - sh.x) < w) continue;
+					if(best == nullptr || sh.h < best->h) {
+						page = &tp;
+						best = &sh;
+					}
+				}
 			}
 
-			tex_page& tp = it->second;
-			if(tp.x == 0 && tp.y == 0) {
-				// OpenGL テクスチャー ID を生成
-				glGenTextures(1, &tp.id);
-				if(tp.id == 0) return false;
-				pages_.push_back(tp.id);
+			if(best == nullptr) {
+				if(tex_pages_.empty() || (texture_page_height - tex_pages_.back().next_y) < h) {
+					if(!add_texture_page_()) return false;
+				}
+				page = &tex_pages_.back();
+				shelf_t sh;
+				sh.y = page->next_y;
+				sh.h = h;
+				sh.x = 0;
+				page->shelves.push_back(sh);
+				page->next_y += h;
+				best = &page->shelves.back();
 			}
 
-			tmap.id  = tp.id;
-			tmap.lcx = tp.x;
-			tmap.lcy = tp.y;
+			tmap.id  = page->id;
+			tmap.lcx = best->x;
+			tmap.lcy = best->y;
 			tmap.w = width;
 			tmap.h = height;
 
-			tp.x += w;
-			if((texture_page_width - tp.x) < w) {
-				tp.x = 0;
-				tp.y += h;
-				if((texture_page_height - tp.y) < h) {
-					tp.y = 0;
+			best->x += w;
+
+			return true;
+		}
+
+
+		batch_vtxs& at_batch_(GLuint id)
+		{
+			if(batchs_.empty() || batchs_.back().id != id) {
+				batchs::iterator it = batchs_.begin();
+				for(; it != batchs_.end(); ++it) {
+					if(it->id == id) break;
+				}
+				if(it == batchs_.end()) {
+					batch_t t;
+					t.id = id;
+					batchs_.push_back(t);
+				} else {
+					return it->vtxs;
+				}
+			}
+			return batchs_.back().vtxs;
+		}
+
+
+		// トライアングル・ストリップ順の４頂点を、トライアングル２つとして追加
+		static void add_quad_(batch_vtxs& out, const vtx_xy* vt, const tex_uv* uv, const img::rgba8& c)
+		{
+			static const int order[6] = { 0, 1, 2, 2, 1, 3 };
+			for(int i : order) {
+				batch_vtx v;
+				v.x = vt[i].x;
+				v.y = vt[i].y;
+				if(uv != nullptr) {
+					v.u = uv[i].u;
+					v.v = uv[i].v;
+				} else {
+					v.u = v.v = 0;
 				}
+				v.c = c;
+				out.push_back(v);
 			}
+		}
 
-			return true;
+
+		void flush_batch_()
+		{
+			if(batch_back_.empty() && batchs_.empty()) return;
+
+			glEnableClientState(GL_VERTEX_ARRAY);
+			glEnableClientState(GL_COLOR_ARRAY);
+			if(!batch_back_.empty()) {
+				glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+				glDisable(GL_TEXTURE_2D);
+				glVertexPointer(2, GL_SHORT, sizeof(batch_vtx), &batch_back_[0].x);
+				glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(batch_vtx), &batch_back_[0].c);
+				glDrawArrays(GL_TRIANGLES, 0, batch_back_.size());
+				++draw_calls_;
+				batch_back_.clear();
+			}
+
+			glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+			glEnable(GL_TEXTURE_2D);
+			glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+			for(batch_t& t : batchs_) {
+				if(t.vtxs.empty()) continue;
+				glBindTexture(GL_TEXTURE_2D, t.id);
+				glVertexPointer(2, GL_SHORT, sizeof(batch_vtx), &t.vtxs[0].x);
+				glTexCoordPointer(2, GL_SHORT, sizeof(batch_vtx), &t.vtxs[0].u);
+				glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(batch_vtx), &t.vtxs[0].c);
+				glDrawArrays(GL_TRIANGLES, 0, t.vtxs.size());
+				++draw_calls_;
+				t.vtxs.clear();
+			}
+
+			glDisableClientState(GL_COLOR_ARRAY);
+			glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+			glDisableClientState(GL_VERTEX_ARRAY);
 		}
 
 
+		fcode_map::iterator install_image_(face_t& face, int size, uint32_t code,
+			const img::img_gray8& gray, const img::ftimg::metrics& met)
+		{
+			const vtx::spos& isz = gray.get_size();
+// std::cout << static_cast<int>(code) << ": " << static_cast<int>(isz.x) << ", " << static_cast<int>(isz.y) << std::endl;
+			tex_map tmap;
+			tmap.met = met;
+			float font_width = tmap.met.width + tmap.met.hori_x + 0.5f;
+			if(code == 0x20) {
+ 				font_width = static_cast<float>(isz.y / 4);
+			}
+			int fw = static_cast<int>(font_width);
+			if(!allocate_font_texture_(std::max(fw, static_cast<int>(isz.x)), isz.y, tmap)) {
+				return face.fcode_map_.end();
+			}
+			tmap.w = fw;
+
+			glBindTexture(GL_TEXTURE_2D, tmap.id);
+
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+
+			int level = 0;
+			{
+				glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+				glTexSubImage2D(GL_TEXTURE_2D, level,
+					tmap.lcx, tmap.lcy, isz.x, isz.y, GL_ALPHA, GL_UNSIGNED_BYTE, gray());
+			}
+
+			face.pending_.erase(size_code_t(size, code));
+			std::pair<fcode_map::iterator, bool> ret;
+			ret = face.fcode_map_.insert(fcode_map::value_type(size_code_t(size, code), tmap));
+			return ret.first;
+		}
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	コンストラクター
 		*/
 		//-----------------------------------------------------------------//
-		fonts() : face_(0),
+		fonts() : face_(0), batch_nest_(0), draw_calls_(0),
 			fore_color_(255, 255, 255, 255), back_color_(0, 0, 0, 255),
 			setup_(false),
 			render_back_(false), h_flip_(false), v_flip_(false), ccw_(false),
@@ -437,7 +605,8 @@ namespace gl {
 			if(setup_ == false) {
 				glMatrixMode(GL_TEXTURE);
 				glLoadIdentity();
-				glScalef(1.0f / 256.0f, 1.0f / 256.0f, 1.0f);
+				glScalef(1.0f / static_cast<float>(texture_page_width),
+					1.0f / static_cast<float>(texture_page_height), 1.0f);
 
 				glMatrixMode(GL_MODELVIEW);
 				glLoadIdentity();
@@ -460,7 +629,8 @@ namespace gl {
 			if(setup_ == false) {
 				glMatrixMode(GL_TEXTURE);
 				glLoadIdentity();
-				glScalef(1.0f / 256.0f, 1.0f / 256.0f, 1.0f);
+				glScalef(1.0f / static_cast<float>(texture_page_width),
+					1.0f / static_cast<float>(texture_page_height), 1.0f);
 
 				glMatrixMode(GL_PROJECTION);
 				glLoadIdentity();
@@ -610,44 +780,35 @@ namespace gl {
 		//-----------------------------------------------------------------//
 		fcode_map::iterator install_image(uint32_t code)
 		{
-			const img::img_gray8& gray = img::ftimg::get_instance().get_img();
-			const vtx::spos& isz = gray.get_size();
-// std::cout << static_cast<int>(code) << ": " << static_cast<int>(isz.x) << ", " << static_cast<int>(isz.y) << std::endl;
-			tex_map tmap;
-			tmap.met = img::ftimg::get_instance().get_metrics();
-			float font_width = tmap.met.width + tmap.met.hori_x + 0.5f;
-			if(code == 0x20) {
- 				font_width = static_cast<float>(isz.y / 4);
-			}
-			if(!allocate_font_texture_(static_cast<int>(font_width), isz.y, tmap)) {
-				return face_->fcode_map_.end();
-			}
-
-			glBindTexture(GL_TEXTURE_2D, tmap.id);
-
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			return install_image_(*face_, face_->info_.size, code,
+				img::ftimg::get_instance().get_img(), img::ftimg::get_instance().get_metrics());
+		}
 
-			int level = 0;
-			if(tmap.lcx == 0 && tmap.lcy == 0) {
-				std::vector<uint8_t> clrimg;
-				clrimg.resize(texture_page_width * texture_page_height);
-				glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-				glTexImage2D(GL_TEXTURE_2D, level,
-							 GL_ALPHA, texture_page_width, texture_page_height,
-							 0, GL_ALPHA, GL_UNSIGNED_BYTE, &clrimg[0]);
-			}
 
-			{
-				glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-				glTexSubImage2D(GL_TEXTURE_2D, level,
-					tmap.lcx, tmap.lcy, isz.x, isz.y, GL_ALPHA, GL_UNSIGNED_BYTE, gray());
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	フォントの登録（先行生成）@n
+					ワーカー・プールが起動していない場合は、即座に登録する。
+			@param[in]	code	フォントのコード
+		*/
+		//-----------------------------------------------------------------//
+		void request_font(uint32_t code)
+		{
+			if(!pool_.is_running()) {
+				install_font(code);
+				return;
 			}
-
-//			if(h & 7) { h |= 7; ++h; }
-			return install_font_code(code, tmap);
+			size_code_t sc(face_->info_.size, code);
+			if(face_->fcode_map_.find(sc) != face_->fcode_map_.end()) return;
+			if(!face_->pending_.insert(sc).second) return;
+
+			img::ftimg_pool::request_t req;
+			req.alias = get_font_type();
+			req.path  = img::ftimg::get_instance().get_font_path(req.alias);
+			req.size  = face_->info_.size;
+			req.code  = code;
+			req.antialias = face_->info_.antialias;
+			pool_.request(req);
 		}
 
 
@@ -675,7 +836,7 @@ namespace gl {
 		void install_font(const uint32_t* list) {
 			uint32_t lc;
 			while((lc = *list++) != 0) {
-				install_font(lc);
+				request_font(lc);
 			}
 		}
 
@@ -689,7 +850,7 @@ namespace gl {
 		void install_font(const uint16_t* list) {
 			uint16_t wc;
 			while((wc = *list++) != 0) {
-				install_font(wc);
+				request_font(wc);
 			}
 		}
 
@@ -703,11 +864,79 @@ namespace gl {
 		void install_font(const char* list) {
 			uint8_t c;
 			while((c = static_cast<uint8_t>(*list++)) != 0) {
-				install_font(c);
+				request_font(c);
 			}
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	フォント先行生成のワーカー・プールを起動する @n
+					起動後、文字列の「install_font」はワーカーでビットマップを生成し、@n
+					「service」でテクスチャーへ転送される。
+			@param[in]	num	スレッド数（０の場合、自動）
+		*/
+		//-----------------------------------------------------------------//
+		void start_preload(uint32_t num = 0) { pool_.start(num); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	フォント先行生成のワーカー・プールを停止する
+		*/
+		//-----------------------------------------------------------------//
+		void stop_preload()
+		{
+			pool_.stop();
+			for(face_map::iterator it = face_map_.begin(); it != face_map_.end(); ++it) {
+				it->second.pending_.clear();
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	先行生成の未処理数を取得
+			@return 未処理数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_preload_pending() { return pool_.get_pending(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	先行生成されたビットマップをテクスチャーへ転送する @n
+					OpenGL スレッドから、毎フレーム呼ぶ。
+			@param[in]	budget	１フレームで転送に使う時間の上限（ミリ秒）
+			@return 転送したフォントの数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t service(double budget = 2.0)
+		{
+			if(!pool_.is_running()) return 0;
+
+			typedef std::chrono::steady_clock clock;
+			clock::time_point limit = clock::now()
+				+ std::chrono::microseconds(static_cast<int64_t>(budget * 1000.0));
+			uint32_t n = 0;
+			img::ftimg_pool::result_t res;
+			while(clock::now() < limit && pool_.fetch(res)) {
+				face_map::iterator it = face_map_.find(res.alias);
+				if(it == face_map_.end()) continue;
+				face_t& face = it->second;
+				size_code_t sc(res.size, res.code);
+				if(face.fcode_map_.find(sc) != face.fcode_map_.end()) {
+					// 描画時に同期して登録済み
+					face.pending_.erase(sc);
+					continue;
+				}
+				install_image_(face, res.size, res.code, res.gray, res.met);
+				++n;
+			}
+			return n;
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	フォント・テクスチャー・ページを描画する
@@ -723,14 +952,18 @@ namespace gl {
 			glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 			glEnableClientState(GL_VERTEX_ARRAY);
 
-			coord_[0].u  =   0; coord_[0].v  =   0;
-			vertex_[0].x =   0; vertex_[0].y = 256;
-			coord_[1].u  =   0; coord_[1].v  = 256;
-			vertex_[1].x =   0; vertex_[1].y =   0;
-			coord_[3].u  = 256; coord_[3].v  = 256;
-			vertex_[3].x = 256; vertex_[3].y =   0;
-			coord_[2].u  = 256; coord_[2].v  =   0;
-			vertex_[2].x = 256; vertex_[2].y = 256;
+			const short w = texture_page_width;
+			const short h = texture_page_height;
+			coord_[0].u  = 0; coord_[0].v  = 0;
+			vertex_[0].x = 0; vertex_[0].y = h;
+			coord_[1].u  = 0; coord_[1].v  = h;
+			vertex_[1].x = 0; vertex_[1].y = 0;
+			coord_[3].u  = w; coord_[3].v  = h;
+			vertex_[3].x = w; vertex_[3].y = 0;
+			coord_[2].u  = w; coord_[2].v  = 0;
+			vertex_[2].x = w; vertex_[2].y = h;
+			glTexCoordPointer(2, GL_SHORT, 0, coord_);
+			glVertexPointer(2, GL_SHORT, 0, vertex_);
 			glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
 			glDisable(GL_TEXTURE_2D);
@@ -834,8 +1067,10 @@ namespace gl {
 				coord_[2].v = ve;
 			}
 
-			glEnableClientState(GL_VERTEX_ARRAY);
-			glVertexPointer(2, GL_SHORT, 0, vertex_);
+			if(batch_nest_ == 0) {
+				glEnableClientState(GL_VERTEX_ARRAY);
+				glVertexPointer(2, GL_SHORT, 0, vertex_);
+			}
 			if(render_back_ || inv) {
 				img::rgba8 bc;
 				if(swap_color_ || inv) {
@@ -855,10 +1090,14 @@ namespace gl {
 					vertex_[3].x = ox + xe + i; vertex_[3].y = oy + yt;
 					vertex_[2].x = ox + xe + i; vertex_[2].y = oy + ye;
 				}
-				glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-				glDisable(GL_TEXTURE_2D);
-				glColor4ub(bc.r, bc.g, bc.b, bc.a);
-				glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+				if(batch_nest_ > 0) {
+					add_quad_(batch_back_, vertex_, nullptr, bc);
+				} else {
+					glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+					glDisable(GL_TEXTURE_2D);
+					glColor4ub(bc.r, bc.g, bc.b, bc.a);
+					glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+				}
 			}
 
 			if(ccw_) {
@@ -880,6 +1119,11 @@ namespace gl {
 				fc = fore_color_;
 			}
 
+			if(batch_nest_ > 0) {
+				add_quad_(at_batch_(tmap.id), vertex_, coord_, fc);
+				return font_width_(code, tmap.w, tmap.h);
+			}
+
 			glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 			glTexCoordPointer(2, GL_SHORT, 0, coord_);
 			glEnable(GL_TEXTURE_2D);
@@ -942,6 +1186,70 @@ namespace gl {
 		//-----------------------------------------------------------------//
 		int draw(const vtx::ipos& pos, const utils::lstring& text, int limit = 0, int cursor = -1)
 		{
+			return draw_text(pos, text, limit, cursor);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	バッチ描画を開始する @n
+					「end_batch」までの文字、バックの描画は頂点バッファに蓄積され、@n
+					テクスチャーページ毎に一回の描画で出力される
+		 */
+		//-----------------------------------------------------------------//
+		void begin_batch() { ++batch_nest_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	バッチ描画を終了し、蓄積した頂点を描画する
+		 */
+		//-----------------------------------------------------------------//
+		void end_batch()
+		{
+			if(batch_nest_ == 0) return;
+			--batch_nest_;
+			if(batch_nest_ == 0) flush_batch_();
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	描画コール数を取得（バッチ描画の効果確認用）
+			@param[in]	clear	取得後にクリアする場合「true」
+			@return	描画コール数
+		 */
+		//-----------------------------------------------------------------//
+		uint32_t get_draw_calls(bool clear = true)
+		{
+			uint32_t n = draw_calls_;
+			if(clear) draw_calls_ = 0;
+			return n;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	テクスチャーページ数を取得
+			@return	テクスチャーページ数
+		 */
+		//-----------------------------------------------------------------//
+		uint32_t get_page_num() const { return pages_.size(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	文字列をバッチ描画する
+			@param[in]	pos	描画位置
+			@param[in]	text	描画ロング文字列
+			@param[in]	limit	改行のリミット幅
+			@param[in]	cursor カーソル位置反転文字
+			@return	描画幅を返す（複数行の場合、最大値）
+		 */
+		//-----------------------------------------------------------------//
+		int draw_text(const vtx::ipos& pos, const utils::lstring& text, int limit = 0, int cursor = -1)
+		{
+			begin_batch();
 			int x = pos.x;
 			int y = pos.y;
 			int xx = x;
@@ -965,6 +1273,7 @@ namespace gl {
 				}
 				++n;
 			}
+			end_batch();
 			return xx - pos.x;
 		}
 
@@ -1151,9 +1460,11 @@ namespace gl {
 		//-----------------------------------------------------------------//
 		void draw_back(const vtx::irect& rect)
 		{
-			glEnableClientState(GL_VERTEX_ARRAY);
-			glVertexPointer(2, GL_SHORT, 0, vertex_);
-			glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+			if(batch_nest_ == 0) {
+				glEnableClientState(GL_VERTEX_ARRAY);
+				glVertexPointer(2, GL_SHORT, 0, vertex_);
+				glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+			}
 			if(ccw_) {
 				vertex_[0].x = rect.org.x;     vertex_[0].y = rect.org.y;
 				vertex_[1].x = rect.org.x;     vertex_[1].y = rect.end_y();
@@ -1165,13 +1476,17 @@ namespace gl {
 				vertex_[3].x = rect.end_x();   vertex_[3].y = rect.org.y;
 				vertex_[2].x = rect.end_x();   vertex_[2].y = rect.end_y();
 			}
-			glDisable(GL_TEXTURE_2D);
+			if(batch_nest_ == 0) glDisable(GL_TEXTURE_2D);
 			img::rgba8 fc;
 			if(swap_color_) {
 				fc = fore_color_;
 			} else {
 				fc = back_color_;
 			}
+			if(batch_nest_ > 0) {
+				add_quad_(batch_back_, vertex_, nullptr, fc);
+				return;
+			}
 			glColor4ub(fc.r, fc.g, fc.b, fc.a);
 			glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 		}
@@ -1184,10 +1499,14 @@ namespace gl {
 		//-----------------------------------------------------------------//
 		void destroy()
 		{
+			stop_preload();
 			if(!pages_.empty()) {
 				glDeleteTextures(pages_.size(), &pages_[0]);
 				pages_.clear();
 			}
+			tex_pages_.clear();
+			batchs_.clear();
+			batch_back_.clear();
 		}
 	};
 }
@@ -9,6 +9,8 @@
 */
 //=====================================================================//
 #include <vector>
+#include <map>
+#include <algorithm>
 #include "gl_fw/gl_info.hpp"
 #include "gl_fw/glutils.hpp"
 #include "img_io/i_img.hpp"
@@ -23,45 +25,156 @@ namespace gl {
 
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	/*!
-		@brief	テクスチャーページ内の割り当てを行うクラス
+		@brief	テクスチャーページ内の割り当てを行うクラス @n
+				ギロチン分割による空き領域リストで管理し、解放、デフラグが可能
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	class texture_mem {
+	public:
+
+		//=================================================================//
+		/*!
+			@brief	ページの利用状況
+		*/
+		//=================================================================//
+		struct info_t {
+			int			area;		///< ページ全体の面積
+			int			used;		///< 利用中の面積
+			int			free_max;	///< 最大の空き領域の面積
+			uint32_t	num;		///< 割り当て数
+			uint32_t	frag;		///< 空き領域の断片数
+			info_t() : area(0), used(0), free_max(0), num(0), frag(0) { }
+		};
+
+
+		//=================================================================//
+		/*!
+			@brief	デフラグによる移動情報
+		*/
+		//=================================================================//
+		struct move_t {
+			vtx::spos	from;	///< 移動前の位置
+			vtx::spos	to;		///< 移動後の位置
+			move_t(const vtx::spos& f, const vtx::spos& t) : from(f), to(t) { }
+		};
+		typedef std::vector<move_t>	moves;
 
-		GLuint	id_;
+	private:
+		GLuint		id_;
 
-		int		block_w_;
-		int		block_h_;
-		int		block_num_;
+		vtx::spos	size_;
+		short		align_;
+		int			used_area_;
 
-		std::vector<uint32_t>	tex_map_;
+		typedef std::vector<vtx::srect>	rects;
+		rects		free_;
+		rects		used_;
 
-		bool scan(int x, int w, int y, int h) {
-			for(int i = 0; i < h; ++i) {
-				for(int j = 0; j < w; ++j) {
-					int a = (i + y) * block_w_ + (j + x);
-					if(tex_map_[a >> 5] & (1 << (a & 31))) return false;
+		short align_up_(short v) const {
+			return ((v + align_ - 1) / align_) * align_;
+		}
+
+		void reset_() {
+			free_.clear();
+			used_.clear();
+			free_.push_back(vtx::srect(vtx::spos(0), size_));
+			used_area_ = 0;
+		}
+
+		// 最も無駄の少ない空き領域を探す（ベスト・エリア・フィット）
+		int find_(short w, short h) const {
+			int idx = -1;
+			int best_area = 0;
+			int best_side = 0;
+			for(uint32_t i = 0; i < free_.size(); ++i) {
+				const vtx::srect& r = free_[i];
+				if(r.size.x < w || r.size.y < h) continue;
+				int area = static_cast<int>(r.size.x) * r.size.y - static_cast<int>(w) * h;
+				int side = std::min(r.size.x - w, r.size.y - h);
+				if(idx < 0 || area < best_area || (area == best_area && side < best_side)) {
+					idx = i;
+					best_area = area;
+					best_side = side;
 				}
 			}
-			return true;
+			return idx;
+		}
+
+		// 短い残り辺に沿って分割（Shorter Axis Split）
+		void split_(const vtx::srect& fr, short w, short h) {
+			short rw = fr.size.x - w;
+			short rh = fr.size.y - h;
+			vtx::srect right;
+			vtx::srect bottom;
+			if(rw < rh) {
+				right  = vtx::srect(fr.org.x + w, fr.org.y, rw, h);
+				bottom = vtx::srect(fr.org.x, fr.org.y + h, fr.size.x, rh);
+			} else {
+				right  = vtx::srect(fr.org.x + w, fr.org.y, rw, fr.size.y);
+				bottom = vtx::srect(fr.org.x, fr.org.y + h, w, rh);
+			}
+			if(right.size.x > 0 && right.size.y > 0) free_.push_back(right);
+			if(bottom.size.x > 0 && bottom.size.y > 0) free_.push_back(bottom);
 		}
 
-		void fill(int x, int w, int y, int h) {
-			for(int i = 0; i < h; ++i) {
-				for(int j = 0; j < w; ++j) {
-					int a = (i + y) * block_w_ + (j + x);
-					tex_map_[a >> 5] |= 1 << (a & 31);
+		// 隣接する空き領域を結合
+		void merge_() {
+			bool loop = true;
+			while(loop) {
+				loop = false;
+				for(uint32_t i = 0; i < free_.size() && !loop; ++i) {
+					for(uint32_t j = i + 1; j < free_.size(); ++j) {
+						vtx::srect& a = free_[i];
+						const vtx::srect& b = free_[j];
+						if(a.org.x == b.org.x && a.size.x == b.size.x) {
+							if(a.end_y() == b.org.y) {
+								a.size.y += b.size.y;
+							} else if(b.end_y() == a.org.y) {
+								a.org.y = b.org.y;
+								a.size.y += b.size.y;
+							} else {
+								continue;
+							}
+						} else if(a.org.y == b.org.y && a.size.y == b.size.y) {
+							if(a.end_x() == b.org.x) {
+								a.size.x += b.size.x;
+							} else if(b.end_x() == a.org.x) {
+								a.org.x = b.org.x;
+								a.size.x += b.size.x;
+							} else {
+								continue;
+							}
+						} else {
+							continue;
+						}
+						free_.erase(free_.begin() + j);
+						loop = true;
+						break;
+					}
 				}
 			}
 		}
 
+		bool insert_(short& x, short& y, short w, short h) {
+			int idx = find_(w, h);
+			if(idx < 0) return false;
+			vtx::srect fr = free_[idx];
+			free_.erase(free_.begin() + idx);
+			split_(fr, w, h);
+			x = fr.org.x;
+			y = fr.org.y;
+			used_.push_back(vtx::srect(x, y, w, h));
+			used_area_ += static_cast<int>(w) * h;
+			return true;
+		}
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	コンストラクター
 		 */
 		//-----------------------------------------------------------------//
-		texture_mem() : id_(0), block_w_(0), block_h_(0), block_num_(0) { }
+		texture_mem() : id_(0), size_(0), align_(1), used_area_(0) { }
 
 
 		//-----------------------------------------------------------------//
@@ -80,22 +193,14 @@ namespace gl {
 			@param[in]	internalFormat	OpenGL の内部画像形式
 			@param[in]	mp	ミップマップの場合「true」
 			@param[in]	im	初期化イメージ
+			@param[in]	align	割り当て単位（ピクセル）
 		 */
 		//-----------------------------------------------------------------//
-		void initialize(int pgw, int pgh, GLint internalFormat, bool mp, const img::img_rgba8& im)
+		void initialize(int pgw, int pgh, GLint internalFormat, bool mp, const img::img_rgba8& im, short align = 4)
 		{
-			// 16 ピクセル毎のブロック管理
-			int ww = pgw / 16;
-			if(pgw & 15) ++ww;
-			int hh = pgh / 16;
-			if(pgh & 15) ++hh;
-			block_w_ = ww;
-			block_h_ = hh;
-			block_num_ = ww * hh;
-			tex_map_.resize(block_num_ >> 5);
-			for(int i = 0; i < (block_num_ >> 5); ++i) {
-				tex_map_[i] = 0;
-			}
+			size_.set(pgw, pgh);
+			align_ = align > 0 ? align : 1;
+			reset_();
 
 			glGenTextures(1, &id_);
 			glBindTexture(GL_TEXTURE_2D, id_);
@@ -129,10 +234,16 @@ namespace gl {
 			@return いっぱいなら「true」
 		 */
 		//-----------------------------------------------------------------//
-		bool is_full() const {
-			if(block_num_ > 0) return false;
-			else return true;
-		}
+		bool is_full() const { return free_.empty(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	空か調べる
+			@return 割り当てが無ければ「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool is_empty() const { return used_.empty(); }
 
 
 		//-----------------------------------------------------------------//
@@ -147,27 +258,121 @@ namespace gl {
 		//-----------------------------------------------------------------//
 		bool allocate(short& x, short& y, short w, short h)
 		{
-			if(block_num_ <= 0) return false;
-
-			int w_num = w >> 4;
-			if(w & 15) w_num++;
-			int h_num = h >> 4;
-			if(h & 15) h_num++;
-			if(w_num > block_w_ || h_num > block_h_) return false;
-
-			for(int i = 0; i < (block_h_ - h_num + 1); ++i) {
-				for(int j = 0; j < (block_w_ - w_num + 1); ++j) {
-					if(scan(j, w_num, i, h_num)) {
-						x = j << 4;
-						y = i << 4;
-						block_num_ -= w_num * h_num;
-						fill(j, w_num, i, h_num);
-						return true;
+			if(w <= 0 || h <= 0) return false;
+			short ww = std::min(align_up_(w), size_.x);
+			short hh = std::min(align_up_(h), size_.y);
+			if(w > ww || h > hh) return false;
+			return insert_(x, y, ww, hh);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	テクスチャー・エリアの解放
+			@param[in]	x	アロケートした位置 X
+			@param[in]	y	アロケートした位置 Y
+			return 割り当てが無い場合「false」が返る
+		 */
+		//-----------------------------------------------------------------//
+		bool free(short x, short y)
+		{
+			for(rects::iterator it = used_.begin(); it != used_.end(); ++it) {
+				if(it->org.x == x && it->org.y == y) {
+					used_area_ -= static_cast<int>(it->size.x) * it->size.y;
+					free_.push_back(*it);
+					used_.erase(it);
+					if(used_.empty()) {
+						reset_();
+					} else {
+						merge_();
 					}
+					return true;
 				}
 			}
+			return false;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	利用状況を取得
+			@return 利用状況
+		 */
+		//-----------------------------------------------------------------//
+		info_t get_info() const
+		{
+			info_t t;
+			t.area = static_cast<int>(size_.x) * size_.y;
+			t.used = used_area_;
+			for(const vtx::srect& r : free_) {
+				int a = static_cast<int>(r.size.x) * r.size.y;
+				if(t.free_max < a) t.free_max = a;
+			}
+			t.num = used_.size();
+			t.frag = free_.size();
+			return t;
+		}
+
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	デフラグ（生きている領域を詰めて再配置し、再転送する）
+			@param[out]	mvs	移動した領域の情報
+			return 再配置出来ない場合「false」（状態は変化しない）
+		 */
+		//-----------------------------------------------------------------//
+		bool compact(moves& mvs)
+		{
+			mvs.clear();
+			if(used_.empty()) return true;
+#ifdef OPENGL_ES
 			return false;
+#else
+			rects src = used_;
+			std::sort(src.begin(), src.end(), [](const vtx::srect& a, const vtx::srect& b) {
+				if(a.size.y != b.size.y) return a.size.y > b.size.y;
+				return a.size.x > b.size.x;
+			});
+
+			rects back_free = free_;
+			rects back_used = used_;
+			int back_area = used_area_;
+			reset_();
+			rects dst;
+			for(const vtx::srect& r : src) {
+				short x, y;
+				if(!insert_(x, y, r.size.x, r.size.y)) {
+					free_ = back_free;
+					used_ = back_used;
+					used_area_ = back_area;
+					return false;
+				}
+				dst.push_back(vtx::srect(x, y, r.size.x, r.size.y));
+			}
+
+			img::img_rgba8 page;
+			page.create(size_, true);
+			glBindTexture(GL_TEXTURE_2D, id_);
+			glPixelStorei(GL_PACK_ALIGNMENT, 4);
+			glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, page.at_image());
+
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+			img::img_rgba8 tmp;
+			for(uint32_t i = 0; i < src.size(); ++i) {
+				const vtx::srect& s = src[i];
+				const vtx::srect& d = dst[i];
+				if(s.org == d.org) continue;
+				tmp.create(s.size, true);
+				for(short y = 0; y < s.size.y; ++y) {
+					const img::rgba8* p = page.get_img(s.org.y + y) + s.org.x;
+					std::copy(p, p + s.size.x, tmp.at_image(y * s.size.x));
+				}
+				glTexSubImage2D(GL_TEXTURE_2D, 0, d.org.x, d.org.y, s.size.x, s.size.y,
+					GL_RGBA, GL_UNSIGNED_BYTE, tmp());
+				mvs.push_back(move_t(s.org, d.org));
+			}
+			return true;
+#endif
 		}
 
 
@@ -187,7 +392,9 @@ namespace gl {
 		//-----------------------------------------------------------------//
 		void destroy()
 		{
-			std::vector<unsigned int>().swap(tex_map_);
+			rects().swap(free_);
+			rects().swap(used_);
+			used_area_ = 0;
 		}
 
 
@@ -199,16 +406,13 @@ namespace gl {
 		//-----------------------------------------------------------------//
 		void dump(std::ostream& ost)
 		{
-			for(int j = 0; j < 16; ++j) {
-				unsigned short bits = 1;
-				for(int i = 0; i < 16; ++i) {
-					char c;
-					if(tex_map_[j] & bits) c = '*';
-					else c = ' ';
-					ost << boost::format("%c") % c;
-					i <<= 1;
-				}
-				ost << std::endl;
+			info_t t = get_info();
+			ost << boost::format("Texture page: %d (%d, %d)") % id_ % size_.x % size_.y << std::endl;
+			ost << boost::format("  used: %d/%d (%d regions), free max: %d, fragments: %d")
+				% t.used % t.area % t.num % t.free_max % t.frag << std::endl;
+			for(const vtx::srect& r : free_) {
+				ost << boost::format("  free: %d, %d, %d, %d")
+					% r.org.x % r.org.y % r.size.x % r.size.y << std::endl;
 			}
 		}
 	};
@@ -255,6 +459,9 @@ namespace gl {
 			short	tw;		///< texture width (cordinate U)
 			short	th;		///< texture height (cordinate V)
 
+			short	ax;		///< texture allocate location X
+			short	ay;		///< texture allocate location Y
+
 			short	oxp;	///< draw offset X positive
 			short	oyp;	///< draw offset Y positive
 			short	oxn;	///< draw offset X negative (flip)
@@ -271,7 +478,7 @@ namespace gl {
 			bool	ex;		///< EX format
 
 			obj*	link;	///< リンクオブジェクト
-			obj() : link(0) { }
+			obj() : ax(0), ay(0), link(0) { }
 		};
 
 		typedef unsigned int			handle;			///< 管理ハンドル
@@ -307,6 +514,8 @@ namespace gl {
 			for(unsigned int i = 0; i < mems.size(); ++i) {
 				if(mems[i].allocate(mo->tx, mo->ty, mo->tw, mo->th)) {
 					mo->id = mems[i].get_id();
+					mo->ax = mo->tx;
+					mo->ay = mo->ty;
 					return true;
 				}
 			}
@@ -320,6 +529,35 @@ namespace gl {
 			mem.allocate(mo->tx, mo->ty, mo->tw, mo->th);
 			mems.push_back(mem);
 			mo->id = mem.get_id();
+			mo->ax = mo->tx;
+			mo->ay = mo->ty;
+		}
+
+		static uint32_t pos_key_(short x, short y)
+		{
+			return (static_cast<uint32_t>(static_cast<uint16_t>(y)) << 16) | static_cast<uint16_t>(x);
+		}
+
+		texture_mem* find_texture_page_(GLuint id)
+		{
+			for(texture_mem& txm : texture_mems_) {
+				if(txm.get_id() == id) return &txm;
+			}
+			return nullptr;
+		}
+
+		handle add_obj_(obj* root)
+		{
+			// 削除されたハンドルを再利用
+			for(handle h = 1; h < objs_.size(); ++h) {
+				if(objs_[h] == 0) {
+					objs_[h] = root;
+					return h;
+				}
+			}
+			handle h = objs_.size();
+			objs_.push_back(root);
+			return h;
 		}
 
 		void destroy_texture_page_(texture_mems& mems)
@@ -400,7 +638,7 @@ namespace gl {
 		//-----------------------------------------------------------------//
 		const vtx::spos& get_size(handle h) const
 		{
-			if(h > 0 && h < objs_.size()) {
+			if(h > 0 && h < objs_.size() && objs_[h] != 0) {
 				return objs_[h]->size;
 			} else {
 				static vtx::spos zero_(0);
@@ -507,9 +745,7 @@ namespace gl {
 				oy += lk->th;
 			}
 
-			handle h = objs_.size();
-			objs_.push_back(root);
-			return h;
+			return add_obj_(root);
 		}
 
 
@@ -614,9 +850,7 @@ namespace gl {
 				}
 				oy += lk->dh;
 			}
-			handle h = objs_.size();
-			objs_.push_back(root);
-			return h;
+			return add_obj_(root);
 		}
 
 
@@ -701,9 +935,105 @@ namespace gl {
 				p->link = tmp;
 				p = tmp;
 			}
-			handle h = objs_.size();
-			objs_.push_back(top);
-			return h;
+			return add_obj_(top);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	モーションオブジェクトを削除して、テクスチャー領域を解放する
+			@param[in]	h	ハンドル
+			@return 削除出来たら「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool erase(handle h)
+		{
+			if(h == 0 || h >= objs_.size() || objs_[h] == 0) return false;
+
+			obj* m = objs_[h];
+			while(m != 0) {
+				texture_mem* txm = find_texture_page_(m->id);
+				if(txm != nullptr) txm->free(m->ax, m->ay);
+				obj* tmp = m;
+				m = m->link;
+				delete tmp;
+			}
+			objs_[h] = 0;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	テクスチャーページのデフラグ @n
+					生きている領域を詰めて再転送し、オブジェクトのテクスチャー座標を更新する
+			@param[in]	release	空になったページを廃棄する場合「true」
+			@return デフラグ出来なかったページ数
+		 */
+		//-----------------------------------------------------------------//
+		uint32_t compact(bool release = true)
+		{
+			uint32_t err = 0;
+			tex_mem_it it = texture_mems_.begin();
+			while(it != texture_mems_.end()) {
+				if(it->is_empty()) {
+					if(release) {
+						GLuint id = it->get_id();
+						glDeleteTextures(1, &id);
+						it = texture_mems_.erase(it);
+						continue;
+					}
+				} else {
+					texture_mem::moves mvs;
+					if(it->compact(mvs)) {
+						// 移動元の位置で引き、各オブジェクトは一度だけ移動させる
+						//（移動先が別の領域の移動元と一致する場合がある為）
+						std::map<uint32_t, vtx::spos> tbl;
+						for(const texture_mem::move_t& mv : mvs) {
+							tbl[pos_key_(mv.from.x, mv.from.y)] = mv.to;
+						}
+						for(obj* root : objs_) {
+							for(obj* m = root; m != 0; m = m->link) {
+								if(m->id != it->get_id()) continue;
+								auto f = tbl.find(pos_key_(m->ax, m->ay));
+								if(f == tbl.end()) continue;
+								const vtx::spos& to = f->second;
+								m->tx += to.x - m->ax;
+								m->ty += to.y - m->ay;
+								m->ax = to.x;
+								m->ay = to.y;
+							}
+						}
+					} else {
+						++err;
+					}
+				}
+				++it;
+			}
+			return err;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	テクスチャーページ全体の利用状況を取得
+			@param[out]	pages	ページ数を受け取る
+			@return 利用状況（合計）
+		 */
+		//-----------------------------------------------------------------//
+		texture_mem::info_t get_info(uint32_t& pages) const
+		{
+			texture_mem::info_t t;
+			for(const texture_mem& txm : texture_mems_) {
+				texture_mem::info_t i = txm.get_info();
+				t.area += i.area;
+				t.used += i.used;
+				if(t.free_max < i.free_max) t.free_max = i.free_max;
+				t.num += i.num;
+				t.frag += i.frag;
+			}
+			pages = texture_mems_.size();
+			return t;
 		}
 
 
@@ -791,6 +1121,7 @@ namespace gl {
 				imif = &tmp;
 			}
 
+			if(h == 0 || h >= objs_.size()) return;
 			const obj* m = objs_[h];
 			while(m != 0) {
 				glBindTexture(GL_TEXTURE_2D, m->id);
@@ -832,7 +1163,7 @@ namespace gl {
 		//-----------------------------------------------------------------//
 		void draw(handle h, attribute::type atr, const vtx::spos& pos, bool linear = true)
 		{
-			if(h == 0 || h >= objs_.size()) return;
+			if(h == 0 || h >= objs_.size() || objs_[h] == 0) return;
 
 			bool hf = false;
 			bool vf = false;
@@ -949,7 +1280,7 @@ namespace gl {
 		//-----------------------------------------------------------------//
 		void draw_sub(handle h, attribute::type atr, const vtx::spos& pos, const vtx::spos& ofs, const vtx::spos& wh, bool linear = true)
 		{
-			if(h == 0 || h >= objs_.size()) return;
+			if(h == 0 || h >= objs_.size() || objs_[h] == 0) return;
 
 			const obj* m = objs_[h];
 			do {
@@ -1086,7 +1417,7 @@ namespace gl {
 		//-----------------------------------------------------------------//
 		bool resize(handle h, const vtx::spos& size)
 		{
-			if(h == 0 && h >= objs_.size()) {
+			if(h == 0 || h >= objs_.size() || objs_[h] == 0) {
 				return false;
 			}
 
@@ -246,6 +246,7 @@ namespace gl {
 			fonts.set_fore_color(fore_color_);
 			fonts.set_back_color(back_color_);
 
+			fonts.begin_batch();
 			for(int y = 0; y < limit_pos_.y; ++y) {
 				int xx = 0;
 				for(int x = 0; x < limit_pos_.x; ++x) {
@@ -272,6 +273,7 @@ namespace gl {
 					xx += fw;
 				}
 			}
+			fonts.end_batch();
 			++frame_count_;
 		}
 
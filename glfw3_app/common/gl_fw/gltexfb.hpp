@@ -4,7 +4,9 @@
 	@brief	OpenGL テクスチャー・フレーム・バッファ・クラス @n
 			テクスチャーを２枚初期化して、それをダブルバッファとして@n
 			使い、ビットマップの動画表示などを行う。@n
-			24(RGB)、32(RGBA) ビットの表示モードに対応。
+			24(RGB)、32(RGBA) ビットの表示モードに対応。@n
+			YUV420 のソースは、プレーン毎に PBO で転送し、シェーダーで RGB に @n
+			変換してページに描画する（シェーダーが使えない場合は CPU で変換）。
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2017, 2020 Kunihito Hiramatsu @n
 				Released under the MIT license @n
@@ -12,6 +14,8 @@
 */
 //=====================================================================//
 #include <vector>
+#include <cstring>
+#include <algorithm>
 #include "gl_fw/gl_info.hpp"
 #include "utils/vtx.hpp"
 
@@ -36,6 +40,7 @@ namespace gl {
 			RGB,		///< RGB 24 ビットカラー画像
 			RGBA,		///< RGBA 32 ビットカラー画像
 			BGR,		///< BGR 24 ビットカラー画像（BGR オーダー）
+			YUV420,		///< YUV 4:2:0 プレーナー（Y、U、V の順に詰めた I420）
 		};
 
 	private:
@@ -65,6 +70,326 @@ namespace gl {
 		bool	h_flip_;
 		bool	v_flip_;
 
+		bool	bt709_;
+		bool	full_range_;
+
+#ifndef OPENGL_ES
+		// YUV420 の GPU 変換
+		struct yuv_t {
+			GLuint		tex[3];		///< Y、U、V のプレーン
+			GLuint		prog;
+			GLuint		fbo;
+			GLuint		pbo;
+			uint8_t*	ptr;		///< 永続マップされた PBO（無い場合 nullptr）
+			GLsync		fence[2];
+			uint32_t	page;
+			uint32_t	size;		///< １フレーム分のサイズ
+			vtx::ipos	dim;
+			bool		init;
+			bool		ok;
+			yuv_t() : tex{ 0, 0, 0 }, prog(0), fbo(0), pbo(0), ptr(nullptr),
+				fence{ nullptr, nullptr }, page(0), size(0), dim(0), init(false), ok(false) { }
+		};
+		yuv_t	yuv_;
+
+
+		static GLuint compile_(GLenum type, const char* src)
+		{
+			GLuint sh = glCreateShader(type);
+			glShaderSource(sh, 1, &src, nullptr);
+			glCompileShader(sh);
+			GLint st = 0;
+			glGetShaderiv(sh, GL_COMPILE_STATUS, &st);
+			if(st == GL_FALSE) {
+				glDeleteShader(sh);
+				return 0;
+			}
+			return sh;
+		}
+
+
+		bool create_yuv_program_()
+		{
+			static const char* vs =
+				"#version 120\n"
+				"void main() {\n"
+				"  gl_TexCoord[0] = gl_MultiTexCoord0;\n"
+				"  gl_Position = ftransform();\n"
+				"}\n";
+			static const char* fs =
+				"#version 120\n"
+				"uniform sampler2D tex_y;\n"
+				"uniform sampler2D tex_u;\n"
+				"uniform sampler2D tex_v;\n"
+				"uniform vec3 ofs;\n"
+				"uniform mat3 mtx;\n"
+				"void main() {\n"
+				"  vec2 t = gl_TexCoord[0].st;\n"
+				"  vec3 yuv = vec3(texture2D(tex_y, t).r, texture2D(tex_u, t).r, texture2D(tex_v, t).r);\n"
+				"  gl_FragColor = vec4(clamp(mtx * (yuv - ofs), 0.0, 1.0), 1.0);\n"
+				"}\n";
+			GLuint v = compile_(GL_VERTEX_SHADER, vs);
+			GLuint f = compile_(GL_FRAGMENT_SHADER, fs);
+			if(v == 0 || f == 0) {
+				if(v) glDeleteShader(v);
+				if(f) glDeleteShader(f);
+				return false;
+			}
+			yuv_.prog = glCreateProgram();
+			glAttachShader(yuv_.prog, v);
+			glAttachShader(yuv_.prog, f);
+			glLinkProgram(yuv_.prog);
+			glDeleteShader(v);
+			glDeleteShader(f);
+			GLint st = 0;
+			glGetProgramiv(yuv_.prog, GL_LINK_STATUS, &st);
+			if(st == GL_FALSE) {
+				glDeleteProgram(yuv_.prog);
+				yuv_.prog = 0;
+				return false;
+			}
+			return true;
+		}
+
+
+		void destroy_yuv_()
+		{
+			for(int i = 0; i < 2; ++i) {
+				if(yuv_.fence[i]) glDeleteSync(yuv_.fence[i]);
+			}
+			if(yuv_.pbo) {
+				if(yuv_.ptr) {
+					glBindBuffer(GL_PIXEL_UNPACK_BUFFER, yuv_.pbo);
+					glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+					glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+				}
+				glDeleteBuffers(1, &yuv_.pbo);
+			}
+			if(yuv_.tex[0]) glDeleteTextures(3, yuv_.tex);
+			if(yuv_.fbo) glDeleteFramebuffers(1, &yuv_.fbo);
+			if(yuv_.prog) glDeleteProgram(yuv_.prog);
+			yuv_ = yuv_t();
+		}
+
+
+		// シェーダー、FBO、プレーン用テクスチャー、PBO の準備
+		bool setup_yuv_()
+		{
+			if(yuv_.init && yuv_.dim == disp_size_) return yuv_.ok;
+			destroy_yuv_();
+			yuv_.init = true;
+			yuv_.dim = disp_size_;
+
+			if(glfwExtensionSupported("GL_ARB_fragment_shader") != GL_TRUE
+				|| glfwExtensionSupported("GL_ARB_framebuffer_object") != GL_TRUE
+				|| glfwExtensionSupported("GL_ARB_pixel_buffer_object") != GL_TRUE) {
+				return false;
+			}
+			if(!create_yuv_program_()) return false;
+
+			glGenFramebuffers(1, &yuv_.fbo);
+
+			int cw = (disp_size_.x + 1) / 2;
+			int ch = (disp_size_.y + 1) / 2;
+			glGenTextures(3, yuv_.tex);
+			for(int i = 0; i < 3; ++i) {
+				glBindTexture(GL_TEXTURE_2D, yuv_.tex[i]);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+				int w = i == 0 ? disp_size_.x : cw;
+				int h = i == 0 ? disp_size_.y : ch;
+				glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, w, h, 0,
+					GL_LUMINANCE, GL_UNSIGNED_BYTE, nullptr);
+			}
+
+			// PBO は２フレーム分のリング（永続マップが使える場合はマップしたまま）
+			yuv_.size = disp_size_.x * disp_size_.y + cw * ch * 2;
+			glGenBuffers(1, &yuv_.pbo);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, yuv_.pbo);
+			if(glfwExtensionSupported("GL_ARB_buffer_storage") == GL_TRUE) {
+				GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+				glBufferStorage(GL_PIXEL_UNPACK_BUFFER, yuv_.size * 2, nullptr, flags);
+				yuv_.ptr = static_cast<uint8_t*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER,
+					0, yuv_.size * 2, flags));
+			} else {
+				glBufferData(GL_PIXEL_UNPACK_BUFFER, yuv_.size * 2, nullptr, GL_STREAM_DRAW);
+			}
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+			yuv_.ok = true;
+			return true;
+		}
+
+
+		void yuv_matrix_(GLfloat* ofs, GLfloat* mtx) const
+		{
+			// limited range の場合は、16-235（235-16 = 219）、16-240（240-16 = 224）を伸張する
+			float ys = full_range_ ? 1.0f : 255.0f / 219.0f;
+			float cs = full_range_ ? 1.0f : 255.0f / 224.0f;
+			ofs[0] = full_range_ ? 0.0f : 16.0f / 255.0f;
+			ofs[1] = 128.0f / 255.0f;
+			ofs[2] = 128.0f / 255.0f;
+			float kr = bt709_ ? 0.2126f : 0.299f;
+			float kb = bt709_ ? 0.0722f : 0.114f;
+			float kg = 1.0f - kr - kb;
+			float rv = 2.0f * (1.0f - kr);
+			float bu = 2.0f * (1.0f - kb);
+			float gu = -bu * kb / kg;
+			float gv = -rv * kr / kg;
+			// GLSL の mat3 は列優先
+			mtx[0] = ys;      mtx[1] = ys;      mtx[2] = ys;
+			mtx[3] = 0.0f;    mtx[4] = gu * cs; mtx[5] = bu * cs;
+			mtx[6] = rv * cs; mtx[7] = gv * cs; mtx[8] = 0.0f;
+		}
+
+
+		bool rendering_yuv_(const uint8_t* img)
+		{
+			if(!setup_yuv_()) return false;
+
+			int cw = (disp_size_.x + 1) / 2;
+			int ch = (disp_size_.y + 1) / 2;
+
+			// PBO へ書き込み（GPU が読み終わるまで待つ）
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, yuv_.pbo);
+			uint32_t ofs = yuv_.page * yuv_.size;
+			if(yuv_.ptr) {
+				GLsync& fc = yuv_.fence[yuv_.page];
+				if(fc) {
+					glClientWaitSync(fc, GL_SYNC_FLUSH_COMMANDS_BIT, 100000000);
+					glDeleteSync(fc);
+					fc = nullptr;
+				}
+				std::memcpy(yuv_.ptr + ofs, img, yuv_.size);
+			} else {
+				glBufferSubData(GL_PIXEL_UNPACK_BUFFER, ofs, yuv_.size, img);
+			}
+
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+			uint32_t pofs[3] = { ofs, ofs + disp_size_.x * disp_size_.y, ofs + disp_size_.x * disp_size_.y + cw * ch };
+			for(int i = 0; i < 3; ++i) {
+				int w = i == 0 ? disp_size_.x : cw;
+				int h = i == 0 ? disp_size_.y : ch;
+				glBindTexture(GL_TEXTURE_2D, yuv_.tex[i]);
+				glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, GL_LUMINANCE, GL_UNSIGNED_BYTE,
+					reinterpret_cast<const void*>(static_cast<uintptr_t>(pofs[i])));
+			}
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+			// 裏ページへ変換描画
+			GLint fbo = 0;
+			glGetIntegerv(GL_FRAMEBUFFER_BINDING, &fbo);
+			glBindFramebuffer(GL_FRAMEBUFFER, yuv_.fbo);
+			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+				tex_id_.ids_[disp_page_ ^ 1], 0);
+
+			glPushAttrib(GL_VIEWPORT_BIT | GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_TEXTURE_BIT);
+			glDisable(GL_BLEND);
+			glDisable(GL_DEPTH_TEST);
+			glViewport(disp_start_.x, disp_start_.y, disp_size_.x, disp_size_.y);
+			glMatrixMode(GL_PROJECTION);
+			glPushMatrix();
+			glLoadIdentity();
+			glOrthof(0.0f, 1.0f, 0.0f, 1.0f, -1.0f, 1.0f);
+			glMatrixMode(GL_MODELVIEW);
+			glPushMatrix();
+			glLoadIdentity();
+			glMatrixMode(GL_TEXTURE);
+			glPushMatrix();
+			glLoadIdentity();
+
+			glUseProgram(yuv_.prog);
+			static const char* names[3] = { "tex_y", "tex_u", "tex_v" };
+			for(int i = 0; i < 3; ++i) {
+				glActiveTexture(GL_TEXTURE0 + i);
+				glBindTexture(GL_TEXTURE_2D, yuv_.tex[i]);
+				glUniform1i(glGetUniformLocation(yuv_.prog, names[i]), i);
+			}
+			GLfloat yo[3];
+			GLfloat ym[9];
+			yuv_matrix_(yo, ym);
+			glUniform3fv(glGetUniformLocation(yuv_.prog, "ofs"), 1, yo);
+			glUniformMatrix3fv(glGetUniformLocation(yuv_.prog, "mtx"), 1, GL_FALSE, ym);
+
+			static const GLfloat quad[8] = { 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f };
+			glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+			glEnableClientState(GL_VERTEX_ARRAY);
+			glTexCoordPointer(2, GL_FLOAT, 0, quad);
+			glVertexPointer(2, GL_FLOAT, 0, quad);
+			glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+			glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+			glDisableClientState(GL_VERTEX_ARRAY);
+
+			glUseProgram(0);
+			glActiveTexture(GL_TEXTURE0);
+			glMatrixMode(GL_TEXTURE);
+			glPopMatrix();
+			glMatrixMode(GL_MODELVIEW);
+			glPopMatrix();
+			glMatrixMode(GL_PROJECTION);
+			glPopMatrix();
+			glMatrixMode(GL_MODELVIEW);
+			glPopAttrib();
+
+			glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(fbo));
+
+			if(yuv_.ptr) {
+				yuv_.fence[yuv_.page] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			}
+			yuv_.page ^= 1;
+			return true;
+		}
+#endif
+
+
+		// YUV420 から RGB(A) への CPU 変換（GPU 変換が使えない場合）
+		void convert_yuv_(const uint8_t* img, std::vector<uint8_t>& dst, int bpp, int alpha) const
+		{
+			int w = disp_size_.x;
+			int h = disp_size_.y;
+			int cw = (w + 1) / 2;
+			const uint8_t* py = img;
+			const uint8_t* pu = py + w * h;
+			const uint8_t* pv = pu + cw * ((h + 1) / 2);
+			// 係数は 8192 倍、limited range（255 / 224）
+			int kr = bt709_ ? 14686 : 13075;
+			int kgu = bt709_ ? -1747 : -3209;
+			int kgv = bt709_ ? -4366 : -6660;
+			int kb = bt709_ ? 17305 : 16525;
+			int ky = 9539;  // 255 / 219 * 8192
+			int y0 = 16;
+			if(full_range_) {
+				kr = kr * 224 / 255;
+				kgu = kgu * 224 / 255;
+				kgv = kgv * 224 / 255;
+				kb = kb * 224 / 255;
+				ky = 8192;
+				y0 = 0;
+			}
+			dst.resize(w * h * bpp);
+			uint8_t* p = &dst[0];
+			for(int y = 0; y < h; ++y) {
+				const uint8_t* ly = py + y * w;
+				const uint8_t* lu = pu + (y / 2) * cw;
+				const uint8_t* lv = pv + (y / 2) * cw;
+				for(int x = 0; x < w; ++x) {
+					int yy = (ly[x] - y0) * ky;
+					int u = lu[x / 2] - 128;
+					int v = lv[x / 2] - 128;
+					int r = (yy + kr * v + 4096) >> 13;
+					int g = (yy + kgu * u + kgv * v + 4096) >> 13;
+					int b = (yy + kb * u + 4096) >> 13;
+					p[0] = static_cast<uint8_t>(std::min(std::max(r, 0), 255));
+					p[1] = static_cast<uint8_t>(std::min(std::max(g, 0), 255));
+					p[2] = static_cast<uint8_t>(std::min(std::max(b, 0), 255));
+					if(bpp == 4) p[3] = alpha;
+					p += bpp;
+				}
+			}
+		}
+
 		void draw_quad_(GLuint tex_id)
 		{
 			glEnable(GL_TEXTURE_2D);
@@ -116,6 +441,9 @@ namespace gl {
 
 		void destroy_()
 		{
+#ifndef OPENGL_ES
+			destroy_yuv_();
+#endif
 			glDeleteTextures(2, tex_id_.ids_);
 		}
 
@@ -142,7 +470,11 @@ namespace gl {
 			disp_page_(0), tex_type_(0), tex_depth_(0),
 			disp_start_(0, 0), disp_size_(0, 0), tex_size_(0, 0),
 			tex_id_(0, 0),
-			h_flip_(false), v_flip_(false)
+			h_flip_(false), v_flip_(false),
+			bt709_(false), full_range_(false)
+#ifndef OPENGL_ES
+			, yuv_()
+#endif
 		{ }
 
 
@@ -306,6 +638,16 @@ namespace gl {
 		void set_flip(bool hf, bool vf) { h_flip_ = hf; v_flip_ = vf; }
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief		YUV420 ソースの色空間を設定
+			@param[in]	bt709	「true」なら BT.709、「false」なら BT.601
+			@param[in]	full	「true」ならフルレンジ（0-255）
+		*/
+		//-----------------------------------------------------------------//
+		void set_yuv_format(bool bt709, bool full) { bt709_ = bt709; full_range_ = full; }
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	テクスチャー ID を取得
@@ -351,7 +693,7 @@ namespace gl {
 						で行っており、最終的な変換を行う為、DST 形式が RGB(24) @n
 						を選択する事で変換が二度起こり、パフォーマンスを悪化 @n
 						させると考えられる。
-			@param[in]	srct	ソース・イメージのタイプ（RGB、RGBA、BGR）
+			@param[in]	srct	ソース・イメージのタイプ（RGB、RGBA、BGR、YUV420）
 			@param[in]	img		ソース・イメージのポインター
 			@param[in]	alpha	24 -> 32 ビットフォーマット変換時のアルファ値
 		*/
@@ -363,7 +705,19 @@ namespace gl {
 			// GL_RGB 又は、GL_RGBA への変換（必要な場合）
 			std::vector<uint8_t> dst;
 			GLuint src_type = GL_RGBA;
-			if(tex_depth_ == 4) {
+			if(srct == IMAGE::YUV420) {
+#ifndef OPENGL_ES
+				if(rendering_yuv_(static_cast<const uint8_t*>(img))) return;
+#endif
+				if(tex_depth_ == 24) {
+					src_type = GL_RGB;
+					convert_yuv_(static_cast<const uint8_t*>(img), dst, 3, alpha);
+				} else if(tex_depth_ == 32) {
+					convert_yuv_(static_cast<const uint8_t*>(img), dst, 4, alpha);
+				} else {
+					return;
+				}
+			} else if(tex_depth_ == 4) {
 			} else if(tex_depth_ == 8) {
 			} else if(tex_depth_ == 16) {		// RGBA4
 			} else if(tex_depth_ == 24) {		// DST: RGB8(24)
@@ -9,7 +9,10 @@
 */
 //=====================================================================//
 #include <vector>
+#include <algorithm>
 #include "gl_fw/glutils.hpp"
+#include "utils/capture_file.hpp"
+#include "utils/wave_pyramid.hpp"
 
 namespace view {
 
@@ -39,6 +42,21 @@ namespace view {
 		};
 
 
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  エンベロープ（区間の最小、最大、平均）
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct envelope_param {
+			UNIT		min_;		///< 最小値
+			UNIT		max_;		///< 最大値
+			float		mean_;		///< 平均
+			uint32_t	num_;		///< サンプル数
+
+			envelope_param() : min_(0), max_(0), mean_(0.0f), num_(0) { }
+		};
+
+
 		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 		/*!
 			@brief  計測パラメーター
@@ -258,13 +276,18 @@ namespace view {
 	private:
 		typedef std::vector<UNIT> UNITS;
 
+		typedef utils::wave_pyramid<UNIT> PYRAMID;
+		typedef typename PYRAMID::acc_t acc_t;
+
 		struct ch_t {
 			chr_param	param_;
 			uint32_t	tstep_;
 			UNITS		units_;
 			vtx::fposs	lines_;
+			PYRAMID		pyramid_;	///< 列毎の min/max を求める為のピラミッド
+			bool		file_;		///< 描画はキャプチャー・ファイルから行う
 
-			ch_t() : param_(), tstep_(0), units_(), lines_()
+			ch_t() : param_(), tstep_(0), units_(), lines_(), pyramid_(), file_(false)
 			{ }
 		};
 
@@ -281,6 +304,20 @@ namespace view {
 		bool		smooth_before_;
 		bool		smooth_;
 
+		utils::capture_file	cap_;		///< バッファに入り切らないキャプチャー
+		int64_t		cap_org_;			///< バッファの０に当たるファイルの位置
+		UNITS		cap_win_;			///< ファイルから読んだ描画の窓
+
+		static constexpr UNIT BASE_ = static_cast<UNIT>(32768);	///< 波形の無い所の値
+
+		static void invalidate_(ch_t& t) noexcept
+		{
+			t.pyramid_.invalidate();
+			t.file_ = false;
+			t.param_.update_ = true;
+		}
+
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
@@ -288,7 +325,7 @@ namespace view {
 		*/
 		//-----------------------------------------------------------------//
 		render_waves() noexcept : ch_{ }, div_(0.0), gain_{ 1.0f }, win_size_(0),
-			smooth_before_(false), smooth_(true) { }
+			smooth_before_(false), smooth_(true), cap_(), cap_org_(0), cap_win_() { }
 
 
 		//-----------------------------------------------------------------//
@@ -356,10 +393,24 @@ namespace view {
 				static UNITS u;
 				return u;
 			}
+			invalidate_(ch_[ch]);
 			return ch_[ch].units_;
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  波形を直接書き換えた事を通知（ピラミッドを作り直す）
+			@param[in]	ch	チャネル
+		*/
+		//-----------------------------------------------------------------//
+		void invalidate(uint32_t ch) noexcept
+		{
+			if(ch >= CHN) return;
+			invalidate_(ch_[ch]);
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief  情報パラメーターを取得
@@ -394,6 +445,7 @@ namespace view {
 				for(uint32_t j = 0; j < size(); ++j) {
 					ch_[i].units_.push_back(32768);
 				}
+				invalidate_(ch_[i]);
 			}
 		}
 
@@ -421,6 +473,7 @@ namespace view {
 				a += dt;
 				if(a >= 1.0) a -= 1.0;
 			}
+			invalidate_(ch_[ch]);
 			return static_cast<uint32_t>(t);
 		}
 
@@ -446,6 +499,7 @@ namespace view {
 				a += dt;
 				if(a >= 1.0) a -= 1.0;
 			}
+			invalidate_(ch_[ch]);
 		}
 
 
@@ -460,17 +514,65 @@ namespace view {
 		//-----------------------------------------------------------------//
 		void copy(uint32_t ch, const UNIT* src, uint32_t len, uint32_t ofs = 0) noexcept
 		{
+			ch_t& t = ch_[ch];
+			uint32_t sz = t.units_.size();
+			if(sz == 0 || len == 0) return;
+
 			for(uint32_t i = 0; i < len; ++i) {
 				uint16_t w = *src++;
-				ch_[ch].units_[(i + ofs) % ch_[ch].units_.size()] = w;
+				t.units_[(i + ofs) % sz] = w;
+			}
+			t.file_ = false;
+			t.param_.update_ = true;
+
+			// 書き込んだ範囲だけピラミッドを更新
+			if(len >= sz) {
+				t.pyramid_.update(t.units_, 0, sz);
+			} else {
+				uint32_t org = ofs % sz;
+				uint32_t n = std::min(len, sz - org);
+				t.pyramid_.update(t.units_, org, org + n);
+				if(len > n) t.pyramid_.update(t.units_, 0, len - n);
 			}
-			ch_[ch].param_.update_ = true;
 		}
 
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief  レンダリング（レガシー）
+			@brief  エンベロープの取得 @n
+					ピラミッドを使うので、区間の長さに依らずほぼ一定時間
+			@param[in]	ch		チャネル
+			@param[in]	org		開始位置（負の場合、バッファ末尾から）
+			@param[in]	len		サンプル数
+			@return エンベロープ
+		*/
+		//-----------------------------------------------------------------//
+		envelope_param get_envelope(uint32_t ch, int32_t org, uint32_t len) noexcept
+		{
+			envelope_param e;
+			if(ch >= CHN) return e;
+
+			ch_t& t = ch_[ch];
+			int32_t sz = t.units_.size();
+			if(sz == 0 || len == 0) return e;
+
+			org %= sz;
+			if(org < 0) org += sz;
+			acc_t a;
+			t.pyramid_.envelope(t.units_, org, std::min(len, static_cast<uint32_t>(sz)), a);
+			e.min_ = a.min_;
+			e.max_ = a.max_;
+			e.mean_ = static_cast<float>(a.sum_ / static_cast<double>(a.num_));
+			e.num_ = a.num_;
+			return e;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  レンダリング（レガシー） @n
+					１ピクセルに複数のサンプルが入る場合は、ピラミッドから @n
+					各列の最小、最大を求めて描画するので、スパイクを見落とさない。
 			@param[in]	size	描画サイズ（ピクセル）
 			@param[in]	step	時間軸ステップ（65536 を 1.0 ピクセル）
 		*/
@@ -503,20 +605,69 @@ namespace view {
 					}
 				}
 
+				// ファイルから描画するチャネルは、バッファの外へもスクロールできる
+				bool file = t.file_ && cap_.is_open();
+				int64_t sz = t.units_.size();
+				int64_t lo_lim = file ? -cap_org_ : -(sz / 2);
+				int64_t hi_lim = file ? static_cast<int64_t>(cap_.get_header().samples_) - cap_org_ : sz / 2;
+
 				int mod_x = 0;
-				if(update || t.param_.update_) {
+				if((update || t.param_.update_) && tstep > 65536) {
+					// 列毎に [min, max] を往復するストリップ（区間は列の間で重ならない）
+					float gain = t.param_.gain_;
+					int64_t tsc = static_cast<int64_t>(t.param_.offset_.x) * tstep;
+					t.lines_.clear();
+					for(int32_t i = 0; i < size.x; ++i) {
+						int64_t org = std::max(tsc >> 16, lo_lim);
+						tsc += tstep;
+						int64_t end = std::min(tsc >> 16, hi_lim);
+						if(org >= end) continue;
+
+						int32_t min;
+						int32_t max;
+						if(file) {  // チャンク索引を使う
+							cap_.envelope(n, cap_org_ + org, end - org, min, max);
+						} else {
+							acc_t a;
+							t.pyramid_.envelope(t.units_, org < 0 ? org + sz : org, end - org, a);
+							min = a.min_;
+							max = a.max_;
+						}
+						vtx::fpos hi(i, (static_cast<float>(max) - 32768.0f) * -gain);
+						vtx::fpos lo(i, (static_cast<float>(min) - 32768.0f) * -gain);
+						if(t.lines_.empty() || t.lines_.back() != hi) {
+							t.lines_.push_back(hi);
+						}
+						if(lo != hi) {
+							t.lines_.push_back(lo);
+						}
+					}
+					t.param_.update_ = false;
+				} else if(update || t.param_.update_) {
 					float gain = t.param_.gain_;
-					int32_t tsc = t.param_.offset_.x * tstep;
+					int64_t tsc = static_cast<int64_t>(t.param_.offset_.x) * tstep;
+					// ファイルの場合、見えている範囲（補完の１つ先まで）だけを読む
+					int64_t top = tsc >> 16;
+					if(file) {
+						int64_t num = ((tsc + static_cast<int64_t>(size.x) * tstep) >> 16) - top + 2;
+						cap_win_.resize(num);
+						cap_.read_window(n, cap_org_ + top, &cap_win_[0], num, BASE_);
+					}
 					t.lines_.clear();
 					for(uint32_t i = 0; i < size.x; ++i) {
-						int32_t idx = (tsc >> 16);
-						int32_t sz = t.units_.size();
-						if(-(sz / 2) <= idx && idx < (sz / 2)) {
-							if(idx < 0) idx += sz;
-							float v = static_cast<float>(t.units_[idx % sz]);
+						int64_t idx = (tsc >> 16);
+						if(lo_lim <= idx && idx < hi_lim) {
+							const UNIT* p;
+							if(file) {
+								p = &cap_win_[idx - top];
+							} else {
+								if(idx < 0) idx += sz;
+								p = &t.units_[idx % sz];
+							}
+							float v = static_cast<float>(p[0]);
 							if(smooth_) {
 								if(tstep < 65536) {  // 補完する
-									float v2 = static_cast<float>(t.units_[(idx + 1) % sz]);
+									float v2 = static_cast<float>(file || (idx + 1) < sz ? p[1] : t.units_[0]);
 									v += (v2 - v) * static_cast<float>(tsc & 0xffff) / 65535.0f;
 								}
 							}
@@ -658,6 +809,7 @@ namespace view {
 				v = a;
 				w = static_cast<UNIT>((a + d) * 32767.0f) + 32768;
 			}
+			invalidate_(ch_[ch]);
 		}
 
 
@@ -844,53 +996,63 @@ if(ch == 0) {
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief  セーブ
+			@brief  セーブ（utils::capture_file 形式）
 			@param[in]	path	ファイル・パス
+			@param[in]	rate	サンプリング周期 [秒]（記録用）
 			@return 成功なら「true」
 		*/
 		//-----------------------------------------------------------------//
-		bool save(const std::string& path) noexcept
+		bool save(const std::string& path, double rate = 0.0) noexcept
 		{
-			utils::file_io fio;
-
-			if(!fio.open(path, "wb")) {
-				return false;
-			}
-
+			const UNITS* src[CHN];
+			float gain[CHN];
 			for(uint32_t ch = 0; ch < CHN; ++ch) {
-				for(auto w : ch_[ch].units_) {
-					fio.put(w);
-				}
+				src[ch] = &ch_[ch].units_;
+				gain[ch] = ch_[ch].param_.gain_;
 			}
-			fio.close();
-
-			return true;
+			return utils::capture_file::save_buffers(path, src, CHN, rate, gain);
 		}
 
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief  ロード
+			@brief  ロード @n
+					バッファより大きなキャプチャーは、org を時間軸の０として、@n
+					その前後のバッファ分だけを読み込む。ファイルはマップしたまま @n
+					にして、描画はスクロール、ズームの位置の窓をファイルから読む。@n
+					（縮小表示はチャンク索引のエンベロープを使う）@n
+					ヘッダーの無い旧形式のファイルも読める。
 			@param[in]	path	ファイル・パス
+			@param[in]	org		大きなキャプチャーの読み込み位置（サンプル）
 			@return 成功なら「true」
 		*/
 		//-----------------------------------------------------------------//
-		bool load(const std::string& path) noexcept
+		bool load(const std::string& path, uint64_t org = 0) noexcept
 		{
-			utils::file_io fio;
-
-			if(!fio.open(path, "rb")) {
+			UNITS* dst[CHN];
+			for(uint32_t ch = 0; ch < CHN; ++ch) {
+				dst[ch] = &ch_[ch].units_;
+			}
+			if(!cap_.load_buffers(path, dst, CHN, org, BASE_)) {
 				return false;
 			}
 
+			// バッファに入り切らないチャネルだけ、ファイルから描画する
+			bool keep = false;
 			for(uint32_t ch = 0; ch < CHN; ++ch) {
-				for(auto& w : ch_[ch].units_) {
-					fio.get<UNIT>(w);
+				ch_t& t = ch_[ch];
+				invalidate_(t);
+				if(cap_.is_open() && ch < cap_.get_header().channels_ && !t.units_.empty()
+					&& cap_.get_header().samples_ > t.units_.size()) {
+					t.file_ = true;
+					keep = true;
 				}
-				ch_[ch].param_.update_ = true;
 			}
-			fio.close();
-
+			if(keep) {
+				cap_org_ = org;
+			} else {
+				cap_.close();
+			}
 			return true;
 		}
 	};
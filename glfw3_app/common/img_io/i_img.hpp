@@ -155,6 +155,49 @@ namespace img {
 		virtual const vtx::spos& get_size() const = 0;
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	１ラインのバイト数を得る
+			@return	ライン・バイト数
+		*/
+		//-----------------------------------------------------------------//
+		virtual uint32_t get_stride() const = 0;
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ラインの先頭ポインターを得る
+			@param[in]	y	ライン
+			@return	ライン・ポインター（範囲外なら「nullptr」）
+		*/
+		//-----------------------------------------------------------------//
+		virtual const void* get_line(int y) const = 0;
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	読み書き可能なラインの先頭ポインターを得る
+			@param[in]	y	ライン
+			@return	ライン・ポインター（範囲外なら「nullptr」）
+		*/
+		//-----------------------------------------------------------------//
+		virtual void* at_line(int y) = 0;
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ラインの一部を RGBA8 に変換して得る @n
+					※範囲のクリップは呼び出し側で行う事
+			@param[in]	y	ライン
+			@param[in]	x	開始位置
+			@param[in]	len	ピクセル数
+			@param[out]	out	出力先
+			@return	範囲外なら「false」
+		*/
+		//-----------------------------------------------------------------//
+		virtual bool get_line_rgba8(int y, int x, int len, rgba8* out) const = 0;
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	カラー・ルック・アップ・テーブルの最大数を返す
@@ -200,4 +243,29 @@ namespace img {
 	};
 
 	typedef std::shared_ptr<i_img>  shared_img;
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	矩形コピーの領域をクリップする @n
+				ソース、コピー先の両方からはみ出す部分を取り除く。
+		@param[in]		ssize	ソースのサイズ
+		@param[in,out]	rsrc	ソースの領域
+		@param[in]		dsize	コピー先のサイズ
+		@param[in,out]	pdst	コピー先の位置
+		@return	コピーする領域が無い場合「false」
+	*/
+	//-----------------------------------------------------------------//
+	inline bool clip_copy_rect(const vtx::spos& ssize, vtx::srect& rsrc, const vtx::spos& dsize, vtx::spos& pdst)
+	{
+		if(rsrc.org.x < 0) { pdst.x -= rsrc.org.x; rsrc.size.x += rsrc.org.x; rsrc.org.x = 0; }
+		if(rsrc.org.y < 0) { pdst.y -= rsrc.org.y; rsrc.size.y += rsrc.org.y; rsrc.org.y = 0; }
+		if(pdst.x < 0) { rsrc.org.x -= pdst.x; rsrc.size.x += pdst.x; pdst.x = 0; }
+		if(pdst.y < 0) { rsrc.org.y -= pdst.y; rsrc.size.y += pdst.y; pdst.y = 0; }
+		if((rsrc.org.x + rsrc.size.x) > ssize.x) rsrc.size.x = ssize.x - rsrc.org.x;
+		if((rsrc.org.y + rsrc.size.y) > ssize.y) rsrc.size.y = ssize.y - rsrc.org.y;
+		if((pdst.x + rsrc.size.x) > dsize.x) rsrc.size.x = dsize.x - pdst.x;
+		if((pdst.y + rsrc.size.y) > dsize.y) rsrc.size.y = dsize.y - pdst.y;
+		return rsrc.size.x > 0 && rsrc.size.y > 0;
+	}
 };
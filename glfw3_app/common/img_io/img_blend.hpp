@@ -0,0 +1,239 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	RGBA8 スパン合成（ブレンド・エンジン）@n
+			１ライン分のピクセル列（スパン）を、まとめて合成する。@n
+			AVX2 が使える CPU なら８ピクセル、SSE2 なら４ピクセル単位で処理し、@n
+			端数はスカラーで処理する（結果は全て同じ）。AVX2 はビルド・オプションに @n
+			依らず、実行時に CPU を調べて選択する。@n
+			各成分は 16 ビットに拡張し、(x * (a + 1)) >> 8 の形で計算する。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/glfw3_app/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define IMG_BLEND_AVX2
+#define IMG_BLEND_SSE2
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+// AVX2 はターゲット属性で関数単位に有効化し、実行時に選択する
+#include <immintrin.h>
+#define IMG_BLEND_AVX2
+#if defined(__SSE2__)
+#define IMG_BLEND_SSE2
+#endif
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define IMG_BLEND_SSE2
+#endif
+#include "img.hpp"
+
+namespace img {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	合成モード
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct BLEND {
+		enum type {
+			COPY,		///< 上書き
+			OVER,		///< ソース・アルファで合成（コピー先のアルファは維持）
+			OVER_DA,	///< ソースとコピー先のアルファで合成（コピー先のアルファは維持）
+			ADD,		///< 加算（飽和、コピー先のアルファは維持）
+			MULTIPLY,	///< 乗算（ソース・アルファで効きを調整、コピー先のアルファは維持）
+			PREMUL,		///< 乗算済みアルファのソースを合成（アルファも合成）
+		};
+	};
+
+
+	namespace blend_ {
+
+		// スカラー版（SIMD 版と同じ計算）
+		inline void pixel(rgba8& d, const rgba8& s, BLEND::type mode)
+		{
+			uint32_t a  = s.a;
+			uint32_t a1 = a + 1;
+			uint32_t ia = 256 - a;
+			switch(mode) {
+			case BLEND::COPY:
+				d = s;
+				break;
+			case BLEND::OVER:
+				d.r = ((a1 * s.r) >> 8) + ((ia * d.r) >> 8);
+				d.g = ((a1 * s.g) >> 8) + ((ia * d.g) >> 8);
+				d.b = ((a1 * s.b) >> 8) + ((ia * d.b) >> 8);
+				break;
+			case BLEND::OVER_DA:
+				{
+					uint32_t da = ((static_cast<uint32_t>(d.a) + 1) * ia) >> 8;
+					d.r = (d.r * da + s.r * a1) >> 8;
+					d.g = (d.g * da + s.g * a1) >> 8;
+					d.b = (d.b * da + s.b * a1) >> 8;
+				}
+				break;
+			case BLEND::ADD:
+				d.r = std::min(255u, d.r + ((s.r * a1) >> 8));
+				d.g = std::min(255u, d.g + ((s.g * a1) >> 8));
+				d.b = std::min(255u, d.b + ((s.b * a1) >> 8));
+				break;
+			case BLEND::MULTIPLY:
+				{
+					uint32_t mr = 255 - (((255 - s.r) * a1) >> 8);
+					uint32_t mg = 255 - (((255 - s.g) * a1) >> 8);
+					uint32_t mb = 255 - (((255 - s.b) * a1) >> 8);
+					d.r = (d.r * (mr + 1)) >> 8;
+					d.g = (d.g * (mg + 1)) >> 8;
+					d.b = (d.b * (mb + 1)) >> 8;
+				}
+				break;
+			case BLEND::PREMUL:
+				d.r = std::min(255u, s.r + ((d.r * ia) >> 8));
+				d.g = std::min(255u, s.g + ((d.g * ia) >> 8));
+				d.b = std::min(255u, s.b + ((d.b * ia) >> 8));
+				d.a = std::min(255u, s.a + ((d.a * ia) >> 8));
+				break;
+			}
+		}
+
+
+#if defined(IMG_BLEND_SSE2)
+		namespace sse2_ {
+
+			struct vec {
+				typedef __m128i T;
+				static const uint32_t num = 4;
+				static T load(const rgba8* p) { return _mm_loadu_si128(reinterpret_cast<const T*>(p)); }
+				static void store(rgba8* p, T v) { _mm_storeu_si128(reinterpret_cast<T*>(p), v); }
+				static T set1_32(uint32_t v) { return _mm_set1_epi32(static_cast<int>(v)); }
+				static T set1_16(uint16_t v) { return _mm_set1_epi16(static_cast<short>(v)); }
+				static T zero() { return _mm_setzero_si128(); }
+				static T lo(T v) { return _mm_unpacklo_epi8(v, zero()); }
+				static T hi(T v) { return _mm_unpackhi_epi8(v, zero()); }
+				static T pack(T l, T h) { return _mm_packus_epi16(l, h); }
+				static T mul(T a, T b) { return _mm_mullo_epi16(a, b); }
+				static T add(T a, T b) { return _mm_add_epi16(a, b); }
+				static T sub(T a, T b) { return _mm_sub_epi16(a, b); }
+				static T sr8(T a) { return _mm_srli_epi16(a, 8); }
+				static T adds8(T a, T b) { return _mm_adds_epu8(a, b); }
+				static T alpha(T v) { return _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xff), 0xff); }
+				static T sel(T m, T a, T b) { return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b)); }
+			};
+
+#define IMG_BLEND_TARGET
+#include "img_blend_simd.hpp"
+#undef IMG_BLEND_TARGET
+		}
+#endif
+
+#if defined(IMG_BLEND_AVX2)
+		namespace avx2_ {
+
+#if defined(__AVX2__)
+#define IMG_BLEND_TARGET
+#else
+#define IMG_BLEND_TARGET __attribute__((target("avx2")))
+#endif
+			struct vec {
+				typedef __m256i T;
+				static const uint32_t num = 8;
+				IMG_BLEND_TARGET static T load(const rgba8* p) { return _mm256_loadu_si256(reinterpret_cast<const T*>(p)); }
+				IMG_BLEND_TARGET static void store(rgba8* p, T v) { _mm256_storeu_si256(reinterpret_cast<T*>(p), v); }
+				IMG_BLEND_TARGET static T set1_32(uint32_t v) { return _mm256_set1_epi32(static_cast<int>(v)); }
+				IMG_BLEND_TARGET static T set1_16(uint16_t v) { return _mm256_set1_epi16(static_cast<short>(v)); }
+				IMG_BLEND_TARGET static T zero() { return _mm256_setzero_si256(); }
+				IMG_BLEND_TARGET static T lo(T v) { return _mm256_unpacklo_epi8(v, zero()); }
+				IMG_BLEND_TARGET static T hi(T v) { return _mm256_unpackhi_epi8(v, zero()); }
+				IMG_BLEND_TARGET static T pack(T l, T h) { return _mm256_packus_epi16(l, h); }
+				IMG_BLEND_TARGET static T mul(T a, T b) { return _mm256_mullo_epi16(a, b); }
+				IMG_BLEND_TARGET static T add(T a, T b) { return _mm256_add_epi16(a, b); }
+				IMG_BLEND_TARGET static T sub(T a, T b) { return _mm256_sub_epi16(a, b); }
+				IMG_BLEND_TARGET static T sr8(T a) { return _mm256_srli_epi16(a, 8); }
+				IMG_BLEND_TARGET static T adds8(T a, T b) { return _mm256_adds_epu8(a, b); }
+				IMG_BLEND_TARGET static T alpha(T v) { return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(v, 0xff), 0xff); }
+				IMG_BLEND_TARGET static T sel(T m, T a, T b) { return _mm256_or_si256(_mm256_and_si256(m, a), _mm256_andnot_si256(m, b)); }
+			};
+
+#include "img_blend_simd.hpp"
+#undef IMG_BLEND_TARGET
+		}
+
+
+		// AVX2 を指定せずにビルドした場合は、実行時に CPU を調べる
+		inline bool has_avx2()
+		{
+#if defined(__AVX2__)
+			return true;
+#else
+			static const bool f = (__builtin_cpu_init(), __builtin_cpu_supports("avx2"));
+			return f;
+#endif
+		}
+#endif
+	}
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	スパンの合成（ピクセル毎のソース）
+		@param[in,out]	dst		コピー先
+		@param[in]		src		ソース
+		@param[in]		len		ピクセル数
+		@param[in]		mode	合成モード
+	*/
+	//-----------------------------------------------------------------//
+	inline void blend_span(rgba8* dst, const rgba8* src, uint32_t len, BLEND::type mode)
+	{
+		if(mode == BLEND::COPY) {
+			std::memmove(static_cast<void*>(dst), src, len * sizeof(rgba8));
+			return;
+		}
+		uint32_t i = 0;
+#if defined(IMG_BLEND_AVX2)
+		if(blend_::has_avx2()) i = blend_::avx2_::span(dst, src, i, len, mode);
+#endif
+#if defined(IMG_BLEND_SSE2)
+		i = blend_::sse2_::span(dst, src, i, len, mode);
+#endif
+		for(; i < len; ++i) {
+			blend_::pixel(dst[i], src[i], mode);
+		}
+	}
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	スパンの合成（単色）
+		@param[in,out]	dst		コピー先
+		@param[in]		c		カラー
+		@param[in]		len		ピクセル数
+		@param[in]		mode	合成モード
+	*/
+	//-----------------------------------------------------------------//
+	inline void blend_fill(rgba8* dst, const rgba8& c, uint32_t len, BLEND::type mode)
+	{
+		if(mode == BLEND::COPY) {
+			std::fill(dst, dst + len, c);
+			return;
+		}
+		uint32_t i = 0;
+#if defined(IMG_BLEND_AVX2) || defined(IMG_BLEND_SSE2)
+		uint32_t cv;
+		std::memcpy(&cv, &c, 4);
+#endif
+#if defined(IMG_BLEND_AVX2)
+		if(blend_::has_avx2()) i = blend_::avx2_::fill(dst, cv, i, len, mode);
+#endif
+#if defined(IMG_BLEND_SSE2)
+		i = blend_::sse2_::fill(dst, cv, i, len, mode);
+#endif
+		for(; i < len; ++i) {
+			blend_::pixel(dst[i], c, mode);
+		}
+	}
+}
@@ -0,0 +1,88 @@
+//=====================================================================//
+/*!	@file
+	@brief	RGBA8 スパン合成の SIMD 本体 @n
+			img_blend.hpp から、SIMD 幅毎の名前空間の中でインクルードする。@n
+			「vec」（幅毎の基本操作）と「IMG_BLEND_TARGET」（関数のターゲット属性）@n
+			を定義してから読み込む為、#pragma once は置かない。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2023 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/glfw3_app/blob/master/LICENSE
+*/
+//=====================================================================//
+
+		// 16 ビットに拡張した半分（２／４ピクセル）の合成
+		IMG_BLEND_TARGET
+		inline vec::T half(vec::T d, vec::T s, BLEND::type mode)
+		{
+			const vec::T c256 = vec::set1_16(256);
+			const vec::T c255 = vec::set1_16(255);
+			const vec::T one  = vec::set1_16(1);
+			vec::T a  = vec::alpha(s);
+			vec::T a1 = vec::add(a, one);
+			vec::T ia = vec::sub(c256, a);
+			switch(mode) {
+			case BLEND::OVER:
+				return vec::add(vec::sr8(vec::mul(s, a1)), vec::sr8(vec::mul(d, ia)));
+			case BLEND::OVER_DA:
+				{
+					// ((da + 1) * ia) >> 8 は 16 ビットを越えるので、ia - ceil(ia * (255 - da) / 256) で求める
+					vec::T t = vec::mul(ia, vec::sub(c255, vec::alpha(d)));
+					vec::T da = vec::sub(ia, vec::sr8(vec::add(t, c255)));
+					return vec::sr8(vec::add(vec::mul(d, da), vec::mul(s, a1)));
+				}
+			case BLEND::ADD:
+				return vec::sr8(vec::mul(s, a1));  // 飽和加算はパック後に行う
+			case BLEND::MULTIPLY:
+				{
+					vec::T m = vec::sub(c255, vec::sr8(vec::mul(vec::sub(c255, s), a1)));
+					return vec::sr8(vec::mul(d, vec::add(m, one)));
+				}
+			case BLEND::PREMUL:
+				return vec::sr8(vec::mul(d, ia));  // 飽和加算はパック後に行う
+			default:
+				return s;
+			}
+		}
+
+
+		IMG_BLEND_TARGET
+		inline vec::T block(vec::T d, vec::T s, BLEND::type mode, vec::T amask)
+		{
+			vec::T v = vec::pack(half(vec::lo(d), vec::lo(s), mode), half(vec::hi(d), vec::hi(s), mode));
+			switch(mode) {
+			case BLEND::ADD:
+				return vec::sel(amask, d, vec::adds8(d, v));
+			case BLEND::PREMUL:
+				return vec::adds8(s, v);
+			default:
+				return vec::sel(amask, d, v);
+			}
+		}
+
+
+		// i から vec::num 単位で合成し、処理した終端を返す
+		IMG_BLEND_TARGET
+		inline uint32_t span(rgba8* dst, const rgba8* src, uint32_t i, uint32_t len, BLEND::type mode)
+		{
+			const vec::T amask = vec::set1_32(0xff000000);
+			for(; (i + vec::num) <= len; i += vec::num) {
+				vec::T d = vec::load(dst + i);
+				vec::T s = vec::load(src + i);
+				vec::store(dst + i, block(d, s, mode, amask));
+			}
+			return i;
+		}
+
+
+		IMG_BLEND_TARGET
+		inline uint32_t fill(rgba8* dst, uint32_t c, uint32_t i, uint32_t len, BLEND::type mode)
+		{
+			const vec::T amask = vec::set1_32(0xff000000);
+			const vec::T s = vec::set1_32(c);
+			for(; (i + vec::num) <= len; i += vec::num) {
+				vec::T d = vec::load(dst + i);
+				vec::store(dst + i, block(d, s, mode, amask));
+			}
+			return i;
+		}
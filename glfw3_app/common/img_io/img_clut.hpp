@@ -1,13 +1,16 @@
 #pragma once
 //=====================================================================//
 /*!	@file
-	@brief	カラー・ルック・アップ・テーブル（ヘッダー）
+	@brief	カラー・ルック・アップ・テーブル（ヘッダー）@n
+			色からテーブル位置への検索は、オープン・アドレスのハッシュで行う。
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
 				Released under the MIT license @n
 				https://github.com/hirakuni45/glfw3_app/blob/master/LICENSE
 */
 //=====================================================================//
+#include <cstdint>
+#include <cstring>
 #include "img.hpp"
 
 namespace img {
@@ -20,17 +23,44 @@ namespace img {
 	template <class COLOR = rgba8, uint32_t NUM = 256>
 	class img_clut {
 
+		// ハッシュ・テーブルのサイズ（NUM * 2 以上の２のべき乗）
+		static constexpr uint32_t hash_size_(uint32_t n, uint32_t s = 1) {
+			return s >= n ? s : hash_size_(n, s << 1);
+		}
+		static const uint32_t HASH_SIZE = hash_size_(NUM * 2);
+
 		uint32_t		clut_pos_;
 		COLOR			clut_[NUM];
 		bool			alpha_;
 
+		int16_t			hash_[HASH_SIZE];	///< テーブル位置（-1 は空き）
+
+		static uint32_t slot_(const COLOR& c) {
+			return static_cast<uint32_t>(c.hash() * 0x9e3779b1u) & (HASH_SIZE - 1);
+		}
+
+		// 同じ色が複数ある場合は、先に登録された位置を優先する
+		void insert_(uint32_t pos) {
+			uint32_t h = slot_(clut_[pos]);
+			while(hash_[h] >= 0) {
+				if(clut_[hash_[h]] == clut_[pos]) return;
+				h = (h + 1) & (HASH_SIZE - 1);
+			}
+			hash_[h] = static_cast<int16_t>(pos);
+		}
+
+		void rehash_() {
+			std::memset(hash_, 0xff, sizeof(hash_));
+			for(uint32_t i = 0; i < clut_pos_; ++i) insert_(i);
+		}
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	コンストラクター
 		*/
 		//-----------------------------------------------------------------//
-		img_clut() : clut_pos_(0), alpha_(true) { }
+		img_clut() : clut_pos_(0), alpha_(true) { std::memset(hash_, 0xff, sizeof(hash_)); }
 
 
 		//-----------------------------------------------------------------//
@@ -64,7 +94,10 @@ namespace img {
 			@brief	カラーテーブルのクリア
 		*/
 		//-----------------------------------------------------------------//
-		void clear() { clut_pos_ = 0; }
+		void clear() {
+			clut_pos_ = 0;
+			std::memset(hash_, 0xff, sizeof(hash_));
+		}
 
 
 		//-----------------------------------------------------------------//
@@ -88,7 +121,10 @@ namespace img {
 		//-----------------------------------------------------------------//
 		bool set_color(uint32_t pos, const COLOR& c) {
 			if(pos < clut_pos_) {
-				clut_[pos] = c;
+				if(clut_[pos] != c) {
+					clut_[pos] = c;
+					rehash_();
+				}
 				return true;
 			}
 			return false;
@@ -103,12 +139,14 @@ namespace img {
 			@return	適合するカラーがあった場合「true」
 		*/
 		//-----------------------------------------------------------------//
-		bool lookup_color(const COLOR& c, int& pos) {
-			for(uint32_t i = 0; i < clut_pos_; ++i) {
-				if(clut_[i] == c) {
-					pos = i;
+		bool lookup_color(const COLOR& c, int& pos) const {
+			uint32_t h = slot_(c);
+			while(hash_[h] >= 0) {
+				if(clut_[hash_[h]] == c) {
+					pos = hash_[h];
 					return true;
 				}
+				h = (h + 1) & (HASH_SIZE - 1);
 			}
 			return false;
 		}
@@ -124,6 +162,7 @@ namespace img {
 		bool add_color(const rgba8& c) {
 			if(clut_pos_ < NUM) {
 				clut_[clut_pos_] = c;
+				insert_(clut_pos_);
 				clut_pos_++;
 				return true;
 			}
@@ -9,6 +9,7 @@
 */
 //=====================================================================//
 #include <vector>
+#include <cstring>
 #include <boost/unordered_set.hpp>
 #include <boost/foreach.hpp>
 #include "img_io/i_img.hpp"
@@ -195,6 +196,96 @@ namespace img {
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	読み書き可能なラインのポインターを得る。
+			@param[in]	y	ライン
+			@return	ラインのポインター（範囲外なら「nullptr」）
+		*/
+		//-----------------------------------------------------------------//
+		gray8* at_img(int y) {
+			if(y >= 0 && y < size_.y) return &img_[size_.x * y]; else return nullptr;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	１ラインのバイト数を得る
+			@return	ライン・バイト数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_stride() const override { return size_.x * sizeof(value_type); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ラインの先頭ポインターを得る
+			@param[in]	y	ライン
+			@return	ライン・ポインター（範囲外なら「nullptr」）
+		*/
+		//-----------------------------------------------------------------//
+		const void* get_line(int y) const override { return get_img(y); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	読み書き可能なラインの先頭ポインターを得る
+			@param[in]	y	ライン
+			@return	ライン・ポインター（範囲外なら「nullptr」）
+		*/
+		//-----------------------------------------------------------------//
+		void* at_line(int y) override { return at_img(y); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ラインの一部を RGBA8 に変換して得る
+			@param[in]	y	ライン
+			@param[in]	x	開始位置
+			@param[in]	len	ピクセル数
+			@param[out]	out	出力先
+			@return	範囲外なら「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool get_line_rgba8(int y, int x, int len, rgba8* out) const override {
+			if(y < 0 || y >= size_.y || x < 0 || (x + len) > size_.x) return false;
+			const gray8* src = &img_[size_.x * y + x];
+			for(int i = 0; i < len; ++i) {
+				out[i].r = out[i].g = out[i].b = src[i].g;
+				out[i].a = 255;
+			}
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	全てのラインに関数を適用する
+			@param[in]	func	関数（int y, value_type* line, int width）
+		*/
+		//-----------------------------------------------------------------//
+		template <class FUNC>
+		void for_each_row(FUNC func) {
+			for(int y = 0; y < size_.y; ++y) {
+				func(y, &img_[size_.x * y], static_cast<int>(size_.x));
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	全てのラインに関数を適用する（読み出し専用）
+			@param[in]	func	関数（int y, const value_type* line, int width）
+		*/
+		//-----------------------------------------------------------------//
+		template <class FUNC>
+		void for_each_row(FUNC func) const {
+			for(int y = 0; y < size_.y; ++y) {
+				func(y, &img_[size_.x * y], static_cast<int>(size_.x));
+			}
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	イメージのアドレスを得る。
@@ -263,11 +354,11 @@ namespace img {
 		*/
 		//-----------------------------------------------------------------//
 		void fill(const gray8& c, const vtx::srect& rect) {
-			vtx::spos p;
-			for(p.y = rect.org.y; p.y < rect.end_y(); ++p.y) {
-				for(p.x = rect.org.x; p.x < rect.end_x(); ++p.x) {
-					put_pixel(p, c);
-				}
+			vtx::srect r = rect;
+			vtx::spos d = rect.org;
+			if(!clip_copy_rect(size_, r, size_, d)) return;
+			for(int y = 0; y < r.size.y; ++y) {
+				std::memset(static_cast<void*>(&img_[size_.x * (r.org.y + y) + r.org.x]), c.g, r.size.x);
 			}
 		}
 
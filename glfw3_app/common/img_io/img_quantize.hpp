@@ -0,0 +1,360 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	減色クラス（メディアン・カット）@n
+			任意のイメージを、指定色数以下の IDX8 イメージへ変換する。@n
+			・色数が指定以下なら、そのままの色でパレットを作る（ハッシュ CLUT）@n
+			・それ以上なら、RGB 各５ビット（アルファ付きはアルファ４ビット）の @n
+			  ヒストグラムを作り、メディアン・カットでパレットを決める。@n
+			色からパレット番号への変換は、ヒストグラムの区画毎にキャッシュするので、@n
+			画像サイズに対して線形時間で終わる。@n
+			作業バッファはインスタンスで保持するので、連続して変換する場合は @n
+			同じインスタンスを使うと良い。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/glfw3_app/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include "img_io/i_img.hpp"
+#include "img_io/img_idx8.hpp"
+#include "img_io/img_clut.hpp"
+
+namespace img {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	減色クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class quantizer {
+	public:
+		typedef img_clut<rgba8, 256>	clut_type;
+
+	private:
+		struct bin_t {
+			uint32_t	key;
+			uint32_t	cnt;
+			uint64_t	sum[4];
+		};
+
+		struct box_t {
+			uint32_t	org;
+			uint32_t	end;
+			uint32_t	axis;	///< 最も幅の広い成分
+			uint32_t	range;	///< その幅
+		};
+
+		bool					alpha_;
+		std::vector<uint32_t>	hist_;	///< 区画 → bins_ の位置 + 1（０は未使用）
+		std::vector<bin_t>		bins_;
+		std::vector<int16_t>	cache_;	///< 区画 → パレット番号（-1 は未計算）
+		std::vector<rgba8>		line_;
+		std::vector<int16_t>	err_;	///< ディザの誤差（２ライン分）
+		clut_type				clut_;
+
+		// 区画番号（RGB 各５ビット、アルファ付きはアルファ４ビットを加える）
+		uint32_t key_(int r, int g, int b, int a) const {
+			uint32_t k = ((r >> 3) << 10) | ((g >> 3) << 5) | (b >> 3);
+			if(alpha_) k |= (a >> 4) << 15;
+			return k;
+		}
+
+		uint32_t key_(const rgba8& c) const { return key_(c.r, c.g, c.b, c.a); }
+
+		static uint32_t comp_(uint32_t key, uint32_t axis) {
+			switch(axis) {
+			case 0: return (key >> 10) & 31;
+			case 1: return (key >> 5) & 31;
+			case 2: return key & 31;
+			default: return ((key >> 15) & 15) << 1;  // 幅を RGB に合わせる
+			}
+		}
+
+		void measure_(box_t& box) const {
+			uint32_t mi[4] = { 255, 255, 255, 255 };
+			uint32_t ma[4] = { 0, 0, 0, 0 };
+			uint32_t axes = alpha_ ? 4 : 3;
+			for(uint32_t i = box.org; i < box.end; ++i) {
+				for(uint32_t j = 0; j < axes; ++j) {
+					uint32_t v = comp_(bins_[i].key, j);
+					if(v < mi[j]) mi[j] = v;
+					if(v > ma[j]) ma[j] = v;
+				}
+			}
+			box.axis = 0;
+			box.range = 0;
+			for(uint32_t j = 0; j < axes; ++j) {
+				if(mi[j] <= ma[j] && (ma[j] - mi[j]) > box.range) {
+					box.range = ma[j] - mi[j];
+					box.axis = j;
+				}
+			}
+		}
+
+		// 区画毎の出現数と、実際の色の合計を集計
+		void histogram_(const i_img* src) {
+			const vtx::spos& size = src->get_size();
+			hist_.assign(alpha_ ? (1 << 19) : (1 << 15), 0);
+			bins_.clear();
+			line_.resize(size.x);
+			for(int y = 0; y < size.y; ++y) {
+				src->get_line_rgba8(y, 0, size.x, &line_[0]);
+				for(int x = 0; x < size.x; ++x) {
+					const rgba8& c = line_[x];
+					uint32_t k = key_(c);
+					uint32_t& h = hist_[k];
+					if(h == 0) {
+						bin_t b;
+						b.key = k;
+						b.cnt = 0;
+						b.sum[0] = b.sum[1] = b.sum[2] = b.sum[3] = 0;
+						bins_.push_back(b);
+						h = static_cast<uint32_t>(bins_.size());
+					}
+					bin_t& b = bins_[h - 1];
+					++b.cnt;
+					b.sum[0] += c.r;
+					b.sum[1] += c.g;
+					b.sum[2] += c.b;
+					b.sum[3] += c.a;
+				}
+			}
+		}
+
+		void median_cut_(uint32_t colors) {
+			std::vector<box_t> boxes;
+			box_t all;
+			all.org = 0;
+			all.end = static_cast<uint32_t>(bins_.size());
+			measure_(all);
+			boxes.push_back(all);
+			while(boxes.size() < colors) {
+				// 最も幅の広い箱を分割する
+				uint32_t sel = 0;
+				bool found = false;
+				for(uint32_t i = 0; i < boxes.size(); ++i) {
+					const box_t& b = boxes[i];
+					if((b.end - b.org) < 2) continue;
+					if(!found || b.range > boxes[sel].range) {
+						sel = i;
+						found = true;
+					}
+				}
+				if(!found) break;
+
+				box_t& b = boxes[sel];
+				uint32_t axis = b.axis;
+				std::sort(bins_.begin() + b.org, bins_.begin() + b.end,
+					[axis](const bin_t& l, const bin_t& r) { return comp_(l.key, axis) < comp_(r.key, axis); });
+				uint64_t total = 0;
+				for(uint32_t i = b.org; i < b.end; ++i) total += bins_[i].cnt;
+				uint64_t acc = 0;
+				uint32_t mid = b.org + 1;
+				for(uint32_t i = b.org; i < (b.end - 1); ++i) {
+					acc += bins_[i].cnt;
+					mid = i + 1;
+					if((acc * 2) >= total) break;
+				}
+				box_t nb;
+				nb.org = mid;
+				nb.end = b.end;
+				b.end = mid;
+				measure_(b);
+				measure_(nb);
+				boxes.push_back(nb);
+			}
+
+			clut_.clear();
+			for(const box_t& b : boxes) {
+				uint64_t sum[4] = { 0, 0, 0, 0 };
+				uint64_t cnt = 0;
+				for(uint32_t i = b.org; i < b.end; ++i) {
+					for(int j = 0; j < 4; ++j) sum[j] += bins_[i].sum[j];
+					cnt += bins_[i].cnt;
+				}
+				if(cnt == 0) continue;
+				rgba8 c((sum[0] + cnt / 2) / cnt, (sum[1] + cnt / 2) / cnt,
+						(sum[2] + cnt / 2) / cnt, (sum[3] + cnt / 2) / cnt);
+				clut_.add_color(c);
+			}
+		}
+
+		// 最も近いパレット番号
+		int nearest_(int r, int g, int b, int a) const {
+			int idx = 0;
+			int32_t best = 0x7fffffff;
+			for(uint32_t i = 0; i < clut_.size(); ++i) {
+				const rgba8& c = clut_.get_color(i);
+				int dr = r - c.r;
+				int dg = g - c.g;
+				int db = b - c.b;
+				int da = alpha_ ? (a - c.a) : 0;
+				int32_t d = dr * dr * 2 + dg * dg * 4 + db * db * 3 + da * da * 3;
+				if(d < best) {
+					best = d;
+					idx = i;
+				}
+			}
+			return idx;
+		}
+
+		int lookup_(int r, int g, int b, int a) {
+			uint32_t k = key_(r, g, b, a);
+			int16_t& i = cache_[k];
+			if(i < 0) {
+				// 区画の中心に最も近い色（区画内は同じ番号になる）
+				i = nearest_((r & 0xf8) | 4, (g & 0xf8) | 4, (b & 0xf8) | 4, (a & 0xf0) | 8);
+			}
+			return i;
+		}
+
+		// 全ての色がパレットに収まる場合
+		bool exact_(const i_img* src, uint32_t colors) {
+			const vtx::spos& size = src->get_size();
+			clut_.clear();
+			line_.resize(size.x);
+			for(int y = 0; y < size.y; ++y) {
+				src->get_line_rgba8(y, 0, size.x, &line_[0]);
+				for(int x = 0; x < size.x; ++x) {
+					int pos;
+					if(clut_.lookup_color(line_[x], pos)) continue;
+					if(clut_.size() >= colors || !clut_.add_color(line_[x])) return false;
+				}
+			}
+			return true;
+		}
+
+		void map_exact_(const i_img* src, img_idx8& dst) {
+			const vtx::spos& size = src->get_size();
+			for(int y = 0; y < size.y; ++y) {
+				src->get_line_rgba8(y, 0, size.x, &line_[0]);
+				idx8* out = dst.at_img(y);
+				for(int x = 0; x < size.x; ++x) {
+					int pos = 0;
+					clut_.lookup_color(line_[x], pos);
+					out[x].i = pos;
+				}
+			}
+		}
+
+		void map_(const i_img* src, img_idx8& dst, bool dither) {
+			const vtx::spos& size = src->get_size();
+			cache_.assign(hist_.size(), -1);
+			if(!dither) {
+				for(int y = 0; y < size.y; ++y) {
+					src->get_line_rgba8(y, 0, size.x, &line_[0]);
+					idx8* out = dst.at_img(y);
+					for(int x = 0; x < size.x; ++x) {
+						const rgba8& c = line_[x];
+						out[x].i = lookup_(c.r, c.g, c.b, c.a);
+					}
+				}
+				return;
+			}
+
+			// Floyd-Steinberg（蛇行走査）、誤差は左右１ピクセル余分に持つ
+			int w = size.x;
+			err_.assign((w + 2) * 4 * 2, 0);
+			for(int y = 0; y < size.y; ++y) {
+				int16_t* cur = &err_[((y & 1) * (w + 2) + 1) * 4];
+				int16_t* nxt = &err_[((~y & 1) * (w + 2) + 1) * 4];
+				std::fill(nxt - 4, nxt + (w + 1) * 4, 0);
+				src->get_line_rgba8(y, 0, w, &line_[0]);
+				idx8* out = dst.at_img(y);
+				bool rev = (y & 1) != 0;
+				int dir = rev ? -1 : 1;
+				for(int n = 0; n < w; ++n) {
+					int x = rev ? (w - 1 - n) : n;
+					const rgba8& c = line_[x];
+					int v[4] = { c.r, c.g, c.b, c.a };
+					for(int j = 0; j < 4; ++j) {
+						v[j] += (cur[x * 4 + j] + 8) >> 4;
+						if(v[j] < 0) v[j] = 0; else if(v[j] > 255) v[j] = 255;
+					}
+					if(!alpha_) v[3] = c.a;
+					int idx = lookup_(v[0], v[1], v[2], v[3]);
+					out[x].i = idx;
+					const rgba8& p = clut_.get_color(idx);
+					int e[4] = { v[0] - p.r, v[1] - p.g, v[2] - p.b, alpha_ ? (v[3] - p.a) : 0 };
+					for(int j = 0; j < 4; ++j) {
+						cur[(x + dir) * 4 + j] += e[j] * 7;
+						nxt[(x - dir) * 4 + j] += e[j] * 3;
+						nxt[x * 4 + j]         += e[j] * 5;
+						nxt[(x + dir) * 4 + j] += e[j] * 1;
+					}
+				}
+			}
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+		quantizer() : alpha_(false), hist_(), bins_(), cache_(), line_(), err_(), clut_() { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	IDX8 イメージへ変換
+			@param[in]	src		ソース・イメージ
+			@param[out]	dst		変換先
+			@param[in]	colors	最大色数（2 ～ 256）
+			@param[in]	dither	誤差拡散（Floyd-Steinberg）を行う場合「true」
+			@return 失敗した場合「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool convert(const i_img* src, img_idx8& dst, uint32_t colors = 256, bool dither = false)
+		{
+			if(src == nullptr || src->empty()) return false;
+			if(colors < 2) colors = 2;
+			else if(colors > 256) colors = 256;
+
+			const vtx::spos& size = src->get_size();
+			alpha_ = src->test_alpha();
+			dst.create(size, alpha_);
+
+			if(src->get_type() == IMG::INDEXED8 && src->get_clut_max() <= static_cast<int>(colors)) {
+				// パレットはそのまま、番号もそのまま
+				clut_.clear();
+				for(int i = 0; i < src->get_clut_max(); ++i) {
+					rgba8 c;
+					src->get_clut(i, c);
+					clut_.add_color(c);
+					dst.put_clut(i, c);
+				}
+				for(int y = 0; y < size.y; ++y) {
+					const idx8* s = static_cast<const idx8*>(src->get_line(y));
+					std::copy(s, s + size.x, dst.at_img(y));
+				}
+				return true;
+			}
+
+			if(exact_(src, colors)) {
+				map_exact_(src, dst);
+			} else {
+				histogram_(src);
+				median_cut_(colors);
+				map_(src, dst, dither);
+			}
+			for(uint32_t i = 0; i < clut_.size(); ++i) {
+				dst.put_clut(i, clut_.get_color(i));
+			}
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	最後に作成したパレットを取得
+			@return パレット
+		*/
+		//-----------------------------------------------------------------//
+		const clut_type& get_clut() const { return clut_; }
+	};
+}
@@ -9,11 +9,13 @@
 */
 //=====================================================================//
 #include <vector>
+#include <cstring>
 #include <boost/unordered_set.hpp>
 #include <boost/foreach.hpp>
 #include "i_img.hpp"
 #include "img_idx8.hpp"
 #include "img_gray8.hpp"
+#include "img_blend.hpp"
 
 namespace img {
 
@@ -214,6 +216,93 @@ namespace img {
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	読み書き可能なラインのポインターを得る。
+			@param[in]	y	ライン
+			@return	ラインのポインター（範囲外なら「nullptr」）
+		*/
+		//-----------------------------------------------------------------//
+		rgba8* at_img(int y) {
+			if(y >= 0 && y < size_.y) return &img_[size_.x * y]; else return nullptr;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	１ラインのバイト数を得る
+			@return	ライン・バイト数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_stride() const override { return size_.x * sizeof(value_type); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ラインの先頭ポインターを得る
+			@param[in]	y	ライン
+			@return	ライン・ポインター（範囲外なら「nullptr」）
+		*/
+		//-----------------------------------------------------------------//
+		const void* get_line(int y) const override { return get_img(y); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	読み書き可能なラインの先頭ポインターを得る
+			@param[in]	y	ライン
+			@return	ライン・ポインター（範囲外なら「nullptr」）
+		*/
+		//-----------------------------------------------------------------//
+		void* at_line(int y) override { return at_img(y); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ラインの一部を RGBA8 に変換して得る
+			@param[in]	y	ライン
+			@param[in]	x	開始位置
+			@param[in]	len	ピクセル数
+			@param[out]	out	出力先
+			@return	範囲外なら「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool get_line_rgba8(int y, int x, int len, rgba8* out) const override {
+			if(y < 0 || y >= size_.y || x < 0 || (x + len) > size_.x) return false;
+			const rgba8* src = &img_[size_.x * y + x];
+			std::memcpy(static_cast<void*>(out), src, len * sizeof(rgba8));
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	全てのラインに関数を適用する
+			@param[in]	func	関数（int y, value_type* line, int width）
+		*/
+		//-----------------------------------------------------------------//
+		template <class FUNC>
+		void for_each_row(FUNC func) {
+			for(int y = 0; y < size_.y; ++y) {
+				func(y, &img_[size_.x * y], static_cast<int>(size_.x));
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	全てのラインに関数を適用する（読み出し専用）
+			@param[in]	func	関数（int y, const value_type* line, int width）
+		*/
+		//-----------------------------------------------------------------//
+		template <class FUNC>
+		void for_each_row(FUNC func) const {
+			for(int y = 0; y < size_.y; ++y) {
+				func(y, &img_[size_.x * y], static_cast<int>(size_.x));
+			}
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	イメージのアドレスを得る。
@@ -293,14 +382,12 @@ namespace img {
 		*/
 		//-----------------------------------------------------------------//
 		void copy(const vtx::spos& dst, const img_rgba8& isrc, const vtx::srect& rsrc) {
-			vtx::spos p;
-			for(p.y = 0; p.y < rsrc.size.y; ++p.y) {
-				for(p.x = 0; p.x < rsrc.size.x; ++p.x) {
-					rgba8 c;
-					if(isrc.get_pixel(p + rsrc.org, c)) {
-						put_pixel(p + dst, c);
-					}
-				}
+			vtx::srect r = rsrc;
+			vtx::spos d = dst;
+			if(!clip_copy_rect(isrc.get_size(), r, size_, d)) return;
+			for(int y = 0; y < r.size.y; ++y) {
+				std::memmove(static_cast<void*>(&img_[size_.x * (d.y + y) + d.x]), isrc.get_img(r.org.y + y) + r.org.x,
+					r.size.x * sizeof(rgba8));
 			}
 		}
 
@@ -323,14 +410,11 @@ namespace img {
 		*/
 		//-----------------------------------------------------------------//
 		void copy(const vtx::spos& dst, const img_idx8& isrc, const vtx::srect& rsrc) {
-			vtx::spos p;
-			for(p.y = 0; p.y < rsrc.size.y; ++p.y) {
-				for(p.x = 0; p.x < rsrc.size.x; ++p.x) {
-					rgba8 c;
-					if(isrc.get_pixel(p + rsrc.org, c)) {
-						put_pixel(p + dst, c);
-					}
-				}
+			vtx::srect r = rsrc;
+			vtx::spos d = dst;
+			if(!clip_copy_rect(isrc.get_size(), r, size_, d)) return;
+			for(int y = 0; y < r.size.y; ++y) {
+				isrc.get_line_rgba8(r.org.y + y, r.org.x, r.size.x, &img_[size_.x * (d.y + y) + d.x]);
 			}
 		}
 
@@ -344,16 +428,15 @@ namespace img {
 		*/
 		//-----------------------------------------------------------------//
 		void copy(const vtx::spos& dst, const img_gray8& isrc, const vtx::srect& rsrc) {
-			vtx::spos p;
-			for(p.y = 0; p.y < rsrc.size.y; ++p.y) {
-				for(p.x = 0; p.x < rsrc.size.x; ++p.x) {
-					gray8	g;
-					if(isrc.get_pixel(p + rsrc.org, g)) {
-						rgba8	c;
-						c.r = c.g = c.b = g.g;
-						if(g.g) c.a = 255; else c.a = 0;
-						put_pixel(p + dst, c);
-					}
+			vtx::srect r = rsrc;
+			vtx::spos d = dst;
+			if(!clip_copy_rect(isrc.get_size(), r, size_, d)) return;
+			for(int y = 0; y < r.size.y; ++y) {
+				const gray8* src = isrc.get_img(r.org.y + y) + r.org.x;
+				rgba8* out = &img_[size_.x * (d.y + y) + d.x];
+				for(int x = 0; x < r.size.x; ++x) {
+					out[x].r = out[x].g = out[x].b = src[x].g;
+					out[x].a = src[x].g ? 255 : 0;
 				}
 			}
 		}
@@ -374,26 +457,17 @@ namespace img {
 			@param[in]	pdst	ブレンド先
 			@param[in]	isrc	ソースイメージ
 			@param[in]	rsrc	ソースの領域
+			@param[in]	mode	合成モード
 		*/
 		//-----------------------------------------------------------------//
-		void blend(const vtx::spos& pdst, const img_rgba8& isrc, const vtx::srect& rsrc) {
-			vtx::spos p;
-			for(p.y = 0; p.y < rsrc.size.y; ++p.y) {
-				for(p.x = 0; p.x < rsrc.size.x; ++p.x) {
-					rgba8 sc;
-					if(isrc.get_pixel(p + rsrc.org, sc)) {
-						rgba8 dc;
-						if(get_pixel(p + pdst, dc)) {
-							dc.r = ((static_cast<uint16_t>(sc.a + 1) * static_cast<uint16_t>(sc.r)) >> 8) +
-								((static_cast<uint16_t>(256 - sc.a) * static_cast<uint16_t>(dc.r)) >> 8);
-							dc.g = ((static_cast<uint16_t>(sc.a + 1) * static_cast<uint16_t>(sc.g)) >> 8) +
-								((static_cast<uint16_t>(256 - sc.a) * static_cast<uint16_t>(dc.g)) >> 8);
-							dc.b = ((static_cast<uint16_t>(sc.a + 1) * static_cast<uint16_t>(sc.b)) >> 8) +
-								((static_cast<uint16_t>(256 - sc.a) * static_cast<uint16_t>(dc.b)) >> 8);
-							put_pixel(p + pdst, dc);
-						}
-					}
-				}
+		void blend(const vtx::spos& pdst, const img_rgba8& isrc, const vtx::srect& rsrc,
+			BLEND::type mode = BLEND::OVER) {
+			vtx::srect r = rsrc;
+			vtx::spos d = pdst;
+			if(!clip_copy_rect(isrc.get_size(), r, size_, d)) return;
+			for(int y = 0; y < r.size.y; ++y) {
+				blend_span(&img_[size_.x * (d.y + y) + d.x], isrc.get_img(r.org.y + y) + r.org.x,
+					r.size.x, mode);
 			}
 		}
 
@@ -443,15 +517,10 @@ namespace img {
 		//-----------------------------------------------------------------//
 		img_rgba8& operator = (const i_img* img) {
 			if(img == 0) return *this;
+			if(img == this) return *this;
 			create(img->get_size(), img->test_alpha());
-			vtx::spos p;
-			for(p.y = 0; p.y < size_.y; ++p.y) {
-				for(p.x = 0; p.x < size_.x; ++p.x) {
-					rgba8 c;
-					if(img->get_pixel(p, c)) {
-						put_pixel(p, c);
-					}
-				}
+			for(int y = 0; y < size_.y; ++y) {
+				img->get_line_rgba8(y, 0, size_.x, &img_[size_.x * y]);
 			}
 			return *this;
 		}
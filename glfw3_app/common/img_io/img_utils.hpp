@@ -8,15 +8,38 @@
 				https://github.com/hirakuni45/glfw3_app/blob/master/LICENSE
 */
 //=====================================================================//
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #include "img_io/img.hpp"
 #include "img_io/i_img.hpp"
 #include "img_io/img_idx8.hpp"
 #include "img_io/img_gray8.hpp"
 #include "img_io/img_rgba8.hpp"
+#include "img_io/img_quantize.hpp"
 #include "img_io/perlin_noise.hpp"
 
 namespace img {
 
+	// 同じ形式のイメージ間で、ライン単位にコピーする
+	static void copy_lines_(const i_img* src, i_img* dst)
+	{
+		uint32_t len = src->get_stride();
+		if(len == 0 || len != dst->get_stride()) return;
+		for(int y = 0; y < src->get_size().y; ++y) {
+			std::memcpy(dst->at_line(y), src->get_line(y), len);
+		}
+	}
+
+
 	//-----------------------------------------------------------------//
 	/*!
 		@brief	ソース・イメージのコピーを作成
@@ -39,14 +62,7 @@ namespace img {
 					src->get_clut(i, c);
 					tmp->put_clut(i, c);
 				}
-				vtx::spos p;
-				for(p.y = 0; p.y < src->get_size().y; ++p.y) {
-					for(p.x = 0; p.x < src->get_size().x; ++p.x) {
-						idx8 c;
-						src->get_pixel(p, c);
-						tmp->put_pixel(p, c);
-					}
-				}
+				copy_lines_(src, tmp);
 				if(opt) {
 					tmp->index_optimize();
 				}
@@ -57,28 +73,14 @@ namespace img {
 			{
 				dst = dynamic_cast<i_img*>(new img_gray8);
 				dst->create(src->get_size(), false);
-				vtx::spos p;
-				for(p.y = 0; p.y < src->get_size().y; ++p.y) {
-					for(p.x = 0; p.x < src->get_size().x; ++p.x) {
-						gray8 c;
-						src->get_pixel(p, c);
-						dst->put_pixel(p, c);
-					}
-				}
+				copy_lines_(src, dst);
 			}
 			break;
 		case IMG::FULL8:
 			{
 				dst = dynamic_cast<i_img*>(new img_rgba8);
 				dst->create(src->get_size(), src->test_alpha());
-				vtx::spos p;
-				for(p.y = 0; p.y < src->get_size().y; ++p.y) {
-					for(p.x = 0; p.x < src->get_size().x; ++p.x) {
-						rgba8 c;
-						src->get_pixel(p, c);
-						dst->put_pixel(p, c);
-					}
-				}
+				copy_lines_(src, dst);
 			}
 			break;
 		default:
@@ -101,13 +103,11 @@ namespace img {
 	{
 		if(isrc == nullptr) return;
 
-		vtx::spos p;
-		for(p.y = 0; p.y < rect.size.y; ++p.y) {
-			for(p.x = 0; p.x < rect.size.x; ++p.x) {
-				rgba8 c;
-				isrc->get_pixel(rect.org + p, c);
-				idst.put_pixel(ofs + p, c);
-			}
+		vtx::srect r = rect;
+		vtx::spos d = ofs;
+		if(!clip_copy_rect(isrc->get_size(), r, idst.get_size(), d)) return;
+		for(int y = 0; y < r.size.y; ++y) {
+			isrc->get_line_rgba8(r.org.y + y, r.org.x, r.size.x, idst.at_img(d.y + y) + d.x);
 		}
 	}
 
@@ -167,18 +167,34 @@ namespace img {
 	static bool copy_to_idx8(const i_img* isrc, const vtx::srect& rect, img_idx8& idst, const vtx::spos& pos)
 	{
 		if(isrc->get_type() != IMG::INDEXED8) return false;
-		vtx::spos p;
-		for(p.y = 0; p.y < rect.size.y; ++p.y) {
-			for(p.x = 0; p.x < rect.size.x; ++p.x) {
-				idx8 ix;
-				isrc->get_pixel(rect.org + p, ix);
-				idst.put_pixel(pos + p, ix);
-			}
+		vtx::srect r = rect;
+		vtx::spos d = pos;
+		if(!clip_copy_rect(isrc->get_size(), r, idst.get_size(), d)) return true;
+		for(int y = 0; y < r.size.y; ++y) {
+			const idx8* src = static_cast<const idx8*>(isrc->get_line(r.org.y + y)) + r.org.x;
+			std::memmove(static_cast<void*>(idst.at_img(d.y + y) + d.x), src, r.size.x * sizeof(idx8));
 		}
 		return true;
 	}
 
 
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	減色して IDX8 イメージへ変換する
+		@param[in]	isrc	ソースのイメージインターフェース
+		@param[out]	dst		変換先 IDX8 イメージ（リファレンス）
+		@param[in]	colors	最大色数
+		@param[in]	dither	誤差拡散を行う場合「true」
+		@return 変換に成功したら「true」を返す。
+	*/
+	//-----------------------------------------------------------------//
+	static bool convert_to_idx8(const i_img* isrc, img_idx8& dst, uint32_t colors = 256, bool dither = false)
+	{
+		quantizer q;
+		return q.convert(isrc, dst, colors, dither);
+	}
+
+
 	//-----------------------------------------------------------------//
 	/*!
 		@brief	RGBA8 イメージへコピーする
@@ -221,21 +237,21 @@ namespace img {
 		dst.destroy();
 		const vtx::spos& size = src->get_size();
 		dst.create(size / 2, src->test_alpha());
-		vtx::spos p;
-		for(p.y = 0; p.y < size.y; p.y += 2) {
-			for(p.x = 0; p.x < size.x; p.x += 2) {
-				int	r, g, b, a;
-			  	rgba8	c;
-				src->get_pixel(p, c);
-				r = c.r; g = c.g; b = c.b; a = c.a;
-				src->get_pixel(vtx::spos(p.x + 1, p.y), c);
-				r += c.r; g += c.g; b += c.b; a += c.a;
-				src->get_pixel(vtx::spos(p.x, p.y + 1), c);
-				r += c.r; g += c.g; b += c.b; a += c.a;
-				src->get_pixel(vtx::spos(p.x + 1, p.y + 1), c);
-				r += c.r; g += c.g; b += c.b; a += c.a;
-				c.r = r >> 2; c.g = g >> 2; c.b = b >> 2; c.a = a >> 2;
-				dst.put_pixel(vtx::spos(p.x / 2, p.y / 2), c);
+		int dw = dst.get_size().x;
+		if(dw <= 0) return;
+		std::vector<rgba8> l0(dw * 2);
+		std::vector<rgba8> l1(dw * 2);
+		for(int y = 0; y < dst.get_size().y; ++y) {
+			src->get_line_rgba8(y * 2 + 0, 0, dw * 2, &l0[0]);
+			src->get_line_rgba8(y * 2 + 1, 0, dw * 2, &l1[0]);
+			rgba8* out = dst.at_img(y);
+			for(int x = 0; x < dw; ++x) {
+				const rgba8* a = &l0[x * 2];
+				const rgba8* b = &l1[x * 2];
+				out[x].r = (a[0].r + a[1].r + b[0].r + b[1].r) >> 2;
+				out[x].g = (a[0].g + a[1].g + b[0].g + b[1].g) >> 2;
+				out[x].b = (a[0].b + a[1].b + b[0].b + b[1].b) >> 2;
+				out[x].a = (a[0].a + a[1].a + b[0].a + b[1].a) >> 2;
 			}
 		}
 	}
@@ -259,92 +275,309 @@ namespace img {
 		}
 	}
 
-	static float lanczos_tbl_[(12 + 1) * (12 + 1)];
-	static float lanczos_n_ = 0.0f;
-	// -3.0, -2.5, -2.0, -1.5, -1.0, -0.5, 0.0, 0.5, 1.0, 1.5, 2.0, 2.5, 3.0
-	static void init_lanczos_(float n)
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	lanczos の１次元ウェイト・テーブル @n
+				出力座標毎に、ソースの開始位置、タップ数、正規化済みのウェイトを持つ。
+	*/
+	//-----------------------------------------------------------------//
+	struct lanczos_weight_ {
+		std::vector<int>	pos;	///< ソースの開始位置（出力座標毎）
+		std::vector<int>	num;	///< タップ数（出力座標毎）
+		std::vector<float>	w;		///< ウェイト（出力座標 * taps）
+		int		taps;
+
+		lanczos_weight_() : pos(), num(), w(), taps(0) { }
+
+		void make(int slen, int dlen, float scale, float n)
+		{
+			float scn = 1.0f / scale;
+			// 窓の最大幅（拡大：±n、縮小：±n / scale）
+			taps = static_cast<int>(n * 2.0f * (scale > 1.0f ? 1.0f : scn)) + 3;
+			pos.resize(dlen);
+			num.resize(dlen);
+			w.assign(static_cast<size_t>(dlen) * taps, 0.0f);
+			for(int o = 0; o < dlen; ++o) {
+				int s;
+				int e;
+				float cc;
+				if(scale > 1.0f) {
+					cc = (static_cast<float>(o) + 0.5f) * scn;
+					s = static_cast<int>(cc - n);
+					e = static_cast<int>(cc + n);
+				} else {
+					cc = static_cast<float>(o) + 0.5f;
+					s = static_cast<int>((cc - n) * scn);
+					e = static_cast<int>((cc + n) * scn);
+				}
+				if(s < 0) s = 0;
+				if(e > (slen - 1)) e = slen - 1;
+				if((e - s + 1) > taps) e = s + taps - 1;
+				float* p = &w[static_cast<size_t>(o) * taps];
+				float total = 0.0f;
+				for(int i = s; i <= e; ++i) {
+					float d;
+					if(scale > 1.0f) {
+						d = std::abs((static_cast<float>(i) + 0.5f) - cc);
+					} else {
+						d = std::abs(((static_cast<float>(i) + 0.5f) * scale) - cc);
+					}
+					float l = lanczos_(d, n);
+					p[i - s] = l;
+					total += l;
+				}
+				if(total != 0.0f) {
+					float sf = 1.0f / total;
+					for(int i = 0; i <= (e - s); ++i) p[i] *= sf;
+				}
+				pos[o] = s;
+				num[o] = e - s + 1;
+			}
+		}
+	};
+
+
+	// ソースの１ラインを、RGBA の float 列（４要素／ピクセル）として取り出す
+	static void fetch_line_(const i_img* src, int y, float* out)
 	{
-		if(lanczos_n_ == n) return;
-
-		float y = -3.0f;
-		for(int i = 0; i < (12 + 1); ++i) {
-			float yl = lanczos_(y, n);
-			float x = -3.0f;
-			for(int j = 0; j < (12 + 1); ++j) {
-				float xl = lanczos_(x, n);
-				lanczos_tbl_[i * (12 + 1) + j] = xl * yl;
-				x += 0.5f;
+		int w = src->get_size().x;
+		if(src->get_type() == IMG::FULL8) {
+			const rgba8* p = static_cast<const img_rgba8*>(src)->get_img(y);
+			for(int x = 0; x < w; ++x) {
+				out[0] = p[x].r;
+				out[1] = p[x].g;
+				out[2] = p[x].b;
+				out[3] = p[x].a;
+				out += 4;
+			}
+		} else if(src->get_type() == IMG::GRAY8) {
+			const gray8* p = static_cast<const img_gray8*>(src)->get_img(y);
+			for(int x = 0; x < w; ++x) {
+				out[0] = out[1] = out[2] = p[x].g;
+				out[3] = 255.0f;
+				out += 4;
+			}
+		} else {
+			std::vector<rgba8> tmp(w);
+			src->get_line_rgba8(y, 0, w, &tmp[0]);
+			for(int x = 0; x < w; ++x) {
+				out[0] = tmp[x].r;
+				out[1] = tmp[x].g;
+				out[2] = tmp[x].b;
+				out[3] = tmp[x].a;
+				out += 4;
 			}
-			y += 0.5f;
 		}
-		lanczos_n_ = n;
 	}
 
 
-	static float lanczos_t_(float x, float y, float n)
+	// 水平方向のフィルター（１ライン）
+	static void filter_h_(const float* in, float* out, const lanczos_weight_& wt)
 	{
-		int i = static_cast<int>(y * 2.0f);
-		i += 6;
-		int j = static_cast<int>(x * 2.0f);
-		j += 6;
-		if(i >= 0 && i < (12 + 1) && j >= 0 && j < (12 + 1)) {
-			return lanczos_tbl_[i * (12 + 1) + j];
-		} else {
-			return lanczos_(x, n) * lanczos_(y, n);
+		int dlen = static_cast<int>(wt.pos.size());
+		for(int o = 0; o < dlen; ++o) {
+			const float* s = in + wt.pos[o] * 4;
+			const float* w = &wt.w[static_cast<size_t>(o) * wt.taps];
+			int n = wt.num[o];
+#ifdef __SSE2__
+			__m128 acc = _mm_setzero_ps();
+			for(int i = 0; i < n; ++i) {
+				acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(w[i]), _mm_loadu_ps(s + i * 4)));
+			}
+			_mm_storeu_ps(out, acc);
+#else
+			float r = 0.0f, g = 0.0f, b = 0.0f, a = 0.0f;
+			for(int i = 0; i < n; ++i) {
+				r += s[i * 4 + 0] * w[i];
+				g += s[i * 4 + 1] * w[i];
+				b += s[i * 4 + 2] * w[i];
+				a += s[i * 4 + 3] * w[i];
+			}
+			out[0] = r; out[1] = g; out[2] = b; out[3] = a;
+#endif
+			out += 4;
 		}
 	}
 
 
-	static void color_div_(const rgbaf& col, float total, rgba8& c)
+	// 垂直方向のフィルター（１ライン）、飽和して RGBA8 へ
+	static void filter_v_(const float* const* in, const float* w, int n, float* acc, rgba8* out, int len)
 	{
-		rgbaf cc;
-		if(total != 0.0f) {
-			float sf = 1.0f / total;
-			cc.r = col.r * sf;
-			cc.g = col.g * sf;
-			cc.b = col.b * sf;
-			cc.a = col.a * sf;
-		} else {
-			cc = col;
+		int num = len * 4;
+		for(int x = 0; x < num; ++x) acc[x] = 0.0f;
+		for(int i = 0; i < n; ++i) {
+			const float* s = in[i];
+			int x = 0;
+#ifdef __SSE2__
+			__m128 ww = _mm_set1_ps(w[i]);
+			for(; x < num; x += 4) {
+				_mm_storeu_ps(acc + x,
+					_mm_add_ps(_mm_loadu_ps(acc + x), _mm_mul_ps(ww, _mm_loadu_ps(s + x))));
+			}
+#endif
+			for(; x < num; ++x) acc[x] += s[x] * w[i];
 		}
 
-		if(cc.r < 0.0f) {
-			c.r = 0;
-		} else if(cc.r > 255.0f) {
-			c.r = 255;
-		} else {
-			c.r = static_cast<unsigned char>(cc.r);
+		int x = 0;
+#ifdef __SSE2__
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 full = _mm_set1_ps(255.0f);
+		for(; x < len; ++x) {
+			__m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(acc + x * 4), zero), full);
+			__m128i i = _mm_cvttps_epi32(v);
+			i = _mm_packs_epi32(i, i);
+			i = _mm_packus_epi16(i, i);
+			int32_t t = _mm_cvtsi128_si32(i);
+			std::memcpy(static_cast<void*>(&out[x]), &t, 4);
+		}
+#endif
+		for(; x < len; ++x) {
+			const float* a = acc + x * 4;
+			u8 c[4];
+			for(int j = 0; j < 4; ++j) {
+				if(a[j] < 0.0f) c[j] = 0;
+				else if(a[j] > 255.0f) c[j] = 255;
+				else c[j] = static_cast<u8>(a[j]);
+			}
+			out[x].set(c[0], c[1], c[2], c[3]);
 		}
+	}
 
-		if(cc.g < 0.0f) {
-			c.g = 0;
-		} else if(cc.g > 255.0f) {
-			c.g = 255;
-		} else {
-			c.g = static_cast<unsigned char>(cc.g);
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	ライン処理用のワーカー・プール @n
+				初回の利用時に（論理コア数 - 1）個のスレッドを起動し、@n
+				プロセスの終了まで使い回す。
+	*/
+	//-----------------------------------------------------------------//
+	class line_pool_ {
+
+		typedef std::function<void (int, int)>	func_t;
+
+		struct job_t {
+			const func_t*	func;
+			int		org;
+			int		end;
+			int*	left;
+		};
+
+		std::vector<std::thread>	threads_;
+		std::mutex				sync_;
+		std::condition_variable	cond_;
+		std::condition_variable	done_;
+		std::deque<job_t>		jobs_;
+		bool					stop_;
+
+		// キューから１つ取り出して実行（sync_ をロックした状態で呼ぶ）
+		void exec_(std::unique_lock<std::mutex>& lock)
+		{
+			job_t job = jobs_.front();
+			jobs_.pop_front();
+			lock.unlock();
+			(*job.func)(job.org, job.end);
+			lock.lock();
+			if(--*job.left == 0) done_.notify_all();
 		}
 
-		if(cc.b < 0.0f) {
-			c.b = 0;
-		} else if(cc.b > 255.0f) {
-			c.b = 255;
-		} else {
-			c.b = static_cast<unsigned char>(cc.b);
+		void task_()
+		{
+			std::unique_lock<std::mutex> lock(sync_);
+			while(1) {
+				cond_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+				if(stop_) break;
+				exec_(lock);
+			}
 		}
 
-		if(cc.a < 0.0f) {
-			c.a = 0;
-		} else if(cc.a > 255.0f) {
-			c.a = 255;
-		} else {
-			c.a = static_cast<unsigned char>(cc.a);
+		line_pool_() : threads_(), jobs_(), stop_(false)
+		{
+			uint32_t num = std::thread::hardware_concurrency();
+			if(num > 1) --num;  // 呼び出し元の分を空ける
+			else num = 0;
+			for(uint32_t i = 0; i < num; ++i) {
+				threads_.emplace_back(&line_pool_::task_, this);
+			}
 		}
-	}
+
+	public:
+		~line_pool_()
+		{
+			{
+				std::lock_guard<std::mutex> lock(sync_);
+				stop_ = true;
+			}
+			cond_.notify_all();
+			for(auto& t : threads_) t.join();
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	インスタンスを取得
+			@return プール
+		*/
+		//-----------------------------------------------------------------//
+		static line_pool_& get()
+		{
+			static line_pool_ pool;
+			return pool;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	行範囲を分割して実行（最後の範囲は呼び出し元で処理）@n
+					待つ間は、キューに残った仕事を呼び出し元も手伝う。
+			@param[in]	lines	行数
+			@param[in]	work	仕事量の目安
+			@param[in]	func	処理（開始行、終了行）
+		*/
+		//-----------------------------------------------------------------//
+		void run(int lines, size_t work, const func_t& func)
+		{
+			int nt = static_cast<int>(threads_.size()) + 1;
+			// 小さい画像では分割のコストの方が大きい
+			int lim = static_cast<int>(work / (128 * 1024));
+			if(nt > lim) nt = lim;
+			if(nt > lines) nt = lines;
+			if(nt <= 1) {
+				func(0, lines);
+				return;
+			}
+			int left = nt - 1;
+			int org = 0;
+			{
+				std::lock_guard<std::mutex> lock(sync_);
+				for(int i = 0; i < (nt - 1); ++i) {
+					int end = lines * (i + 1) / nt;
+					job_t job;
+					job.func = &func;
+					job.org  = org;
+					job.end  = end;
+					job.left = &left;
+					jobs_.push_back(job);
+					org = end;
+				}
+			}
+			cond_.notify_all();
+			func(org, lines);
+
+			std::unique_lock<std::mutex> lock(sync_);
+			while(left > 0) {
+				if(!jobs_.empty()) exec_(lock);
+				else done_.wait(lock);
+			}
+		}
+	};
 
 
 	//-----------------------------------------------------------------//
 	/*!
-		@brief	画像をリサイズする（lanczos-3 アルゴリズム）
+		@brief	画像をリサイズする（lanczos-3 アルゴリズム）@n
+				水平、垂直の２パスに分け、ウェイトは行／列毎に事前に計算する。@n
+				中間バッファは垂直フィルターの窓（taps ライン）分だけ持つ。@n
+				大きな画像では、出力ラインをワーカー・プールに分割する。
 		@param[in]	src	ソースのイメージ
 		@param[out]	dst	リサイズイメージ
 		@param[in]	scale	スケール・ファクター
@@ -359,85 +592,39 @@ namespace img {
 		int dw = static_cast<int>(static_cast<float>(sw) * scale);
 		int dh = static_cast<int>(static_cast<float>(sh) * scale);
 		dst.create(vtx::spos(dw, dh), src->test_alpha());
+		if(dw <= 0 || dh <= 0) return;
 
 		float n = 3.0f;
-		init_lanczos_(n);
-
-		float scn = 1.0f / scale;
-		if(scale > 1.0f) {
-			vtx::spos out;
-			for(out.y = 0; out.y < dh; ++out.y) {
-				float yy = (static_cast<float>(out.y) + 0.5f) * scn;
-				int ys = static_cast<int>(yy - n);
-				if(ys < 0) ys = 0;
-				int ye = static_cast<int>(yy + n);
-				if(ye > (sh - 1)) ye = sh - 1;
-				for(out.x = 0; out.x < dw; ++out.x) {
-					float xx = (static_cast<float>(out.x) + 0.5f) * scn;
-					int xs = static_cast<int>(xx - n);
-					if(xs < 0) xs = 0;
-					int xe = static_cast<int>(xx + n);
-					if(xe > (sw - 1)) xe = sw - 1;
-
-					rgbaf col(0.0f);
-					float weight_total = 0.0f;
-					vtx::spos pos;
-					for(pos.y = ys; pos.y <= ye; ++pos.y) {
-						float yl = fabs((pos.y + 0.5f) - yy);
-						for(pos.x = xs; pos.x <= xe; ++pos.x) {
-							float xl = std::abs((static_cast<float>(pos.x) + 0.5f) - xx);
-							float weight = lanczos_t_(xl, yl, n);
-							rgba8 c;
-							src->get_pixel(pos, c);
-							col.r += c.r * weight;
-							col.g += c.g * weight;
-							col.b += c.b * weight;
-							col.a += c.a * weight;
-							weight_total += weight;
-						}
-					}
-					rgba8 c;
-					color_div_(col, weight_total, c);
-					dst.put_pixel(out, c);
+		lanczos_weight_ wx;
+		wx.make(sw, dw, scale, n);
+		lanczos_weight_ wy;
+		wy.make(sh, dh, scale, n);
+
+		// 出力ライン毎に、必要なソースのラインだけを水平方向にフィルターし、
+		// 直近 taps ライン分のリング・バッファに置いて垂直方向にフィルターする
+		int stride = dw * 4;
+		int ring = wy.taps;
+		size_t work = static_cast<size_t>(sh) * dw * wx.taps + static_cast<size_t>(dh) * dw * wy.taps;
+		line_pool_::get().run(dh, work, [&](int org, int end) {
+			std::vector<float> line(static_cast<size_t>(sw) * 4);
+			std::vector<float> tmp(static_cast<size_t>(ring) * stride);
+			std::vector<const float*> rows(ring);
+			std::vector<float> acc(stride);
+			int next = wy.pos[org];
+			for(int y = org; y < end; ++y) {
+				int pos = wy.pos[y];
+				int num = wy.num[y];
+				if(next < pos) next = pos;
+				for(; next < (pos + num); ++next) {
+					fetch_line_(src, next, &line[0]);
+					filter_h_(&line[0], &tmp[static_cast<size_t>(next % ring) * stride], wx);
 				}
-			}
-		} else {
-			vtx::spos out;
-			for(out.y = 0; out.y < dh; ++out.y) {
-				float yy = static_cast<float>(out.y) + 0.5f;
-				int ys = static_cast<int>((yy - n) * scn);
-				if(ys < 0) ys = 0;
-				int ye = static_cast<int>((yy + n) * scn);
-				if(ye > (sh - 1)) ye = sh - 1;
-				for(out.x = 0; out.x < dw; ++out.x) {
-					float xx = static_cast<float>(out.x) + 0.5f;
-					int xs = static_cast<int>((xx - n) * scn);
-					if(xs < 0) xs = 0;
-					int xe = static_cast<int>((xx + n) * scn);
-					if(xe > (sw - 1)) xe = sw - 1;
-
-					rgbaf col(0.0f);
-					float weight_total = 0.0f;
-					vtx::spos pos;
-					for(pos.y = ys; pos.y <= ye; ++pos.y) {
-						float yl = std::abs(((static_cast<float>(pos.y) + 0.5f) * scale) - yy);
-						for(pos.x = xs; pos.x <= xe; ++pos.x) {
-							float xl = std::abs(((static_cast<float>(pos.x) + 0.5f) * scale) - xx);
-							float weight = lanczos_t_(xl, yl, n);
-							rgba8 c;
-							src->get_pixel(pos, c);
-							col.r += static_cast<float>(c.r) * weight;
-							col.g += static_cast<float>(c.g) * weight;
-							col.b += static_cast<float>(c.b) * weight;
-							col.a += static_cast<float>(c.a) * weight;
-							weight_total += weight;
-						}
-					}
-					rgba8 c;
-					color_div_(col, weight_total, c);
-					dst.put_pixel(out, c);
+				for(int i = 0; i < num; ++i) {
+					rows[i] = &tmp[static_cast<size_t>((pos + i) % ring) * stride];
 				}
+				filter_v_(&rows[0], &wy.w[static_cast<size_t>(y) * wy.taps], num, &acc[0],
+					dst.at_image(y * dw), dw);
 			}
-		}
+		});
 	}
 }
@@ -15,6 +15,8 @@
 #include <iostream>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <vector>
 
 extern "C" {
 #include <jpeglib.h>
@@ -434,37 +436,24 @@ namespace img {
 			unsigned char* line = new unsigned char[cinfo.output_width * cinfo.output_components];
 			unsigned char* lines[1];
 			lines[0] = &line[0];
-			vtx::spos pos;
-			for(pos.y = 0; pos.y < static_cast<short>(cinfo.image_height); ++pos.y) {
+			for(int y = 0; y < static_cast<int>(cinfo.image_height); ++y) {
 				jpeg_read_scanlines(&cinfo, (JSAMPLE**)lines, 1);
-				unsigned char* p = &line[0];
+				const unsigned char* p = &line[0];
+				rgba8* out = static_cast<rgba8*>(img_->at_line(y));
+				uint32_t w = cinfo.image_width;
 				if(cinfo.output_components == 4) {
-					for(pos.x = 0; pos.x < static_cast<short>(cinfo.image_width); ++pos.x) {
-						img::rgba8 c;
-						c.r = *p++;
-						c.g = *p++;
-						c.b = *p++;
-						c.a = *p++;
-						img_->put_pixel(pos, c);
-					}
+					std::memcpy(static_cast<void*>(out), p, w * 4);
 				} else if(cinfo.output_components == 3) {
-					for(pos.x = 0; pos.x < static_cast<short>(cinfo.image_width); ++pos.x) {
-						img::rgba8 c;
-						c.r = *p++;
-						c.g = *p++;
-						c.b = *p++;
-						c.a = 255;
-						img_->put_pixel(pos, c);
+					for(uint32_t x = 0; x < w; ++x) {
+						out[x].set(p[0], p[1], p[2], 255);
+						p += 3;
 					}
 				} else if(cinfo.output_components == 1) {
-					for(pos.x = 0; pos.x < static_cast<short>(cinfo.image_width); ++pos.x) {
-						img::rgba8 c;
-						c.b = c.g = c.r = *p++;
-						c.a = 255;
-						img_->put_pixel(pos, c);
+					for(uint32_t x = 0; x < w; ++x) {
+						out[x].set(p[x], p[x], p[x], 255);
 					}
 				}
-				prgl_pos_ = pos.y;
+				prgl_pos_ = y;
 			}
 			delete[] line;
 
@@ -565,13 +554,13 @@ namespace img {
 			JSAMPROW row_pointer[1];
 			unsigned char* tmp = new unsigned char[w * cinfo.input_components];
 			row_pointer[0] = (JSAMPLE *)tmp;
-			vtx::spos pos;
-			pos.y = 0;
+			std::vector<rgba8> line(w);
+			int y = 0;
 			while(static_cast<short>(cinfo.next_scanline) < h) {
+				img_->get_line_rgba8(y, 0, w, &line[0]);
 				unsigned char* p = tmp;
-				for(pos.x = 0; pos.x < w; ++pos.x) {
-					rgba8 c;
-					img_->get_pixel(pos, c);
+				for(int x = 0; x < w; ++x) {
+					const rgba8& c = line[x];
 					*p++ = c.r;
 					*p++ = c.g;
 					*p++ = c.b;
@@ -581,7 +570,7 @@ namespace img {
 				}
 				jpeg_write_scanlines(&cinfo, row_pointer, 1);
 				if(dst->error) break;
-				++pos.y;
+				++y;
 				++prgl_pos_;
 			}
 			delete[] tmp;
@@ -13,6 +13,7 @@
 #include "i_img.hpp"
 #include "img_rgba8.hpp"
 #include "img_utils.hpp"
+#include "img_blend.hpp"
 #include <stack>
 #include "utils/vtx.hpp"
 #include "utils/string_utils.hpp"
@@ -104,6 +105,8 @@ namespace img {
 
 		bool				alpha_blend_;
 
+		std::vector<rgba8>	span_;
+
 		inline uint8_t distance_(float d)
 		{
 			float m = 1.0f - (d * 2.0f / 3.0f);
@@ -150,27 +153,82 @@ namespace img {
 		}
 
 
+		BLEND::type blend_mode_() const { return alpha_blend_ ? BLEND::OVER_DA : BLEND::COPY; }
+
+
+		// 水平スパンをクリップする（x, len を調整）
+		bool clip_span_(int& x, int y, int& len, int& ofs) const
+		{
+			ofs = 0;
+			if(y < 0 || y >= get_size().y) return false;
+			if(x < 0) { ofs = -x; len += x; x = 0; }
+			if((x + len) > get_size().x) len = get_size().x - x;
+			return len > 0;
+		}
+
+
+		// 単色の水平スパンを描画（plot と同じ合成）
+		void fill_span_(const img::rgba8& c, int x, int y, int len)
+		{
+			int ofs;
+			if(!clip_span_(x, y, len, ofs)) return;
+			blend_fill(at_img(y) + x, c, len, blend_mode_());
+		}
+
+
+		// ピクセル毎の色を持つ水平スパンを描画（plot と同じ合成）
+		void draw_span_(const img::rgba8* src, int x, int y, int len)
+		{
+			int ofs;
+			if(!clip_span_(x, y, len, ofs)) return;
+			blend_span(at_img(y) + x, src + ofs, len, blend_mode_());
+		}
+
+
 		void h_line_(const img::rgba8& c, const vtx::spos& pos, short len)
 		{
-			short l = 0;
-			for(short i = 0; i < std::abs(len); ++i) {
-				plot(vtx::spos(pos.x + l, pos.y), c);
-				if(len < 0) --l; else ++l;
-			}
+			int d = std::abs(len);
+			int x = pos.x;
+			if(len < 0) x -= d - 1;
+			fill_span_(c, x, pos.y, d);
 		}
 
 
 		void h_line_gray_(const img::rgba8& c, const vtx::spos& pos, short len)
 		{
-			img::rgba8 cc = c;
-			short l = 0;
-			short d = std::abs(len);
-			for(short i = 0; i < d; ++i) {
-				int a = static_cast<int>(d - i) * static_cast<int>(c.a) / d;
-				cc.a = a;
-				plot(vtx::spos(pos.x + l, pos.y), cc);
-				if(len < 0) --l; else ++l;
+			int d = std::abs(len);
+			if(d == 0) return;
+			// 始点から遠ざかる程、アルファを下げる（len が負なら左方向）
+			span_.resize(d);
+			for(int i = 0; i < d; ++i) {
+				img::rgba8 cc = c;
+				cc.a = (d - i) * static_cast<int>(c.a) / d;
+				if(len < 0) span_[d - 1 - i] = cc; else span_[i] = cc;
 			}
+			int x = pos.x;
+			if(len < 0) x -= d - 1;
+			draw_span_(&span_[0], x, pos.y, d);
+		}
+
+
+		static rgba8 round_pixel_(const rgba8& col, const rgba8& dst, int al)
+		{
+			rgba8 c = col;
+			c.a = al;
+			uint16_t a = static_cast<uint16_t>(dst.a) * (256 - c.a);
+			a += static_cast<uint16_t>(c.a) * (c.a + 1);
+			a >>= 8;
+			uint16_t r = static_cast<uint16_t>(dst.r) * (256 - a);
+			uint16_t g = static_cast<uint16_t>(dst.g) * (256 - a);
+			uint16_t b = static_cast<uint16_t>(dst.b) * (256 - a);
+			r += static_cast<uint16_t>(c.r) * (a + 1);
+			g += static_cast<uint16_t>(c.g) * (a + 1);
+			b += static_cast<uint16_t>(c.b) * (a + 1);
+			c.a = al;
+			c.r = r >> 8;
+			c.g = g >> 8;
+			c.b = b >> 8;
+			return c;
 		}
 
 
@@ -200,7 +258,7 @@ namespace img {
 			inten_rect_(255),
 			round_radius_(0),
 			font_size_(24), font_space_(2),
-			alpha_blend_(false)
+			alpha_blend_(false), span_()
 		{ }
 
 
@@ -312,23 +370,9 @@ namespace img {
 		bool plot(const vtx::spos& p, const rgba8& c)
 		{
 			if(alpha_blend_) {
-				rgba8 bc;
-				if(get_pixel(p, bc)) {
-					u16 a = static_cast<u16>(bc.a) + 1;
-					a *= 256 - static_cast<u16>(c.a);
-					a >>= 8;
-					u16 r = static_cast<u16>(bc.r) * a;
-					u16 g = static_cast<u16>(bc.g) * a;
-					u16 b = static_cast<u16>(bc.b) * a;
-					a = static_cast<u16>(c.a) + 1;
-					r += static_cast<u16>(c.r) * a;
-					g += static_cast<u16>(c.g) * a;
-					b += static_cast<u16>(c.b) * a;
-					put_pixel(p, rgba8(r >> 8, g >> 8, b >> 8, bc.a));
-					return true;
-				} else {
-					return false;
-				}
+				if(p.x < 0 || p.x >= get_size().x || p.y < 0 || p.y >= get_size().y) return false;
+				blend_::pixel(at_img(p.y)[p.x], c, BLEND::OVER_DA);
+				return true;
 			} else {
 				return put_pixel(p, c);
 			}
@@ -442,14 +486,8 @@ namespace img {
 		//-----------------------------------------------------------------//
 		void line_holizontal(const vtx::spos& org, uint16_t len, uint16_t lw = 1)
 		{
-			auto pos = org;
 			for(uint16_t l = 0; l < lw; ++l) {
-				pos.x = org.x;
-				for(uint16_t i = 0; i < len; ++i) {
-					plot(pos, fore_color_);
-					++pos.x;
-				}
-				++pos.y;
+				fill_span_(fore_color_, org.x, org.y + l, len);
 			}
 		}
 
@@ -486,7 +524,7 @@ namespace img {
 		void fill_circle(const vtx::spos& center, int radius)
 		{
 			using vtx::spos;
-			short ln;
+			short ln = radius - 1;  // dy = 0 では、アンチエイリアスの幅は１
 			for(int dy = 0; dy < radius; ++dy) {
 				int r = radius - 1;
 				int dx = static_cast<int>(sqrtf(r * r - dy * dy) * 256.0f);
@@ -620,31 +658,34 @@ namespace img {
 					make_slope_(left[yy], center[yy], right[yy], line);
 				}
 
-				rgba8* dst = p + x + ox;
-				for(int xx = ox; xx < ln; ++xx) {
-					rgba8 c = fore_color_;
+				rgba8* dst = p + x;
+				if(ln > ox) {
+					// 角の端は、書き込み前のピクセルと合成する
+					rgba8 el;
+					rgba8 er;
+					if(round) {
+						rgba8 cl = fore_color_;
+						rgba8 cr = fore_color_;
+						if(i) {
+							cl.mod(line[ox]);
+							cr.mod(line[ln - 1]);
+						}
+						el = round_pixel_(cl, dst[ox], al);
+						er = round_pixel_(cr, dst[ln - 1], al);
+					}
 					if(i) {
-						c.mod(line[xx]);
+						for(int xx = ox; xx < ln; ++xx) {
+							rgba8 c = fore_color_;
+							c.mod(line[xx]);
+							dst[xx] = c;
+						}
+					} else {
+						blend_fill(dst + ox, fore_color_, ln - ox, BLEND::COPY);
 					}
 					if(round) {
-						if(xx == ox || xx == (ln - 1)) {
-							c.a = al;
-							uint16_t a = static_cast<uint16_t>(dst->a) * (256 - c.a);
-							a += static_cast<uint16_t>(c.a) * (c.a + 1);
-							a >>= 8;
-							uint16_t r = static_cast<uint16_t>(dst->r) * (256 - a);
-							uint16_t g = static_cast<uint16_t>(dst->g) * (256 - a);
-							uint16_t b = static_cast<uint16_t>(dst->b) * (256 - a);
-							r += static_cast<uint16_t>(c.r) * (a + 1);
-							g += static_cast<uint16_t>(c.g) * (a + 1);
-							b += static_cast<uint16_t>(c.b) * (a + 1);
-							c.a = al;
-							c.r = r >> 8;
-							c.g = g >> 8;
-							c.b = b >> 8;
-						}
+						dst[ox] = el;
+						dst[ln - 1] = er;
 					}
-					*dst++ = c;
 				}
 				p += ww;
 			}
@@ -683,22 +724,25 @@ namespace img {
 		//-----------------------------------------------------------------//
 		void fill_rect_scale_h(const vtx::srect& rect)
 		{
+			if(rect.size.x <= 0) return;
 			auto fc = fore_color_;
 			auto bc = back_color_;
 			float gain = 1.0f;
 			float gainadd = 1.0f / static_cast<float>(rect.size.x - 1);
-			auto pos = rect.org;
-			push_fore_color();
+			// １ライン分の色を作り、各ラインにスパンで描画する
+			span_.resize(rect.size.x);
 			for(int x = 0; x < rect.size.x; ++x) {
 				uint8_t s = static_cast<uint8_t>(gain * 256.0f);
-				fore_color_.r = ((fc.r * (256 - s)) + bc.r * s) >> 8;
-				fore_color_.g = ((fc.g * (256 - s)) + bc.g * s) >> 8;
-				fore_color_.b = ((fc.b * (256 - s)) + bc.b * s) >> 8;
-				line_vertical(pos, rect.size.y);
-				++pos.x;
+				rgba8& c = span_[x];
+				c = fc;
+				c.r = ((fc.r * (256 - s)) + bc.r * s) >> 8;
+				c.g = ((fc.g * (256 - s)) + bc.g * s) >> 8;
+				c.b = ((fc.b * (256 - s)) + bc.b * s) >> 8;
 				gain += gainadd;
 			}
-			pop_fore_color();
+			for(int y = 0; y < rect.size.y; ++y) {
+				draw_span_(&span_[0], rect.org.x, rect.org.y + y, rect.size.x);
+			}
 		}
 
 
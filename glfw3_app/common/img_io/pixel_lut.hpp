@@ -0,0 +1,267 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	フレームバッファ変換（パレット・インデックス、RGB565 → RGBA8）@n
+			エミュレータ等のフレームバッファを、gl::texfb へ転送する RGBA へ変換する。@n
+			パレットは 32 ビットにパックしたテーブルで持ち、１ピクセル１回の @n
+			ストアで書き込む。パレット変換は AVX2 のギャザー命令を使い、@n
+			AVX2 を指定せずにビルドした場合も、実行時に CPU を調べて切り替える。@n
+			２値変換は SSE2 の比較マスクを使う。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017, 2019 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/glfw3_app/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <cstring>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+// AVX2 はターゲット属性で関数単位に有効化し、実行時に選択する
+#include <immintrin.h>
+#define PIXEL_LUT_AVX2_DISPATCH
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace img {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	パレット変換クラス（８ビット・インデックス → RGBA8）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class pixel_lut {
+
+		uint32_t	lut_[256];
+
+#if defined(__AVX2__) || defined(PIXEL_LUT_AVX2_DISPATCH)
+#if defined(PIXEL_LUT_AVX2_DISPATCH)
+		__attribute__((target("avx2")))
+#endif
+		static uint32_t convert_avx2_(const uint32_t* lut, const uint8_t* src, uint32_t* dst, uint32_t len)
+		{
+			const int* base = reinterpret_cast<const int*>(lut);
+			uint32_t i = 0;
+			for(; (i + 8) <= len; i += 8) {
+				__m128i idx = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i));
+				__m256i v = _mm256_i32gather_epi32(base, _mm256_cvtepu8_epi32(idx), 4);
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), v);
+			}
+			return i;
+		}
+#endif
+
+#if defined(PIXEL_LUT_AVX2_DISPATCH)
+		static bool has_avx2_()
+		{
+			static const bool f = __builtin_cpu_supports("avx2");
+			return f;
+		}
+#endif
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	RGBA8 を、メモリー上のバイト順 R,G,B,A の 32 ビットにパック
+			@param[in]	r	赤
+			@param[in]	g	緑
+			@param[in]	b	青
+			@param[in]	a	アルファ
+			@return パックした値
+		*/
+		//-----------------------------------------------------------------//
+		static uint32_t pack(uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255)
+		{
+			uint8_t t[4] = { r, g, b, a };
+			uint32_t v;
+			std::memcpy(&v, t, 4);
+			return v;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+		pixel_lut() { clear(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	テーブルをクリア（透明な黒）
+		*/
+		//-----------------------------------------------------------------//
+		void clear() { std::memset(lut_, 0, sizeof(lut_)); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	パレットを設定
+			@param[in]	idx	インデックス
+			@param[in]	r	赤
+			@param[in]	g	緑
+			@param[in]	b	青
+			@param[in]	a	アルファ
+		*/
+		//-----------------------------------------------------------------//
+		void set(uint8_t idx, uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255)
+		{
+			lut_[idx] = pack(r, g, b, a);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	r, g, b メンバーを持つパレット配列から設定 @n
+					num 以降のインデックスには、(idx % num) の色を複製する。@n
+					※ソース側のマスク（idx & 63 等）を不要にする。
+			@param[in]	pal	パレット配列
+			@param[in]	num	パレット数（２のべき乗）
+		*/
+		//-----------------------------------------------------------------//
+		template <class RGB>
+		void set_palette(const RGB* pal, uint32_t num)
+		{
+			if(pal == nullptr || num == 0 || num > 256) return;
+			for(uint32_t i = 0; i < num; ++i) {
+				lut_[i] = pack(pal[i].r, pal[i].g, pal[i].b);
+			}
+			for(uint32_t i = num; i < 256; ++i) {
+				lut_[i] = lut_[i & (num - 1)];
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	パックしたテーブルを取得
+			@return テーブル
+		*/
+		//-----------------------------------------------------------------//
+		const uint32_t* get() const { return lut_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	インデックス列を RGBA8 へ変換
+			@param[in]	src	インデックス列
+			@param[out]	dst	RGBA8（３２ビット単位）
+			@param[in]	len	ピクセル数
+		*/
+		//-----------------------------------------------------------------//
+		void convert(const uint8_t* src, uint32_t* dst, uint32_t len) const
+		{
+			uint32_t i = 0;
+#if defined(__AVX2__)
+			i = convert_avx2_(lut_, src, dst, len);
+#elif defined(PIXEL_LUT_AVX2_DISPATCH)
+			if(has_avx2_()) i = convert_avx2_(lut_, src, dst, len);
+#endif
+			for(; (i + 4) <= len; i += 4) {
+				uint32_t a = lut_[src[i + 0]];
+				uint32_t b = lut_[src[i + 1]];
+				uint32_t c = lut_[src[i + 2]];
+				uint32_t d = lut_[src[i + 3]];
+				dst[i + 0] = a;
+				dst[i + 1] = b;
+				dst[i + 2] = c;
+				dst[i + 3] = d;
+			}
+			for(; i < len; ++i) {
+				dst[i] = lut_[src[i]];
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ピッチを持つインデックス画像を RGBA8 へ変換
+			@param[in]	src		インデックス画像
+			@param[in]	pitch	ソースのライン・バイト数
+			@param[out]	dst		RGBA8（３２ビット単位、隙間無し）
+			@param[in]	w		横幅
+			@param[in]	h		高さ
+		*/
+		//-----------------------------------------------------------------//
+		void convert(const uint8_t* src, uint32_t pitch, uint32_t* dst, uint32_t w, uint32_t h) const
+		{
+			for(uint32_t y = 0; y < h; ++y) {
+				convert(src, dst, w);
+				src += pitch;
+				dst += w;
+			}
+		}
+	};
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	RGB565 列を RGBA8 へ変換 @n
+				各成分は (v * 255 + n / 2) / n で丸めたテーブルを使う。
+		@param[in]	src	RGB565
+		@param[out]	dst	RGBA8（３２ビット単位）
+		@param[in]	len	ピクセル数
+	*/
+	//-----------------------------------------------------------------//
+	inline void convert_rgb565(const uint16_t* src, uint32_t* dst, uint32_t len)
+	{
+		struct lut_t {
+			uint32_t	r[32];
+			uint32_t	g[64];
+			uint32_t	b[32];
+			lut_t() {
+				for(uint32_t i = 0; i < 32; ++i) {
+					uint8_t v = (i * 255 + 15) / 31;
+					r[i] = pixel_lut::pack(v, 0, 0, 255);
+					b[i] = pixel_lut::pack(0, 0, v, 0);
+				}
+				for(uint32_t i = 0; i < 64; ++i) {
+					g[i] = pixel_lut::pack(0, (i * 255 + 31) / 63, 0, 0);
+				}
+			}
+		};
+		static const lut_t lut;
+
+		for(uint32_t i = 0; i < len; ++i) {
+			uint32_t c = src[i];
+			dst[i] = lut.r[c >> 11] | lut.g[(c >> 5) & 0x3f] | lut.b[c & 0x1f];
+		}
+	}
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	２値（０／非０）のバイト列を RGBA8 へ変換
+		@param[in]	src	ソース
+		@param[out]	dst	RGBA8（３２ビット単位）
+		@param[in]	len	ピクセル数
+		@param[in]	on	非０の色（pixel_lut::pack）
+		@param[in]	off	０の色（pixel_lut::pack）
+	*/
+	//-----------------------------------------------------------------//
+	inline void convert_mono(const uint8_t* src, uint32_t* dst, uint32_t len, uint32_t on, uint32_t off = 0)
+	{
+		uint32_t i = 0;
+#if defined(__SSE2__)
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i von  = _mm_set1_epi32(static_cast<int>(on));
+		const __m128i voff = _mm_set1_epi32(static_cast<int>(off));
+		for(; (i + 4) <= len; i += 4) {
+			int32_t t;
+			std::memcpy(&t, src + i, 4);
+			__m128i b = _mm_cvtsi32_si128(t);
+			b = _mm_unpacklo_epi8(b, zero);
+			b = _mm_unpacklo_epi16(b, zero);
+			__m128i m = _mm_cmpeq_epi32(b, zero);  // ０のレーンが全ビット１
+			__m128i v = _mm_or_si128(_mm_and_si128(m, voff), _mm_andnot_si128(m, von));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v);
+		}
+#endif
+		for(; i < len; ++i) {
+			dst[i] = src[i] != 0 ? on : off;
+		}
+	}
+}
@@ -10,6 +10,8 @@
 //=====================================================================//
 #include "i_img_io.hpp"
 #include <png.h>
+#include <cstring>
+#include <vector>
 #include "img_idx8.hpp"
 #include "img_rgba8.hpp"
 #include <boost/format.hpp>
@@ -322,48 +324,62 @@ namespace img {
 				}
 			}
 
+			// カラーキー（透明色）
+			png_color_16p key = nullptr;
+			if(color_key_enable_ && !indexed) {
+				png_bytep kta;
+				int knt;
+				png_get_tRNS(png_ptr, info_ptr, &kta, &knt, &key);
+			}
+
 			png_byte* iml = new png_byte[width * ch * skip];
-			vtx::spos pos;
-			for(pos.y = 0; pos.y < static_cast<short>(height); ++pos.y) {
+			for(int y = 0; y < static_cast<int>(height); ++y) {
 				png_read_row(png_ptr, iml, nullptr);
-				png_byte* p = iml;
-				for(pos.x = 0; pos.x < static_cast<short>(width); ++pos.x) {
-					img::rgba8 c;
-					if(indexed) {
-						idx8 i(*p);
+				const png_byte* p = iml;
+				if(indexed) {
+					idx8* out = static_cast<idx8*>(img_->at_line(y));
+					for(uint32_t x = 0; x < width; ++x) {
+						out[x].i = *p;
 						p += skip;
-						img_->put_pixel(pos, i);
-					} else {
-						if(gray) {
-							c.r = c.g = c.b = *p;
-							p += skip;
-							if(alpha) { c.a = *p; p += skip; }
-							else c.a = 255;
-						} else {
-							c.r = *p;
-							p += skip;
-							c.g = *p;
-							p += skip;
-							c.b = *p;
-							p += skip;
-							if(alpha) { c.a = *p; p += skip; }
-							else c.a = 255;
-						}
-						if(color_key_enable_) {
-							png_bytep ta;
-							int nt;
-							png_color_16p tc;
-							png_get_tRNS(png_ptr, info_ptr, &ta, &nt, &tc);
-							if(static_cast<unsigned short>(c.r) == tc->red
-							   && static_cast<unsigned short>(c.g) == tc->green
-							   && static_cast<unsigned short>(c.b) == tc->blue) {
-								c.a = 0;
-							}
+					}
+					prgl_pos_ = y;
+					continue;
+				}
+				rgba8* out = static_cast<rgba8*>(img_->at_line(y));
+				if(gray) {
+					for(uint32_t x = 0; x < width; ++x) {
+						rgba8& c = out[x];
+						c.r = c.g = c.b = *p;
+						p += skip;
+						if(alpha) { c.a = *p; p += skip; }
+						else c.a = 255;
+					}
+				} else if(skip == 1 && alpha) {
+					std::memcpy(static_cast<void*>(out), p, width * 4);
+				} else {
+					for(uint32_t x = 0; x < width; ++x) {
+						rgba8& c = out[x];
+						c.r = *p;
+						p += skip;
+						c.g = *p;
+						p += skip;
+						c.b = *p;
+						p += skip;
+						if(alpha) { c.a = *p; p += skip; }
+						else c.a = 255;
+					}
+				}
+				if(key != nullptr) {
+					for(uint32_t x = 0; x < width; ++x) {
+						rgba8& c = out[x];
+						if(static_cast<unsigned short>(c.r) == key->red
+						   && static_cast<unsigned short>(c.g) == key->green
+						   && static_cast<unsigned short>(c.b) == key->blue) {
+							c.a = 0;
 						}
-						img_->put_pixel(pos, c);
 					}
 				}
-				prgl_pos_ = pos.y;
+				prgl_pos_ = y;
 			}
 			delete[] iml;
 
@@ -466,28 +482,25 @@ namespace img {
 				png_write_info(png_ptr, info_ptr);
 			}
 
-			vtx::spos pos;
 			png_byte* iml = new png_byte[w * ch];
-			for(pos.y = 0; pos.y < h; ++pos.y) {
-				png_byte* p = iml;
+			std::vector<rgba8> line(w);
+			for(int y = 0; y < h; ++y) {
 				if(ch == 1) {
-					for(pos.x = 0; pos.x < w; ++pos.x) {
-						idx8 idx;
-						img_->get_pixel(pos, idx);
-						*p++ = idx.i;
-					}
-				} else if(img_->get_type() == IMG::FULL8) {
-					for(pos.x = 0; pos.x < w; ++pos.x) {
-						rgba8 c;
-						img_->get_pixel(pos, c);
+					std::memcpy(iml, img_->get_line(y), w);
+				} else if(ch == 4) {
+					img_->get_line_rgba8(y, 0, w, reinterpret_cast<rgba8*>(iml));
+				} else {
+					img_->get_line_rgba8(y, 0, w, &line[0]);
+					png_byte* p = iml;
+					for(int x = 0; x < w; ++x) {
+						const rgba8& c = line[x];
 						*p++ = c.r;
 						*p++ = c.g;
 						*p++ = c.b;
-						if(ch == 4) *p++ = c.a;
 					}
 				}
 				png_write_row(png_ptr, iml);
-				prgl_pos_ = pos.y;
+				prgl_pos_ = y;
 			}
 			delete[] iml;
 
@@ -0,0 +1,487 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	先行デコード・ストリーム・クラス @n
+			ワーカースレッドで、再生位置の数秒先までデコードしておき、@n
+			デコード済みのブロック（audio）をそのまま渡す。@n
+			再生済みのブロックも一定時間保持し、その範囲のシークはキャッシュから返す。@n
+			次の曲を登録すると、現在の曲をデコードし終えた後、次の曲の先頭も @n
+			デコードしておく（曲間の途切れを無くす）。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017, 2025 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/glfw_app/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstring>
+#include "snd_io/snd_files.hpp"
+#include "snd_io/pcm.hpp"
+
+namespace al {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	先行デコード・ストリーム・クラス @n
+				open, get, seek, set_next は、一つのスレッド（再生側）から呼ぶ事。
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class snd_prefetch {
+	public:
+
+		//=================================================================//
+		/*!
+			@brief	統計情報
+		*/
+		//=================================================================//
+		struct info_t {
+			uint32_t	cache_hit;		///< キャッシュから返したシーク数
+			uint32_t	cache_miss;		///< デコードし直したシーク数
+			uint32_t	underrun;		///< デコードが間に合わなかった回数
+			uint32_t	gapless;		///< 先行デコードした次の曲を使った回数
+			info_t() : cache_hit(0), cache_miss(0), underrun(0), gapless(0) { }
+		};
+
+	private:
+		struct block_t {
+			size_t	pos;
+			audio	aif;
+		};
+		typedef std::deque<block_t>	blocks;
+
+		struct track_t {
+			snd_files		sdf;
+			utils::file_io	fin;
+			audio_info		info;
+			::sound::tag_t	tag;
+			std::string		file;
+			bool			pending;	///< ワーカーでオープンする
+			bool			open;
+			bool			eof;
+			bool			restart;	///< 先頭からデコードし直す
+			size_t			dpos;		///< 次にデコードする位置
+			uint32_t		gen;		///< シーク毎に更新（デコード中のブロックを捨てる）
+			blocks			cache;
+			track_t() : sdf(), fin(), info(), tag(), file(), pending(false), open(false),
+				eof(false), restart(false), dpos(0), gen(0), cache() { }
+		};
+		typedef std::unique_ptr<track_t>	track_ptr;
+
+		uint32_t		block_;
+		uint32_t		ahead_sec_;
+		uint32_t		history_sec_;
+
+		track_ptr		cur_;
+		track_ptr		next_;
+		size_t			read_pos_;
+
+		info_t			info_;
+
+		std::thread		thread_;
+		std::mutex		dec_sync_;	///< デコーダー（snd_files, file_io）の排他
+		std::mutex		sync_;		///< キャッシュ、位置の排他（dec_sync_ の後に取る）
+		std::condition_variable	cond_;
+		bool			quit_;
+
+
+		static size_t sample_bytes_(audio_format t)
+		{
+			switch(t) {
+			case audio_format::PCM8_MONO:    return sizeof(pcm8_m);
+			case audio_format::PCM8_STEREO:  return sizeof(pcm8_s);
+			case audio_format::PCM16_MONO:   return sizeof(pcm16_m);
+			case audio_format::PCM16_STEREO: return sizeof(pcm16_s);
+			case audio_format::PCM24_MONO:   return sizeof(pcm24_m);
+			case audio_format::PCM24_STEREO: return sizeof(pcm24_s);
+			case audio_format::PCM32_MONO:   return sizeof(pcm32_m);
+			case audio_format::PCM32_STEREO: return sizeof(pcm32_s);
+			default: return 0;
+			}
+		}
+
+
+		static audio copy_(const audio src, size_t ofs, size_t len)
+		{
+			audio dst = create_audio(src->get_type());
+			if(!dst) return dst;
+			dst->create(src->get_rate(), len);
+			std::memcpy(dst->at_wave(), src->get_wave(ofs), len * sample_bytes_(src->get_type()));
+			return dst;
+		}
+
+
+		static size_t samples_(const track_t& t) { return t.info.samples; }
+
+
+		static void close_(track_t& t)
+		{
+			if(t.open) {
+				t.sdf.close_stream();
+				t.fin.close();
+			}
+			t.file.clear();
+			t.pending = false;
+			t.open = false;
+			t.eof = false;
+			t.restart = false;
+			t.dpos = 0;
+			++t.gen;
+			t.cache.clear();
+		}
+
+
+		// dec_sync_ を取った状態で呼ぶ（ファイルの I/O 中は sync_ を取らない）
+		bool open_(track_t& t, const std::string& file)
+		{
+			{
+				std::lock_guard<std::mutex> lk(sync_);
+				close_(t);
+				t.file = file;
+			}
+			if(!t.fin.open(file, "rb")) return false;
+			audio_info inf;
+			if(!t.sdf.open_stream(t.fin, block_, inf, utils::get_file_ext(file))) {
+				t.sdf.close_stream();
+				t.fin.close();
+				return false;
+			}
+			std::lock_guard<std::mutex> lk(sync_);
+			t.info = inf;
+			t.tag = t.sdf.get_tag();
+			t.open = true;
+			return true;
+		}
+
+
+		size_t ahead_(const track_t& t) const {
+			return static_cast<size_t>(t.info.frequency) * ahead_sec_;
+		}
+
+
+		size_t history_(const track_t& t) const {
+			return static_cast<size_t>(t.info.frequency) * history_sec_;
+		}
+
+
+		// デコードするトラックを選ぶ（sync_ を取った状態で呼ぶ）
+		track_t* select_()
+		{
+			if(cur_->open && !cur_->eof && (cur_->restart || cur_->dpos < read_pos_ + ahead_(*cur_))) {
+				return cur_.get();
+			}
+			if(cur_->open && !cur_->eof) return nullptr;
+			if(next_->pending) return next_.get();
+			if(next_->open && !next_->eof && next_->dpos < ahead_(*next_)) {
+				return next_.get();
+			}
+			return nullptr;
+		}
+
+
+		void trim_(track_t& t)
+		{
+			size_t h = history_(t);
+			while(!t.cache.empty()) {
+				const block_t& b = t.cache.front();
+				if((b.pos + b.aif->get_samples() + h) > read_pos_) break;
+				t.cache.pop_front();
+			}
+		}
+
+
+		void worker_()
+		{
+			while(1) {
+				std::unique_lock<std::mutex> dl(dec_sync_);
+				track_t* t;
+				size_t pos;
+				uint32_t gen;
+				bool restart;
+				bool pending;
+				std::string file;
+				{
+					std::unique_lock<std::mutex> lk(sync_);
+					if(quit_) break;
+					t = select_();
+					if(t == nullptr) {
+						dl.unlock();
+						cond_.wait(lk);
+						continue;
+					}
+					pos = t->dpos;
+					gen = t->gen;
+					restart = t->restart;
+					pending = t->pending;
+					file = t->file;
+				}
+
+				if(pending) {  // 次の曲のオープン
+					open_(*t, file);
+					continue;
+				}
+
+				if(restart) {  // 先頭へのシーク（デコーダーによっては位置０を検出出来ない）
+					t->sdf.close_stream();
+					t->fin.seek(0, utils::file_io::SEEK::SET);
+					audio_info inf;
+					bool ok = t->sdf.open_stream(t->fin, block_, inf, utils::get_file_ext(t->file));
+					std::lock_guard<std::mutex> lk(sync_);
+					t->restart = false;
+					if(!ok) t->eof = true;
+					continue;
+				}
+
+				size_t len = t->sdf.read_stream(t->fin, pos, block_);
+				audio aif;
+				if(len > 0) {
+					aif = copy_(t->sdf.get_stream(), 0, len);
+				}
+				{
+					std::lock_guard<std::mutex> lk(sync_);
+					if(t->gen != gen) continue;  // デコード中にシークされた
+					if(aif) {
+						t->cache.push_back(block_t { pos, aif });
+						t->dpos = pos + len;
+						if(t->dpos >= samples_(*t)) t->eof = true;
+					} else {
+						t->eof = true;
+					}
+				}
+			}
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+			@param[in]	block	ブロックのサンプル数
+			@param[in]	ahead	先行してデコードする時間（秒）
+			@param[in]	history	再生後も保持する時間（秒）
+		*/
+		//-----------------------------------------------------------------//
+		snd_prefetch(uint32_t block = 2048, uint32_t ahead = 4, uint32_t history = 8) :
+			block_(block), ahead_sec_(ahead), history_sec_(history),
+			cur_(new track_t), next_(new track_t), read_pos_(0), info_(),
+			thread_(), quit_(false)
+		{
+			thread_ = std::thread(&snd_prefetch::worker_, this);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	デストラクター
+		*/
+		//-----------------------------------------------------------------//
+		~snd_prefetch()
+		{
+			{
+				std::lock_guard<std::mutex> lk(sync_);
+				quit_ = true;
+			}
+			cond_.notify_all();
+			thread_.join();
+			close_(*cur_);
+			close_(*next_);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	対応している拡張子を取得
+			@return 拡張子（, 区切り）
+		*/
+		//-----------------------------------------------------------------//
+		const std::string& get_file_exts() const { return cur_->sdf.get_file_exts(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ストリームをオープン @n
+					set_next で登録済みの曲なら、先行デコードしたデータを使う。
+			@param[in]	file	ファイル名
+			@param[out]	inf		オーディオ情報
+			@return 成功なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool open(const std::string& file, audio_info& inf)
+		{
+			std::lock_guard<std::mutex> dl(dec_sync_);
+			bool ret;
+			{
+				std::lock_guard<std::mutex> lk(sync_);
+				read_pos_ = 0;
+				if(next_->open && next_->file == file) {
+					cur_.swap(next_);
+					++info_.gapless;
+					inf = cur_->info;
+					ret = true;
+				} else {
+					ret = false;
+				}
+				close_(*next_);
+			}
+			if(!ret) {
+				ret = open_(*cur_, file);
+				inf = cur_->info;
+			}
+			cond_.notify_all();
+			return ret;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	次の曲を登録（現在の曲のデコードが終わったら、先頭をデコードする）
+			@param[in]	file	ファイル名（空ならキャンセル）
+		*/
+		//-----------------------------------------------------------------//
+		void set_next(const std::string& file)
+		{
+			std::lock_guard<std::mutex> dl(dec_sync_);
+			{
+				std::lock_guard<std::mutex> lk(sync_);
+				if(next_->file == file) return;
+				close_(*next_);
+				next_->file = file;
+				next_->pending = !file.empty();
+			}
+			cond_.notify_all();
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	次の曲の情報を取得（先行デコードが始まっている場合）
+			@param[out]	inf		オーディオ情報
+			@return 次の曲が使える場合「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool get_next_info(audio_info& inf)
+		{
+			std::lock_guard<std::mutex> lk(sync_);
+			if(!next_->open || next_->cache.empty()) return false;
+			inf = next_->info;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	クローズ
+		*/
+		//-----------------------------------------------------------------//
+		void close()
+		{
+			std::lock_guard<std::mutex> dl(dec_sync_);
+			std::lock_guard<std::mutex> lk(sync_);
+			close_(*cur_);
+			read_pos_ = 0;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	タグを取得（open 後）
+			@return タグ
+		*/
+		//-----------------------------------------------------------------//
+		const ::sound::tag_t& get_tag() const { return cur_->tag; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	次のブロックを取得
+			@param[out]	pos	ブロックの先頭位置
+			@return デコードが間に合っていない場合、終端の場合、空
+		*/
+		//-----------------------------------------------------------------//
+		audio get(size_t& pos)
+		{
+			audio aif;
+			{
+				std::lock_guard<std::mutex> lk(sync_);
+				track_t& t = *cur_;
+				for(const block_t& b : t.cache) {
+					size_t len = b.aif->get_samples();
+					if(read_pos_ >= b.pos && read_pos_ < (b.pos + len)) {
+						if(read_pos_ == b.pos) {
+							aif = b.aif;
+						} else {  // ブロックの途中へシークした
+							aif = copy_(b.aif, read_pos_ - b.pos, b.pos + len - read_pos_);
+						}
+						pos = read_pos_;
+						read_pos_ = b.pos + len;
+						break;
+					}
+				}
+				if(!aif && t.open && !t.eof) ++info_.underrun;
+				trim_(t);
+			}
+			cond_.notify_all();
+			return aif;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	終端か？
+			@return 全て取得した場合「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool is_end()
+		{
+			std::lock_guard<std::mutex> lk(sync_);
+			return !cur_->open || (cur_->eof && read_pos_ >= cur_->dpos);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	シーク @n
+					デコード済みの範囲ならキャッシュから返し、それ以外はデコードし直す。
+			@param[in]	pos	位置（サンプル）
+			@return キャッシュの範囲なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool seek(size_t pos)
+		{
+			bool hit = false;
+			{
+				std::lock_guard<std::mutex> lk(sync_);
+				track_t& t = *cur_;
+				if(!t.cache.empty() && pos >= t.cache.front().pos && pos < t.dpos) {
+					hit = true;
+					++info_.cache_hit;
+				} else {
+					++info_.cache_miss;
+					++t.gen;
+					t.cache.clear();
+					t.dpos = pos;
+					t.eof = pos >= samples_(t);
+					t.restart = pos == 0;
+				}
+				read_pos_ = pos;
+			}
+			cond_.notify_all();
+			return hit;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	統計情報を取得
+			@return 統計情報
+		*/
+		//-----------------------------------------------------------------//
+		info_t get_info()
+		{
+			std::lock_guard<std::mutex> lk(sync_);
+			return info_;
+		}
+	};
+}
@@ -17,9 +17,11 @@
 #include <pthread.h>
 #include "snd_io/audio_io.hpp"
 #include "snd_io/snd_files.hpp"
+#include "snd_io/snd_prefetch.hpp"
 #include "snd_io/tag.hpp"
 #include "snd_io/pcm.hpp"
 #include "utils/fifo.hpp"
+#include "utils/spsc_fifo.hpp"
 #include "utils/string_utils.hpp"
 #include "utils/file_info.hpp"
 
@@ -76,6 +78,19 @@ namespace al {
 		};
 
 
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief	ストリーム・スレッドからの通知（ファイル、タグ）
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct stream_info_t {
+			std::string		fph_;
+			::sound::tag_t	tag_;
+			bool			tag_valid_;
+			stream_info_t() : fph_(), tag_(), tag_valid_(false) { }
+		};
+
+
 		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 		/*!
 			@brief	ストリーム構造体
@@ -87,7 +102,8 @@ namespace al {
 			std::string				root_;
 			std::string				file_;
 
-			utils::fifo<request_t, 64> request_;
+			utils::spsc_fifo<request_t, 64> request_;
+			utils::spsc_fifo<stream_info_t, 8> info_;
 			stream_state::type		state_;
 
 			volatile bool			start_;
@@ -99,16 +115,11 @@ namespace al {
 			volatile time_t			etime_;
 			volatile uint32_t		open_err_;
 
-			pthread_mutex_t			sync_;
-			uint32_t				fph_cnt_;
-			std::string				fph_;
-			::sound::tag_t			tag_;
-
 			sstream_t() : audio_io_(0), slot_(0),
 				root_(), file_(), state_(stream_state::STALL),
 				start_(false), finsh_(false),
 				pos_(0), len_(0), time_(0), etime_(0),
-				open_err_(0), fph_cnt_(0), fph_(), tag_() { }
+				open_err_(0) { }
 		};
 
 
@@ -135,10 +146,8 @@ namespace al {
 			audio_io*				audio_io_;
 			audio_io::slot_handle	slot_;
 
-			utils::fifo<int16_t, 512 * 8>	wave_;
-			utils::fifo<audio, 32>			audio_;
-
-			pthread_mutex_t			sync_;
+			utils::spsc_fifo<int16_t, 512 * 8>	wave_;
+			utils::spsc_fifo<audio, 32>			audio_;
 
 			volatile uint32_t		frame_;
 			volatile bool			start_;
@@ -165,7 +174,6 @@ namespace al {
 		sstream_t		sstream_t_;
 
 		pthread_t			pth_;
-		volatile uint32_t	stream_fph_cnt_;
 		std::string			stream_fph_;
 		::sound::tag_t		stream_tag_;
 
@@ -199,7 +207,20 @@ namespace al {
 		}
 
 
-		static void play_task_(sound::sstream_t& sst, snd_files& sdf,
+		// 次に再生するファイル（ディレクトリの場合は先行デコードしない）
+		static std::string next_file_(const std::string& root, const utils::file_infos& fis, uint32_t i)
+		{
+			for(++i; i < fis.size(); ++i) {
+				const utils::file_info& fi = fis[i];
+				if(fi.get_name() == "." || fi.get_name() == "..") continue;
+				if(fi.is_directory()) break;
+				return root + '/' + fi.get_name();
+			}
+			return std::string();
+		}
+
+
+		static void play_task_(sound::sstream_t& sst, snd_prefetch& sdf,
 			std::string& root, utils::file_infos& src, const std::string& file)
 		{
 			static constexpr int stream_buff_size = 2048;
@@ -238,31 +259,27 @@ namespace al {
 					continue;
 				}
 
-				pthread_mutex_lock(&sst.sync_);
-				sst.fph_ = fn;
-				++sst.fph_cnt_;
-				pthread_mutex_unlock(&sst.sync_);
+				{
+					stream_info_t info;
+					info.fph_ = fn;
+					sst.info_.put(info);
+				}
 
-				utils::file_io fin;
 				audio_info ainfo;
-				if(fin.open(fn, "rb")) {
-					if(!sdf.open_stream(fin, stream_buff_size, ainfo)) {
-						sdf.close_stream();
-						fin.close();
-						++sst.open_err_;
-						++i;
-						continue;
-					}
-				} else {
-					fin.close();
+				if(!sdf.open(fn, ainfo)) {
 					++sst.open_err_;
 					++i;
 					continue;
 				}
-
-				pthread_mutex_lock(&sst.sync_);
-				sst.tag_ = sdf.get_tag();
-				pthread_mutex_unlock(&sst.sync_);
+				sdf.set_next(next_file_(root, fis, i));
+
+				{
+					stream_info_t info;
+					info.fph_ = fn;
+					info.tag_ = sdf.get_tag();
+					info.tag_valid_ = true;
+					sst.info_.put(info);
+				}
 
 				sst.len_ = ainfo.samples;
 				time_t t;
@@ -274,8 +291,8 @@ namespace al {
 				sst.state_ = sound::stream_state::PLAY;
 				bool first_pause = true;
 				while(pos < ainfo.samples) {
-					if(sst.request_.length()) {
-						const sound::request_t& r = sst.request_.get();
+					sound::request_t r;
+					if(sst.request_.get(r)) {
 						if(r.command_ == sound::request_t::command::NEXT) {
 							++i;
 							cmdin = true;
@@ -312,6 +329,7 @@ namespace al {
 							}
 						} else if(r.command_ == sound::request_t::command::SEEK) {
 							pos = r.seek_pos_;
+							sdf.seek(pos);
 						}
 					}
 
@@ -324,11 +342,13 @@ namespace al {
 
 						audio_io::wave_handle h = sst.audio_io_->status_stream(sst.slot_);
 						if(h) {
-							uint32_t len = sdf.read_stream(fin, pos, stream_buff_size);
-							if(len) {
-								pos += len;
-								sst.audio_io_->queue_stream(sst.slot_, h, sdf.get_stream());
-							} else {
+							// 先行デコード済みのブロックを、そのままキューに積む
+							size_t p;
+							audio aif = sdf.get(p);
+							if(aif) {
+								pos = p + aif->get_samples();
+								sst.audio_io_->queue_stream(sst.slot_, h, aif);
+							} else if(sdf.is_end()) {
 								pos = ainfo.samples;
 							}
 						}
@@ -341,14 +361,17 @@ namespace al {
 					usleep(8000);	// 8ms くらいの時間待ち
 #endif
 				}
+				// 次の曲が同じフォーマットで先行デコード済みなら、キューを止めずに続ける
+				audio_info next;
+				bool gapless = !purge && sdf.get_next_info(next)
+					&& next.chanels == ainfo.chanels && next.frequency == ainfo.frequency;
 				if(purge) sst.audio_io_->purge_stream(sst.slot_);
-				else {
+				else if(!gapless) {
 					sst.audio_io_->sync_stream(sst.slot_);
 					sst.audio_io_->purge_stream(sst.slot_);
 				}
 				sst.pos_ = sst.len_;
-				sdf.close_stream();
-				fin.close();
+				sdf.close();
 
 				if(!cmdin) ++i;
 			}
@@ -360,7 +383,7 @@ namespace al {
 		{
 			sound::sstream_t& sst = *(static_cast<sound::sstream_t*>(entry));
 
-			snd_files sdf;
+			snd_prefetch sdf(2048);
 
 			sst.start_ = true;
 
@@ -384,19 +407,18 @@ namespace al {
 			audio aif;
 			aif = al::create_audio(al::audio_format::PCM16_STEREO);
 			aif->create(44100, pcm_size);
+			int16_t tmp[pcm_size];
 
 			while(!qt.exit_) {
 				if(qt.wave_.length() >= pcm_size) {
 
 					audio_io::wave_handle h = qt.audio_io_->status_stream(qt.slot_);
 					if(h) {
-						pthread_mutex_lock(&qt.sync_);
+						qt.wave_.read(tmp, pcm_size);
 						for(uint32_t i = 0; i < pcm_size; ++i) {
-							auto a = qt.wave_.get();
-							al::pcm16_s w(a, a);
+							al::pcm16_s w(tmp[i], tmp[i]);
 							aif->put(i, w);
 						}
-						pthread_mutex_unlock(&qt.sync_);
 
 						qt.audio_io_->set_loop(h, false);
 						qt.audio_io_->queue_stream(qt.slot_, h, aif);
@@ -407,9 +429,7 @@ namespace al {
 					audio_io::wave_handle h = qt.audio_io_->status_stream(qt.slot_);
 					if(h) {
 						audio aif;
-						pthread_mutex_lock(&qt.sync_);
-						aif = qt.audio_.get();
-						pthread_mutex_unlock(&qt.sync_);
+						qt.audio_.get(aif);
 
 						qt.audio_io_->set_loop(h, false);
 						qt.audio_io_->queue_stream(qt.slot_, h, aif);
@@ -439,7 +459,6 @@ namespace al {
 				queue_t_.slot_ = stream_slot_;
 				queue_t_.exit_ = false;
 
-				pthread_mutex_init(&queue_t_.sync_, nullptr);
 				pthread_create(&queue_pth_, nullptr, queue_task_, &queue_t_);
 			}
 		}
@@ -514,7 +533,7 @@ namespace al {
 			@brief	コンストラクター
 		*/
 		//-----------------------------------------------------------------//
-		sound() noexcept : slot_max_(0), stream_fph_cnt_(0),
+		sound() noexcept : slot_max_(0),
 			stream_slot_(0), stream_start_(false),
 			tag_serial_(0), tag_thread_(false),
 			queue_start_(false)
@@ -912,6 +931,7 @@ namespace al {
 			sstream_t_.start_ = false;
 
 			sstream_t_.request_.clear();
+			sstream_t_.info_.clear();
 
 			sstream_t_.finsh_ = false;
 
@@ -924,7 +944,6 @@ namespace al {
 ///			pthread_attr_init(&attr_);
 ///			pthread_attr_setdetachstate(&attr_, PTHREAD_CREATE_DETACHED);
 
-			pthread_mutex_init(&sstream_t_.sync_, nullptr);
 			pthread_create(&pth_, nullptr, stream_task_, &sstream_t_);
 
 			return true;
@@ -944,15 +963,7 @@ namespace al {
 
 			queue_setup_();
 
-			bool f = false;
-			if(queue_t_.audio_.length() < (queue_t_.audio_.size() - 1)) {
-				pthread_mutex_lock(&queue_t_.sync_);
-				queue_t_.audio_.put(aif);
-				pthread_mutex_unlock(&queue_t_.sync_);
-				f = true;
-			}
-
-			return f;
+			return queue_t_.audio_.put(aif);
 		}
 
 
@@ -973,12 +984,8 @@ namespace al {
 //				std::cout << "no waves..." << std::endl;
 //			}
 
-			if((queue_t_.wave_.size() - queue_t_.wave_.length()) > waves.size()) {
-				pthread_mutex_lock(&queue_t_.sync_);
-				for(auto w : waves) {
-					queue_t_.wave_.put(w);
-				}
-				pthread_mutex_unlock(&queue_t_.sync_);
+			if(queue_t_.wave_.space() >= waves.size()) {
+				queue_t_.wave_.write(&waves[0], waves.size());
 				return true;
 			} else {
 //				std::cout << "full..." << std::endl;
@@ -1104,7 +1111,6 @@ namespace al {
 			if(stream_start_) {
 				sstream_t_.request_.put(request_t(request_t::command::STOP));
 				pthread_join(pth_ , nullptr);
-				pthread_mutex_destroy(&sstream_t_.sync_);
 				stream_start_ = false;
 				sstream_t_.state_ = stream_state::STOP;
 				sstream_t_.time_ = 0;
@@ -1124,18 +1130,15 @@ namespace al {
 		{
 			// 曲の終了を感知して、フラグを下げる～
 			if(stream_start_) {
-				pthread_mutex_lock(&sstream_t_.sync_);
-				if(stream_fph_cnt_ != sstream_t_.fph_cnt_) {
-					stream_fph_ = sstream_t_.fph_;
-					stream_fph_cnt_ = sstream_t_.fph_cnt_;
-				}
-				if(stream_tag_.serial_ != sstream_t_.tag_.serial_) {
-					stream_tag_ = sstream_t_.tag_;
+				stream_info_t info;
+				while(sstream_t_.info_.get(info)) {
+					stream_fph_ = info.fph_;
+					if(info.tag_valid_ && stream_tag_.serial_ != info.tag_.serial_) {
+						stream_tag_ = info.tag_;
+					}
 				}
-				pthread_mutex_unlock(&sstream_t_.sync_);
 				if(sstream_t_.finsh_) {
 					pthread_detach(pth_);
-					pthread_mutex_destroy(&sstream_t_.sync_);
 					stream_start_ = false;
 				}
 			}
@@ -1204,7 +1207,6 @@ namespace al {
 			if(queue_start_) {
 				queue_t_.exit_ = true;
 				pthread_join(queue_pth_ , nullptr);
-				pthread_mutex_destroy(&queue_t_.sync_);
 			}
 
 			if(tag_thread_) {
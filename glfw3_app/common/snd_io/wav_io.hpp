@@ -263,7 +263,7 @@ std::cout << std::endl;
 			wh.szRIFF[1] = 'I';
 			wh.szRIFF[2] = 'F';
 			wh.szRIFF[3] = 'F';
-			wh.ulRIFFSize = sizeof(RIFFCHUNK) * 2 + sizeof(wave_format_ex) + align * src->get_samples();
+			wh.ulRIFFSize = 4 + sizeof(RIFFCHUNK) * 2 + sizeof(wave_format_ex) + align * src->get_samples();  // "WAVE" + fmt + data
 			wh.szWAVE[0] = 'W';
 			wh.szWAVE[1] = 'A';
 			wh.szWAVE[2] = 'V';
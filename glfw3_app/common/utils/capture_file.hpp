@@ -0,0 +1,530 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	波形キャプチャー・ファイル @n
+			ファイル構成（リトル・エンディアン）： @n
+			  header_t（64 バイト） @n
+			  ゲイン（float x チャネル数） @n
+			  チャンク索引（index_t x チャンク数 x チャネル数） @n
+			  データ（4096 バイト境界から、チャンク毎に全チャネルを並べる） @n
+			読み込みはメモリー・マップなので、巨大なファイルも直ぐに開け、@n
+			触れた範囲だけがページ・インされる。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2023 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/glfw3_app/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+#include "utils/file_io.hpp"
+#include "utils/file_map.hpp"
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	波形キャプチャー・ファイル・クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class capture_file {
+	public:
+		static const uint32_t VERSION = 1;				///< フォーマットのバージョン
+		static const uint32_t CHUNK_SIZE = 65536;		///< 標準のチャンク・サンプル数
+		static const uint32_t DATA_ALIGN = 4096;		///< データ先頭の境界
+
+		//=============================================================//
+		/*!
+			@brief	ファイル・ヘッダー
+		*/
+		//=============================================================//
+		struct header_t {
+			char		magic_[4];	///< "WCAP"
+			uint32_t	version_;	///< バージョン
+			uint32_t	channels_;	///< チャネル数
+			uint16_t	unit_;		///< サンプルのバイト数（1, 2, 4）
+			uint16_t	sign_;		///< 符号付きなら１
+			uint64_t	samples_;	///< チャネル毎のサンプル数
+			double		rate_;		///< サンプリング周期 [秒]
+			uint32_t	chunk_;		///< チャンクのサンプル数
+			uint32_t	chunk_num_;	///< チャンク数
+			uint64_t	index_;		///< チャンク索引の位置
+			uint64_t	data_;		///< データの位置
+			uint64_t	reserve_;
+		};
+		static_assert(sizeof(header_t) == 64, "capture_file::header_t size");
+
+
+		//=============================================================//
+		/*!
+			@brief	チャンク索引
+		*/
+		//=============================================================//
+		struct index_t {
+			uint64_t	offset_;	///< データの位置
+			int32_t		min_;		///< 最小値
+			int32_t		max_;		///< 最大値
+		};
+		static_assert(sizeof(index_t) == 16, "capture_file::index_t size");
+
+	private:
+		file_map		map_;
+		header_t		head_;
+		const float*	gain_;
+		const index_t*	index_;
+
+		template <typename UNIT>
+		static void set_unit_(header_t& h)
+		{
+			static_assert(std::is_integral<UNIT>::value && sizeof(UNIT) <= 4, "capture_file UNIT");
+			h.unit_ = sizeof(UNIT);
+			h.sign_ = std::is_signed<UNIT>::value ? 1 : 0;
+		}
+
+		uint32_t chunk_len_(uint32_t n) const noexcept
+		{
+			uint64_t org = static_cast<uint64_t>(n) * head_.chunk_;
+			uint64_t len = head_.samples_ - org;
+			return len < head_.chunk_ ? static_cast<uint32_t>(len) : head_.chunk_;
+		}
+
+		int32_t sample_(const uint8_t* p) const noexcept
+		{
+			switch(head_.unit_) {
+			case 1:
+				return head_.sign_ ? static_cast<int32_t>(*reinterpret_cast<const int8_t*>(p)) : *p;
+			case 2:
+				{
+					uint16_t v;
+					std::memcpy(&v, p, 2);
+					return head_.sign_ ? static_cast<int32_t>(static_cast<int16_t>(v)) : v;
+				}
+			default:
+				{
+					int32_t v;
+					std::memcpy(&v, p, 4);
+					return v;
+				}
+			}
+		}
+
+	public:
+		//-------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		*/
+		//-------------------------------------------------------------//
+		capture_file() noexcept : map_(), head_(), gain_(nullptr), index_(nullptr) { }
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	セーブ
+			@param[in]	path	ファイル・パス
+			@param[in]	src		チャネル毎の波形
+			@param[in]	chn		チャネル数
+			@param[in]	len		チャネル毎のサンプル数
+			@param[in]	rate	サンプリング周期 [秒]
+			@param[in]	gain	チャネル毎のゲイン（nullptr なら 1.0）
+			@param[in]	chunk	チャンクのサンプル数
+			@return 成功なら「true」
+		*/
+		//-------------------------------------------------------------//
+		template <typename UNIT>
+		static bool save(const std::string& path, const UNIT* const* src, uint32_t chn, uint64_t len,
+			double rate, const float* gain = nullptr, uint32_t chunk = CHUNK_SIZE)
+		{
+			if(chn == 0 || chunk == 0) return false;
+
+			header_t h;
+			std::memset(&h, 0, sizeof(h));
+			std::memcpy(h.magic_, "WCAP", 4);
+			h.version_ = VERSION;
+			h.channels_ = chn;
+			set_unit_<UNIT>(h);
+			h.samples_ = len;
+			h.rate_ = rate;
+			h.chunk_ = chunk;
+			h.chunk_num_ = static_cast<uint32_t>((len + chunk - 1) / chunk);
+			h.index_ = (sizeof(header_t) + sizeof(float) * chn + sizeof(index_t) - 1)
+				/ sizeof(index_t) * sizeof(index_t);
+			uint64_t idxlen = sizeof(index_t) * static_cast<uint64_t>(h.chunk_num_) * chn;
+			h.data_ = (h.index_ + idxlen + DATA_ALIGN - 1) / DATA_ALIGN * DATA_ALIGN;
+
+			// 索引（チャンクの最小、最大）
+			std::vector<index_t> idx(static_cast<size_t>(h.chunk_num_) * chn);
+			uint64_t ofs = h.data_;
+			for(uint32_t n = 0; n < h.chunk_num_; ++n) {
+				uint64_t org = static_cast<uint64_t>(n) * chunk;
+				uint32_t num = static_cast<uint32_t>(std::min<uint64_t>(chunk, len - org));
+				for(uint32_t ch = 0; ch < chn; ++ch) {
+					auto& t = idx[n * chn + ch];
+					t.offset_ = ofs;
+					const UNIT* p = src[ch] + org;
+					int32_t min = p[0];
+					int32_t max = p[0];
+					for(uint32_t i = 1; i < num; ++i) {
+						int32_t v = p[i];
+						if(min > v) min = v;
+						if(max < v) max = v;
+					}
+					t.min_ = min;
+					t.max_ = max;
+					ofs += static_cast<uint64_t>(num) * sizeof(UNIT);
+				}
+			}
+
+			utils::file_io fout;
+			if(!fout.open(path, "wb")) {
+				return false;
+			}
+			bool ok = fout.write(&h, sizeof(h)) == sizeof(h);
+			std::vector<uint8_t> gains(h.index_ - sizeof(header_t), 0);
+			for(uint32_t ch = 0; ch < chn; ++ch) {
+				float g = gain != nullptr ? gain[ch] : 1.0f;
+				std::memcpy(&gains[ch * sizeof(float)], &g, sizeof(float));
+			}
+			ok = ok && fout.write(&gains[0], gains.size()) == gains.size();
+			if(!idx.empty()) {
+				ok = ok && fout.write(&idx[0], idxlen) == idxlen;
+			}
+			std::vector<uint8_t> pad(h.data_ - h.index_ - idxlen, 0);
+			if(!pad.empty()) {
+				ok = ok && fout.write(&pad[0], pad.size()) == pad.size();
+			}
+			for(uint32_t n = 0; ok && n < h.chunk_num_; ++n) {
+				uint64_t org = static_cast<uint64_t>(n) * chunk;
+				size_t num = static_cast<size_t>(std::min<uint64_t>(chunk, len - org));
+				for(uint32_t ch = 0; ok && ch < chn; ++ch) {
+					ok = fout.write(src[ch] + org, sizeof(UNIT), num) == num;
+				}
+			}
+			fout.close();
+			return ok;
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	波形バッファのセーブ（短いバッファに合わせる）
+			@param[in]	path	ファイル・パス
+			@param[in]	src		チャネル毎の波形バッファ
+			@param[in]	chn		チャネル数
+			@param[in]	rate	サンプリング周期 [秒]
+			@param[in]	gain	チャネル毎のゲイン（nullptr なら 1.0）
+			@return 成功なら「true」
+		*/
+		//-------------------------------------------------------------//
+		template <typename UNIT>
+		static bool save_buffers(const std::string& path, const std::vector<UNIT>* const* src, uint32_t chn,
+			double rate, const float* gain = nullptr)
+		{
+			if(chn == 0) return false;
+
+			std::vector<const UNIT*> ptr(chn);
+			uint64_t len = src[0]->size();
+			for(uint32_t ch = 0; ch < chn; ++ch) {
+				len = std::min(len, static_cast<uint64_t>(src[ch]->size()));
+				ptr[ch] = src[ch]->empty() ? nullptr : src[ch]->data();
+			}
+			return save(path, &ptr[0], chn, len, rate, gain);
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	オープン（ヘッダーと索引を検査する）
+			@param[in]	path	ファイル・パス
+			@return 成功なら「true」
+		*/
+		//-------------------------------------------------------------//
+		bool open(const std::string& path)
+		{
+			close();
+			if(!map_.open(path)) return false;
+
+			auto top = map_.get();
+			uint64_t size = map_.size();
+			if(size < sizeof(header_t)) {
+				close();
+				return false;
+			}
+			std::memcpy(&head_, top, sizeof(header_t));
+			const auto& h = head_;
+			uint64_t chn = h.channels_;
+			uint64_t idxlen = sizeof(index_t) * static_cast<uint64_t>(h.chunk_num_) * chn;
+			bool ok = std::memcmp(h.magic_, "WCAP", 4) == 0 && h.version_ == VERSION && chn > 0
+				&& (h.unit_ == 1 || h.unit_ == 2 || h.unit_ == 4) && h.chunk_ > 0
+				&& h.chunk_num_ == (h.samples_ + h.chunk_ - 1) / h.chunk_
+				&& h.index_ >= (sizeof(header_t) + sizeof(float) * chn)
+				&& (h.index_ % sizeof(index_t)) == 0
+				&& (h.index_ + idxlen) <= h.data_
+				&& (h.data_ + h.samples_ * h.unit_ * chn) <= size;
+			if(!ok) {
+				close();
+				return false;
+			}
+			gain_ = reinterpret_cast<const float*>(top + sizeof(header_t));
+			index_ = reinterpret_cast<const index_t*>(top + h.index_);
+			// 索引が指す先がファイル内に収まっているか
+			for(uint64_t i = 0; i < static_cast<uint64_t>(h.chunk_num_) * chn; ++i) {
+				uint32_t len = chunk_len_(static_cast<uint32_t>(i / chn));
+				if(index_[i].offset_ < h.data_ || (index_[i].offset_ + static_cast<uint64_t>(len) * h.unit_) > size
+					|| (index_[i].offset_ % h.unit_) != 0) {
+					close();
+					return false;
+				}
+			}
+			return true;
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	クローズ
+		*/
+		//-------------------------------------------------------------//
+		void close()
+		{
+			map_.close();
+			std::memset(&head_, 0, sizeof(head_));
+			gain_ = nullptr;
+			index_ = nullptr;
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	オープンしているか
+			@return オープンしていれば「true」
+		*/
+		//-------------------------------------------------------------//
+		bool is_open() const noexcept { return map_.is_open(); }
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	ヘッダーを取得
+			@return ヘッダー
+		*/
+		//-------------------------------------------------------------//
+		const header_t& get_header() const noexcept { return head_; }
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	ゲインを取得
+			@param[in]	ch	チャネル
+			@return ゲイン
+		*/
+		//-------------------------------------------------------------//
+		float get_gain(uint32_t ch) const noexcept
+		{
+			if(ch >= head_.channels_) return 1.0f;
+			float g;
+			std::memcpy(&g, &gain_[ch], sizeof(g));
+			return g;
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	サンプル型が一致するか
+			@return 一致すれば「true」
+		*/
+		//-------------------------------------------------------------//
+		template <typename UNIT>
+		bool match_unit() const noexcept
+		{
+			header_t h;
+			set_unit_<UNIT>(h);
+			return is_open() && h.unit_ == head_.unit_ && h.sign_ == head_.sign_;
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	チャンク索引を取得
+			@param[in]	ch	チャネル
+			@param[in]	n	チャンク番号
+			@return チャンク索引（最小、最大）
+		*/
+		//-------------------------------------------------------------//
+		const index_t& get_index(uint32_t ch, uint32_t n) const noexcept
+		{
+			return index_[static_cast<uint64_t>(n) * head_.channels_ + ch];
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	サンプルを取得（型はファイルに従う）
+			@param[in]	ch	チャネル
+			@param[in]	idx	位置
+			@return サンプル
+		*/
+		//-------------------------------------------------------------//
+		int32_t get(uint32_t ch, uint64_t idx) const noexcept
+		{
+			if(ch >= head_.channels_ || idx >= head_.samples_) return 0;
+			const auto& t = get_index(ch, static_cast<uint32_t>(idx / head_.chunk_));
+			return sample_(map_.get() + t.offset_ + (idx % head_.chunk_) * head_.unit_);
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	波形の読み出し（サンプル型が一致している事）@n
+					読んだ範囲のページだけがディスクから読み込まれる。
+			@param[in]	ch	チャネル
+			@param[in]	org	開始位置
+			@param[out]	dst	読み出し先
+			@param[in]	len	サンプル数
+			@return 読み出したサンプル数
+		*/
+		//-------------------------------------------------------------//
+		template <typename UNIT>
+		uint64_t read(uint32_t ch, uint64_t org, UNIT* dst, uint64_t len) const noexcept
+		{
+			if(!match_unit<UNIT>() || ch >= head_.channels_ || org >= head_.samples_) return 0;
+
+			len = std::min(len, head_.samples_ - org);
+			uint64_t n = 0;
+			while(n < len) {
+				uint32_t cn = static_cast<uint32_t>(org / head_.chunk_);
+				uint32_t co = static_cast<uint32_t>(org % head_.chunk_);
+				uint64_t num = std::min<uint64_t>(chunk_len_(cn) - co, len - n);
+				std::memcpy(dst + n, map_.get() + get_index(ch, cn).offset_ + co * sizeof(UNIT),
+					num * sizeof(UNIT));
+				n += num;
+				org += num;
+			}
+			return n;
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	窓の読み出し（ファイルの外は base で埋める）
+			@param[in]	ch		チャネル
+			@param[in]	org		開始位置（負でも良い）
+			@param[out]	dst		読み出し先
+			@param[in]	len		サンプル数
+			@param[in]	base	ファイルの外の値
+			@return 読み出したサンプル数
+		*/
+		//-------------------------------------------------------------//
+		template <typename UNIT>
+		uint64_t read_window(uint32_t ch, int64_t org, UNIT* dst, int64_t len, UNIT base) const noexcept
+		{
+			if(len <= 0) return 0;
+
+			std::fill(dst, dst + len, base);
+			int64_t a = std::max<int64_t>(org, 0);
+			int64_t b = std::min<int64_t>(org + len, head_.samples_);
+			if(a >= b) return 0;
+			return read(ch, a, dst + (a - org), b - a);
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	波形バッファへのロード @n
+					バッファより大きなキャプチャーは、org をバッファの０として、@n
+					その前後のバッファ分だけを読み込む（バッファの後半は org より前）。@n
+					キャプチャー形式ならオープンしたままにするので、続けて read_window、@n
+					envelope で窓の外も読める。ヘッダーの無い旧形式も読める（クローズする）。
+			@param[in]	path	ファイル・パス
+			@param[out]	dst		チャネル毎の波形バッファ（大きさは変えない）
+			@param[in]	chn		チャネル数
+			@param[in]	org		大きなキャプチャーの読み込み位置（サンプル）
+			@param[in]	base	波形の無い所の値
+			@return 成功なら「true」
+		*/
+		//-------------------------------------------------------------//
+		template <typename UNIT>
+		bool load_buffers(const std::string& path, std::vector<UNIT>* const* dst, uint32_t chn,
+			uint64_t org, UNIT base)
+		{
+			if(open(path)) {
+				if(!match_unit<UNIT>()) {
+					close();
+					return false;
+				}
+				for(uint32_t ch = 0; ch < chn; ++ch) {
+					auto& u = *dst[ch];
+					if(u.empty()) continue;
+					int64_t sz = u.size();
+					if(ch >= head_.channels_) {
+						std::fill(u.begin(), u.end(), base);
+					} else if(head_.samples_ <= static_cast<uint64_t>(sz)) {
+						read_window(ch, 0, &u[0], sz, base);
+					} else {
+						int64_t half = sz / 2;
+						read_window(ch, org, &u[0], half, base);
+						read_window(ch, static_cast<int64_t>(org) - (sz - half), &u[half], sz - half, base);
+					}
+				}
+				return true;
+			}
+
+			// 旧形式（全チャネルの生データを並べただけ）
+			utils::file_io fio;
+			if(!fio.open(path, "rb")) {
+				return false;
+			}
+			for(uint32_t ch = 0; ch < chn; ++ch) {
+				auto& u = *dst[ch];
+				if(!u.empty()) {
+					fio.read(&u[0], sizeof(UNIT), u.size());
+				}
+			}
+			fio.close();
+			return true;
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	区間の最小、最大（全体が入るチャンクは索引を使う）
+			@param[in]	ch	チャネル
+			@param[in]	org	開始位置
+			@param[in]	len	サンプル数
+			@param[out]	min	最小値
+			@param[out]	max	最大値
+			@return 区間が空なら「false」
+		*/
+		//-------------------------------------------------------------//
+		bool envelope(uint32_t ch, uint64_t org, uint64_t len, int32_t& min, int32_t& max) const noexcept
+		{
+			if(ch >= head_.channels_ || org >= head_.samples_ || len == 0) return false;
+
+			uint64_t end = std::min(org + len, head_.samples_);
+			min = std::numeric_limits<int32_t>::max();
+			max = std::numeric_limits<int32_t>::min();
+			while(org < end) {
+				uint32_t cn = static_cast<uint32_t>(org / head_.chunk_);
+				uint64_t corg = static_cast<uint64_t>(cn) * head_.chunk_;
+				uint64_t cend = corg + chunk_len_(cn);
+				const auto& t = get_index(ch, cn);
+				if(org == corg && cend <= end) {
+					if(min > t.min_) min = t.min_;
+					if(max < t.max_) max = t.max_;
+				} else {
+					auto p = map_.get() + t.offset_;
+					uint64_t e = std::min(cend, end);
+					for(uint64_t i = org; i < e; ++i) {
+						int32_t v = sample_(p + (i - corg) * head_.unit_);
+						if(min > v) min = v;
+						if(max < v) max = v;
+					}
+				}
+				org = cend;
+			}
+			return true;
+		}
+	};
+}
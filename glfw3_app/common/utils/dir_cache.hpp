@@ -0,0 +1,555 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	ディレクトリー・キャッシュ・クラス @n
+			パス毎にディレクトリーのエントリーを保持し、inotify（Linux）と、@n
+			ディレクトリーの更新時間で変化を検出して、差分だけを更新する。@n
+			エントリーの stat（サイズ、時間、モード）は後から遅延して取得する。@n
+			※クラスはスレッド・セーフでは無いので、呼び出し側でロックする事。@n
+			※I/O を伴う static 関数は、ロックの外で呼ぶ事を想定している。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2023 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/glfw_app/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <dirent.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+#include "utils/file_info.hpp"
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	ディレクトリー・キャッシュ・クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class dir_cache {
+	public:
+
+		//=================================================================//
+		/*!
+			@brief	エントリー
+		*/
+		//=================================================================//
+		struct entry_t {
+			std::string	name_;
+			bool		dir_;
+			bool		stat_;		///< stat が最新なら「true」
+			size_t		size_;
+			time_t		time_;
+			mode_t		mode_;
+			uint32_t	gen_;		///< 変更の世代（stat の取得中に変化したか判定）
+			entry_t(const std::string& name = "", bool dir = false) : name_(name), dir_(dir),
+				stat_(false), size_(0), time_(0), mode_(0), gen_(0) { }
+			bool operator < (const entry_t& right) const { return name_ < right.name_; }
+		};
+		typedef std::vector<entry_t> entries;
+
+		static const uint32_t dir_limit = 64;	///< キャッシュするディレクトリーの最大数
+		static const uint32_t rev_batch = 8;	///< stat の反映で、リビジョンを進める間隔
+
+	private:
+		struct dir_t {
+			entries		list_;
+			time_t		mtime_;
+			int			wd_;		///< inotify の watch（無い場合 -1）
+			bool		dirty_;		///< 再スキャンが必要
+			bool		lazy_;		///< stat の取得待ちがある
+			bool		change_;	///< リビジョンに未反映の stat 更新がある
+			uint32_t	batch_;
+			uint32_t	rev_;
+			uint32_t	use_;
+			dir_t() : list_(), mtime_(0), wd_(-1), dirty_(false), lazy_(false), change_(false),
+				batch_(0), rev_(0), use_(0) { }
+		};
+		typedef std::map<std::string, dir_t> dir_map;
+
+		dir_map						dirs_;
+		std::map<int, std::string>	wds_;
+		int							fd_;
+		uint32_t					serial_;
+		uint32_t					use_;
+		uint32_t					gen_;
+
+		static entries::iterator find_(entries& list, const std::string& name)
+		{
+			auto it = std::lower_bound(list.begin(), list.end(), entry_t(name));
+			if(it != list.end() && it->name_ == name) return it;
+			return list.end();
+		}
+
+		void unwatch_(dir_t& d)
+		{
+#ifdef __linux__
+			if(d.wd_ >= 0) {
+				inotify_rm_watch(fd_, d.wd_);
+				wds_.erase(d.wd_);
+			}
+#endif
+			d.wd_ = -1;
+		}
+
+		void watch_(const std::string& path, dir_t& d)
+		{
+#ifdef __linux__
+			if(fd_ < 0 || d.wd_ >= 0) return;
+			d.wd_ = inotify_add_watch(fd_, path.c_str(), IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO
+				| IN_ATTRIB | IN_MODIFY | IN_CLOSE_WRITE | IN_DELETE_SELF | IN_MOVE_SELF);
+			if(d.wd_ >= 0) {
+				wds_[d.wd_] = path;
+			}
+#endif
+		}
+
+		void evict_(const std::string& keep)
+		{
+			while(dirs_.size() > dir_limit) {
+				auto old = dirs_.end();
+				for(auto it = dirs_.begin(); it != dirs_.end(); ++it) {
+					if(it->first == keep) continue;
+					if(old == dirs_.end() || it->second.use_ < old->second.use_) old = it;
+				}
+				if(old == dirs_.end()) break;
+				unwatch_(old->second);
+				dirs_.erase(old);
+			}
+		}
+
+#ifdef __linux__
+		void event_(const struct inotify_event& ev, strings& touch)
+		{
+			if(ev.mask & IN_Q_OVERFLOW) {
+				for(auto& d : dirs_) d.second.dirty_ = true;
+				return;
+			}
+			auto wt = wds_.find(ev.wd);
+			if(wt == wds_.end()) return;
+			auto dt = dirs_.find(wt->second);
+			if(dt == dirs_.end()) return;
+			dir_t& d = dt->second;
+
+			if(ev.mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF | IN_UNMOUNT)) {
+				if(ev.mask & IN_IGNORED) {
+					wds_.erase(wt);
+					d.wd_ = -1;
+				} else {
+					unwatch_(d);
+				}
+				d.dirty_ = true;
+				return;
+			}
+			if(ev.len == 0) return;
+
+			std::string name(ev.name);
+			auto it = find_(d.list_, name);
+			if(ev.mask & (IN_CREATE | IN_MOVED_TO)) {
+				if(it == d.list_.end()) {
+					entry_t e(name, (ev.mask & IN_ISDIR) != 0);
+					e.gen_ = ++gen_;
+					d.list_.insert(std::lower_bound(d.list_.begin(), d.list_.end(), e), e);
+				} else {
+					it->stat_ = false;
+					it->gen_ = ++gen_;
+				}
+				d.lazy_ = true;
+				d.rev_ = ++serial_;
+				touch.push_back(dt->first);
+			} else if(ev.mask & (IN_DELETE | IN_MOVED_FROM)) {
+				if(it != d.list_.end()) {
+					d.list_.erase(it);
+					d.rev_ = ++serial_;
+					touch.push_back(dt->first);
+				}
+			} else if(it != d.list_.end()) {  // IN_ATTRIB, IN_MODIFY, IN_CLOSE_WRITE
+				it->stat_ = false;
+				it->gen_ = ++gen_;
+				d.lazy_ = true;
+			}
+		}
+#endif
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+		dir_cache() : dirs_(), wds_(), fd_(-1), serial_(0), use_(0), gen_(0)
+		{
+#ifdef __linux__
+			fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	デストラクター
+		*/
+		//-----------------------------------------------------------------//
+		~dir_cache()
+		{
+#ifdef __linux__
+			if(fd_ >= 0) close(fd_);
+#endif
+		}
+
+
+		dir_cache(const dir_cache&) = delete;
+		dir_cache& operator = (const dir_cache&) = delete;
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ディレクトリーの更新時間を取得（I/O）
+			@param[in]	path	パス
+			@param[out]	mtime	更新時間
+			@return ディレクトリーで無い場合「false」
+		*/
+		//-----------------------------------------------------------------//
+		static bool dir_time(const std::string& path, time_t& mtime)
+		{
+#ifdef WIN32
+			mtime = 0;
+			return true;
+#else
+			struct stat st;
+			if(stat(path.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) return false;
+			mtime = st.st_mtime;
+			return true;
+#endif
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	エントリーの stat を取得（I/O）
+			@param[in]	path	ディレクトリーのパス
+			@param[in]	e		エントリー
+			@return 失敗したら「false」
+		*/
+		//-----------------------------------------------------------------//
+		static bool fill_stat(const std::string& path, entry_t& e)
+		{
+			e.stat_ = true;
+			std::string fn = path;
+			fn += '/';
+			fn += e.name_;
+			struct stat st;
+			if(stat(fn.c_str(), &st) != 0) return false;
+			e.dir_  = S_ISDIR(st.st_mode);
+			e.size_ = st.st_size;
+			e.time_ = st.st_mtime;
+			e.mode_ = st.st_mode;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ディレクトリーの名前だけを走査（I/O） @n
+					d_type でディレクトリーが判る場合、stat は後回しにする。
+			@param[in]	path	パス
+			@param[out]	list	エントリー（名前順）
+			@return 失敗したら「false」
+		*/
+		//-----------------------------------------------------------------//
+		static bool scan(const std::string& path, entries& list)
+		{
+			list.clear();
+#ifdef WIN32
+			file_infos fis;
+			if(!create_file_list(path, fis)) return false;
+			for(const auto& fi : fis) {
+				entry_t e(fi.get_name(), fi.is_directory());
+				e.stat_ = true;
+				e.size_ = fi.get_size();
+				e.time_ = fi.get_time();
+				e.mode_ = fi.get_mode();
+				list.push_back(e);
+			}
+#else
+			DIR* dir = opendir(path.c_str());
+			if(dir == nullptr) return false;
+			struct dirent* ent;
+			while((ent = readdir(dir)) != nullptr) {
+				entry_t e(ent->d_name);
+#ifdef _DIRENT_HAVE_D_TYPE
+				if(ent->d_type == DT_DIR) {
+					e.dir_ = true;
+				} else if(ent->d_type == DT_UNKNOWN || ent->d_type == DT_LNK) {
+					if(!fill_stat(path, e)) continue;
+				}
+#else
+				if(!fill_stat(path, e)) continue;
+#endif
+				list.push_back(e);
+			}
+			closedir(dir);
+#endif
+			std::sort(list.begin(), list.end());
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	キャッシュが有効か検査 @n
+					inotify で監視出来ないディレクトリー（ネットワーク等）は、@n
+					有効でも stat を取り直す（値は残したまま、遅延で更新）。
+			@param[in]	path	パス
+			@param[in]	mtime	ディレクトリーの更新時間（dir_time）
+			@return 有効なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool find(const std::string& path, time_t mtime)
+		{
+#ifdef WIN32
+			return false;
+#else
+			auto it = dirs_.find(path);
+			if(it == dirs_.end()) return false;
+			dir_t& d = it->second;
+			d.use_ = ++use_;
+			if(d.dirty_ || d.mtime_ != mtime) return false;
+			if(d.wd_ < 0) {
+				for(auto& e : d.list_) {
+					e.stat_ = false;
+					e.gen_ = ++gen_;
+				}
+				d.lazy_ = true;
+			}
+			return true;
+#endif
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	走査結果を反映 @n
+					名前が同じエントリーは、取得済みの stat を引き継ぐ。
+			@param[in]	path	パス
+			@param[in]	list	走査結果（scan）
+			@param[in]	mtime	ディレクトリーの更新時間
+		*/
+		//-----------------------------------------------------------------//
+		void update(const std::string& path, entries& list, time_t mtime)
+		{
+			dir_t& d = dirs_[path];
+			bool lazy = false;
+			for(auto& e : list) {
+				if(!e.stat_) {
+					auto it = find_(d.list_, e.name_);
+					if(it != d.list_.end() && it->dir_ == e.dir_) {
+						e = *it;
+					}
+					if(!e.stat_) lazy = true;
+				}
+			}
+			d.list_.swap(list);
+			d.mtime_ = mtime;
+			d.dirty_ = false;
+			d.lazy_ = lazy;
+			d.rev_ = ++serial_;
+			d.use_ = ++use_;
+			watch_(path, d);
+			evict_(path);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	キャッシュから削除
+			@param[in]	path	パス
+		*/
+		//-----------------------------------------------------------------//
+		void erase(const std::string& path)
+		{
+			auto it = dirs_.find(path);
+			if(it == dirs_.end()) return;
+			unwatch_(it->second);
+			dirs_.erase(it);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	再スキャンが必要か検査
+			@param[in]	path	パス
+			@return 必要なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool is_dirty(const std::string& path) const
+		{
+			auto it = dirs_.find(path);
+			if(it == dirs_.end()) return false;
+			return it->second.dirty_;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ディレクトリーの更新時間を更新（inotify で差分を反映した後）
+			@param[in]	path	パス
+			@param[in]	mtime	更新時間
+		*/
+		//-----------------------------------------------------------------//
+		void set_time(const std::string& path, time_t mtime)
+		{
+			auto it = dirs_.find(path);
+			if(it == dirs_.end()) return;
+			it->second.mtime_ = mtime;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	リビジョンを取得（エントリーの変化で進む）
+			@param[in]	path	パス
+			@return リビジョン（キャッシュに無い場合０）
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_revision(const std::string& path) const
+		{
+			auto it = dirs_.find(path);
+			if(it == dirs_.end()) return 0;
+			return it->second.rev_;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ファイル情報郡を取得
+			@param[in]	path	パス
+			@param[in]	filter	拡張子フィルター
+			@param[out]	infos	ファイル情報郡
+			@param[out]	rev		リビジョン
+			@return キャッシュに無い場合「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool get(const std::string& path, const std::string& filter, file_infos& infos, uint32_t& rev)
+		{
+			infos.clear();
+			auto it = dirs_.find(path);
+			if(it == dirs_.end()) return false;
+			const dir_t& d = it->second;
+			infos.reserve(d.list_.size());
+			for(const auto& e : d.list_) {
+				infos.emplace_back(e.name_, e.dir_, e.size_, e.time_, e.mode_);
+			}
+			if(!filter.empty()) {
+				infos = filter_file_infos(infos, filter);
+			}
+			rev = d.rev_;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	stat の取得待ちを集める（最近使ったディレクトリーから）
+			@param[out]	path	ディレクトリーのパス
+			@param[out]	list	エントリー
+			@param[in]	max		最大数
+			@return 取得待ちが無い場合「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool pending(std::string& path, entries& list, uint32_t max)
+		{
+			list.clear();
+			while(1) {
+				auto sel = dirs_.end();
+				for(auto it = dirs_.begin(); it != dirs_.end(); ++it) {
+					if(!it->second.lazy_) continue;
+					if(sel == dirs_.end() || it->second.use_ > sel->second.use_) sel = it;
+				}
+				if(sel == dirs_.end()) return false;
+
+				for(const auto& e : sel->second.list_) {
+					if(e.stat_) continue;
+					list.push_back(e);
+					if(list.size() >= max) break;
+				}
+				if(!list.empty()) {
+					path = sel->first;
+					return true;
+				}
+				sel->second.lazy_ = false;
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	取得した stat を反映 @n
+					取得中にイベントで変化したエントリー（世代が違う）は捨てて、@n
+					取得待ちのまま残す。
+			@param[in]	path	ディレクトリーのパス
+			@param[in]	list	エントリー（fill_stat 済み）
+		*/
+		//-----------------------------------------------------------------//
+		void apply_stat(const std::string& path, const entries& list)
+		{
+			auto dt = dirs_.find(path);
+			if(dt == dirs_.end()) return;
+			dir_t& d = dt->second;
+			for(const auto& e : list) {
+				auto it = find_(d.list_, e.name_);
+				if(it == d.list_.end() || it->gen_ != e.gen_) continue;
+				if(it->dir_ != e.dir_ || it->size_ != e.size_ || it->time_ != e.time_ || it->mode_ != e.mode_) {
+					d.change_ = true;
+				}
+				*it = e;
+			}
+			bool remain = false;
+			for(const auto& e : d.list_) {
+				if(!e.stat_) {
+					remain = true;
+					break;
+				}
+			}
+			d.lazy_ = remain;
+			++d.batch_;
+			if(d.change_ && (!remain || (d.batch_ % rev_batch) == 0)) {
+				d.rev_ = ++serial_;
+				d.change_ = false;
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	inotify のイベントを反映
+			@param[out]	touch	エントリーが増減したディレクトリー
+		*/
+		//-----------------------------------------------------------------//
+		void service(strings& touch)
+		{
+			touch.clear();
+#ifdef __linux__
+			if(fd_ < 0) return;
+			alignas(struct inotify_event) char buf[4096];
+			while(1) {
+				auto len = read(fd_, buf, sizeof(buf));
+				if(len <= 0) break;
+				for(char* p = buf; p < (buf + len); ) {
+					const auto* ev = reinterpret_cast<const struct inotify_event*>(p);
+					event_(*ev, touch);
+					p += sizeof(struct inotify_event) + ev->len;
+				}
+			}
+			std::sort(touch.begin(), touch.end());
+			touch.erase(std::unique(touch.begin(), touch.end()), touch.end());
+#endif
+		}
+	};
+}
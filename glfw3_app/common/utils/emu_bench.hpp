@@ -0,0 +1,305 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	エミュレーター・ベンチマーク・クラス @n
+			ウィンドウ無しで、コアを指定フレーム数だけ全速で回し、@n
+			フレーム毎の時間、CPU サイクル数を集計する。@n
+			入力スクリプトは「フレーム番号 パッド値」の行で構成し、@n
+			パッド値は次の行のフレームまで保持される（'#' 以降はコメント）。@n
+			app -bench ROM [-frames n] [-warmup n] [-input script]
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2019 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/glfw3_app/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include "utils/file_io.hpp"
+#include "utils/format.hpp"
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	エミュレーター・ベンチマーク・クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class emu_bench {
+	public:
+
+		//=============================================================//
+		/*!
+			@brief	ベンチマーク設定
+		*/
+		//=============================================================//
+		struct param {
+			uint32_t	frames;		///< 計測するフレーム数
+			uint32_t	warmup;		///< 計測前に捨てるフレーム数
+			std::string	script;		///< 入力スクリプト（空なら入力無し）
+			param() : frames(3600), warmup(60), script() { }
+		};
+
+		static const uint32_t hist_num = 12;	///< ヒストグラムの段数（32us から倍々）
+
+	private:
+		struct input_t {
+			uint32_t	frame;
+			uint32_t	pad;
+		};
+
+		param					param_;
+		std::vector<input_t>	input_;
+		std::vector<uint32_t>	time_;		///< フレーム毎の時間（ナノ秒）
+		uint64_t				cycles_;
+		double					total_;
+
+		static bool number_(const std::string& s, uint32_t& val)
+		{
+			if(s.empty()) return false;
+			char* end = nullptr;
+			unsigned long v = std::strtoul(s.c_str(), &end, 0);
+			if(end == nullptr || *end != 0) return false;
+			val = static_cast<uint32_t>(v);
+			return true;
+		}
+
+		// 1 ～ 2 個のトークンに分ける
+		static std::vector<std::string> split_(const std::string& line)
+		{
+			std::vector<std::string> out;
+			std::string t;
+			for(char ch : line) {
+				if(ch == '#') break;
+				if(ch == ' ' || ch == '\t' || ch == ',') {
+					if(!t.empty()) out.push_back(t);
+					t.clear();
+				} else {
+					t += ch;
+				}
+			}
+			if(!t.empty()) out.push_back(t);
+			return out;
+		}
+
+		uint32_t percentile_(const std::vector<uint32_t>& sorted, double p) const
+		{
+			if(sorted.empty()) return 0;
+			auto n = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+			return sorted[n];
+		}
+
+	public:
+		//-------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+			@param[in]	prm	設定
+		*/
+		//-------------------------------------------------------------//
+		emu_bench(const param& prm = param()) : param_(prm), input_(), time_(),
+			cycles_(0), total_(0.0) { }
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	コマンドラインの解析 @n
+					argv[first] 以降の「-frames」「-warmup」「-input」を取り込み、@n
+					それ以外の引数は files に積む。
+			@param[in]	argc	引数の数
+			@param[in]	argv	引数
+			@param[in]	first	解析を始める位置
+			@param[out]	prm		設定
+			@param[out]	files	オプション以外の引数
+			@return 不正なオプションがあれば「false」
+		*/
+		//-------------------------------------------------------------//
+		static bool parse(int argc, char** argv, int first, param& prm, std::vector<std::string>& files)
+		{
+			for(int i = first; i < argc; ++i) {
+				std::string s = argv[i];
+				if(s == "-frames" && (i + 1) < argc) {
+					if(!number_(argv[++i], prm.frames) || prm.frames == 0) return false;
+				} else if(s == "-warmup" && (i + 1) < argc) {
+					if(!number_(argv[++i], prm.warmup)) return false;
+				} else if(s == "-input" && (i + 1) < argc) {
+					prm.script = argv[++i];
+				} else if(!s.empty() && s[0] == '-') {
+					return false;
+				} else {
+					files.push_back(s);
+				}
+			}
+			return true;
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	入力スクリプトの読み込み（param の script）
+			@return 読めない、又は書式エラーなら「false」
+		*/
+		//-------------------------------------------------------------//
+		bool load_script()
+		{
+			input_.clear();
+			if(param_.script.empty()) return true;
+
+			utils::file_io fin;
+			if(!fin.open(param_.script, "rb")) {
+				utils::format("Can't open input script: '%s'\n") % param_.script.c_str();
+				return false;
+			}
+			uint32_t no = 0;
+			while(!fin.eof()) {
+				auto line = fin.get_line();
+				++no;
+				auto ss = split_(line);
+				if(ss.empty()) continue;
+				input_t t;
+				if(ss.size() != 2 || !number_(ss[0], t.frame) || !number_(ss[1], t.pad)) {
+					utils::format("Input script error (%u): '%s'\n") % no % line.c_str();
+					return false;
+				}
+				input_.push_back(t);
+			}
+			std::stable_sort(input_.begin(), input_.end(),
+				[](const input_t& a, const input_t& b) { return a.frame < b.frame; });
+			return true;
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	フレームの入力を取得
+			@param[in]	frame	フレーム番号（ウォームアップを含む通し番号）
+			@return パッド値
+		*/
+		//-------------------------------------------------------------//
+		uint32_t get_input(uint32_t frame) const
+		{
+			auto it = std::upper_bound(input_.begin(), input_.end(), frame,
+				[](uint32_t f, const input_t& t) { return f < t.frame; });
+			if(it == input_.begin()) return 0;
+			return (--it)->pad;
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	実行 @n
+					step は、パッド値を受け取って１フレーム進め、@n
+					実行した CPU サイクル数を返す関数。
+			@param[in]	step	フレーム関数
+		*/
+		//-------------------------------------------------------------//
+		template <class STEP>
+		void run(STEP step)
+		{
+			time_.clear();
+			time_.reserve(param_.frames);
+			cycles_ = 0;
+			total_ = 0.0;
+
+			for(uint32_t i = 0; i < param_.warmup; ++i) {
+				step(get_input(i));
+			}
+
+			typedef std::chrono::steady_clock clock;
+			auto org = clock::now();
+			auto t0 = org;
+			for(uint32_t i = 0; i < param_.frames; ++i) {
+				cycles_ += step(get_input(param_.warmup + i));
+				auto t1 = clock::now();
+				auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+				time_.push_back(static_cast<uint32_t>(std::min<int64_t>(ns, 0xffffffff)));
+				t0 = t1;
+			}
+			total_ = std::chrono::duration<double>(t0 - org).count();
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	ヒストグラムの段を取得
+			@param[in]	ns	フレーム時間（ナノ秒）
+			@return 段（0: 32us 未満、n: 32us * 2^(n-1) 以上）
+		*/
+		//-------------------------------------------------------------//
+		static uint32_t hist_index(uint32_t ns)
+		{
+			uint32_t us = ns / 1000;
+			uint32_t idx = 0;
+			for(uint32_t lim = 32; idx < (hist_num - 1) && us >= lim; lim <<= 1) {
+				++idx;
+			}
+			return idx;
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	計測時間を取得
+			@return 計測時間（秒）
+		*/
+		//-------------------------------------------------------------//
+		double get_total() const { return total_; }
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	フレーム毎の時間を取得
+			@return フレーム毎の時間（ナノ秒）
+		*/
+		//-------------------------------------------------------------//
+		const std::vector<uint32_t>& get_times() const { return time_; }
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	結果の表示
+			@param[in]	name	コアの名前
+			@param[in]	rate	実機のフレーム・レート（実時間比の計算）
+		*/
+		//-------------------------------------------------------------//
+		void report(const char* name, double rate) const
+		{
+			if(time_.empty() || total_ <= 0.0) return;
+
+			std::vector<uint32_t> s = time_;
+			std::sort(s.begin(), s.end());
+			double fps = static_cast<double>(time_.size()) / total_;
+
+			utils::format("Core:      %s\n") % name;
+			utils::format("Frames:    %u (+%u warmup), %5.3f [sec]\n")
+				% static_cast<uint32_t>(time_.size()) % param_.warmup % total_;
+			utils::format("Speed:     %5.1f [fps] (%4.1f x real-time)\n") % fps % (fps / rate);
+			utils::format("Cycles:    %5.2f [MHz] (%u / frame)\n")
+				% (static_cast<double>(cycles_) / total_ * 1e-6)
+				% static_cast<uint32_t>(cycles_ / time_.size());
+			utils::format("Frame:     avg %5.1f, p50 %5.1f, p90 %5.1f, p99 %5.1f, max %5.1f [us]\n")
+				% (total_ * 1e6 / time_.size())
+				% (percentile_(s, 0.5) * 1e-3) % (percentile_(s, 0.9) * 1e-3)
+				% (percentile_(s, 0.99) * 1e-3) % (s.back() * 1e-3);
+
+			uint32_t hist[hist_num] = { 0 };
+			for(auto ns : time_) {
+				++hist[hist_index(ns)];
+			}
+			uint32_t peak = *std::max_element(hist, hist + hist_num);
+			for(uint32_t i = 0; i < hist_num; ++i) {
+				if(hist[i] == 0) continue;
+				uint32_t lo = i == 0 ? 0 : (32u << (i - 1));
+				std::string bar(static_cast<size_t>(hist[i]) * 40 / peak + 1, '#');
+				if(i < (hist_num - 1)) {
+					utils::format("  %6u - %6u us: %6u %s\n") % lo % ((32u << i) - 1) % hist[i] % bar.c_str();
+				} else {
+					utils::format("  %6u -        us: %6u %s\n") % lo % hist[i] % bar.c_str();
+				}
+			}
+		}
+	};
+}
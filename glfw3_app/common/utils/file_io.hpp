@@ -13,8 +13,12 @@
 #include <cstdio>
 #include <memory>
 #include <cstring>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
 #include "utils/string_utils.hpp"
 #include "utils/format.hpp"
+#include "utils/file_map.hpp"
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <dirent.h>
@@ -143,11 +147,16 @@ namespace utils {
 
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	/*!
-		@brief	ファイル入出力・クラス
+		@brief	ファイル入出力・クラス @n
+				読み込み専用でオープンした通常ファイルは、記憶領域として扱う。@n
+				（map_threshold 未満は一括読み込み、以上はメモリー・マップ）@n
+				get_char、read、get<T> は libc を経由せず、バッファから取り出す。
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	class file_io {
 	public:
+		static const size_t map_threshold = 256 * 1024;	///< これ以上のファイルはマップする
+
 		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 		/*!
 			@brief	seek タイプ
@@ -173,6 +182,10 @@ namespace utils {
 		void*	w_buff_;
 		const char*			rbuff_;
 		std::vector<char>	wbuff_;
+		std::vector<char>	rdata_;		///< 一括読み込みしたファイル
+		file_map			map_;		///< マップしたファイル
+		std::vector<char>	span_;		///< read_span 用（FILE* の場合）
+		bool				eof_;		///< 記憶領域化したファイルの終端（feof 相当）
 
 		size_t	fpos_;
 		size_t	size_;
@@ -195,6 +208,35 @@ namespace utils {
 
 		bool	cr_;
 
+		// 読み込み専用のファイルを記憶領域に置き換える（失敗したら FILE* のまま）
+		void load_(const std::string& mode) {
+			if(!read_mode_ || write_mode_ || append_mode_ || mode.find('+') != std::string::npos) return;
+#ifdef WIN32
+			if(!binary_mode_) return;	// テキスト・モードの改行変換があるので
+#endif
+			struct stat st;
+			if(fstat(fileno(fp_), &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) return;
+			size_t size = st.st_size;
+			if(size >= map_threshold) {
+				if(!map_.open(fpath_)) return;
+				rbuff_ = reinterpret_cast<const char*>(map_.get());
+				size_ = map_.size();
+			} else {
+				rdata_.resize(size);
+				if(fread(&rdata_[0], 1, size, fp_) != size) {
+					rdata_.clear();
+					rewind(fp_);
+					return;
+				}
+				rbuff_ = &rdata_[0];
+				size_ = size;
+			}
+			fclose(fp_);
+			fp_ = 0;
+			fpos_ = 0;
+			eof_ = false;
+		}
+
 	public:
 
 		//-----------------------------------------------------------------//
@@ -203,7 +245,8 @@ namespace utils {
 		*/
 		//-----------------------------------------------------------------//
 		file_io() : count_(0), open_(false), file_(false),
-					fp_(0), w_buff_(0), rbuff_(0), fpos_(0), size_(0),
+					fp_(0), w_buff_(0), rbuff_(0), wbuff_(), rdata_(), map_(), span_(), eof_(false),
+					fpos_(0), size_(0),
 					binary_mode_(true), read_mode_(false), write_mode_(false),
 					cr_(false) { }
 
@@ -250,6 +293,7 @@ namespace utils {
 				make_file_mode_(mode.c_str());
 				open_ = true;
 				++count_;
+				load_(mode);
 				return true;
 			}
 		}
@@ -374,6 +418,8 @@ namespace utils {
 			if(fp_) {
 				if(feof(fp_)) return true;
 				else return false;
+			} else if(file_) {
+				return eof_;
 			} else {
 				if(fpos_ >= size_) return true;
 				else return false;
@@ -454,6 +500,7 @@ namespace utils {
 				}
 				if(pos <= size_) {
 					fpos_ = pos;
+					eof_ = false;
 					return true;
 				} else {
 					return false;
@@ -485,6 +532,7 @@ namespace utils {
 						fpos_++;
 						return true;
 					} else {
+						eof_ = true;
 						return false;
 					}
 				}
@@ -506,14 +554,16 @@ namespace utils {
 			if(fp_) {
 				return fread(ptr, size, num, fp_);
 			} else {
-				char *p = static_cast<char*>(ptr);
-				size_t i;
-				for(i = 0; i < (size * num); ++i) {
-					char c;
-					if(get_char(c) == false) { return i / size; }
-					*p++ = c;
+				if(!open_ || rbuff_ == 0 || size == 0) return 0;
+				size_t len = size * num;
+				size_t rem = fpos_ < size_ ? (size_ - fpos_) : 0;
+				if(len > rem) {
+					len = rem;
+					eof_ = true;
 				}
-				return i / size;
+				memcpy(ptr, rbuff_ + fpos_, len);
+				fpos_ += len;
+				return len / size;
 			}
 		}
 
@@ -529,6 +579,69 @@ namespace utils {
 		size_t read(void* ptr, size_t size) { return read(ptr, 1, size); }
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	連続領域の読み出し @n
+					記憶領域ならコピーせずに直接指し、FILE* なら内部バッファに読む。@n
+					ポインターは、次の read_span、又は close まで有効。
+			@param[in]	len	バイト数
+			@return	先頭（足りない場合 nullptr で、位置は変えない）
+		*/
+		//-----------------------------------------------------------------//
+		const void* read_span(size_t len) {
+			if(fp_) {
+				span_.resize(len + 1);
+				size_t n = fread(&span_[0], 1, len, fp_);
+				if(n != len) {
+					fseek(fp_, -static_cast<long>(n), SEEK_CUR);
+					return nullptr;
+				}
+				return &span_[0];
+			} else {
+				if(!open_ || rbuff_ == 0) return nullptr;
+				if(fpos_ > size_ || len > (size_ - fpos_)) {
+					eof_ = true;
+					return nullptr;
+				}
+				const char* p = rbuff_ + fpos_;
+				fpos_ += len;
+				return p;
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	T の配列を一括で読み込み
+			@param[out]	dst	読み込み先
+			@param[in]	num	個数
+			@return	読み込んだ数
+		*/
+		//-----------------------------------------------------------------//
+		template <typename T>
+		size_t get_array(T* dst, size_t num) {
+			static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+			if(num == 0) return 0;
+			return read(dst, sizeof(T), num);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	T の配列を一括で読み込み
+			@param[out]	dst	読み込み先（num 個に変更）
+			@param[in]	num	個数
+			@return	全て読めたら「true」
+		*/
+		//-----------------------------------------------------------------//
+		template <typename T>
+		bool get_array(std::vector<T>& dst, size_t num) {
+			dst.resize(num);
+			if(num == 0) return true;
+			return get_array(&dst[0], num) == num;
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	文字列の読み込み
@@ -779,6 +892,9 @@ namespace utils {
 		*/
 		//-----------------------------------------------------------------//
 		size_t write(const void* ptr, size_t size, size_t num) {
+			if(fp_) {
+				return fwrite(ptr, size, num, fp_);
+			}
 			const char*p = static_cast<const char*>(ptr);
 			size_t i;
 			for(i = 0; i < (size * num); ++i) {
@@ -928,6 +1044,16 @@ namespace utils {
 					fclose(fp_);
 					fp_ = 0;
 				}
+				if(file_) {	// 記憶領域化したファイルを解放
+					map_.close();
+					rdata_.clear();
+					rdata_.shrink_to_fit();
+					rbuff_ = 0;
+					size_ = 0;
+					fpos_ = 0;
+				}
+				span_.clear();
+				eof_ = false;
 				open_ = false;
 				return true;
 			} else {
@@ -0,0 +1,131 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	ファイルのメモリー・マップ（読み込み専用） @n
+			ページは触れた所だけ読み込まれるので、大きなファイルも直ぐに開ける。@n
+			※OS に依存する実装は、device.cpp に存在
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2023 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/glfw3_app/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <string>
+
+namespace utils {
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	ファイルをメモリーにマップする（UTF8） @n
+				※実装は、device.cpp に存在
+		@param[in]	fn		ファイル名
+		@param[out]	size	ファイル・サイズ
+		@param[out]	handle	解放用ハンドル
+		@return マップしたアドレス（失敗、又は空のファイルなら nullptr）
+	*/
+	//-----------------------------------------------------------------//
+	const void* map_file(const std::string& fn, uint64_t& size, void*& handle);
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	マップの解除 @n
+				※実装は、device.cpp に存在
+		@param[in]	ptr		map_file が返したアドレス
+		@param[in]	size	ファイル・サイズ
+		@param[in]	handle	解放用ハンドル
+	*/
+	//-----------------------------------------------------------------//
+	void unmap_file(const void* ptr, uint64_t size, void* handle);
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	ファイル・マップ・クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class file_map {
+
+		const uint8_t*	ptr_;
+		uint64_t		size_;
+		void*			handle_;
+
+		file_map(const file_map&) = delete;
+		file_map& operator = (const file_map&) = delete;
+
+	public:
+		//-------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		*/
+		//-------------------------------------------------------------//
+		file_map() noexcept : ptr_(nullptr), size_(0), handle_(nullptr) { }
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	デストラクター
+		*/
+		//-------------------------------------------------------------//
+		~file_map() { close(); }
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	オープン
+			@param[in]	fn	ファイル名
+			@return 成功なら「true」
+		*/
+		//-------------------------------------------------------------//
+		bool open(const std::string& fn)
+		{
+			close();
+			ptr_ = static_cast<const uint8_t*>(map_file(fn, size_, handle_));
+			return ptr_ != nullptr;
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	クローズ
+		*/
+		//-------------------------------------------------------------//
+		void close()
+		{
+			if(ptr_ != nullptr) {
+				unmap_file(ptr_, size_, handle_);
+			}
+			ptr_ = nullptr;
+			size_ = 0;
+			handle_ = nullptr;
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	オープンしているか
+			@return オープンしていれば「true」
+		*/
+		//-------------------------------------------------------------//
+		bool is_open() const noexcept { return ptr_ != nullptr; }
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	先頭アドレスを取得
+			@return 先頭アドレス
+		*/
+		//-------------------------------------------------------------//
+		const uint8_t* get() const noexcept { return ptr_; }
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	サイズを取得
+			@return サイズ
+		*/
+		//-------------------------------------------------------------//
+		uint64_t size() const noexcept { return size_; }
+	};
+}
@@ -2,7 +2,9 @@
 //=====================================================================//
 /*!	@file
 	@brief	ディレクトリー情報取得クラス @n
-			ディレクトリー情報取得をスレッドにて並行して行う
+			ディレクトリー情報取得をスレッドにて並行して行う @n
+			取得した情報は dir_cache に保持し、変化した分だけを更新する。@n
+			stat は遅延して取得し、反映するとリビジョンが進む。
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2017, 2023 Kunihito Hiramatsu @n
 				Released under the MIT license @n
@@ -13,6 +15,7 @@
 #include <string>
 #include "utils/drive_info.hpp"
 #include "utils/file_info.hpp"
+#include "utils/dir_cache.hpp"
 #include "utils/string_utils.hpp"
 #include <pthread.h>
 #include <unistd.h>
@@ -34,9 +37,13 @@ namespace utils {
 			std::string			path_;
 			std::string			filter_;
 			file_infos			infos_;
-			file_t() : loop_(true), idx_(0), ans_(0) { }
+			uint32_t			rev_;
+			dir_cache			cache_;
+			file_t() : loop_(true), idx_(0), ans_(0), rev_(0) { }
 		};
 
+		static const uint32_t stat_batch = 256;	///< 一度に取得する stat の数
+
 		volatile uint32_t	ans_;
 
 		uint32_t	init_;
@@ -57,26 +64,90 @@ namespace utils {
 #endif
 		}
 
+		// ディレクトリーを走査してキャッシュを更新（I/O はロックの外）
+		static void scan_(file_t& t, const std::string& path)
+		{
+			time_t mt = 0;
+			bool ok = dir_cache::dir_time(path, mt);
+			pthread_mutex_lock(&t.sync_);
+			bool hit = ok && t.cache_.find(path, mt);
+			pthread_mutex_unlock(&t.sync_);
+			if(hit) return;
+
+			dir_cache::entries list;
+			ok = ok && dir_cache::scan(path, list);
+			pthread_mutex_lock(&t.sync_);
+			if(ok) {
+				t.cache_.update(path, list, mt);
+			} else {
+				t.cache_.erase(path);
+			}
+			pthread_mutex_unlock(&t.sync_);
+		}
+
+		// inotify の反映、再スキャン、遅延 stat（続きがあれば「true」）
+		static bool lazy_(file_t& t)
+		{
+			strings touch;
+			pthread_mutex_lock(&t.sync_);
+			t.cache_.service(touch);
+			std::string path = t.path_;
+			bool dirty = t.cache_.is_dirty(path);
+			pthread_mutex_unlock(&t.sync_);
+
+			for(const auto& s : touch) {
+				time_t mt;
+				if(dir_cache::dir_time(s, mt)) {
+					pthread_mutex_lock(&t.sync_);
+					t.cache_.set_time(s, mt);
+					pthread_mutex_unlock(&t.sync_);
+				}
+			}
+
+			if(dirty) {
+				scan_(t, path);
+			}
+
+			dir_cache::entries list;
+			pthread_mutex_lock(&t.sync_);
+			bool pend = t.cache_.pending(path, list, stat_batch);
+			pthread_mutex_unlock(&t.sync_);
+			if(pend) {
+				for(auto& e : list) {
+					dir_cache::fill_stat(path, e);
+				}
+				pthread_mutex_lock(&t.sync_);
+				t.cache_.apply_stat(path, list);
+				pthread_mutex_unlock(&t.sync_);
+			}
+			return dirty || list.size() >= stat_batch;
+		}
+
 		static void* task_(void* in)
 		{
 			file_t& t = *(static_cast<file_t*>(in));
 
-			volatile uint32_t idx = t.idx_;
+			// スレッド開始前に set_path されても取りこぼさないよう、初期値から比較
+			volatile uint32_t idx = 0;
 			while(t.loop_) {
 				if(idx != t.idx_) {
 					pthread_mutex_lock(&t.sync_);
-					t.infos_.clear();
-					if(t.filter_.empty()) {
-						t.infos_ = create_file_list(t.path_);
-					} else {
-						auto fis = create_file_list(t.path_);
-						t.infos_ = filter_file_infos(fis, t.filter_);
-					}
+					std::string path = t.path_;
 					idx = t.idx_;
-					++t.ans_;
+					pthread_mutex_unlock(&t.sync_);
+
+					scan_(t, path);
+
+					pthread_mutex_lock(&t.sync_);
+					if(idx == t.idx_) {  // 走査中に次の要求が来た場合は捨てる
+						t.cache_.get(path, t.filter_, t.infos_, t.rev_);
+						++t.ans_;
+					}
 					pthread_mutex_unlock(&t.sync_);
 				} else {
-					sleep_(10);
+					if(!lazy_(t)) {
+						sleep_(10);
+					}
 				}
 			}
 
@@ -180,5 +251,48 @@ namespace utils {
 			}
 			return file_t_.infos_;
 		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	get で取得したファイル情報郡のリビジョンを取得
+			@return リビジョン
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_revision() const { return file_t_.rev_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	キャッシュされたディレクトリーのリビジョンを取得 @n
+					エントリーの増減、stat の取得、変化で進む。
+			@param[in]	path	パス
+			@return リビジョン（キャッシュに無い場合０）
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_revision(const std::string& path) {
+			pthread_mutex_lock(&file_t_.sync_);
+			auto rev = file_t_.cache_.get_revision(path);
+			pthread_mutex_unlock(&file_t_.sync_);
+			return rev;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	キャッシュからファイル情報郡を取得（待たない）
+			@param[in]	path	パス
+			@param[in]	filter	拡張子フィルター
+			@param[out]	infos	ファイル情報郡
+			@param[out]	rev		リビジョン
+			@return キャッシュに無い場合「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool fetch(const std::string& path, const std::string& filter, file_infos& infos, uint32_t& rev) {
+			pthread_mutex_lock(&file_t_.sync_);
+			bool ret = file_t_.cache_.get(path, filter, infos, rev);
+			pthread_mutex_unlock(&file_t_.sync_);
+			return ret;
+		}
 	};
 }
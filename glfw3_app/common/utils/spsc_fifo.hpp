@@ -0,0 +1,165 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	Single-Producer/Single-Consumer ロックフリー FIFO テンプレート @n
+			fixed_fifo と同じ操作を、スレッド間でロック無しに行う。@n
+			格納側スレッド、取得側スレッドがそれぞれ一つの場合に限り安全。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017, 2019 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/glfw3_app/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <atomic>
+#include <utility>
+
+namespace utils {
+
+    //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+    /*!
+        @brief  SPSC ロックフリー FIFO クラス @n
+				位置は単調増加させ、SIZE（２のべき乗）でマスクする。@n
+				get/put 位置は、フォルス・シェアリングを避ける為、別のキャッシュラインに置く。
+		@param[in]	UNIT	基本形
+		@param[in]	SIZE	バッファサイズ（２のべき乗）
+    */
+    //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class UNIT, uint32_t SIZE>
+	class spsc_fifo {
+
+		static_assert(SIZE >= 2 && (SIZE & (SIZE - 1)) == 0, "SIZE must be a power of two");
+
+		static const uint32_t cache_line_ = 64;
+		static const uint32_t mask_ = SIZE - 1;
+
+		alignas(cache_line_) std::atomic<uint32_t>	get_;
+		alignas(cache_line_) std::atomic<uint32_t>	put_;
+
+		alignas(cache_line_) UNIT	buff_[SIZE];
+
+	public:
+        //-----------------------------------------------------------------//
+        /*!
+            @brief  コンストラクター
+        */
+        //-----------------------------------------------------------------//
+		spsc_fifo() noexcept : get_(0), put_(0) { }
+
+
+        //-----------------------------------------------------------------//
+        /*!
+            @brief  バッファのサイズを返す
+			@return	バッファのサイズ
+        */
+        //-----------------------------------------------------------------//
+		inline uint32_t size() const noexcept { return SIZE; }
+
+
+        //-----------------------------------------------------------------//
+        /*!
+            @brief  長さを返す
+			@return	長さ
+        */
+        //-----------------------------------------------------------------//
+		uint32_t length() const noexcept {
+			return put_.load(std::memory_order_acquire) - get_.load(std::memory_order_acquire);
+		}
+
+
+        //-----------------------------------------------------------------//
+        /*!
+            @brief  空き容量を返す
+			@return	空き容量
+        */
+        //-----------------------------------------------------------------//
+		uint32_t space() const noexcept { return SIZE - length(); }
+
+
+        //-----------------------------------------------------------------//
+        /*!
+            @brief  クリア（格納側、取得側の両方が停止している時に限る）
+        */
+        //-----------------------------------------------------------------//
+		void clear() noexcept {
+			get_.store(0, std::memory_order_relaxed);
+			put_.store(0, std::memory_order_release);
+		}
+
+
+        //-----------------------------------------------------------------//
+        /*!
+            @brief  値の格納（格納側スレッド）
+			@param[in]	v	値
+			@return	満杯の場合「false」
+        */
+        //-----------------------------------------------------------------//
+		bool put(const UNIT& v) noexcept {
+			uint32_t put = put_.load(std::memory_order_relaxed);
+			if((put - get_.load(std::memory_order_acquire)) >= SIZE) return false;
+			buff_[put & mask_] = v;
+			put_.store(put + 1, std::memory_order_release);
+			return true;
+		}
+
+
+        //-----------------------------------------------------------------//
+        /*!
+            @brief  値の取得（取得側スレッド）
+			@param[out]	v	値を受け取る参照
+			@return	空の場合「false」
+        */
+        //-----------------------------------------------------------------//
+		bool get(UNIT& v) noexcept {
+			uint32_t get = get_.load(std::memory_order_relaxed);
+			if(get == put_.load(std::memory_order_acquire)) return false;
+			v = std::move(buff_[get & mask_]);
+			get_.store(get + 1, std::memory_order_release);
+			return true;
+		}
+
+
+        //-----------------------------------------------------------------//
+        /*!
+            @brief  一括格納（格納側スレッド）
+			@param[in]	src	ソース
+			@param[in]	len	格納数
+			@return	格納出来た数
+        */
+        //-----------------------------------------------------------------//
+		uint32_t write(const UNIT* src, uint32_t len) noexcept {
+			uint32_t put = put_.load(std::memory_order_relaxed);
+			uint32_t spc = SIZE - (put - get_.load(std::memory_order_acquire));
+			if(len > spc) len = spc;
+			uint32_t pos = put & mask_;
+			uint32_t n = SIZE - pos;
+			if(n > len) n = len;
+			for(uint32_t i = 0; i < n; ++i) buff_[pos + i] = src[i];
+			for(uint32_t i = n; i < len; ++i) buff_[i - n] = src[i];
+			put_.store(put + len, std::memory_order_release);
+			return len;
+		}
+
+
+        //-----------------------------------------------------------------//
+        /*!
+            @brief  一括取得（取得側スレッド）
+			@param[out]	dst	コピー先
+			@param[in]	len	取得数
+			@return	取得出来た数
+        */
+        //-----------------------------------------------------------------//
+		uint32_t read(UNIT* dst, uint32_t len) noexcept {
+			uint32_t get = get_.load(std::memory_order_relaxed);
+			uint32_t num = put_.load(std::memory_order_acquire) - get;
+			if(len > num) len = num;
+			uint32_t pos = get & mask_;
+			uint32_t n = SIZE - pos;
+			if(n > len) n = len;
+			for(uint32_t i = 0; i < n; ++i) dst[i] = std::move(buff_[pos + i]);
+			for(uint32_t i = n; i < len; ++i) dst[i] = std::move(buff_[i - n]);
+			get_.store(get + len, std::memory_order_release);
+			return len;
+		}
+	};
+}
@@ -66,6 +66,8 @@ namespace utils {
 
 		output_func	output_func_;
 
+		uint32_t	serial_;
+
 		void nl_() {
 			if(lines_.size() >= max_) {
 				lines_.pop_front();
@@ -88,7 +90,7 @@ namespace utils {
 		*/
 		//-----------------------------------------------------------------//
 		terminal(uint32_t max = 150) noexcept : cha_(), lines_(), max_(max), pos_(0), tmp_(' '),
-			auto_crlf_(false), insert_(true), last_(), output_func_(nullptr)
+			auto_crlf_(false), insert_(true), last_(), output_func_(nullptr), serial_(0)
 		{
 			line l;
 			lines_.push_back(l);
@@ -133,6 +135,7 @@ namespace utils {
 			lines_.push_back(l);
 			pos_.set(0);
 			last_.clear();
+			++serial_;
 		}
 
 
@@ -150,6 +153,7 @@ namespace utils {
 					l.resize(pos_.x);
 				}
 			}
+			++serial_;
 		}
 
 
@@ -166,6 +170,7 @@ namespace utils {
 					ch.select_ = ena;
 				}
 			}
+			++serial_;
 		}
 
 
@@ -191,6 +196,7 @@ namespace utils {
 		{
 			if(output_func_ != nullptr) output_func_(cha);
 
+			++serial_;
 			cha_.cha_ = cha;
 			switch(cha) {
 			case '\r':  // CR
@@ -309,6 +315,7 @@ namespace utils {
 				auto& l = lines_[pos.y];
 				if(pos.x >= 0 && pos.x < l.size()) {
 					l[pos.x].fc_ = col;
+					++serial_;
 				}
 			}
 		}
@@ -327,6 +334,7 @@ namespace utils {
 				auto& l = lines_[pos.y];
 				if(pos.x >= 0 && pos.x < l.size()) {
 					l[pos.x].bc_ = col;
+					++serial_;
 				}
 			}
 		}
@@ -345,6 +353,7 @@ namespace utils {
 				auto& l = lines_[pos.y];
 				if(pos.x >= 0 && pos.x < l.size()) {
 					l[pos.x].select_ = ena;
+					++serial_;
 				}
 			}
 		}
@@ -359,6 +368,15 @@ namespace utils {
 		const vtx::ipos& get_cursor() const noexcept { return pos_; }
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	変更シリアルを取得（内容が変化する度に増える）
+			@return 変更シリアル
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_serial() const noexcept { return serial_; }
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	ライン数を取得
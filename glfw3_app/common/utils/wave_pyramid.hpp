@@ -0,0 +1,238 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	波形の min/max ピラミッド @n
+			波形バッファを 1/4 ずつ縮小した min/max/平均を段毎に持ち、@n
+			任意の区間の集計を、区間の長さに依らずほぼ一定時間で求める。@n
+			波形バッファ自体は持たないので、各関数に同じバッファを渡す事。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2023 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/glfw3_app/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	波形の min/max ピラミッド・クラス
+		@param[in]	UNIT	波形値の型
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <typename UNIT>
+	class wave_pyramid {
+	public:
+		typedef std::vector<UNIT> UNITS;
+
+		//=============================================================//
+		/*!
+			@brief	集計結果
+		*/
+		//=============================================================//
+		struct acc_t {
+			UNIT		min_;
+			UNIT		max_;
+			double		sum_;
+			uint64_t	num_;
+			acc_t() : min_(0), max_(0), sum_(0.0), num_(0) { }
+		};
+
+	private:
+		static const uint32_t SHIFT = 2;	///< ピラミッド１段の縮小（1/4）
+		static const uint32_t MASK = (1 << SHIFT) - 1;
+
+		struct node_t {
+			UNIT	min_;
+			UNIT	max_;
+			float	mean_;
+		};
+		typedef std::vector<node_t> NODES;
+
+		std::vector<NODES>	level_;		///< [n] は 4^(n+1) サンプル単位の min/max/平均
+		bool				valid_;
+
+		// レベル（0 は生データ）の要素数
+		uint32_t level_size_(const UNITS& u, uint32_t lvl) const noexcept
+		{
+			if(lvl == 0) return u.size();
+			return level_[lvl - 1].size();
+		}
+
+
+		// レベルの要素が持つサンプル数（末尾の要素だけ端数になる）
+		static uint32_t level_weight_(const UNITS& u, uint32_t lvl, uint32_t idx) noexcept
+		{
+			uint32_t sh = lvl * SHIFT;
+			uint64_t org = static_cast<uint64_t>(idx) << sh;
+			return std::min(static_cast<uint64_t>(u.size()) - org, static_cast<uint64_t>(1) << sh);
+		}
+
+
+		node_t level_node_(const UNITS& u, uint32_t lvl, uint32_t idx) const noexcept
+		{
+			if(lvl == 0) {
+				auto w = u[idx];
+				return node_t{ w, w, static_cast<float>(w) };
+			}
+			return level_[lvl - 1][idx];
+		}
+
+
+		// レベル（1 以上）の要素を、一つ下のレベルから作り直す
+		void build_node_(const UNITS& u, uint32_t lvl, uint32_t idx) noexcept
+		{
+			uint32_t org = idx << SHIFT;
+			uint32_t end = std::min(org + MASK + 1, level_size_(u, lvl - 1));
+			auto a = level_node_(u, lvl - 1, org);
+			double num = level_weight_(u, lvl - 1, org);
+			double sum = a.mean_ * num;
+			for(uint32_t i = org + 1; i < end; ++i) {
+				auto b = level_node_(u, lvl - 1, i);
+				if(a.min_ > b.min_) a.min_ = b.min_;
+				if(a.max_ < b.max_) a.max_ = b.max_;
+				double w = level_weight_(u, lvl - 1, i);
+				sum += b.mean_ * w;
+				num += w;
+			}
+			a.mean_ = static_cast<float>(sum / num);
+			level_[lvl - 1][idx] = a;
+		}
+
+
+		void accumulate_(const UNITS& u, uint32_t lvl, uint32_t idx, acc_t& a) const noexcept
+		{
+			auto n = level_node_(u, lvl, idx);
+			uint32_t w = level_weight_(u, lvl, idx);
+			if(a.num_ == 0) {
+				a.min_ = n.min_;
+				a.max_ = n.max_;
+			} else {
+				if(a.min_ > n.min_) a.min_ = n.min_;
+				if(a.max_ < n.max_) a.max_ = n.max_;
+			}
+			a.sum_ += static_cast<double>(n.mean_) * w;
+			a.num_ += w;
+		}
+
+
+		// 生データ [org, end) の集計（端数は下のレベル、残りは上のレベルで拾う）
+		void query_(const UNITS& u, uint32_t org, uint32_t end, acc_t& a) const noexcept
+		{
+			uint32_t lvl = 0;
+			while(org < end) {
+				if(lvl >= level_.size()) {
+					for(; org < end; ++org) accumulate_(u, lvl, org, a);
+					break;
+				}
+				while(org < end && (org & MASK) != 0) {
+					accumulate_(u, lvl, org, a);
+					++org;
+				}
+				if(end != level_size_(u, lvl)) {
+					while(org < end && (end & MASK) != 0) {
+						--end;
+						accumulate_(u, lvl, end, a);
+					}
+				}
+				if(org >= end) break;
+				org >>= SHIFT;
+				end = (end + MASK) >> SHIFT;
+				++lvl;
+			}
+		}
+
+	public:
+		//-------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		*/
+		//-------------------------------------------------------------//
+		wave_pyramid() noexcept : level_(), valid_(false) { }
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	有効か検査
+			@return 作り直しが必要なら「false」
+		*/
+		//-------------------------------------------------------------//
+		bool is_valid() const noexcept { return valid_; }
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	無効化（波形を書き換えた、大きさを変えた場合）@n
+					次の envelope で作り直す。
+		*/
+		//-------------------------------------------------------------//
+		void invalidate() noexcept { valid_ = false; }
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	全体を作る
+			@param[in]	u	波形
+		*/
+		//-------------------------------------------------------------//
+		void build(const UNITS& u) noexcept
+		{
+			level_.clear();
+			uint32_t n = u.size();
+			while(n > 1) {
+				n = (n + MASK) >> SHIFT;
+				level_.emplace_back(n);
+			}
+			for(uint32_t lvl = 1; lvl <= level_.size(); ++lvl) {
+				for(uint32_t i = 0; i < level_size_(u, lvl); ++i) {
+					build_node_(u, lvl, i);
+				}
+			}
+			valid_ = true;
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	生データ [org, end) が変更された時、上位の要素だけ作り直す @n
+					無効な場合は何もしない（次の envelope で全体を作る）。
+			@param[in]	u	波形
+			@param[in]	org	開始位置
+			@param[in]	end	終端位置
+		*/
+		//-------------------------------------------------------------//
+		void update(const UNITS& u, uint32_t org, uint32_t end) noexcept
+		{
+			if(!valid_ || org >= end) return;
+			for(uint32_t lvl = 1; lvl <= level_.size(); ++lvl) {
+				org >>= SHIFT;
+				end = ((end - 1) >> SHIFT) + 1;
+				for(uint32_t i = org; i < end; ++i) {
+					build_node_(u, lvl, i);
+				}
+			}
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	循環バッファの位置 org から len サンプルの集計
+			@param[in]	u	波形
+			@param[in]	org	開始位置（０～波形数－１）
+			@param[in]	len	サンプル数（波形数以下）
+			@param[out]	a	集計結果（既存の値に加える）
+		*/
+		//-------------------------------------------------------------//
+		void envelope(const UNITS& u, uint32_t org, uint32_t len, acc_t& a) noexcept
+		{
+			if(!valid_) build(u);
+			uint32_t sz = u.size();
+			uint32_t n = std::min(len, sz - org);
+			query_(u, org, org + n, a);
+			if(len > n) query_(u, 0, len - n, a);
+		}
+	};
+}
@@ -195,6 +195,19 @@ namespace gui {
 				utils::utf32_to_utf8(alias_, s);
 				return s;
 			}
+
+			size_t hash() const noexcept {
+				size_t h = boost::hash_range(text_.begin(), text_.end());
+				boost::hash_combine(h, font_);
+				boost::hash_combine(h, font_size_);
+				boost::hash_combine(h, alias_enable_);
+				if(alias_enable_) boost::hash_range(h, alias_.begin(), alias_.end());
+				boost::hash_combine(h, fore_color_);
+				boost::hash_combine(h, shadow_color_);
+				boost::hash_combine(h, offset_);
+				boost::hash_combine(h, cursor_);
+				return h;
+			}
 		};
 
 
@@ -423,6 +436,13 @@ namespace gui {
 
 		bool		mark_;
 
+		bool		dirty_;
+
+		vtx::irect		last_rect_;
+		widget*			last_parents_;
+		state_types		last_state_;
+		action_types	last_action_;
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
@@ -433,7 +453,8 @@ namespace gui {
 		//-----------------------------------------------------------------//
 		widget(const param& para, const std::string& sym = "") noexcept :
 			param_(para), symbol_(sym),
-			serial_(0), mark_(false)
+			serial_(0), mark_(false), dirty_(true),
+			last_rect_(0, 0, -1, -1), last_parents_(nullptr), last_state_(), last_action_()
 			{ }
 
 
@@ -499,6 +520,69 @@ namespace gui {
 		bool get_mark() const noexcept { return mark_; }
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	再描画要求を設定 @n
+					ステート、アクションの変更では自動で設定される。@n
+					パラメーターを直接書き換えて見た目を変えた場合に呼ぶ。
+			@param[in]	f	フラグ
+		*/
+		//-----------------------------------------------------------------//
+		void set_dirty(bool f = true) noexcept { dirty_ = f; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	再描画要求を取得
+			@return	再描画要求があれば「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool get_dirty() const noexcept { return dirty_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	表示内容の変化を検出 @n
+					前回の値と違っていたら、値を更新して再描画要求を設定する。@n
+					個別パラメーターの変化を update 内で検出する為に使う。
+			@param[in,out]	last	前回の値
+			@param[in]	now		現在の値
+		*/
+		//-----------------------------------------------------------------//
+		template <typename T>
+		void sync_dirty(T& last, const T& now) noexcept
+		{
+			if(!(last == now)) {
+				last = now;
+				dirty_ = true;
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	前回の検査からの変化を検出 @n
+					領域、親、ステート、アクションのどれかが変化していたら、@n
+					再描画要求を設定する。
+			@return	領域、親、クリップ方法が変化した場合「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool sync_param() noexcept
+		{
+			bool geo = last_parents_ != param_.parents_
+				|| last_rect_.org != param_.rect_.org || last_rect_.size != param_.rect_.size
+				|| last_state_[state::CLIP_PARENTS] != param_.state_[state::CLIP_PARENTS];
+			if(geo || last_state_ != param_.state_ || last_action_ != param_.action_) {
+				dirty_ = true;
+			}
+			last_rect_ = param_.rect_;
+			last_parents_ = param_.parents_;
+			last_state_ = param_.state_;
+			last_action_ = param_.action_;
+			return geo;
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	widget 型を取得
@@ -591,7 +675,11 @@ namespace gui {
 			} else {
 				param_.stall_group_ &= ~(1 << static_cast<uint32_t>(stg));
 			}
-			param_.state_[state::STALL] = param_.stall_group_ != 0;
+			bool st = param_.stall_group_ != 0;
+			if(param_.state_[state::STALL] != st) {
+				param_.state_[state::STALL] = st;
+				dirty_ = true;
+			}
 		}
 
 
@@ -602,7 +690,12 @@ namespace gui {
 			@param[in]	f	不許可の場合「false」
 		*/
 		//-----------------------------------------------------------------//
-		void set_state(state::type t, bool f = true) noexcept { param_.state_[t] = f; }
+		void set_state(state::type t, bool f = true) noexcept {
+			if(param_.state_[t] != f) {
+				param_.state_[t] = f;
+				dirty_ = true;
+			}
+		}
 
 
 		//-----------------------------------------------------------------//
@@ -622,7 +715,12 @@ namespace gui {
 			@param[in]	f	不許可の場合「false」
 		*/
 		//-----------------------------------------------------------------//
-		void set_action(action::type t, bool f = true) noexcept { param_.action_[t] = f; }
+		void set_action(action::type t, bool f = true) noexcept {
+			if(param_.action_[t] != f) {
+				param_.action_[t] = f;
+				dirty_ = true;
+			}
+		}
 
 
 		//-----------------------------------------------------------------//
@@ -57,6 +57,8 @@ namespace gui {
 		uint32_t			id_;
 		bool				exec_;
 
+		size_t				view_hash_;
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
@@ -64,7 +66,7 @@ namespace gui {
 		*/
 		//-----------------------------------------------------------------//
 		widget_button(widget_director& wd, const widget::param& bp, const param& p) noexcept :
-			widget(bp), wd_(wd), param_(p), objh_(0), id_(0), exec_(false) { }
+			widget(bp), wd_(wd), param_(p), objh_(0), id_(0), exec_(false), view_hash_(0) { }
 
 
 		//-----------------------------------------------------------------//
@@ -198,6 +200,12 @@ namespace gui {
 			if(get_selected()) {
 				++param_.id_;
 			}
+
+			// 表示内容が変化したら再描画
+			size_t h = param_.text_param_.hash();
+			boost::hash_combine(h, param_.color_param_.hash());
+			boost::hash_combine(h, param_.handle_);
+			sync_dirty(view_hash_, h);
 		}
 
 
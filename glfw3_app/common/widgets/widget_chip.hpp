@@ -77,6 +77,8 @@ namespace gui {
 
 		bool				ena_;
 
+		size_t				view_hash_;
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
@@ -84,7 +86,7 @@ namespace gui {
 		*/
 		//-----------------------------------------------------------------//
 		widget_chip(widget_director& wd, const widget::param& bp, const param& p) :
-			widget(bp), wd_(wd), param_(p), objh_(0), id_(0), ena_(false) { }
+			widget(bp), wd_(wd), param_(p), objh_(0), id_(0), ena_(false), view_hash_(0) { }
 
 
 		//-----------------------------------------------------------------//
@@ -299,6 +301,11 @@ namespace gui {
 					set_state(state::ENABLE, false);
 				}
 			}
+
+			// 表示内容が変化したら再描画
+			size_t h = param_.text_param_.hash();
+			boost::hash_combine(h, param_.color_param_.hash());
+			sync_dirty(view_hash_, h);
 		}
 
 
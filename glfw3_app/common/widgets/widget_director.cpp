@@ -125,6 +125,58 @@ namespace gui {
 	}
 
 
+	bool chain_dirty_(const widget* w)
+	{
+		while(w != nullptr) {
+			if(w->get_dirty()) return true;
+			w = w->get_param().parents_;
+		}
+		return false;
+	}
+
+
+	void widget_director::build_hit_grid_(const vtx::spos& size)
+	{
+		hit_size_.set((size.x + hit_cell_ - 1) / hit_cell_, (size.y + hit_cell_ - 1) / hit_cell_);
+		hit_grid_.resize(hit_size_.x * hit_size_.y);
+		for(auto& c : hit_grid_) {
+			c.clear();
+		}
+		for(auto w : widgets_) {
+			const vtx::irect& r = w->get_param().clip_;
+			if(r.size.x <= 0 || r.size.y <= 0) continue;
+			if(r.end_x() <= 0 || r.end_y() <= 0) continue;
+			if(r.org.x >= size.x || r.org.y >= size.y) continue;
+			int x0 = std::max(r.org.x, 0) / hit_cell_;
+			int y0 = std::max(r.org.y, 0) / hit_cell_;
+			int x1 = (std::min(r.end_x(), static_cast<int>(size.x)) - 1) / hit_cell_;
+			int y1 = (std::min(r.end_y(), static_cast<int>(size.y)) - 1) / hit_cell_;
+			for(int y = y0; y <= y1; ++y) {
+				for(int x = x0; x <= x1; ++x) {
+					hit_grid_[y * hit_size_.x + x].push_back(w);
+				}
+			}
+		}
+		hit_valid_ = true;
+	}
+
+
+	bool widget_director::mark_hit_(const vtx::ipos& pos)
+	{
+		if(!hit_valid_) return false;
+		if(pos.x < 0 || pos.y < 0) return false;
+		int x = pos.x / hit_cell_;
+		int y = pos.y / hit_cell_;
+		if(x >= hit_size_.x || y >= hit_size_.y) return false;
+
+		reset_mark();
+		for(auto w : hit_grid_[y * hit_size_.x + x]) {
+			w->set_mark();
+		}
+		return true;
+	}
+
+
 	void widget_director::parents_widget_mark_(widget* root)
 	{
 		root->set_mark();
@@ -576,6 +628,8 @@ namespace gui {
 		}
 
 		// フォーカス、選択、を決定
+		// ※空間索引が有効なら、マウス位置のセルに登録された部品だけ領域を調べる
+		bool hit = mark_hit_(vtx::ipos(msp.x, msp.y));
 		bool resize_trigger = false;
 		bool select_trigger = false;
 		for(auto w : widgets_) {
@@ -594,7 +648,7 @@ namespace gui {
 
 			// クリッピングフォーカス（クリッピング範囲）は、全てに対して評価する。
 			// ※FOCUS_ENABLE が有効な場合に限る
-			bool focus = w->get_param().clip_.is_focus(msp);
+			bool focus = (!hit || w->get_mark()) && w->get_param().clip_.is_focus(msp);
 			if(w->get_state(widget::state::FOCUS_ENABLE)) {
 				w->set_state(widget::state::FOCUS, focus);
 			}
@@ -855,6 +909,68 @@ namespace gui {
 	}
 
 
+	// 描画前の更新：変化したウィジェット（とその子）だけクリップ領域を作り直し、
+	// 再描画が必要な領域（ダメージ領域）を集める
+	void widget_director::refresh_()
+	{
+		core& core = core::get_instance();
+
+		const vtx::spos& size = core.get_rect().size;
+
+		// 並びや画面サイズが変わったら全体を作り直す
+		bool all = render_size_ != size || render_order_ != widgets_;
+		if(all) {
+			render_size_ = size;
+			render_order_ = widgets_;
+			damage_.org.set(0);
+			damage_.size.set(size.x, size.y);
+		}
+
+		// 変化の検出（個別の表示内容は、各ウィジェットの update で検出される）
+		// ※選択中（ドラッグ中）のウィジェットは、常に再描画する
+		for(auto w : widgets_) {
+			w->sync_param();
+			if(retained_ && w->get_state(widget::state::IS_SELECT)) {
+				w->set_dirty();
+			}
+		}
+
+		// 自分か親が変化したウィジェットに印を付ける
+		bool rebuild = all || !hit_valid_;
+		for(auto w : widgets_) {
+			w->set_mark(all || chain_dirty_(w));
+		}
+
+		// クリップ領域のアップデート（印の付いたウィジェットだけ）
+		for(auto w : widgets_) {
+			if(!w->get_mark()) continue;
+			vtx::irect org = w->get_param().clip_;
+			if(!w->get_state(widget::state::ENABLE)) {
+				if(w->get_dirty()) add_damage_(org);
+				w->set_dirty(false);
+				continue;
+			}
+			widget* root = root_widget(w);
+			if(!root->get_state(widget::state::ENABLE)) continue;
+			make_clip_(w);
+			const vtx::irect& clip = w->get_param().clip_;
+			if(org.org != clip.org || org.size != clip.size) {
+				rebuild = true;
+				add_damage_(org);
+				add_damage_(clip);
+			} else if(w->get_dirty()) {
+				add_damage_(clip);
+			}
+			w->set_dirty(false);
+		}
+
+		// 空間索引の再構築（クリップ領域が変化した場合）
+		if(rebuild) {
+			build_hit_grid_(size);
+		}
+	}
+
+
 	//-----------------------------------------------------------------//
 	/*!
 		@brief	レンダリング
@@ -868,21 +984,27 @@ namespace gui {
 		// WIN32 では、アプリケーションを待機状態にすると、サイズが「０」などが来る
 		if(size.x <= 0 || size.y <= 0) return;
 
-		// クリップ領域を全てアップデート
-		reset_mark();
-		for(auto w : widgets_) {
-			if(!w->get_state(widget::state::ENABLE)) {
-				w->set_mark();
-				continue;
-			}
-			widget* pw = w->get_param().parents_;
-			if(pw == 0) {	// is root.
-				w->set_mark();
-				make_clip_(w);
-				widgets ws;
-				parents_widget(w, ws);
-				clip_widgets_(ws, true);
-			}
+		// クリップ領域のアップデート
+		refresh_();
+
+		vtx::irect damage = damage_;
+		damage_.size.set(0);
+		painted_ = true;
+		if(retained_) {
+			render_count_ = 0;
+			painted_ = false;
+			if(damage.size.x <= 0 || damage.size.y <= 0) return;
+			// バック・バッファは２フレーム前の内容なので、前回のダメージ領域も含める
+			vtx::irect area = damage;
+			merge_rect_(area, back_damage_);
+			back_damage_ = damage;
+			damage = area;
+			painted_ = true;
+			float sc = core.get_dpi_scale();
+			mobj::set_scissor(static_cast<int>(damage.org.x * sc),
+				static_cast<int>((size.y - damage.end_y()) * sc),
+				static_cast<int>(damage.size.x * sc), static_cast<int>(damage.size.y * sc));
+			glClear(GL_COLOR_BUFFER_BIT);
 		}
 
 		// 各 描画
@@ -901,6 +1023,10 @@ namespace gui {
 			if(w->get_param().clip_.size.x <= 0 || w->get_param().clip_.size.y <= 0) {
 				continue;
 			}
+			if(retained_) {  // ダメージ領域と重ならないウィジェットは描画しない
+				vtx::irect r = w->get_param().clip_;
+				if(!r.clip(damage) || r.size.x <= 0 || r.size.y <= 0) continue;
+			}
 
 			mobj_.setup_matrix(size.x, size.y);
 			vtx::ipos pos(0);
@@ -957,6 +1083,10 @@ namespace gui {
 			w->render();
 			++rn;
 		}
+		if(retained_) {
+			mobj::reset_scissor();
+		}
+		render_count_ = rn;
 		if(render_num_ < rn) {
 			render_num_ = rn;
 ///			std::cout << "Render peak num: " << rn << std::endl;
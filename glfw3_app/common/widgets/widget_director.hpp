@@ -9,9 +9,11 @@
 */
 //=========================================================================//
 #include <vector>
+#include <algorithm>
 #include <functional>
 #include <iostream>
 #include <boost/unordered_set.hpp>
+#include <boost/unordered_map.hpp>
 #include "gl_fw/glmobj.hpp"
 #include "img_io/paint.hpp"
 #include "img_io/img_files.hpp"
@@ -111,6 +113,74 @@ namespace gui {
 		float					unselect_length_;
 
 		uint32_t				render_num_ = 0;
+		uint32_t				render_count_ = 0;
+
+		widgets					render_order_;
+		vtx::spos				render_size_ = vtx::spos(0);
+		vtx::irect				damage_ = vtx::irect(0);
+		vtx::irect				back_damage_ = vtx::irect(0);
+		bool					retained_ = false;
+		bool					painted_ = false;
+
+		static void merge_rect_(vtx::irect& dst, const vtx::irect& r) noexcept
+		{
+			if(r.size.x <= 0 || r.size.y <= 0) return;
+			if(dst.size.x <= 0 || dst.size.y <= 0) {
+				dst = r;
+				return;
+			}
+			vtx::ipos s(std::min(dst.org.x, r.org.x), std::min(dst.org.y, r.org.y));
+			vtx::ipos e(std::max(dst.end_x(), r.end_x()), std::max(dst.end_y(), r.end_y()));
+			dst.org = s;
+			dst.size = e - s;
+		}
+
+		void add_damage_(const vtx::irect& r) noexcept { merge_rect_(damage_, r); }
+
+		void refresh_();
+
+		// 親子関係の索引（parents_ を直接書き換える部品があるので、使う前に検証する）
+		typedef std::pair<widget*, widget*> tree_ref;
+		typedef boost::unordered_map<const widget*, widgets> child_map;
+		std::vector<tree_ref>	tree_ref_;
+		child_map				childs_;
+
+		void update_tree_()
+		{
+			bool ok = tree_ref_.size() == widgets_.size();
+			for(uint32_t i = 0; ok && i < widgets_.size(); ++i) {
+				ok = tree_ref_[i].first == widgets_[i]
+					&& tree_ref_[i].second == widgets_[i]->get_param().parents_;
+			}
+			if(ok) return;
+
+			tree_ref_.clear();
+			childs_.clear();
+			for(auto w : widgets_) {  // 子の並びは widgets_ の並び（描画順）
+				widget* pw = w->get_param().parents_;
+				tree_ref_.push_back(tree_ref(w, pw));
+				childs_[pw].push_back(w);
+			}
+		}
+
+		void collect_childs_(const widget* pw, widgets& ws) const
+		{
+			auto it = childs_.find(pw);
+			if(it == childs_.end()) return;
+			for(auto w : it->second) {
+				ws.push_back(w);
+				collect_childs_(w, ws);
+			}
+		}
+
+		// ヒット・テスト用の空間索引（クリップ領域をセル単位で登録）
+		static const int		hit_cell_ = 64;
+		std::vector<widgets>	hit_grid_;
+		vtx::ipos				hit_size_ = vtx::ipos(0);
+		bool					hit_valid_ = false;
+
+		void build_hit_grid_(const vtx::spos& size);
+		bool mark_hit_(const vtx::ipos& pos);
 
 		void message_widget_(widget* w, const std::string& s);
 		void parents_widget_mark_(widget* root);
@@ -199,6 +269,7 @@ namespace gui {
 			}
 			++serial_[preidx];
 			widgets_.push_back(w);
+			hit_valid_ = false;
 			return w;
 		}
 
@@ -282,6 +353,7 @@ namespace gui {
 			if(focus_widget_ == w) focus_widget_ = nullptr;
 
 			del_mark_.insert(w);
+			hit_valid_ = false;
 
 			delete w;
 
@@ -298,12 +370,8 @@ namespace gui {
 		//-----------------------------------------------------------------//
 		void parents_widget(widget* pw, widgets& ws) noexcept
 		{
-			for(auto w : widgets_) {
-				if(w->get_param().parents_ == pw) {
-					ws.push_back(w);
-					parents_widget(w, ws);
-				}
-			}
+			update_tree_();
+			collect_childs_(pw, ws);
 		}
 
 
@@ -322,6 +390,25 @@ namespace gui {
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	複数のペアレンツ・ウィジェットの収集 @n
+					親子関係の索引の検証は一度だけ行う。
+			@param[in]	pws	ペアレンツ・ウィジェット列
+			@param[out]	wss	ペアレンツ毎のウィジェット列
+		*/
+		//-----------------------------------------------------------------//
+		void parents_widget(const widgets& pws, std::vector<widgets>& wss)
+		{
+			update_tree_();
+			for(auto pw : pws) {
+				widgets ws;
+				collect_childs_(pw, ws);
+				wss.push_back(ws);
+			}
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	マーキングをリセットする
@@ -491,6 +578,56 @@ namespace gui {
 		void render();
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	保持描画モードの設定 @n
+					有効にすると、ダメージ領域だけをシザーでクリアして再描画し、@n
+					ダメージが無いフレームは何も描画しない。@n
+					ダブル・バッファの為、前のフレームのダメージ領域も再描画する。@n
+					※アプリ側は、画面全体をクリアせず、get_painted() が @n
+					「false」のフレームではフリップしない事。
+			@param[in]	f	無効にする場合「false」
+		*/
+		//-----------------------------------------------------------------//
+		void set_retained(bool f = true) noexcept { retained_ = f; render_order_.clear(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	保持描画モードの取得
+			@return 保持描画モードなら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool get_retained() const noexcept { return retained_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	直前のフレームで描画したウィジェット数を取得
+			@return 描画したウィジェット数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_render_count() const noexcept { return render_count_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	直前の render でフレーム・バッファを書き換えたか
+			@return 書き換えた場合「true」（保持描画モード以外では常に「true」）
+		*/
+		//-----------------------------------------------------------------//
+		bool get_painted() const noexcept { return painted_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	１フレームで描画したウィジェット数の最大値を取得
+			@return 描画したウィジェット数の最大値
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_render_peak() const noexcept { return render_num_; }
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	廃棄
@@ -48,6 +48,9 @@ namespace gui {
 
 		bool				focus_;
 
+		uint32_t			view_serial_;
+		bool				view_blink_;
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
@@ -56,7 +59,7 @@ namespace gui {
 		//-----------------------------------------------------------------//
 		widget_editor(widget_director& wd, const widget::param& bp, const param& p) :
 			widget(bp), wd_(wd), param_(p), terminal_(), interval_(0),
-			focus_(false) { }
+			focus_(false), view_serial_(0), view_blink_(false) { }
 
 
 		//-----------------------------------------------------------------//
@@ -195,6 +198,11 @@ namespace gui {
 					}
 				}
 			}
+
+			// 書き込み、カーソルの点滅を検出
+			++interval_;
+			sync_dirty(view_serial_, terminal_.get_serial());
+			sync_dirty(view_blink_, focus_ && (interval_ % 40) < 20);
 		}
 
 
@@ -300,7 +308,6 @@ namespace gui {
 					chs.y += param_.height_;
 					chs.x = rect.org.x;
 				}
-				++interval_;
 
 				fonts.restore_matrix();
 				fonts.pop_font_face();
@@ -183,6 +183,9 @@ namespace gui {
 			}
 			param_.ms_positive_ = !back &  param_.ms_level_;
 			param_.ms_negative_ =  back & !param_.ms_level_;
+
+			// フレーム・バッファの内容は毎フレーム変化する
+			set_dirty();
 		}
 
 
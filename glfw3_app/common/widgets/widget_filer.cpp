@@ -282,6 +282,35 @@ namespace gui {
 	}
 
 
+	bool widget_filer::refresh_files_(widget_files& wfs, const utils::file_infos& fis)
+	{
+		// create_files_ と同じ並びなら、ラベルはそのままで情報だけ更新
+		std::string pp = utils::previous_path(param_.path_);
+		uint32_t n = (pp.empty() ? drv_.get_num() : 0) + (param_.new_file_ ? 1 : 0);
+		std::vector<const utils::file_info*> list;
+		for(const auto& fi : fis) {
+			const auto& fn = fi.get_name();
+			if(fn == "." || (fn == ".." && pp.empty())) continue;
+			list.push_back(&fi);
+		}
+		if(wfs.size() != (n + list.size())) return false;
+
+		for(uint32_t i = 0; i < list.size(); ++i) {
+			const auto& fi = *list[i];
+			std::string fn = fi.get_name();
+			if(fn != ".." && fi.is_directory()) fn += '/';
+			if(wfs[n + i].name->get_text() != fn) return false;
+		}
+		for(uint32_t i = 0; i < list.size(); ++i) {
+			auto& wf = wfs[n + i];
+			wf.size = list[i]->get_size();
+			wf.time = list[i]->get_time();
+			wf.mode = list[i]->get_mode();
+		}
+		return true;
+	}
+
+
 	void widget_filer::destroy_files_(widget_files& wfs)
 	{
 		// ラベル郡を破棄
@@ -599,6 +628,8 @@ namespace gui {
 			if(center_.empty()) {
 				create_files_(center_, 0);
 				update_files_info_(center_);
+				center_path_ = fsc_path_;
+				center_rev_ = fsc_.get_revision();
 				if(left_.empty()) {
 					std::string pp = utils::previous_path(param_.path_);
 					if(!pp.empty()) {
@@ -625,6 +656,26 @@ namespace gui {
 			focus_(focus_path_);
 		}
 
+		// ディレクトリーの変化（inotify 等）、遅延取得した stat をセンターに反映
+		if(!fsc_wait_ && !center_.empty() && move_speed_ == 0.0f && !files_->get_state(widget::state::DRAG)) {
+			if(center_path_ != param_.path_ || fsc_.get_revision(param_.path_) != center_rev_) {
+				utils::file_infos fis;
+				uint32_t rev = 0;
+				if(fsc_.fetch(param_.path_, param_.filter_, fis, rev)) {
+					if(!refresh_files_(center_, fis)) {
+						destroy_files_(center_);
+						file_infos_ = fis;
+						fsc_path_ = param_.path_;
+						create_files_(center_, 0);
+						focus_(focus_path_);
+					}
+					update_files_info_(center_);
+				}
+				center_path_ = param_.path_;
+				center_rev_ = rev;
+			}
+		}
+
 		// アクセレーターキー操作
 		if(param_.acc_focus_ && acc_key_ && !center_.empty()) {
 			if(acc_key_ >= ' ') {
@@ -82,6 +82,8 @@ namespace gui {
 		std::string			fsc_path_;
 		bool				fsc_wait_;
 		utils::file_infos	file_infos_;
+		std::string			center_path_;	///< センターのパス
+		uint32_t			center_rev_;	///< センターに反映したリビジョン
 		utils::drive_info	drv_;
 
 		widget_button*	info_;	///< インフォメーション切り替えボタン
@@ -168,6 +170,7 @@ namespace gui {
 		void update_files_info_(widget_files& wfs);
 		void update_files_alias_(widget_files& wfs);
 		void destroy_files_(widget_files& wfs);
+		bool refresh_files_(widget_files& wfs, const utils::file_infos& fis);
 		void get_regist_state_();
 		void set_regist_state_();
 		void set_select_pos_(uint32_t pos);
@@ -185,7 +188,7 @@ namespace gui {
 		//-----------------------------------------------------------------//
 		widget_filer(widget_director& wd, const widget::param& bp, const param& p) :
 			widget(bp), wd_(wd), param_(p), objh_(0),
-			fsc_(), fsc_path_(), fsc_wait_(false),
+			fsc_(), fsc_path_(), fsc_wait_(false), file_infos_(), center_path_(), center_rev_(0),
 			info_(0), main_(0), files_(0),
 			info_state_(info_state::NONE),
 			request_right_(false),
@@ -59,6 +59,8 @@ namespace gui {
 
 		gl::mobj::handle	objh_;
 
+		size_t				view_hash_;
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
@@ -66,7 +68,7 @@ namespace gui {
 		*/
 		//-----------------------------------------------------------------//
 		widget_frame(widget_director& wd, const widget::param& bp, const param& p) :
-			widget(bp), wd_(wd), param_(p), objh_(0) { }
+			widget(bp), wd_(wd), param_(p), objh_(0), view_hash_(0) { }
 
 
 		//-----------------------------------------------------------------//
@@ -199,6 +201,10 @@ namespace gui {
 			if(param_.update_func_ != nullptr) {
 				param_.update_func_();
 			}
+
+			// 表示内容が変化したら再描画（描画関数の内容は追跡出来ない）
+			if(param_.render_func_ != nullptr) set_dirty();
+			sync_dirty(view_hash_, param_.text_param_.hash());
 		}
 
 
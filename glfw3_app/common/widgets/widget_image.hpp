@@ -55,6 +55,8 @@ namespace gui {
 
 		gl::mobj::handle	objh_;
 
+		size_t				view_hash_;
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
@@ -62,7 +64,7 @@ namespace gui {
 		*/
 		//-----------------------------------------------------------------//
 		widget_image(widget_director& wd, const widget::param& bp, const param& p) :
-			widget(bp), wd_(wd), param_(p), objh_(0) { }
+			widget(bp), wd_(wd), param_(p), objh_(0), view_hash_(0) { }
 
 
 		//-----------------------------------------------------------------//
@@ -70,7 +72,9 @@ namespace gui {
 			@brief	デストラクター
 		*/
 		//-----------------------------------------------------------------//
-		virtual ~widget_image() { }
+		virtual ~widget_image() {
+			if(objh_) wd_.at_mobj().erase(objh_);
+		}
 
 
 		//-----------------------------------------------------------------//
@@ -177,6 +181,16 @@ namespace gui {
 					at_rect() = w->get_draw_area();
 				}
 			}
+
+			// 表示内容が変化したら再描画
+			// ※同じハンドルのテクスチャーを書き換えた場合は、set_dirty() を呼ぶ事
+			if(param_.render_func_ != nullptr) set_dirty();
+			size_t h = reinterpret_cast<size_t>(param_.image_);
+			boost::hash_combine(h, param_.mobj_handle_);
+			boost::hash_combine(h, param_.offset_);
+			boost::hash_combine(h, param_.scale_);
+			boost::hash_combine(h, param_.linear_);
+			sync_dirty(view_hash_, h);
 		}
 
 
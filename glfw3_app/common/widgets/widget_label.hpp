@@ -83,6 +83,8 @@ namespace gui {
 		gl::mobj::handle	objh_;
 		gl::mobj::handle	select_objh_;
 
+		size_t				view_hash_;
+
 
 		void build_obj_()
 		{
@@ -115,7 +117,7 @@ namespace gui {
 		//-----------------------------------------------------------------//
 		widget_label(widget_director& wd, const widget::param& bp, const param& p) :
 			widget(bp), wd_(wd), param_(p), interval_(0), focus_(false),
-			objh_(0), select_objh_(0) { }
+			objh_(0), select_objh_(0), view_hash_(0) { }
 
 
 		//-----------------------------------------------------------------//
@@ -179,6 +181,7 @@ namespace gui {
 		void set_text(const std::string& text) {
 			param_.text_param_.set_text(text);
 			param_.text_in_pos_ = param_.text_param_.text_.size();
+			set_dirty();
 		}
 
 
@@ -258,7 +261,7 @@ namespace gui {
 					※プレート・オブジェクトを再構築する
 		*/
 		//-----------------------------------------------------------------//
-		void build_plate() { build_obj_(); }
+		void build_plate() { build_obj_(); set_dirty(); }
 
 
 		//-----------------------------------------------------------------//
@@ -268,7 +271,10 @@ namespace gui {
 		//-----------------------------------------------------------------//
 		void update() override
 		{
-			if(param_.text_in_) return;
+			if(param_.text_in_) {  // 入力中はカーソルが点滅する
+				set_dirty();
+				return;
+			}
 
 			// テキスト入力位置を調整
 			if(param_.text_in_pos_ > param_.text_param_.text_.size()) {
@@ -277,6 +283,9 @@ namespace gui {
 
 			param_.shift_param_.size_ = get_rect().size.x - param_.plate_param_.frame_width_ * 2;
 			shift_text_update(get_param(), param_.text_param_, param_.shift_param_);
+
+			// 表示内容が変化したら再描画
+			sync_dirty(view_hash_, param_.text_param_.hash());
 		}
 
 
@@ -73,6 +73,8 @@ namespace gui {
 
 		bool				enable_;
 
+		size_t				view_hash_;
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
@@ -81,7 +83,8 @@ namespace gui {
 		//-----------------------------------------------------------------//
 		widget_list(widget_director& wd, const widget::param& bp, const param& p) :
 			widget(bp), wd_(wd), param_(p),
-			objh_(0), select_objh_(0), menu_(nullptr), id_(0), enable_(false)
+			objh_(0), select_objh_(0), menu_(nullptr), id_(0), enable_(false),
+			view_hash_(0)
 			{ }
 
 
@@ -298,6 +301,9 @@ namespace gui {
 				}
 			}
 ///			menu_->at_rect().org.y = -menu_->get_select_pos() * get_param().rect_.size.y;
+
+			// 表示内容が変化したら再描画
+			sync_dirty(view_hash_, param_.text_param_.hash());
 		}
 
 
@@ -54,6 +54,8 @@ namespace gui {
 		gl::mobj::handle	base_h_;	///< ベース
 		gl::mobj::handle	hand_h_;	///< ハンドル
 
+		float				view_ratio_;
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
@@ -62,7 +64,7 @@ namespace gui {
 		//-----------------------------------------------------------------//
 		widget_progress(widget_director& wd, const widget::param& wp, const param& p) :
 			widget(wp), wd_(wd), param_(p),
-			base_h_(0), hand_h_(0)
+			base_h_(0), hand_h_(0), view_ratio_(-1.0f)
 		{ }
 
 
@@ -180,7 +182,11 @@ namespace gui {
 			@brief	アップデート
 		*/
 		//-----------------------------------------------------------------//
-		void update() override { }
+		void update() override
+		{
+			// 表示内容が変化したら再描画
+			sync_dirty(view_ratio_, param_.ratio_);
+		}
 
 
 		//-----------------------------------------------------------------//
@@ -60,6 +60,8 @@ namespace gui {
 		gl::mobj::handle	ena_h_;
 		gl::mobj::handle	dis_h_;
 
+		size_t				view_hash_;
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
@@ -70,7 +72,7 @@ namespace gui {
 			widget(bp), wd_(wd), param_(p),
 			obj_state_(false),
 			back_state_(false), no_(-1),
-			ena_h_(0), dis_h_(0) { }
+			ena_h_(0), dis_h_(0), view_hash_(0) { }
 
 
 		//-----------------------------------------------------------------//
@@ -197,6 +199,11 @@ namespace gui {
 					++i;
 				}
 			}
+
+			// 表示内容が変化したら再描画
+			size_t h = param_.text_param_.hash();
+			boost::hash_combine(h, obj_state_);
+			sync_dirty(view_hash_, h);
 		}
 
 
@@ -81,6 +81,8 @@ namespace gui {
 
 		float               position_;
 
+		size_t				view_hash_;
+
 		void update_offset_() noexcept
 		{
 			const slider_param& sp = param_.slider_param_;
@@ -157,7 +159,7 @@ namespace gui {
 		widget_slider(widget_director& wd, const widget::param& wp, const param& p) :
 			widget(wp), wd_(wd), param_(p), ref_position_(0.0f),
 			handle_offset_(0), base_h_(0), hand_h_(0),
-			position_(-1.0f)
+			position_(-1.0f), view_hash_(0)
 		{ }
 
 
@@ -411,6 +413,11 @@ namespace gui {
 			}
 
 			update_position_();
+
+			// ハンドル位置（at_position() による変更も含む）が変化したら再描画
+			size_t h = handle_offset_.hash();
+			boost::hash_combine(h, param_.slider_param_.handle_ratio_);
+			sync_dirty(view_hash_, h);
 		}
 
 
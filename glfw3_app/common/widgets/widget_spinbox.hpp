@@ -111,6 +111,8 @@ namespace gui {
 
 		state		state_;
 
+		size_t		view_hash_;
+
 		state get_button_state_(int& d) const noexcept
 		{
 			state st = state::none;
@@ -162,7 +164,7 @@ namespace gui {
 		widget_spinbox(widget_director& wd, const widget::param& bp, const param& p) noexcept :
 			widget(bp), wd_(wd), param_(p), objh_(0), up_objh_(0), dn_objh_(0),
 		    initial_(false), delay_btn_cnt_(0), delay_key_cnt_(0), sel_pos_(0),
-			state_(state::initial)
+			state_(state::initial), view_hash_(0)
 		{ }
 
 
@@ -464,6 +466,11 @@ namespace gui {
 				}
 				state_ = st;
 			}
+
+			// 表示内容が変化したら再描画
+			size_t h = param_.text_param_.hash();
+			boost::hash_combine(h, param_.sel_pos_);
+			sync_dirty(view_hash_, h);
 		}
 
 
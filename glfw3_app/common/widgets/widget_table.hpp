@@ -202,9 +202,9 @@ namespace gui {
 			for(auto w : param_.cell_) {  // 子の基本設定
 				w->at_param().parents_ = base_;
 				w->at_param().state_.set(widget::state::CLIP_PARENTS);
-				auto ws = wd_.parents_widget(w);
-				child_list_.push_back(ws);
 			}
+			// 親を全て付け替えてから、親子関係の索引を一度だけ作り直す
+			wd_.parents_widget(param_.cell_, child_list_);
 
 			if(param_.scroll_bar_h_) {
 				widget::param wp(vtx::irect(0, 0, 0, 0), this);
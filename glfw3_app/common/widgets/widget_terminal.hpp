@@ -73,6 +73,10 @@ namespace gui {
 
 		vtx::ipos			select_org_;
 
+		uint32_t			view_serial_;
+		vtx::ipos			view_scroll_;
+		bool				view_blink_;
+
 
 		void select_cha_(gl::fonts& fonts, const vtx::ipos& pos, int h) noexcept
 		{
@@ -108,7 +112,7 @@ namespace gui {
 		widget_terminal(widget_director& wd, const widget::param& bp, const param& p) noexcept :
 			widget(bp), wd_(wd), param_(p), terminal_(), interval_(0),
 			focus_(false), scroll_ofs_(0),
-			select_org_()
+			select_org_(), view_serial_(0), view_scroll_(0), view_blink_(false)
 		{ }
 
 
@@ -182,6 +186,7 @@ namespace gui {
 		void output(uint32_t wch) noexcept
 		{
 			terminal_.output(wch);
+			set_dirty();
 		}
 
 
@@ -312,6 +317,12 @@ namespace gui {
 				}
 			}
 			fonts.pop_font_face();
+
+			// at_terminal() による書き込み、スクロール、カーソルの点滅を検出
+			++interval_;
+			sync_dirty(view_serial_, terminal_.get_serial());
+			sync_dirty(view_scroll_, scroll_ofs_);
+			sync_dirty(view_blink_, focus_ && (interval_ % 40) < 20);
 		}
 
 
@@ -407,6 +418,7 @@ namespace gui {
 				}
 				ofs.y = npy;
 				vtx::ipos pos;
+				fonts.begin_batch();
 				for(pos.y = 0; pos.y < limit.y; ++pos.y) {
 					for(pos.x = 0; pos.x < limit.x; ++pos.x) {
 						const auto& t = terminal_.get_char(pos + ofs);
@@ -449,7 +461,7 @@ namespace gui {
 					chs.y += param_.height_;
 					chs.x = rect.org.x;
 				}
-				++interval_;
+				fonts.end_batch();
 
 				fonts.restore_matrix();
 				fonts.pop_font_face();
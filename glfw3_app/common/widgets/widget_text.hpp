@@ -45,6 +45,8 @@ namespace gui {
 
 		param				param_;
 
+		size_t				view_hash_;
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
@@ -52,7 +54,7 @@ namespace gui {
 		*/
 		//-----------------------------------------------------------------//
 		widget_text(widget_director& wd, const widget::param& bp, const param& p) :
-			widget(bp), wd_(wd), param_(p) { }
+			widget(bp), wd_(wd), param_(p), view_hash_(0) { }
 
 
 		//-----------------------------------------------------------------//
@@ -150,7 +152,11 @@ namespace gui {
 			@brief	アップデート
 		*/
 		//-----------------------------------------------------------------//
-		void update() override { }
+		void update() override
+		{
+			// 表示内容が変化したら再描画
+			sync_dirty(view_hash_, param_.text_param_.hash());
+		}
 
 
 		//-----------------------------------------------------------------//
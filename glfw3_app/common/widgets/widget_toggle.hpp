@@ -60,6 +60,8 @@ namespace gui {
 
 		bool				check_;
 
+		size_t				view_hash_;
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
@@ -68,7 +70,8 @@ namespace gui {
 		//-----------------------------------------------------------------//
 		widget_toggle(widget_director& wd, const widget::param& bp, const param& p) noexcept :
 			widget(bp), wd_(wd), param_(p),
-			obj_state_(false), ena_h_(0), dis_h_(0), check_(p.check_)
+			obj_state_(false), ena_h_(0), dis_h_(0), check_(p.check_),
+			view_hash_(0)
 		{ }
 
 
@@ -185,6 +188,11 @@ namespace gui {
 			} else {
 				obj_state_ = param_.check_;
 			}
+
+			// 表示内容が変化したら再描画
+			size_t h = param_.text_param_.hash();
+			boost::hash_combine(h, obj_state_);
+			sync_dirty(view_hash_, h);
 		}
 
 
@@ -142,6 +142,8 @@ namespace gui {
 				}
 			}
 			if(param_.update_func_ != nullptr) param_.update_func_();
+			// 描画関数の内容は追跡出来ないので、毎フレーム再描画
+			if(param_.render_func_ != nullptr) set_dirty();
 		}
 
 
@@ -0,0 +1,208 @@
+//=====================================================================//
+/*! @file
+	@brief  DX7 オフライン・レンダラー
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <memory>
+#include <chrono>
+
+#include "dx7_render.hpp"
+#include "src/dx7.hpp"
+#include "midi/MidiFile.h"
+
+#include "snd_io/pcm.hpp"
+#include "snd_io/wav_io.hpp"
+#include "utils/file_io.hpp"
+#include "utils/format.hpp"
+
+namespace {
+
+	// DX7 の音色バンク（３２音色）のシステム・エクスクルーシブ長
+	static const uint32_t bank_size_ = 4104;
+
+	// DX7 クラスが解釈出来るメッセージか？ @n
+	// ※知らないメッセージは、受信バッファ全体を捨ててしまう為、ここで弾く
+	bool accept_(const smf::MidiEvent& e)
+	{
+		if(e.empty()) return false;
+		uint8_t cmd = e[0] & 0xf0;
+		if(cmd == 0x80 || cmd == 0x90 || cmd == 0xb0 || cmd == 0xe0) return e.size() == 3;
+		else if(cmd == 0xc0) return e.size() == 2;
+		else if(e[0] == 0xf0) {
+			return e.size() == bank_size_ && e[1] == 0x43 && e[2] == 0x00 && e[3] == 0x09
+				&& e[4] == 0x20 && e[5] == 0x00;
+		}
+		return false;
+	}
+
+
+	class renderer {
+
+		std::unique_ptr<synth::DX7>	dx7_;
+		std::vector<int16_t>		wave_;
+
+	public:
+		renderer() : dx7_(new synth::DX7()), wave_() { }
+
+		synth::DX7& at() { return *dx7_; }
+
+		const std::vector<int16_t>& get_wave() const { return wave_; }
+
+		void send(const uint8_t* msg, uint32_t len)
+		{
+			// 受信バッファが溢れる場合、先に処理させる（シングル・スレッドなので待てない）
+			if(dx7_->at_msg().WriteBytesAvailable() < len) {
+				dx7_->GetSamples(0, nullptr);
+			}
+			dx7_->at_msg().Write(msg, len);
+		}
+
+		void generate(uint64_t len)
+		{
+			static const uint32_t unit = 4096;
+			while(len > 0) {
+				uint32_t n = len > unit ? unit : static_cast<uint32_t>(len);
+				auto pos = wave_.size();
+				wave_.resize(pos + n);
+				dx7_->GetSamples(n, &wave_[pos]);
+				len -= n;
+			}
+		}
+	};
+}
+
+namespace app {
+
+	bool dx7_render::render(const param& prm, info_t& info)
+	{
+		info = info_t();
+
+		smf::MidiFile mf;
+		if(!mf.read(prm.midi)) {
+			utils::format("Can't read MIDI file: '%s'\n") % prm.midi.c_str();
+			return false;
+		}
+		mf.doTimeAnalysis();
+		mf.joinTracks();
+
+		renderer r;
+		r.at().Init(static_cast<double>(prm.rate));
+#ifdef DX7_VOICE_THREADS
+		r.at().SetRenderThreads(prm.threads);
+		info.threads = r.at().GetRenderThreads();
+#endif
+
+		if(!prm.bank.empty()) {
+			utils::file_io fin;
+			if(!fin.open(prm.bank, "rb")) {
+				utils::format("Can't open bank file: '%s'\n") % prm.bank.c_str();
+				return false;
+			}
+			uint8_t tmp[bank_size_];
+			bool ok = fin.read(tmp, sizeof(tmp)) == sizeof(tmp) && tmp[0] == 0xf0;
+			fin.close();
+			if(!ok) {
+				utils::format("Bank file error: '%s'\n") % prm.bank.c_str();
+				return false;
+			}
+			r.send(tmp, sizeof(tmp));
+			r.generate(0);
+		}
+
+		auto t0 = std::chrono::steady_clock::now();
+
+		uint64_t pos = 0;
+		const auto& track = mf[0];
+		for(int i = 0; i < track.getEventCount(); ++i) {
+			const auto& e = track[i];
+			if(!accept_(e)) continue;
+			uint64_t t = static_cast<uint64_t>(std::llround(e.seconds * prm.rate));
+			if(t > pos) {
+				r.generate(t - pos);
+				pos = t;
+			}
+			r.send(&e[0], e.size());
+			++info.events;
+		}
+		r.generate(static_cast<uint64_t>(prm.tail * prm.rate));
+
+		info.render_sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+		const auto& wave = r.get_wave();
+		info.samples = wave.size();
+		info.audio_sec = static_cast<double>(info.samples) / prm.rate;
+		if(info.render_sec > 0.0) {
+			info.rtf = info.audio_sec / info.render_sec;
+		}
+
+		al::audio_mno16* pcm = new al::audio_mno16;
+		al::audio aif(pcm);
+		pcm->create(prm.rate, wave.size());
+		for(uint32_t i = 0; i < wave.size(); ++i) {
+			al::pcm16_m w;
+			w.w = wave[i];
+			pcm->put(i, w);
+		}
+
+		al::wav_io wav;
+		wav.set_audio(aif);
+		utils::file_io fout;
+		if(!fout.open(prm.wav, "wb")) {
+			utils::format("Can't create WAV file: '%s'\n") % prm.wav.c_str();
+			return false;
+		}
+		bool ret = wav.save(fout);
+		fout.close();
+		if(!ret) {
+			utils::format("WAV write error: '%s'\n") % prm.wav.c_str();
+		}
+		return ret;
+	}
+
+
+	int dx7_render::command(int argc, char** argv)
+	{
+		param prm;
+		std::vector<std::string> files;
+		for(int i = 2; i < argc; ++i) {
+			std::string s = argv[i];
+			if(s == "-bank" && (i + 1) < argc) {
+				prm.bank = argv[++i];
+			} else if(s == "-threads" && (i + 1) < argc) {
+				prm.threads = std::atoi(argv[++i]);
+			} else if(s == "-rate" && (i + 1) < argc) {
+				prm.rate = std::atoi(argv[++i]);
+			} else {
+				files.push_back(s);
+			}
+		}
+		if(files.size() != 2 || prm.rate == 0) {
+			utils::format("Usage: %s -render input.mid output.wav [-bank xxx.SYX] [-threads n] [-rate hz]\n")
+				% argv[0];
+			return -1;
+		}
+		if(prm.threads < 1) prm.threads = 1;
+		prm.midi = files[0];
+		prm.wav  = files[1];
+
+		info_t info;
+		if(!render(prm, info)) {
+			return -1;
+		}
+
+		utils::format("Events:  %u\n") % info.events;
+		utils::format("Audio:   %5.2f [sec] (%u samples, %u Hz)\n")
+			% info.audio_sec % info.samples % prm.rate;
+		utils::format("Render:  %5.3f [sec], %u thread(s)\n") % info.render_sec % info.threads;
+		utils::format("RTF:     %5.1f x real-time\n") % info.rtf;
+		return 0;
+	}
+}
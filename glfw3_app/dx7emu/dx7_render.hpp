@@ -0,0 +1,79 @@
+#pragma once
+//=====================================================================//
+/*! @file
+	@brief  DX7 オフライン・レンダラー @n
+			MIDI ファイルを、ウィンドウ、オーディオ・デバイス無しで WAV に変換する。@n
+			CPU の許す限りの速度で処理し、実時間比を報告する（ベンチマーク）。@n
+			dx7emu -render input.mid output.wav [-bank xxx.SYX] [-threads n] [-rate hz]
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <string>
+
+namespace app {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  DX7 オフライン・レンダラー・クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct dx7_render {
+
+		//=============================================================//
+		/*!
+			@brief  レンダリング設定
+		*/
+		//=============================================================//
+		struct param {
+			std::string	midi;		///< MIDI ファイル
+			std::string	wav;		///< 出力 WAV ファイル
+			std::string	bank;		///< DX7 音色バンク（.SYX、空なら内蔵の音色）
+			uint32_t	rate;		///< サンプルレート
+			uint32_t	threads;	///< ボイス・レンダリングのスレッド数
+			double		tail;		///< 最後のイベント後に追加する時間（秒）
+			param() : midi(), wav(), bank(), rate(44100), threads(1), tail(2.0) { }
+		};
+
+
+		//=============================================================//
+		/*!
+			@brief  レンダリング結果
+		*/
+		//=============================================================//
+		struct info_t {
+			uint32_t	events;		///< 送った MIDI イベント数
+			uint32_t	samples;	///< 生成したサンプル数
+			uint32_t	threads;	///< 実際に使ったレンダリング・スレッド数
+			double		audio_sec;	///< 生成した音の長さ（秒）
+			double		render_sec;	///< 合成に掛かった時間（秒）
+			double		rtf;		///< 実時間比（audio_sec / render_sec）
+			info_t() : events(0), samples(0), threads(1), audio_sec(0.0), render_sec(0.0), rtf(0.0) { }
+		};
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  MIDI ファイルを WAV にレンダリング
+			@param[in]	prm		設定
+			@param[out]	info	結果
+			@return 失敗なら「false」
+		*/
+		//-----------------------------------------------------------------//
+		static bool render(const param& prm, info_t& info);
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コマンドライン・モード（argv[1] が「-render」）
+			@param[in]	argc	引数の数
+			@param[in]	argv	引数
+			@return プロセスの終了コード
+		*/
+		//-----------------------------------------------------------------//
+		static int command(int argc, char** argv);
+	};
+}
@@ -7,6 +7,7 @@
 //=====================================================================//
 #include "main.hpp"
 #include "dx7emu.hpp"
+#include "dx7_render.hpp"
 
 typedef app::dx7emu start_app;
 
@@ -48,6 +49,11 @@ uint32_t micros()
 
 int main(int argc, char** argv)
 {
+	// ヘッドレスで WAV へレンダリング
+	if(argc >= 2 && strcmp(argv[1], "-render") == 0) {
+		return app::dx7_render::command(argc, argv);
+	}
+
 	gl::core& core = gl::core::get_instance();
 
 	if(!core.initialize(argc, argv)) {
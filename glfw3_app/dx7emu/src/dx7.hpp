@@ -26,6 +26,15 @@
 #include "pitchenv.hpp"
 #include "patch.hpp"
 
+// PC (glfw3_app) build: notes can be rendered by several threads
+#if defined(WIN32) && !defined(DX7_NO_VOICE_THREADS)
+#define DX7_VOICE_THREADS
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif
+
 namespace synth {
 
 	class DX7 {
@@ -35,7 +44,7 @@ namespace synth {
 #else
 #if defined(SIG_RX65N)
 		static const int max_active_notes = 8;
-#elif defined(SIG_RX72N)
+#else
 		static const int max_active_notes = 16;
 #endif
 #endif
@@ -93,6 +102,101 @@ namespace synth {
 
 		PitchEnv	pitch_env_;
 
+#ifdef DX7_VOICE_THREADS
+		// voice rendering threads, buffer 0 belongs to the caller of GetSamples
+		std::vector<std::thread>	voice_thread_;
+		std::vector<std::vector<int32_t>>	voice_buf_;
+		std::vector<int32_t>	lfo_value_;
+		std::vector<int32_t>	lfo_delay_;
+		std::mutex	voice_sync_;
+		std::condition_variable	voice_start_;
+		std::condition_variable	voice_done_;
+		uint32_t	voice_gen_;
+		uint32_t	voice_pending_;
+		uint32_t	voice_blocks_;
+		bool		voice_quit_;
+
+
+		// Render the live notes assigned to worker w (of n) for all blocks.
+		// Notes don't share state, so the split doesn't change the result.
+		void RenderVoiceSlice(uint32_t w, uint32_t n, uint32_t blocks)
+		{
+			auto& buf = voice_buf_[w];
+			buf.assign(blocks << SYNTH_LG_N, 0);
+			uint32_t k = 0;
+			for (uint32_t note = 0; note < max_active_notes; ++note) {
+				if (!active_note_[note].live) continue;
+				if ((k++ % n) != w) continue;
+				for (uint32_t b = 0; b < blocks; ++b) {
+					active_note_[note].dx7_note.compute(&buf[b << SYNTH_LG_N],
+						lfo_value_[b], lfo_delay_[b], &controllers_);
+				}
+			}
+		}
+
+
+		void VoiceWorker(uint32_t w, uint32_t n, uint32_t gen)
+		{
+			while (1) {
+				uint32_t blocks;
+				{
+					std::unique_lock<std::mutex> lock(voice_sync_);
+					voice_start_.wait(lock, [&] { return voice_quit_ || voice_gen_ != gen; });
+					if (voice_quit_) return;
+					gen = voice_gen_;
+					blocks = voice_blocks_;
+				}
+				RenderVoiceSlice(w, n, blocks);
+				{
+					std::lock_guard<std::mutex> lock(voice_sync_);
+					--voice_pending_;
+				}
+				voice_done_.notify_one();
+			}
+		}
+
+
+		// Render all live notes for "blocks" blocks of SYNTH_N samples,
+		// returns the mix, or nullptr when threads aren't worth it.
+		const int32_t* RenderVoices(uint32_t blocks)
+		{
+			uint32_t n = voice_thread_.size() + 1;
+			uint32_t live = 0;
+			for (uint32_t note = 0; note < max_active_notes; ++note) {
+				if (active_note_[note].live) ++live;
+			}
+			if (n < 2 || live < 2) return nullptr;
+
+			lfo_value_.resize(blocks);
+			lfo_delay_.resize(blocks);
+			for (uint32_t b = 0; b < blocks; ++b) {
+				lfo_value_[b] = lfo_.getsample();
+				lfo_delay_[b] = lfo_.getdelay();
+			}
+			{
+				std::lock_guard<std::mutex> lock(voice_sync_);
+				voice_blocks_ = blocks;
+				voice_pending_ = n - 1;
+				++voice_gen_;
+			}
+			voice_start_.notify_all();
+			RenderVoiceSlice(0, n, blocks);
+			{
+				std::unique_lock<std::mutex> lock(voice_sync_);
+				voice_done_.wait(lock, [this] { return voice_pending_ == 0; });
+			}
+
+			auto& mix = voice_buf_[0];
+			for (uint32_t w = 1; w < n; ++w) {
+				const auto& src = voice_buf_[w];
+				for (size_t j = 0; j < mix.size(); ++j) {
+					mix[j] += src[j];
+				}
+			}
+			return &mix[0];
+		}
+#endif
+
 	public:
 		DX7() :
 			ring_buffer_(), active_note_{}, current_note_(0),
@@ -103,6 +207,10 @@ namespace synth {
 			filter_(), filter_control_{ 258847126, 0, 0 }, sustain_(false),
 
 			pitch_env_()
+#ifdef DX7_VOICE_THREADS
+			, voice_thread_(), voice_buf_(1), lfo_value_(), lfo_delay_(),
+			voice_gen_(0), voice_pending_(0), voice_blocks_(0), voice_quit_(false)
+#endif
 		{
 			memcpy(patch_data_, epiano_, sizeof(epiano_));
 			ProgramChange(0);
@@ -126,6 +234,36 @@ namespace synth {
 		}
 
 
+#ifdef DX7_VOICE_THREADS
+		~DX7() { SetRenderThreads(1); }
+
+
+		// Number of threads used to render notes (1: caller only). A whole
+		// GetSamples call is split, so large buffers (offline rendering, dense
+		// MIDI files) benefit most. Don't call while GetSamples is running.
+		void SetRenderThreads(uint32_t n)
+		{
+			if (n < 1) n = 1;
+			if (n > max_active_notes) n = max_active_notes;
+			{
+				std::lock_guard<std::mutex> lock(voice_sync_);
+				voice_quit_ = true;
+			}
+			voice_start_.notify_all();
+			for (auto& t : voice_thread_) t.join();
+			voice_thread_.clear();
+			voice_quit_ = false;
+			voice_buf_.resize(n);
+			for (uint32_t w = 1; w < n; ++w) {
+				voice_thread_.emplace_back(&DX7::VoiceWorker, this, w, n, voice_gen_);
+			}
+		}
+
+
+		uint32_t GetRenderThreads() const { return voice_thread_.size() + 1; }
+#endif
+
+
 		auto& at_msg() { return ring_buffer_; }
 
 
@@ -155,18 +293,34 @@ namespace synth {
 				return;
 			}
 
+#ifdef DX7_VOICE_THREADS
+			const int32_t* mix = nullptr;
+			if (i < n_samples) {
+				mix = RenderVoices((n_samples - i + SYNTH_N - 1) >> SYNTH_LG_N);
+			}
+#endif
 			for (; i < n_samples; i += SYNTH_N) {
 				AlignedBuf<int32_t, SYNTH_N> audiobuf;
 				AlignedBuf<int32_t, SYNTH_N> audiobuf2;
-				for (uint32_t j = 0; j < SYNTH_N; ++j) {
-					audiobuf.get()[j] = 0;
-				}
-				int32_t lfovalue = lfo_.getsample();
-				int32_t lfodelay = lfo_.getdelay();
-				for (uint32_t note = 0; note < max_active_notes; ++note) {
-					if (active_note_[note].live) {
-						active_note_[note].dx7_note.compute(audiobuf.get(), lfovalue, lfodelay, 
-							&controllers_);
+#ifdef DX7_VOICE_THREADS
+				if (mix != nullptr) {
+					for (uint32_t j = 0; j < SYNTH_N; ++j) {
+						audiobuf.get()[j] = mix[j];
+					}
+					mix += SYNTH_N;
+				} else
+#endif
+				{
+					for (uint32_t j = 0; j < SYNTH_N; ++j) {
+						audiobuf.get()[j] = 0;
+					}
+					int32_t lfovalue = lfo_.getsample();
+					int32_t lfodelay = lfo_.getdelay();
+					for (uint32_t note = 0; note < max_active_notes; ++note) {
+						if (active_note_[note].live) {
+							active_note_[note].dx7_note.compute(audiobuf.get(), lfovalue, lfodelay, 
+								&controllers_);
+						}
 					}
 				}
 				const int32_t* bufs[] = { audiobuf.get() };
@@ -334,10 +488,13 @@ namespace synth {
 					return 2;
 				}
 				return 0;
-			} else if (cmd == 0xe0) {
-				// pitch bend
-				SetController(kControllerPitch, buf[1] | (buf[2] << 7));
-				return 3;
+			} else if (cmd_type == 0xe0) {
+				if (buf_size >= 3) {
+					// pitch bend (any channel, same as note on/off)
+					SetController(kControllerPitch, buf[1] | (buf[2] << 7));
+					return 3;
+				}
+				return 0;
 			} else if (cmd == 0xf0) {
 				// sysex
 				if (buf_size >= 6 && buf[1] == 0x43 && buf[2] == 0x00 && buf[3] == 0x09 &&
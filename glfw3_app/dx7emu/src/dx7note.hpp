@@ -161,7 +161,7 @@ namespace synth {
 		}
 
 	public:
-		Dx7Note() { }
+		Dx7Note() : fb_buf_{ 0, 0 } { }
 
 		void init(const char patch[128], int midinote, int velocity)
 		{
@@ -151,6 +151,131 @@ const int32_t __attribute__ ((aligned(16))) zeros[N] = {0};
 
 #endif
 
+// x86 kernels: SYNTH_N samples of one operator are processed 8 (AVX2) or
+// 4 (SSE4.1) lanes at a time. Same fixed point arithmetic as the scalar
+// loop (Sin::lookup with SIN_DELTA, (y * gain) >> 24), so the output is
+// bit-identical. Feedback operators stay scalar (serial dependency).
+// The default build passes no -m flags, so on GCC/Clang each kernel is
+// compiled with a target attribute and picked at run time from the CPU.
+#if defined(__x86_64__) || defined(__i386__)
+#if defined(__AVX2__)
+#define X86_TARGET_AVX2
+#define X86_TARGET_SSE41
+#define HAVE_X86_FM_KERNEL
+#elif defined(__GNUC__)
+#define X86_TARGET_AVX2   __attribute__ ((target("avx2")))
+#define X86_TARGET_SSE41  __attribute__ ((target("sse4.1")))
+#define HAVE_X86_FM_KERNEL
+#endif
+#endif
+
+#ifdef HAVE_X86_FM_KERNEL
+#include <immintrin.h>
+
+X86_TARGET_AVX2
+static void x86_fm_kernel_avx2(const int32_t *in, int32_t *out,
+    int32_t phase0, int32_t freq, int32_t gain1, int32_t dgain, bool add) {
+  const int *tab = reinterpret_cast<const int *>(synth::Sin::table());
+  const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  const __m256i lowmask = _mm256_set1_epi32((1 << 14) - 1);
+  const __m256i idxmask = _mm256_set1_epi32(1023 << 1);
+  __m256i phase = _mm256_add_epi32(_mm256_set1_epi32(phase0),
+      _mm256_mullo_epi32(_mm256_set1_epi32(freq), lane));
+  __m256i gain = _mm256_add_epi32(_mm256_set1_epi32(gain1),
+      _mm256_mullo_epi32(_mm256_set1_epi32(dgain),
+      _mm256_add_epi32(lane, _mm256_set1_epi32(1))));
+  const __m256i freq8 = _mm256_set1_epi32(freq * 8);
+  const __m256i dgain8 = _mm256_set1_epi32(dgain * 8);
+  for (int i = 0; i < SYNTH_N; i += 8) {
+    __m256i p = phase;
+    if (in != 0) {
+      p = _mm256_add_epi32(p, _mm256_loadu_si256((const __m256i *)(in + i)));
+    }
+    __m256i lowbits = _mm256_and_si256(p, lowmask);
+    __m256i idx = _mm256_and_si256(_mm256_srli_epi32(p, 13), idxmask);
+    __m256i dy = _mm256_i32gather_epi32(tab, idx, 4);
+    __m256i y0 = _mm256_i32gather_epi32(tab + 1, idx, 4);
+    // |dy| < 2^17, lowbits < 2^14: the product fits in 32 bits
+    __m256i y = _mm256_add_epi32(y0,
+        _mm256_srai_epi32(_mm256_mullo_epi32(dy, lowbits), 14));
+    __m256i even = _mm256_srli_epi64(_mm256_mul_epi32(y, gain), 24);
+    __m256i odd = _mm256_srli_epi64(_mm256_mul_epi32(
+        _mm256_srli_epi64(y, 32), _mm256_srli_epi64(gain, 32)), 24);
+    __m256i r = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xaa);
+    __m256i *dst = (__m256i *)(out + i);
+    if (add) {
+      r = _mm256_add_epi32(r, _mm256_loadu_si256(dst));
+    }
+    _mm256_storeu_si256(dst, r);
+    phase = _mm256_add_epi32(phase, freq8);
+    gain = _mm256_add_epi32(gain, dgain8);
+  }
+}
+
+X86_TARGET_SSE41
+static void x86_fm_kernel_sse41(const int32_t *in, int32_t *out,
+    int32_t phase0, int32_t freq, int32_t gain1, int32_t dgain, bool add) {
+  const int32_t *tab = synth::Sin::table();
+  const __m128i lane = _mm_setr_epi32(0, 1, 2, 3);
+  const __m128i lowmask = _mm_set1_epi32((1 << 14) - 1);
+  const __m128i idxmask = _mm_set1_epi32(1023 << 1);
+  __m128i phase = _mm_add_epi32(_mm_set1_epi32(phase0),
+      _mm_mullo_epi32(_mm_set1_epi32(freq), lane));
+  __m128i gain = _mm_add_epi32(_mm_set1_epi32(gain1),
+      _mm_mullo_epi32(_mm_set1_epi32(dgain),
+      _mm_add_epi32(lane, _mm_set1_epi32(1))));
+  const __m128i freq4 = _mm_set1_epi32(freq * 4);
+  const __m128i dgain4 = _mm_set1_epi32(dgain * 4);
+  for (int i = 0; i < SYNTH_N; i += 4) {
+    __m128i p = phase;
+    if (in != 0) {
+      p = _mm_add_epi32(p, _mm_loadu_si128((const __m128i *)(in + i)));
+    }
+    __m128i lowbits = _mm_and_si128(p, lowmask);
+    __m128i idx = _mm_and_si128(_mm_srli_epi32(p, 13), idxmask);
+    const int32_t *t0 = tab + _mm_extract_epi32(idx, 0);
+    const int32_t *t1 = tab + _mm_extract_epi32(idx, 1);
+    const int32_t *t2 = tab + _mm_extract_epi32(idx, 2);
+    const int32_t *t3 = tab + _mm_extract_epi32(idx, 3);
+    __m128i dy = _mm_setr_epi32(t0[0], t1[0], t2[0], t3[0]);
+    __m128i y0 = _mm_setr_epi32(t0[1], t1[1], t2[1], t3[1]);
+    __m128i y = _mm_add_epi32(y0,
+        _mm_srai_epi32(_mm_mullo_epi32(dy, lowbits), 14));
+    __m128i even = _mm_srli_epi64(_mm_mul_epi32(y, gain), 24);
+    __m128i odd = _mm_srli_epi64(_mm_mul_epi32(
+        _mm_srli_epi64(y, 32), _mm_srli_epi64(gain, 32)), 24);
+    __m128i r = _mm_blend_epi16(even, _mm_slli_epi64(odd, 32), 0xcc);
+    __m128i *dst = (__m128i *)(out + i);
+    if (add) {
+      r = _mm_add_epi32(r, _mm_loadu_si128(dst));
+    }
+    _mm_storeu_si128(dst, r);
+    phase = _mm_add_epi32(phase, freq4);
+    gain = _mm_add_epi32(gain, dgain4);
+  }
+}
+
+typedef void (*x86_fm_kernel_t)(const int32_t *in, int32_t *out,
+    int32_t phase0, int32_t freq, int32_t gain1, int32_t dgain, bool add);
+
+static x86_fm_kernel_t x86_fm_kernel_select() {
+#if defined(__AVX2__)
+  return x86_fm_kernel_avx2;
+#else
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return x86_fm_kernel_avx2;
+  if (__builtin_cpu_supports("sse4.1")) return x86_fm_kernel_sse41;
+  return 0;
+#endif
+}
+
+// null when the CPU has neither (the scalar loop is used)
+static x86_fm_kernel_t x86_fm_kernel() {
+  static const x86_fm_kernel_t k = x86_fm_kernel_select();
+  return k;
+}
+#endif
+
 void FmOpKernel::compute(int32_t *output, const int32_t *input,
                          int32_t phase0, int32_t freq,
                          int32_t gain1, int32_t gain2, bool add) {
@@ -163,6 +288,12 @@ void FmOpKernel::compute(int32_t *output, const int32_t *input,
       phase0, freq, gain, dgain);
 #endif
   } else {
+#ifdef HAVE_X86_FM_KERNEL
+    if (x86_fm_kernel_t k = x86_fm_kernel()) {
+      k(input, output, phase0, freq, gain, dgain, add);
+      return;
+    }
+#endif
     if (add) {
       for (int i = 0; i < SYNTH_N; i++) {
         gain += dgain;
@@ -193,6 +324,12 @@ void FmOpKernel::compute_pure(int32_t *output, int32_t phase0, int32_t freq,
       phase0, freq, gain, dgain);
 #endif
   } else {
+#ifdef HAVE_X86_FM_KERNEL
+    if (x86_fm_kernel_t k = x86_fm_kernel()) {
+      k(0, output, phase0, freq, gain, dgain, add);
+      return;
+    }
+#endif
     if (add) {
       for (int i = 0; i < SYNTH_N; i++) {
         gain += dgain;
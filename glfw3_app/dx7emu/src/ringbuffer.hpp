@@ -15,7 +15,8 @@
  * limitations under the License.
  */
 // for glfw3_app
-#ifdef WIN32
+#if defined(WIN32) || !__has_include("common/delay.hpp")
+#define SYNTH_NANOSLEEP
 #include <time.h>
 #else
 // for RX C++ framework
@@ -77,7 +78,7 @@ namespace synth {
 				auto wr_ix = wr_ix_;
 				auto space_available = (rd_ix - wr_ix - 1) & (kBufSize - 1);
 				if (space_available == 0) {
-#ifdef WIN32
+#ifdef SYNTH_NANOSLEEP
 					struct timespec sleepTime;
 					sleepTime.tv_sec = 0;
 					sleepTime.tv_nsec = 1000'000;
@@ -24,7 +24,7 @@ namespace synth {
 	template <class _>
 	class Sin_ {
 
-		static constexpr double M_PI = 3.1415926535897932384626433832795;
+		static constexpr double PI_ = 3.1415926535897932384626433832795;
 
 		static const uint32_t R = 1 << 29;
 		static const uint32_t SIN_LG_N_SAMPLES = 10;
@@ -61,7 +61,7 @@ namespace synth {
 
 		static void init()
 		{
-			double dphase = 2 * M_PI / SIN_N_SAMPLES;
+			double dphase = 2 * PI_ / SIN_N_SAMPLES;
 			int32_t c = (int32_t)floor(cos(dphase) * (1 << 30) + 0.5);
 			int32_t s = (int32_t)floor(sin(dphase) * (1 << 30) + 0.5);
 			int32_t u = 1 << 30;
@@ -89,6 +89,10 @@ namespace synth {
 		}
 
 
+		// raw table for vectorized lookups (SIN_DELTA layout: dy, y0 pairs)
+		static const int32_t* table() { return sintab_; }
+
+
 		static INLINE int32_t lookup(int32_t phase)
 		{
 			const int SHIFT = 24 - SIN_LG_N_SAMPLES;
@@ -24,7 +24,7 @@
 #define SYNTH_N (1 << SYNTH_LG_N)
 
 // for glfw3_app
-#ifdef WIN32
+#if defined(WIN32) || !__has_include("common/format.hpp")
 #include "utils/format.hpp"
 #else
 // for RX C++ framework
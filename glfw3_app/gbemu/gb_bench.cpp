@@ -0,0 +1,178 @@
+//=====================================================================//
+/*! @file
+	@brief  GameBoy ベンチマーク
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/glfw3_app/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <memory>
+#include <vector>
+#include "gb_bench.hpp"
+#include "utils/emu_bench.hpp"
+
+#include "Memory.h"
+#include "Processor.h"
+#include "Video.h"
+#include "Audio.h"
+#include "Input.h"
+#include "Cartridge.h"
+#include "CommonMemoryRule.h"
+#include "IORegistersMemoryRule.h"
+#include "RomOnlyMemoryRule.h"
+#include "MBC1MemoryRule.h"
+#include "MBC2MemoryRule.h"
+#include "MBC3MemoryRule.h"
+#include "MBC5MemoryRule.h"
+#include "MultiMBC1MemoryRule.h"
+
+namespace {
+
+	// GearboyCore.cpp はステート保存が std::stream 前提でビルド出来ない為、@n
+	// 同じ手順（GearboyCore::LoadROM、RunToVBlank）で部品を組み立てる
+	class machine {
+
+		std::unique_ptr<Memory>		memory_;
+		std::unique_ptr<Processor>	cpu_;
+		std::unique_ptr<Video>		video_;
+		std::unique_ptr<Audio>		audio_;
+		std::unique_ptr<Input>		input_;
+		std::unique_ptr<Cartridge>	cart_;
+		std::unique_ptr<CommonMemoryRule>		common_;
+		std::unique_ptr<IORegistersMemoryRule>	io_;
+		std::unique_ptr<MemoryRule>	rule_;
+		uint32_t	rtc_count_;
+
+		u16		fb_[GAMEBOY_WIDTH * GAMEBOY_HEIGHT];
+		s16		sb_[AUDIO_BUFFER_SIZE];
+
+		MemoryRule* create_rule_(Cartridge::CartridgeTypes type)
+		{
+			auto p = cpu_.get();
+			auto m = memory_.get();
+			auto v = video_.get();
+			auto i = input_.get();
+			auto c = cart_.get();
+			auto a = audio_.get();
+			switch(type) {
+			case Cartridge::CartridgeNoMBC:
+				return new RomOnlyMemoryRule(p, m, v, i, c, a);
+			case Cartridge::CartridgeMBC1:
+				return new MBC1MemoryRule(p, m, v, i, c, a);
+			case Cartridge::CartridgeMBC1Multi:
+				return new MultiMBC1MemoryRule(p, m, v, i, c, a);
+			case Cartridge::CartridgeMBC2:
+				return new MBC2MemoryRule(p, m, v, i, c, a);
+			case Cartridge::CartridgeMBC3:
+				return new MBC3MemoryRule(p, m, v, i, c, a);
+			case Cartridge::CartridgeMBC5:
+				return new MBC5MemoryRule(p, m, v, i, c, a);
+			default:
+				return nullptr;
+			}
+		}
+
+	public:
+		machine() : memory_(new Memory()), cpu_(new Processor(memory_.get())),
+			video_(new Video(memory_.get(), cpu_.get())), audio_(new Audio()),
+			input_(new Input(memory_.get(), cpu_.get())), cart_(new Cartridge()),
+			common_(), io_(), rule_(), rtc_count_(0)
+		{
+			memory_->Init();
+			cpu_->Init();
+			video_->Init();
+			audio_->Init();
+			input_->Init();
+			cart_->Init();
+			common_.reset(new CommonMemoryRule(memory_.get()));
+			io_.reset(new IORegistersMemoryRule(cpu_.get(), memory_.get(), video_.get(),
+				input_.get(), audio_.get()));
+		}
+
+
+		bool open(const std::string& file)
+		{
+			// Cartridge::LoadFromFile は無効化されているので、バッファ経由で読み込む
+			utils::file_io fin;
+			if(!fin.open(file, "rb")) return false;
+			std::vector<u8> rom(fin.get_file_size());
+			if(rom.empty() || fin.read(&rom[0], rom.size()) != rom.size()) return false;
+			fin.close();
+			if(!cart_->LoadFromBuffer(&rom[0], static_cast<int>(rom.size()))) return false;
+			rule_.reset(create_rule_(cart_->GetType()));
+			if(!rule_) return false;
+
+			bool cgb = cart_->IsCGB();
+			memory_->Reset(cgb);
+			cpu_->Reset(cgb);
+			video_->Reset(cgb);
+			audio_->Reset(cgb);
+			input_->Reset();
+			cart_->UpdateCurrentRTC();
+			rtc_count_ = 0;
+			common_->Reset(cgb);
+			rule_->Reset(cgb);
+			io_->Reset(cgb);
+
+			memory_->LoadBank0and1FromROM(cart_->GetTheROM());
+			memory_->SetIORule(io_.get());
+			memory_->SetCommonRule(common_.get());
+			memory_->SetCurrentRule(rule_.get());
+			return true;
+		}
+
+
+		// VBlank まで実行して、実行したサイクル数を返す
+		uint32_t step(uint8_t keys)
+		{
+			input_->KeySet(~keys);
+			uint32_t cycles = 0;
+			bool vblank = false;
+			while(!vblank) {
+				unsigned int clk = cpu_->Tick();
+				vblank = video_->Tick(clk, fb_, GB_PIXEL_RGB565);
+				audio_->Tick(clk);
+				input_->Tick(clk);
+				cycles += clk;
+			}
+			int n = 0;
+			audio_->EndFrame(sb_, &n);
+			++rtc_count_;
+			if(rtc_count_ >= 20) {
+				rtc_count_ = 0;
+				cart_->UpdateCurrentRTC();
+			}
+			return cycles;
+		}
+	};
+}
+
+namespace app {
+
+	int gb_bench::command(int argc, char** argv)
+	{
+		utils::emu_bench::param prm;
+		std::vector<std::string> files;
+		if(!utils::emu_bench::parse(argc, argv, 2, prm, files) || files.size() != 1) {
+			utils::format("Usage: %s -bench xxx.gb [-frames n] [-warmup n] [-input script]\n")
+				% argv[0];
+			return -1;
+		}
+
+		utils::emu_bench bench(prm);
+		if(!bench.load_script()) {
+			return -1;
+		}
+
+		std::unique_ptr<machine> gb(new machine());
+		if(!gb->open(files[0])) {
+			utils::format("Can't open GameBoy ROM: '%s'\n") % files[0].c_str();
+			return -1;
+		}
+
+		bench.run([&gb](uint32_t pad) { return gb->step(pad & 0xff); });
+		bench.report("Gearboy Processor (LR35902)", 59.7275);
+		return 0;
+	}
+}
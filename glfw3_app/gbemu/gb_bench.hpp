@@ -0,0 +1,34 @@
+#pragma once
+//=====================================================================//
+/*! @file
+	@brief  GameBoy ベンチマーク @n
+			ウィンドウ、オーディオ・デバイス無しで、Gearboy のコアを全速で回す。@n
+			入力スクリプトのパッド値は、Gameboy_Keys のビット位置（１で押下）。@n
+			gbemu -bench xxx.gb [-frames n] [-warmup n] [-input script]
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/glfw3_app/blob/master/LICENSE
+*/
+//=====================================================================//
+
+namespace app {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  GameBoy ベンチマーク・クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct gb_bench {
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コマンドライン・モード（argv[1] が「-bench」）
+			@param[in]	argc	引数の数
+			@param[in]	argv	引数
+			@return プロセスの終了コード
+		*/
+		//-----------------------------------------------------------------//
+		static int command(int argc, char** argv);
+	};
+}
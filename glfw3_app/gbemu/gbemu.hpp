@@ -29,6 +29,7 @@
 #include "widgets/widget_button.hpp"
 #include "widgets/widget_slider.hpp"
 #include "gl_fw/gltexfb.hpp"
+#include "img_io/pixel_lut.hpp"
 #include "snd_io/pcm.hpp"
 #include "utils/fifo.hpp"
 #include "utils/input.hpp"
@@ -64,7 +65,7 @@ namespace app {
 
 		gl::texfb				texfb_;
 
-		uint8_t			fb_[GAMEBOY_WIDTH * GAMEBOY_HEIGHT * 4];
+		uint32_t		fb_[GAMEBOY_WIDTH * GAMEBOY_HEIGHT];
 
 		std::string		file_;
 		bool			play_;
@@ -410,16 +411,7 @@ namespace app {
 				}
 
 				// copy video
-				for(int h = 0; h < GAMEBOY_HEIGHT; ++h) {
-					uint8_t* dst = &fb_[h * GAMEBOY_WIDTH * 4];
-					const auto* src = &gb_.rgb565_[h * GAMEBOY_WIDTH];
-					for(int w = 0; w < GAMEBOY_WIDTH; ++w) {
-						*dst++ = (((src[w] >> 11) & 0x1F ) * 255 + 15) / 31;
-						*dst++ = (((src[w] >> 5) & 0x3F ) * 255 + 31) / 63;
-						*dst++ = ((src[w] & 0x1F ) * 255 + 15) / 31;
-						*dst++ = 255;  // alpha
-					}
-				}
+				img::convert_rgb565(&gb_.rgb565_[0], fb_, GAMEBOY_WIDTH * GAMEBOY_HEIGHT);
 				texfb_.rendering(gl::texfb::IMAGE::RGBA, (const char*)&fb_[0]);
 				texfb_.flip();
 
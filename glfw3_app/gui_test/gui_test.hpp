@@ -88,6 +88,8 @@ namespace app {
 		uint32_t	menu_id_;
 		int			menu_ins_cnt_;
 
+		uint32_t	render_count_;
+
 		utils::select_file		sel_file_;
 		utils::select_dir		sel_dir_;
 
@@ -135,7 +137,8 @@ namespace app {
 			view_frame_(nullptr), view_core_(nullptr),
 			arrow_up_(nullptr), arrow_dn_(nullptr),
 			sheet_(nullptr), chip_(nullptr), table_(nullptr),
-			filer_id_(0), menu_id_(0), menu_ins_cnt_(0)
+			filer_id_(0), menu_id_(0), menu_ins_cnt_(0),
+			render_count_(0)
 		{ }
 
 
@@ -654,6 +657,13 @@ namespace app {
 //				if(ch >= 0x7f) ch = ' ';
 			}		
 
+			// 前のフレームで描画したウィジェット数をタイトルに表示
+			if(render_count_ != wd.get_render_count()) {
+				render_count_ = wd.get_render_count();
+				gl::core::get_instance().set_title((boost::format("gui_test (render: %d / peak: %d)")
+					% render_count_ % wd.get_render_peak()).str());
+			}
+
 			wd.update();
 		}
 
@@ -1,19 +1,43 @@
 #pragma once
 //=====================================================================//
 /*! @file
-    @brief  イグナイター・クライアント・クラス
+    @brief  イグナイター・クライアント・クラス @n
+			波形はテキスト（WDMW、TRMW）か、バイナリ・フレームで受信する。@n
+			接続時に「wbin 1」を送り、「WBIN1」が返ればバイナリ・フレームが来る。@n
+			バイナリ・フレーム（リトル・エンディアン）：@n
+			  0: STX(0x02) @n
+			  1: 種別 ('W': WDM 波形、'T': 熱抵抗波形) @n
+			  2: チャネル @n
+			  3: 予約 (0) @n
+			  4: シーケンス番号 (16 bits、フレーム毎に +1) @n
+			  6: 波形バッファ内の位置 (16 bits) @n
+			  8: サンプル数 (16 bits) @n
+			 10: 予約 (0) @n
+			 12: CRC-32 (0 ～ 11 バイトとペイロード) @n
+			 16: ペイロード（16 bits サンプル x サンプル数）
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2017, 2018 Kunihito Hiramatsu @n
 				Released under the MIT license @n
 				https://github.com/hirakuni45/RX/blob/master/LICENSE
 */
 //=====================================================================//
+#ifdef WIN32
 #include <winsock2.h>
+#else
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
 
+#include <cstdio>
+#include <iostream>
 #include <string>
-#include <queue>
 
 #include "utils/format.hpp"
+#include "utils/input.hpp"
 #include "utils/string_utils.hpp"
 
 // デバッグ・エミュレーションを行う場合有効にする
@@ -52,26 +76,41 @@ namespace net {
 
 			uint32_t	treg_id_[2];
 
+			uint32_t	frame_id_;		///< 受信したバイナリ・フレーム数
+			uint32_t	frame_err_;		///< 破棄したバイナリ・フレーム数（CRC、ヘッダー異常）
+			uint32_t	frame_lost_;	///< シーケンス番号の欠落数
+			uint32_t	line_err_;		///< 改行が来ないまま捨てたテキスト数
+
 			mod_status() :
 				crdd_(0), crdd_id_(0),
 				crcd_(0), crcd_id_(0),
 				crrd_(0), crrd_id_(0),
 				d2md_(0), d2md_id_(0),
-				wdm_id_{ 0 }, treg_id_{ 0 }
+				wdm_id_{ 0 }, treg_id_{ 0 },
+				frame_id_(0), frame_err_(0), frame_lost_(0), line_err_(0)
 			{ }
 		};
 
+		static const uint8_t  FRAME_STX = 0x02;		///< バイナリ・フレームの先頭
+		static const uint32_t FRAME_HEAD = 16;		///< バイナリ・フレームのヘッダー長
+		static const uint32_t LINE_LIMIT = 65536;	///< テキスト行の最大長（超えたら捨てる）
+
 	private:
+#ifndef WIN32
+		typedef int SOCKET;
+		static const int INVALID_SOCKET = -1;
+		static const int SOCKET_ERROR = -1;
+#endif
+
 		bool		startup_;
 
 		SOCKET		sock_;
 
 		bool		connect_;
+		bool		binary_;
 
-		std::string	line_;
-
-		typedef std::queue<std::string> SQUEUE;
-		SQUEUE		rmsg_;
+		std::string	rbuf_;
+		uint16_t	frame_seq_;
 
 		mod_status	mod_status_;
 
@@ -83,15 +122,254 @@ namespace net {
 		uint32_t	treg_pos_;
 		uint16_t	treg_buff_[WAVE_BUFF_SIZE * 2];
 
+		static void close_(SOCKET s)
+		{
+#ifdef WIN32
+			closesocket(s);
+#else
+			close(s);
+#endif
+		}
+
+		static bool would_block_()
+		{
+#ifdef WIN32
+			return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+			return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+		}
+
+		static uint32_t get16_(const uint8_t* p) { return p[0] | (p[1] << 8); }
+
+		static uint32_t get32_(const uint8_t* p) { return get16_(p) | (get16_(p + 2) << 16); }
+
+		static void put16_(std::string& out, uint32_t v)
+		{
+			out += static_cast<char>(v & 0xff);
+			out += static_cast<char>((v >> 8) & 0xff);
+		}
+
+		// ４桁の１６進数（不正なら負）
+		static int hex4_(const char* p)
+		{
+			int v = 0;
+			for(int i = 0; i < 4; ++i) {
+				char ch = p[i];
+				v <<= 4;
+				if(ch >= '0' && ch <= '9') v |= ch - '0';
+				else if(ch >= 'A' && ch <= 'F') v |= ch - 'A' + 10;
+				else if(ch >= 'a' && ch <= 'f') v |= ch - 'a' + 10;
+				else return -1;
+			}
+			return v;
+		}
+
+
+		// バイナリ・フレームの取り込み（戻り値は消費したバイト数、０ならデータ待ち）
+		uint32_t frame_(const uint8_t* p, uint32_t len)
+		{
+			if(len < FRAME_HEAD) return 0;
+
+			char kind = p[1];
+			uint32_t ch = p[2];
+			uint32_t seq = get16_(p + 4);
+			uint32_t pos = get16_(p + 6);
+			uint32_t num = get16_(p + 8);
+			bool ok = (kind == 'W' && ch < 4) || (kind == 'T' && ch < 2);
+			if(!ok || (pos + num) > WAVE_BUFF_SIZE) {  // STX を捨てて同期を取り直す
+				++mod_status_.frame_err_;
+				return 1;
+			}
+			uint32_t all = FRAME_HEAD + num * 2;
+			if(len < all) return 0;
+
+			uint32_t crc = crc32(0, p, 12);
+			crc = crc32(crc, p + FRAME_HEAD, num * 2);
+			if(crc != get32_(p + 12)) {  // ヘッダーは妥当なので、フレームごと捨てる
+				++mod_status_.frame_err_;
+				return all;
+			}
+
+			if(mod_status_.frame_id_ > 0 && seq != ((frame_seq_ + 1) & 0xffff)) {
+				++mod_status_.frame_lost_;
+			}
+			frame_seq_ = seq;
+			++mod_status_.frame_id_;
+
+			uint16_t* dst;
+			if(kind == 'W') {
+				dst = &wdm_buff_[ch * WAVE_BUFF_SIZE + pos];
+			} else {
+				dst = &treg_buff_[ch * WAVE_BUFF_SIZE + pos];
+			}
+			const uint8_t* src = p + FRAME_HEAD;
+			for(uint32_t i = 0; i < num; ++i) {
+				dst[i] = get16_(src);
+				src += 2;
+			}
+			if((pos + num) == WAVE_BUFF_SIZE) {
+				if(kind == 'W') ++mod_status_.wdm_id_[ch];
+				else ++mod_status_.treg_id_[ch];
+			}
+			return all;
+		}
+
+
+		// テキスト行の処理
+		void command_(const std::string& s)
+		{
+			if(s.find("CRCD") == 0) {
+				auto t = s.substr(4, 8);
+// std::cout << t << std::endl;
+				int v = 0;
+				if((utils::input("%x", t.c_str()) % v).status()) {
+					mod_status_.crcd_ = v;
+					++mod_status_.crcd_id_;
+				}
+			} else if(s.find("CRRD") == 0) {
+				auto t = s.substr(4, 8);
+// std::cout << t << std::endl;
+				int v = 0;
+				if((utils::input("%x", t.c_str()) % v).status()) {
+					mod_status_.crrd_ = v;
+					++mod_status_.crrd_id_;
+				}			
+			} else if(s.find("CRDD") == 0) {
+				auto t = s.substr(4, 8);
+// std::cout << t << std::endl;
+				int v = 0;
+				if((utils::input("%x", t.c_str()) % v).status()) {
+					mod_status_.crdd_ = v;
+					++mod_status_.crdd_id_;
+				}			
+			} else if(s.find("D2MD") == 0) {
+				auto t = s.substr(4, 5);
+				int v = 0;
+				if((utils::input("%x", t.c_str()) % v).status()) {
+					mod_status_.d2md_ = v;
+					++mod_status_.d2md_id_;
+				}			
+			} else if(s.find("WDCH") == 0) {  // WDM チャネル
+				auto t = s.substr(4);
+				int v = 0;
+				utils::input("%d", t.c_str()) % v;
+				wdm_ch_ = v;
+				wdm_pos_ = 0;
+// std::cout << "WDM capture CH: " << wdm_ch_ << std::endl;
+			} else if(s.find("WDMW") == 0) {  // WDM 波形
+				for(uint32_t i = 4; (i + 4) < s.size(); i += 4) {
+					int v = hex4_(&s[i]);
+					if(v < 0) break;
+					auto pos = wdm_pos_ % WAVE_BUFF_SIZE;
+					wdm_buff_[(wdm_ch_ & 3) * WAVE_BUFF_SIZE + pos] = v;
+					++wdm_pos_;
+					if(wdm_pos_ >= WAVE_BUFF_SIZE) {
+						++mod_status_.wdm_id_[wdm_ch_ & 3];
+					}
+				}
+			} else if(s.find("TRCH") == 0) {  // 熱抵抗チャネル (0, 1)
+				auto t = s.substr(4);
+				int v = 0;
+				utils::input("%d", t.c_str()) % v;
+				treg_ch_ = v;
+				treg_pos_ = 0;
+// std::cout << "TRCH: " << treg_ch_ << std::endl;
+			} else if(s.find("TRMW") == 0) {  // 熱抵抗波形 (0, 1)
+				for(uint32_t i = 4; (i + 4) < s.size(); i += 4) {
+					int v = hex4_(&s[i]);
+					if(v < 0) break;
+					auto pos = treg_pos_ % WAVE_BUFF_SIZE;
+					treg_buff_[(treg_ch_ & 1) * WAVE_BUFF_SIZE + pos] = v;
+					++treg_pos_;
+					if(treg_pos_ >= WAVE_BUFF_SIZE) {
+						++mod_status_.treg_id_[treg_ch_ & 1];
+// std::cout << "TRMW: " << treg_ch_ << std::endl;
+					}
+				}
+			} else if(s.find("WBIN") == 0) {  // バイナリ・フレームの応答
+				binary_ = s.size() > 4 && s[4] == '1';
+			}
+		}
+
 	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  CRC-32 (IEEE 802.3) の計算（crc32(crc32(0, a), b) で連結可能）
+			@param[in]	crc	前回の CRC（最初は０）
+			@param[in]	src	データ
+			@param[in]	len	データ長
+			@return CRC
+		*/
+		//-----------------------------------------------------------------//
+		static uint32_t crc32(uint32_t crc, const void* src, uint32_t len)
+		{
+			static uint32_t table[256];
+			static bool init = false;
+			if(!init) {
+				for(uint32_t i = 0; i < 256; ++i) {
+					uint32_t c = i;
+					for(int j = 0; j < 8; ++j) {
+						c = (c & 1) ? (0xEDB88320 ^ (c >> 1)) : (c >> 1);
+					}
+					table[i] = c;
+				}
+				init = true;
+			}
+			auto p = static_cast<const uint8_t*>(src);
+			crc = ~crc;
+			for(uint32_t i = 0; i < len; ++i) {
+				crc = table[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+			}
+			return ~crc;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  バイナリ・フレームの生成（デバイス側、エミュレーション用）
+			@param[in]	kind	種別（'W' 又は 'T'）
+			@param[in]	ch		チャネル
+			@param[in]	seq		シーケンス番号
+			@param[in]	pos		波形バッファ内の位置
+			@param[in]	src		波形
+			@param[in]	num		サンプル数
+			@param[out]	out		フレームを追加する先
+		*/
+		//-----------------------------------------------------------------//
+		static void make_frame(char kind, uint32_t ch, uint16_t seq, uint16_t pos,
+			const uint16_t* src, uint16_t num, std::string& out)
+		{
+			auto top = out.size();
+			out += static_cast<char>(FRAME_STX);
+			out += kind;
+			out += static_cast<char>(ch);
+			out += static_cast<char>(0);
+			put16_(out, seq);
+			put16_(out, pos);
+			put16_(out, num);
+			put16_(out, 0);
+			put16_(out, 0);  // CRC の場所
+			put16_(out, 0);
+			for(uint16_t i = 0; i < num; ++i) {
+				put16_(out, src[i]);
+			}
+			uint32_t crc = crc32(0, &out[top], 12);
+			crc = crc32(crc, &out[top + FRAME_HEAD], num * 2);
+			for(uint32_t i = 0; i < 4; ++i) {
+				out[top + 12 + i] = static_cast<char>((crc >> (i * 8)) & 0xff);
+			}
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief  コンストラクター
 		*/
 		//-----------------------------------------------------------------//
 		ign_client_tcp() : startup_(false),
-			sock_(0),
-			connect_(false), mod_status_(),
+			sock_(INVALID_SOCKET),
+			connect_(false), binary_(false), rbuf_(), frame_seq_(0), mod_status_(),
 			wdm_ch_(0), wdm_pos_(0), wdm_buff_{ 0 },
 			treg_ch_(0), treg_pos_(0), treg_buff_{ 0 }
 		{ }
@@ -104,9 +382,15 @@ namespace net {
 		//-----------------------------------------------------------------//
 		~ign_client_tcp()
 		{
+			// DEBUG_EMU では、ソケット無しで connect_ になる
+			if(connect_ && sock_ != INVALID_SOCKET) {
+				close_(sock_);
+			}
+#ifdef WIN32
 			if(startup_) {
 				WSACleanup();
 			}
+#endif
 		}
 
 
@@ -152,6 +436,15 @@ namespace net {
 		bool probe() const { return connect_; }
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  バイナリ・フレームの確認
+			@return デバイスがバイナリ・フレームを受け入れたら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool probe_binary() const { return binary_; }
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief  開始
@@ -165,6 +458,7 @@ namespace net {
 			connect_ = true;
 			return true;
 #endif
+#ifdef WIN32
 			if(!startup_) {
 				WSADATA wsaData;
 				int res = WSAStartup(MAKEWORD(2,0), &wsaData);
@@ -172,7 +466,9 @@ namespace net {
 					std::cout << "WSAStartup function failed with error:" << std::endl;
 					return false;
 				}
+				startup_ = true;
 			}
+#endif
 
 			// クライアントソケット作成
 			sock_ = socket(AF_INET, SOCK_STREAM, 0);
@@ -191,7 +487,8 @@ namespace net {
 			// クライアントの接続を待つ
 			int ret = connect(sock_, (struct sockaddr *)&cl, sizeof(cl));
 			if(ret == SOCKET_ERROR) {
-				closesocket(sock_);
+				close_(sock_);
+				sock_ = INVALID_SOCKET;
 				perror("TCP connect fail...");
 				return false;
 			}
@@ -199,8 +496,18 @@ namespace net {
 			connect_ = true;
 //			utils::format("TCP Client connect (%d)\n") % sock_;
 
+#ifdef WIN32
 			u_long val = 1;
 			ioctlsocket(sock_, FIONBIO, &val);
+#else
+			int val = 1;
+			ioctl(sock_, FIONBIO, &val);
+#endif
+
+			// 波形のバイナリ転送を要求（未対応のデバイスはテキストのまま）
+			binary_ = false;
+			rbuf_.clear();
+			send_data("wbin 1\n");
 
 			return true;
 		}
@@ -219,109 +526,48 @@ namespace net {
 #else
 			if(!connect_) return;
 
+			// 溜まっている分を全て受け取る（１回のサービスで最大 512K バイト）
 			char tmp[8192];
-			int n = recv(sock_, tmp, sizeof(tmp) - 1, 0);
-			if(n < 1) {
-				if(WSAGetLastError() == WSAEWOULDBLOCK) {
-					// まだ来ない。
-				} else {
-					std::cout << "recv error..." << std::endl; 
-				}
-			} else {
-				for(int i = 0; i < n; ++i) {
-					auto ch = tmp[i];
-					line_ += ch;
-					if(ch == '\n') {
-						rmsg_.push(line_);
-						line_.clear();			
+			for(int loop = 0; loop < 64; ++loop) {
+				int n = recv(sock_, tmp, sizeof(tmp), 0);
+				if(n < 1) {
+					if(n < 0 && would_block_()) {
+						// まだ来ない。
+					} else {
+						std::cout << "recv error..." << std::endl; 
 					}
+					break;
 				}
+				rbuf_.append(tmp, n);
 			}
 
-			// 読み込みデータ処理
-			while(!rmsg_.empty()) {
-				auto s = rmsg_.front();
-				rmsg_.pop();
-// std::cout << s << std::endl;
-
-				if(s.find("CRCD") == 0) {
-					auto t = s.substr(4, 8);
-// std::cout << t << std::endl;
-					int v = 0;
-					if((utils::input("%x", t.c_str()) % v).status()) {
-						mod_status_.crcd_ = v;
-						++mod_status_.crcd_id_;
-					}
-				} else if(s.find("CRRD") == 0) {
-					auto t = s.substr(4, 8);
-// std::cout << t << std::endl;
-					int v = 0;
-					if((utils::input("%x", t.c_str()) % v).status()) {
-						mod_status_.crrd_ = v;
-						++mod_status_.crrd_id_;
-					}			
-				} else if(s.find("CRDD") == 0) {
-					auto t = s.substr(4, 8);
-// std::cout << t << std::endl;
-					int v = 0;
-					if((utils::input("%x", t.c_str()) % v).status()) {
-						mod_status_.crdd_ = v;
-						++mod_status_.crdd_id_;
-					}			
-				} else if(s.find("D2MD") == 0) {
-					auto t = s.substr(4, 5);
-					int v = 0;
-					if((utils::input("%x", t.c_str()) % v).status()) {
-						mod_status_.d2md_ = v;
-						++mod_status_.d2md_id_;
-					}			
-				} else if(s.find("WDCH") == 0) {  // WDM チャネル
-					auto t = s.substr(4);
-					int v = 0;
-					utils::input("%d", t.c_str()) % v;
-					wdm_ch_ = v;
-					wdm_pos_ = 0;
-// std::cout << "WDM capture CH: " << wdm_ch_ << std::endl;
-				} else if(s.find("WDMW") == 0) {  // WDM 波形
-					auto t = s.substr(4);
-					while(t.size() > 4) {
-						auto d = t.substr(4);
-						t[4] = 0;
-						int v;
-						utils::input("%x", t.c_str()) % v;
-						auto pos = wdm_pos_ % WAVE_BUFF_SIZE;
-						wdm_buff_[(wdm_ch_ & 3) * WAVE_BUFF_SIZE + pos] = v;
-						++wdm_pos_;
-						if(wdm_pos_ >= WAVE_BUFF_SIZE) {
-							++mod_status_.wdm_id_[wdm_ch_ & 3];
-						}
-						t = d;
-					}
-				} else if(s.find("TRCH") == 0) {  // 熱抵抗チャネル (0, 1)
-					auto t = s.substr(4);
-					int v = 0;
-					utils::input("%d", t.c_str()) % v;
-					treg_ch_ = v;
-					treg_pos_ = 0;
-// std::cout << "TRCH: " << treg_ch_ << std::endl;
-				} else if(s.find("TRMW") == 0) {  // 熱抵抗波形 (0, 1)
-					auto t = s.substr(4);
-					while(t.size() > 4) {
-						auto d = t.substr(4);
-						t[4] = 0;
-						int v;
-						utils::input("%x", t.c_str()) % v;
-						auto pos = treg_pos_ % WAVE_BUFF_SIZE;
-						treg_buff_[(treg_ch_ & 1) * WAVE_BUFF_SIZE + pos] = v;
-						++treg_pos_;
-						if(treg_pos_ >= WAVE_BUFF_SIZE) {
-							++mod_status_.treg_id_[treg_ch_ & 1];
-// std::cout << "TRMW: " << treg_ch_ << std::endl;
-						}
-						t = d;
+			// 読み込みデータ処理（行の先頭が STX ならバイナリ・フレーム）
+			uint32_t pos = 0;
+			while(pos < rbuf_.size()) {
+				auto p = reinterpret_cast<const uint8_t*>(rbuf_.data()) + pos;
+				if(p[0] == FRAME_STX) {
+					auto n = frame_(p, rbuf_.size() - pos);
+					if(n == 0) break;
+					pos += n;
+				} else {
+					auto e = rbuf_.find('\n', pos);
+					if(e != std::string::npos && (e - pos) < LINE_LIMIT) {
+						command_(rbuf_.substr(pos, e + 1 - pos));
+						pos = e + 1;
+					} else if(e != std::string::npos) {  // 長過ぎる行は捨てる
+						++mod_status_.line_err_;
+						pos = e + 1;
+					} else if((rbuf_.size() - pos) >= LINE_LIMIT) {
+						// 改行が来ないまま溜まり続ける場合は、次の STX まで捨てる
+						++mod_status_.line_err_;
+						auto s = rbuf_.find(static_cast<char>(FRAME_STX), pos);
+						pos = s == std::string::npos ? rbuf_.size() : s;
+					} else {
+						break;
 					}
 				}
 			}
+			rbuf_.erase(0, pos);
 #endif
 		}
 
@@ -360,13 +606,16 @@ namespace net {
 					++mod_status_.crcd_id_;
 				} else if(text.find("wdm 20") != std::string::npos) {
 					++mod_status_.wdm_id_[2];
+				} else if(s.find("wbin 1") != std::string::npos) {
+					binary_ = true;
 				}
 			}
 			return;
 #else
 			if(send(sock_, text.c_str(), text.size(), 0) == SOCKET_ERROR) {
 				shutdown(sock_, 2);
-				closesocket(sock_);
+				close_(sock_);
+				sock_ = INVALID_SOCKET;
 				connect_ = false;
 			}
 #endif
@@ -1634,7 +1634,7 @@ namespace app {
 						path += '.';
 						path += WAVE_DATA_EXT_;
 					}
-					if(waves_.save(path)) {
+					if(waves_.save(path, sample_param_.rate)) {
 					}
 				}
 			}
@@ -316,8 +316,8 @@ namespace app {
 		void setup_src_image_() noexcept
 		{
 			image_offset_.set(0.0f);
-			mobj_.destroy();
-			mobj_.initialize();
+			mobj_.erase(img_handle_);
+			mobj_.compact();
 			img_handle_ = mobj_.install(src_image_.get());
 			image_->at_local_param().mobj_ = mobj_;
 			image_->at_local_param().mobj_handle_ = img_handle_;
@@ -578,8 +578,8 @@ namespace app {
 					image_info_("new image", src_image_.get());
 					image_offset_.set(0.0f);
 					frame_->at_local_param().text_param_.set_text("new image");
-					mobj_.destroy();
-					mobj_.initialize();
+					mobj_.erase(img_handle_);
+					mobj_.compact();
 					img_handle_ = mobj_.install(src_image_.get());
 					image_->at_local_param().mobj_ = mobj_;
 					image_->at_local_param().mobj_handle_ = img_handle_;
@@ -52,6 +52,7 @@ namespace app {
 
 			using namespace gui;
 			widget_director& wd = director_.at().widget_director_;
+			wd.set_retained();
 
 			{	// ターミナルのテスト
 				{
@@ -5,6 +5,8 @@
 	@author 平松邦仁 (hira@rvf-rc45.net)
 */
 //=====================================================================//
+#include <thread>
+#include <chrono>
 #include "main.hpp"
 #include "logger_main.hpp"
 
@@ -51,8 +53,12 @@ int main(int argc, char** argv)
 	while(!core.get_exit_signal()) {
 		core.service();
 
+		// 保持描画モードでは、ダメージ領域だけを widget_director がクリアする
+		const gui::widget_director& wd = director.at().widget_director_;
 		glClearColor(0, 0, 0, 255);
-		glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+		if(!wd.get_retained()) {
+			glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+		}
 		gl::glColor(img::rgbaf(1.0f));
 
 		glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
@@ -63,7 +69,11 @@ int main(int argc, char** argv)
 
 		director.render();
 
-		core.flip_frame();
+		if(wd.get_painted()) {
+			core.flip_frame();
+		} else {  // 変化の無いフレームはフリップせずに待つ
+			std::this_thread::sleep_for(std::chrono::milliseconds(16));
+		}
 
 		director.at().sound_.service();
 	}
@@ -24,6 +24,7 @@
 */
 
 #include <string.h>
+#include "nes_std.h"
 #include "cpu/nes6502.h"
 
 //#define  NES6502_DISASM
@@ -1131,12 +1132,12 @@
 
 
 /* internal CPU context */
-static nes6502_context cpu;
-static int remaining_cycles = 0; /* so we can release timeslice */
+static NES_TLS nes6502_context cpu;
+static NES_TLS int remaining_cycles = 0; /* so we can release timeslice */
 /* memory region pointers */
-static uint8_t *ram = NULL;
-static uint8_t *stack = NULL;
-static uint8_t null_page[NES6502_BANKSIZE];
+static NES_TLS uint8_t *ram = NULL;
+static NES_TLS uint8_t *stack = NULL;
+static NES_TLS uint8_t null_page[NES6502_BANKSIZE];
 
 
 /*
@@ -87,7 +87,7 @@ int log_print(const char *string)
 int log_printf(const char *format, ... )
 {
    /* don't allocate on stack every call */
-   static char buffer[1024 + 1];
+   static NES_TLS char buffer[1024 + 1];
    va_list arg;
 
    va_start(arg, format);
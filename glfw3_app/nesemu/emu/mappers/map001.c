@@ -50,11 +50,11 @@ not be possible.
 */
 
 /* TODO: roll this into something... */
-static int bitcount = 0;
-static uint8 latch = 0;
-static uint8 regs[4];
-static int bank_select;
-static uint8 lastreg;
+static NES_TLS int bitcount = 0;
+static NES_TLS uint8 latch = 0;
+static NES_TLS uint8 regs[4];
+static NES_TLS int bank_select;
+static NES_TLS uint8 lastreg;
 
 static void map1_write(uint32 address, uint8 value)
 {
@@ -149,6 +149,12 @@ static void map1_write(uint32 address, uint8 value)
 
 static void map1_init(void)
 {
+   MMC_ADDSTATE(bitcount);
+   MMC_ADDSTATE(latch);
+   MMC_ADDSTATE(regs);
+   MMC_ADDSTATE(bank_select);
+   MMC_ADDSTATE(lastreg);
+
    bitcount = 0;
    latch = 0;
 
@@ -173,7 +179,7 @@ static void map1_getstate(SnssMapperBlock *state)
 
 static void map1_setstate(SnssMapperBlock *state)
 {
-   regs[1] = state->extraData.mapper1.registers[0];
+   regs[0] = state->extraData.mapper1.registers[0];
    regs[1] = state->extraData.mapper1.registers[1];
    regs[2] = state->extraData.mapper1.registers[2];
    regs[3] = state->extraData.mapper1.registers[3];
@@ -27,15 +27,15 @@
 #include "nes.h"
 #include "libsnss.h"
 
-static struct
+static NES_TLS struct
 {
    int counter, latch;
    bool enabled, reset;
 } irq;
 
-static uint8 reg;
-static uint8 command;
-static uint16 vrombase;
+static NES_TLS uint8 reg;
+static NES_TLS uint8 command;
+static NES_TLS uint16 vrombase;
 
 /* mapper 4: MMC3 */
 static void map4_write(uint32 address, uint8 value)
@@ -186,6 +186,11 @@ static void map4_setstate(SnssMapperBlock *state)
 
 static void map4_init(void)
 {
+   MMC_ADDSTATE(irq);
+   MMC_ADDSTATE(reg);
+   MMC_ADDSTATE(command);
+   MMC_ADDSTATE(vrombase);
+
    irq.counter = irq.latch = 0;
    irq.enabled = irq.reset = false;
    reg = command = 0;
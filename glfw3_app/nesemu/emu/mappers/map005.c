@@ -32,12 +32,14 @@
 ** let's implement it correctly/completely
 */
 
-static struct
+static NES_TLS struct
 {
    int counter, enabled;
    int reset, latch;
 } irq;
 
+static NES_TLS int page_size = 8;
+
 /* MMC5 - Castlevania III, etc */
 static void map5_hblank(int vblank)
 {
@@ -58,8 +60,6 @@ static void map5_hblank(int vblank)
 
 static void map5_write(uint32 address, uint8 value)
 {
-   static int page_size = 8;
-
    /* ex-ram memory-- bleh! */
    if (address >= 0x5C00 && address <= 0x5FFF)
       return;
@@ -225,6 +225,9 @@ static uint8 map5_read(uint32 address)
 
 static void map5_init(void)
 {
+   MMC_ADDSTATE(irq);
+   MMC_ADDSTATE(page_size);
+
    mmc_bankrom(8, 0x8000, MMC_LASTBANK);
    mmc_bankrom(8, 0xA000, MMC_LASTBANK);
    mmc_bankrom(8, 0xC000, MMC_LASTBANK);
@@ -29,8 +29,8 @@
 #include "nes_ppu.h"
 #include "libsnss.h"
 
-static uint8 latch[2];
-static uint8 regs[4];
+static NES_TLS uint8 latch[2];
+static NES_TLS uint8 regs[4];
 
 /* Used when tile $FD/$FE is accessed */
 static void mmc9_latchfunc(uint32 address, uint8 value)
@@ -102,6 +102,9 @@ static void map9_write(uint32 address, uint8 value)
 
 static void map9_init(void)
 {
+   MMC_ADDSTATE(latch);
+   MMC_ADDSTATE(regs);
+
    memset(regs, 0, sizeof(regs));
 
    mmc_bankrom(8, 0x8000, 0);
@@ -27,7 +27,7 @@
 #include "nes_ppu.h"
 #include "nes.h"
 
-static struct
+static NES_TLS struct
 {
    int counter;
    bool enabled;
@@ -37,6 +37,8 @@ static struct
 
 static void map16_init(void)
 {
+   MMC_ADDSTATE(irq);
+
    mmc_bankrom(16, 0x8000, 0);
    mmc_bankrom(16, 0xC000, MMC_LASTBANK);
    irq.counter = 0;
@@ -45,23 +45,29 @@ do { \
    mmc_bankvrom(1, (bank) << 10, (highnybbles[(bank)] << 4)+lownybbles[(bank)]); \
 }
 
-static struct
+static NES_TLS struct
 {
    int counter, enabled;
    uint8 nybbles[4];
    int clockticks;
 } irq;
 
+static NES_TLS uint8 lownybbles[8];
+static NES_TLS uint8 highnybbles[8];
+static NES_TLS uint8 lowprgnybbles[3];
+static NES_TLS uint8 highprgnybbles[3];
+
 static void map18_init(void)
 {
+   MMC_ADDSTATE(irq);
+   MMC_ADDSTATE(lownybbles);
+   MMC_ADDSTATE(highnybbles);
+   MMC_ADDSTATE(lowprgnybbles);
+   MMC_ADDSTATE(highprgnybbles);
+
    irq.counter = irq.enabled = 0;
 }
 
-static uint8 lownybbles[8];
-static uint8 highnybbles[8];
-static uint8 lowprgnybbles[3];
-static uint8 highprgnybbles[3];
-
 
 static void map18_write(uint32 address, uint8 value)
 {
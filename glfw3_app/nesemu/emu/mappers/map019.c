@@ -38,13 +38,15 @@
    ppu_mirrorhipages(); \
 }
 
-static struct
+static NES_TLS struct
 {
    int counter, enabled;
 } irq;
 
 static void map19_init(void)
 {
+   MMC_ADDSTATE(irq);
+
    irq.counter = irq.enabled = 0;
 }
 
@@ -28,7 +28,7 @@
 #include "log.h"
 #include "vrcvisnd.h"
 
-static struct
+static NES_TLS struct
 {
    int counter, enabled;
    int latch, wait_state;
@@ -36,6 +36,8 @@ static struct
 
 static void map24_init(void)
 {
+   MMC_ADDSTATE(irq);
+
    irq.counter = irq.enabled = 0;
    irq.latch = irq.wait_state = 0;
 }
@@ -26,7 +26,7 @@
 #include "nes_mmc.h"
 #include "nes_ppu.h"
 
-static int select_c000 = 0;
+static NES_TLS int select_c000 = 0;
 
 /* mapper 32: Irem G-101 */
 static void map32_write(uint32 address, uint8 value)
@@ -65,6 +65,11 @@ static void map32_write(uint32 address, uint8 value)
    }
 }
 
+static void map32_init(void)
+{
+   MMC_ADDSTATE(select_c000);
+}
+
 static map_memwrite map32_memwrite[] =
 {
    { 0x8000, 0xFFFF, map32_write },
@@ -75,7 +80,7 @@ mapintf_t map32_intf =
 {
    32, /* mapper number */
    "Irem G-101", /* mapper name */
-   NULL, /* init routine */
+   map32_init, /* init routine */
    NULL, /* vblank callback */
    NULL, /* hblank callback */
    NULL, /* get state (snss) */
@@ -30,7 +30,7 @@
 
 #define  MAP40_IRQ_PERIOD  (4096 / 113.666666)
 
-static struct
+static NES_TLS struct
 {
    int enabled, counter;
 } irq;
@@ -38,6 +38,8 @@ static struct
 /* mapper 40: SMB 2j (hack) */
 static void map40_init(void)
 {
+   MMC_ADDSTATE(irq);
+
    mmc_bankrom(8, 0x6000, 6);
    mmc_bankrom(8, 0x8000, 4);
    mmc_bankrom(8, 0xA000, 5);
@@ -31,8 +31,8 @@
 #include "libsnss.h"
 #include "log.h"
 
-static uint8 register_low;
-static uint8 register_high;
+static NES_TLS uint8 register_low;
+static NES_TLS uint8 register_high;
 
 /*****************************************************/
 /* Set 8K CHR bank from the combined register values */
@@ -51,6 +51,9 @@ static void map41_set_chr (void)
 /******************************/
 static void map41_init (void)
 {
+  MMC_ADDSTATE(register_low);
+  MMC_ADDSTATE(register_high);
+
   /* Both registers set to zero at power on */
   /* TODO: Registers should also be cleared on a soft reset */
   register_low = 0x00;
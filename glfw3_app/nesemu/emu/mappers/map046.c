@@ -31,10 +31,10 @@
 #include "libsnss.h"
 #include "log.h"
 
-static uint8 prg_low_bank;
-static uint8 chr_low_bank;
-static uint8 prg_high_bank;
-static uint8 chr_high_bank;
+static NES_TLS uint8 prg_low_bank;
+static NES_TLS uint8 chr_low_bank;
+static NES_TLS uint8 prg_high_bank;
+static NES_TLS uint8 chr_high_bank;
 
 /*************************************************/
 /* Set banks from the combined register values   */
@@ -54,6 +54,11 @@ static void map46_set_banks (void)
 /*********************************************************/
 static void map46_init (void)
 {
+  MMC_ADDSTATE(prg_low_bank);
+  MMC_ADDSTATE(chr_low_bank);
+  MMC_ADDSTATE(prg_high_bank);
+  MMC_ADDSTATE(chr_high_bank);
+
   /* High bank switch register is set to zero on reset */
   prg_high_bank = 0x00;
   chr_high_bank = 0x00;
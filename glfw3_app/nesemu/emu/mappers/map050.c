@@ -31,7 +31,7 @@
 #include "libsnss.h"
 #include "log.h"
 
-static struct
+static NES_TLS struct
 {
   bool enabled;
   uint32 counter;
@@ -55,6 +55,8 @@ static void map50_irq_reset (void)
 /**************************************************************/
 static void map50_init (void)
 {
+  MMC_ADDSTATE(irq);
+
   /* Set the hardwired pages */
   mmc_bankrom (8, 0x6000, 0x0F);
   mmc_bankrom (8, 0x8000, 0x08);
@@ -27,14 +27,14 @@
 #include "nes.h"
 #include "log.h"
 
-static struct
+static NES_TLS struct
 {
    int counter, latch;
    bool enabled, reset;
 } irq;
 
-static uint8 command = 0;
-static uint16 vrombase = 0x0000;
+static NES_TLS uint8 command = 0;
+static NES_TLS uint16 vrombase = 0x0000;
 
 static void map64_hblank(int vblank)
 {
@@ -163,6 +163,10 @@ static void map64_write(uint32 address, uint8 value)
 
 static void map64_init(void)
 {
+   MMC_ADDSTATE(irq);
+   MMC_ADDSTATE(command);
+   MMC_ADDSTATE(vrombase);
+
    mmc_bankrom(8, 0x8000, MMC_LASTBANK);
    mmc_bankrom(8, 0xA000, MMC_LASTBANK);
    mmc_bankrom(8, 0xC000, MMC_LASTBANK);
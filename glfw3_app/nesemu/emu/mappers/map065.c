@@ -26,7 +26,7 @@
 #include "nes_mmc.h"
 #include "nes_ppu.h"
 
-static struct
+static NES_TLS struct
 {
    int counter;
    bool enabled;
@@ -36,6 +36,8 @@ static struct
 
 static void map65_init(void)
 {
+   MMC_ADDSTATE(irq);
+
    irq.counter = 0;
    irq.enabled = false;
    irq.low = irq.high = 0;
@@ -30,7 +30,7 @@
 #include "libsnss.h"
 #include "log.h"
 
-static struct
+static NES_TLS struct
 {
   bool enabled;
   uint32 counter;
@@ -41,6 +41,8 @@ static struct
 /**************************/
 static void map73_init (void)
 {
+  MMC_ADDSTATE(irq);
+
   /* Turn off IRQs */
   irq.enabled = false;
   irq.counter = 0x0000;
@@ -27,8 +27,8 @@
 #include "nes_ppu.h"
 
 
-static uint8 latch[2];
-static uint8 hibits;
+static NES_TLS uint8 latch[2];
+static NES_TLS uint8 hibits;
 
 /* mapper 75: Konami VRC1 */
 static void map75_write(uint32 address, uint8 value)
@@ -75,6 +75,12 @@ static void map75_write(uint32 address, uint8 value)
    }
 }
 
+static void map75_init(void)
+{
+   MMC_ADDSTATE(latch);
+   MMC_ADDSTATE(hibits);
+}
+
 static map_memwrite map75_memwrite[] =
 {
    { 0x8000, 0xFFFF, map75_write },
@@ -85,7 +91,7 @@ mapintf_t map75_intf =
 {
    75, /* mapper number */
    "Konami VRC1", /* mapper name */
-   NULL, /* init routine */
+   map75_init, /* init routine */
    NULL, /* vblank callback */
    NULL, /* hblank callback */
    NULL, /* get state (snss) */
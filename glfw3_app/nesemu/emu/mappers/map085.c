@@ -27,7 +27,7 @@
 #include "nes.h"
 #include "log.h"
 
-static struct
+static NES_TLS struct
 {
    int counter, latch;
    int wait_state;
@@ -157,6 +157,8 @@ static map_memwrite map85_memwrite[] =
 
 static void map85_init(void)
 {
+   MMC_ADDSTATE(irq);
+
    mmc_bankrom(16, 0x8000, 0);
    mmc_bankrom(16, 0xC000, MMC_LASTBANK);
    
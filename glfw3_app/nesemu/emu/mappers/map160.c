@@ -27,7 +27,7 @@
 #include "nes_ppu.h"
 #include "nes.h"
 
-static struct
+static NES_TLS struct
 {
    bool enabled, expired;
    int counter;
@@ -96,6 +96,8 @@ static void map160_hblank(int vblank)
 
 static void map160_init(void)
 {
+   MMC_ADDSTATE(irq);
+
    irq.enabled = false;
    irq.expired = false;
    irq.counter = 0;
@@ -36,18 +36,23 @@
    mmc_bankvrom(1, (bank) << 10, (highnybbles[(bank)] << 4)+lownybbles[(bank)]); \
 }
 
-static struct
+static NES_TLS struct
 {
    int counter, enabled;
    int latch, wait_state;
 } irq;
 
-static int select_c000 = 0;
-static uint8 lownybbles[8];
-static uint8 highnybbles[8];
+static NES_TLS int select_c000 = 0;
+static NES_TLS uint8 lownybbles[8];
+static NES_TLS uint8 highnybbles[8];
 
 static void vrc_init(void)
 {
+   MMC_ADDSTATE(irq);
+   MMC_ADDSTATE(select_c000);
+   MMC_ADDSTATE(lownybbles);
+   MMC_ADDSTATE(highnybbles);
+
    irq.counter = irq.enabled = 0;
    irq.latch = irq.wait_state = 0;
 }
@@ -394,7 +399,7 @@ mapintf_t map25_intf =
 {
    25, /* mapper number */
    "Konami VRC4 B", /* mapper name */
-   NULL, /* init routine */
+   vrc_init, /* init routine */
    NULL, /* vblank callback */
    vrc_hblank, /* hblank callback */
    NULL, /* get state (snss) */
@@ -44,7 +44,7 @@
 
 #define  NES_SKIP_LIMIT       (NES_REFRESH_RATE / 5)   /* 12 or 10, depending on PAL/NTSC */
 
-static nes_t nes_;
+static NES_TLS nes_t nes_;
 
 nes_t *nes_getcontext(void)
 {
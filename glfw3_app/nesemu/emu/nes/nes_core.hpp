@@ -0,0 +1,353 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	ヘッドレス NES コア・クラス @n
+			ウィンドウ無しで、フレーム単位にエミュレーションを進める。@n
+			エミュレータの状態はスレッド毎に持つ為（NES_REENTRANT）、@n
+			インスタンス毎に専用スレッドを起動し、コアの操作は全てそこで行う。@n
+			NES_REENTRANT を定義せずにビルドした場合、インスタンスは一つに限られる。@n
+			※ログ出力関数「emu_log」はアプリケーション側で用意する事。
+	@author	平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017, 2019 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/glfw3_app/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+
+#include "emu/nes/nes.h"
+#include "emu/nes/nesinput.h"
+#include "emu/nes/nes_pal.h"
+#include "img_io/pixel_lut.hpp"
+
+namespace emu {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	ヘッドレス NES コア・クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class nes_core {
+	public:
+		static const int width  = NES_SCREEN_WIDTH;
+		static const int height = NES_SCREEN_HEIGHT;
+
+		//=============================================================//
+		/*!
+			@brief	１フレームの出力
+		*/
+		//=============================================================//
+		struct frame_t {
+			std::vector<uint32_t>	fb;		///< RGBA フレームバッファ（width * height）
+			std::vector<int16_t>	audio;	///< １フレーム分のサンプル（モノラル）
+			uint32_t				count;	///< フレーム番号
+			uint32_t				cycles;	///< このフレームで実行した CPU サイクル数
+			frame_t() : fb(width * height), audio(), count(0), cycles(0) { }
+		};
+
+	private:
+		typedef std::function<void ()>	task;
+
+		int				sample_rate_;
+
+		std::thread		thread_;
+		std::mutex		sync_;
+		std::condition_variable	cond_;
+		task			task_;
+		bool			busy_;
+		bool			quit_;
+		bool			ok_;
+
+		nesinput_t		inp_[2];
+		bool			cart_;
+
+		img::pixel_lut	lut_;
+
+		frame_t			frame_;
+
+		// パレット生成等、プロセス共有の初期化を直列化する
+		static std::mutex& create_sync_() {
+			static std::mutex m;
+			return m;
+		}
+
+		static std::atomic<int>& instance_num_() {
+			static std::atomic<int> n(0);
+			return n;
+		}
+
+		void worker_()
+		{
+			{
+				std::lock_guard<std::mutex> lock(create_sync_());
+				ok_ = nes_create(sample_rate_, 16) == 0;
+			}
+			lut_.set_palette(get_palette(), 64);
+			if(ok_) {
+				inp_[0].type = INP_JOYPAD0;
+				inp_[0].data = 0;
+				input_register(&inp_[0]);
+				inp_[1].type = INP_JOYPAD1;
+				inp_[1].data = 0;
+				input_register(&inp_[1]);
+			}
+			{
+				std::lock_guard<std::mutex> lock(sync_);
+				busy_ = false;
+			}
+			cond_.notify_all();
+
+			while(1) {
+				task t;
+				{
+					std::unique_lock<std::mutex> lock(sync_);
+					cond_.wait(lock, [this] { return quit_ || busy_; });
+					if(quit_) break;
+					t = std::move(task_);
+				}
+				t();
+				{
+					std::lock_guard<std::mutex> lock(sync_);
+					busy_ = false;
+				}
+				cond_.notify_all();
+			}
+
+			if(ok_) nes_destroy();
+		}
+
+
+		void wait_()
+		{
+			std::unique_lock<std::mutex> lock(sync_);
+			cond_.wait(lock, [this] { return !busy_; });
+		}
+
+
+		void post_(task t)
+		{
+			wait_();
+			{
+				std::lock_guard<std::mutex> lock(sync_);
+				task_ = std::move(t);
+				busy_ = true;
+			}
+			cond_.notify_all();
+		}
+
+
+		void render_frame_(uint8_t pad0, uint8_t pad1)
+		{
+			inp_[0].data = pad0;
+			inp_[1].data = pad1;
+			uint32_t org = nes6502_getcycles(false);
+			nes_emulate(1);
+			frame_.cycles = nes6502_getcycles(false) - org;
+
+			frame_.audio.resize(sample_rate_ / NES_REFRESH_RATE);
+			apu_process(&frame_.audio[0], frame_.audio.size());
+
+			const bitmap_t* v = nes_getcontext()->vidbuf;
+			if(v != nullptr) {
+				lut_.convert(v->data, v->pitch, &frame_.fb[0], width, height);
+			}
+			++frame_.count;
+		}
+
+	public:
+		//-------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+			@param[in]	sample_rate	オーディオ・サンプルレート
+		*/
+		//-------------------------------------------------------------//
+		nes_core(int sample_rate = 44100) : sample_rate_(sample_rate),
+			thread_(), task_(), busy_(false), quit_(false), ok_(false),
+			cart_(false), frame_() { }
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	デストラクター
+		*/
+		//-------------------------------------------------------------//
+		~nes_core() { destroy(); }
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	コアを起動
+			@return 失敗した場合「false」
+		*/
+		//-------------------------------------------------------------//
+		bool start()
+		{
+			if(thread_.joinable()) return ok_;
+
+			int n = instance_num_().fetch_add(1);
+#ifndef NES_REENTRANT
+			if(n > 0) {
+				instance_num_().fetch_sub(1);
+				return false;
+			}
+#else
+			(void)n;
+#endif
+			busy_ = true;
+			quit_ = false;
+			thread_ = std::thread(&nes_core::worker_, this);
+			wait_();
+			if(!ok_) {
+				destroy();
+			}
+			return ok_;
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	コアを廃棄
+		*/
+		//-------------------------------------------------------------//
+		void destroy()
+		{
+			if(!thread_.joinable()) return;
+
+			wait_();
+			{
+				std::lock_guard<std::mutex> lock(sync_);
+				quit_ = true;
+			}
+			cond_.notify_all();
+			thread_.join();
+			instance_num_().fetch_sub(1);
+			ok_ = false;
+			cart_ = false;
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	コアのスレッドで関数を実行（終了まで待つ）@n
+					nes_xxx 等、コアの C API はこの中から呼ぶ事。
+			@param[in]	func	関数
+		*/
+		//-------------------------------------------------------------//
+		void exec(task func)
+		{
+			if(!ok_) return;
+			post_(std::move(func));
+			wait_();
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	カートリッジを挿入
+			@param[in]	file	NES ファイル
+			@return 失敗した場合「false」
+		*/
+		//-------------------------------------------------------------//
+		bool open(const std::string& file)
+		{
+			bool ret = false;
+			exec([&] { ret = nes_insertcart(file.c_str()) == 0; });
+			cart_ = ret;
+			frame_.count = 0;
+			return ret;
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	リセット
+			@param[in]	hard	ハード・リセットの場合「true」
+		*/
+		//-------------------------------------------------------------//
+		void reset(bool hard = true)
+		{
+			if(!cart_) return;
+			exec([=] { nes_reset(hard ? HARD_RESET : SOFT_RESET); });
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	１フレームの実行を要求（ブロックしない）@n
+					複数のインスタンスを並列に進める場合、全てに要求してから @n
+					wait_frame で結果を受け取る。
+			@param[in]	pad0	パッド０の入力（INP_PAD_xxx）
+			@param[in]	pad1	パッド１の入力（INP_PAD_xxx）
+			@return カートリッジが無い場合「false」
+		*/
+		//-------------------------------------------------------------//
+		bool request_frame(uint8_t pad0, uint8_t pad1 = 0)
+		{
+			if(!ok_ || !cart_) return false;
+			post_([=] { render_frame_(pad0, pad1); });
+			return true;
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	要求したフレームの完了を待つ
+			@return フレーム
+		*/
+		//-------------------------------------------------------------//
+		const frame_t& wait_frame()
+		{
+			if(ok_) wait_();
+			return frame_;
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	１フレーム進める
+			@param[in]	pad0	パッド０の入力（INP_PAD_xxx）
+			@param[in]	pad1	パッド１の入力（INP_PAD_xxx）
+			@return フレーム
+		*/
+		//-------------------------------------------------------------//
+		const frame_t& step_frame(uint8_t pad0, uint8_t pad1 = 0)
+		{
+			request_frame(pad0, pad1);
+			return wait_frame();
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	最後のフレームを取得
+			@return フレーム
+		*/
+		//-------------------------------------------------------------//
+		const frame_t& get_frame() const { return frame_; }
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	カートリッジが挿入されているか
+			@return 挿入されていれば「true」
+		*/
+		//-------------------------------------------------------------//
+		bool is_open() const { return cart_; }
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	サンプルレートを取得
+			@return サンプルレート
+		*/
+		//-------------------------------------------------------------//
+		int get_sample_rate() const { return sample_rate_; }
+	};
+}
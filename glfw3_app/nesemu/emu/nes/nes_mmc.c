@@ -48,7 +48,7 @@
 #define  MMC_LAST2KVROM    (MMC_2KVROM - 1)
 #define  MMC_LAST1KVROM    (MMC_1KVROM - 1)
 
-static mmc_t mmc_;
+static NES_TLS mmc_t mmc_;
 
 rominfo_t *mmc_getinfo(void)
 {
@@ -201,6 +201,9 @@ void mmc_reset(void)
    ppu_setlatchfunc(NULL);
    ppu_setvromswitch(NULL);
 
+   /* the init routine registers its variables again */
+   mmc_.num_states = 0;
+
    if (mmc_.intf->init)
       mmc_.intf->init();
 
@@ -208,6 +211,50 @@ void mmc_reset(void)
 }
 
 
+/* register a mapper variable, so that snapshots carry it */
+void mmc_addstate(void *data, int size)
+{
+   ASSERT(mmc_.num_states < MMC_MAX_STATES);
+   if (mmc_.num_states >= MMC_MAX_STATES)
+      return;
+
+   mmc_.states[mmc_.num_states].data = data;
+   mmc_.states[mmc_.num_states].size = size;
+   mmc_.num_states++;
+}
+
+int mmc_statesize(void)
+{
+   int i, size = 0;
+
+   for (i = 0; i < mmc_.num_states; i++)
+      size += mmc_.states[i].size;
+
+   return size;
+}
+
+void mmc_getstates(uint8 *buf)
+{
+   int i;
+
+   for (i = 0; i < mmc_.num_states; i++)
+   {
+      memcpy(buf, mmc_.states[i].data, mmc_.states[i].size);
+      buf += mmc_.states[i].size;
+   }
+}
+
+void mmc_setstates(const uint8 *buf)
+{
+   int i;
+
+   for (i = 0; i < mmc_.num_states; i++)
+   {
+      memcpy(mmc_.states[i].data, buf, mmc_.states[i].size);
+      buf += mmc_.states[i].size;
+   }
+}
+
 int mmc_create(rominfo_t *rominfo)
 {
 	const mapintf_t **map_ptr;
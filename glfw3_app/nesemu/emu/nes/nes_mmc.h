@@ -29,6 +29,10 @@
 
 #define  MMC_LASTBANK      -1
 
+/* mapper-private variables copied by in-memory snapshots */
+#define  MMC_MAX_STATES    8
+#define  MMC_ADDSTATE(v)   mmc_addstate(&(v), sizeof(v))
+
 typedef struct
 {
    uint32 min_range, max_range;
@@ -58,10 +62,18 @@ typedef struct mapintf_s
 
 
 #include <nes_rom.h>
+typedef struct mmc_state_s
+{
+   void *data;
+   int size;
+} mmc_state_t;
+
 typedef struct mmc_s
 {
    const mapintf_t *intf;
    rominfo_t *cart;  /* link it back to the cart */
+   mmc_state_t states[MMC_MAX_STATES];  /* registered by the mapper init */
+   int num_states;
 } mmc_t;
 
 #ifdef __cplusplus
@@ -82,6 +94,11 @@ extern bool mmc_peek(int map_num);
 
 extern void mmc_reset(void);
 
+extern void mmc_addstate(void *data, int size);
+extern int mmc_statesize(void);
+extern void mmc_getstates(uint8 *buf);
+extern void mmc_setstates(const uint8 *buf);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -48,7 +48,7 @@
 #define  FULLBG               (ppu.palette[0] | BG_TRANS)
 
 /* the NES PPU */
-static ppu_t ppu;
+static NES_TLS ppu_t ppu;
 
 void ppu_displaysprites(bool display)
 {
@@ -0,0 +1,230 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	NES 巻き戻しリング・クラス @n
+			毎フレームのスナップショット（state_snapshot）を、直前のフレームとの @n
+			XOR 差分にして zlib で圧縮し、リングバッファに積む。@n
+			差分は「現在 ^ 直前」なので、最新から順に辿れば、任意の過去のフレームに戻れる。@n
+			※コアの C API を呼ぶので、エミュレーションと同じスレッドで使う事。
+	@author	平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017, 2019 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/glfw3_app/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <vector>
+#include <chrono>
+#include <zlib.h>
+
+#include "emu/nes/nes.h"
+#include "emu/nes/nesstate.h"
+
+namespace emu {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	NES 巻き戻しリング・クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class nes_rewind {
+	public:
+
+		//=============================================================//
+		/*!
+			@brief	統計情報
+		*/
+		//=============================================================//
+		struct info_t {
+			uint32_t	frames;		///< 保持しているフレーム数
+			uint32_t	bytes;		///< 圧縮後の合計サイズ
+			uint32_t	raw;		///< スナップショット１枚のサイズ
+			double		last_us;	///< 最後の push に掛かった時間（マイクロ秒）
+			double		avg_us;		///< push の平均時間（マイクロ秒）
+			double		max_us;		///< push の最大時間（マイクロ秒）
+			info_t() : frames(0), bytes(0), raw(0), last_us(0.0), avg_us(0.0), max_us(0.0) { }
+		};
+
+	private:
+		typedef std::vector<uint8_t>	buffer;
+		typedef std::chrono::steady_clock	clock;
+
+		std::vector<buffer>	ring_;
+		uint32_t	top_;	///< 次に書き込む位置
+		uint32_t	num_;
+
+		buffer		cur_;	///< 最新フレームのスナップショット
+		buffer		tmp_;
+		buffer		delta_;
+
+		info_t		info_;
+		double		time_sum_;
+		uint32_t	time_cnt_;
+
+		static void xor_(const buffer& a, const buffer& b, buffer& out)
+		{
+			out.resize(a.size());
+			for(size_t i = 0; i < a.size(); ++i) {
+				out[i] = a[i] ^ b[i];
+			}
+		}
+
+		uint32_t newest_() const { return (top_ + ring_.size() - 1) % ring_.size(); }
+
+	public:
+		//-------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+			@param[in]	frames	保持するフレーム数（６０で１秒）
+		*/
+		//-------------------------------------------------------------//
+		nes_rewind(uint32_t frames = 600) : ring_(frames < 2 ? 2 : frames), top_(0), num_(0),
+			cur_(), tmp_(), delta_(), info_(), time_sum_(0.0), time_cnt_(0) { }
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	クリア（確保したバッファは再利用する）
+		*/
+		//-------------------------------------------------------------//
+		void clear()
+		{
+			for(buffer& b : ring_) b.clear();
+			top_ = 0;
+			num_ = 0;
+			cur_.clear();
+			info_ = info_t();
+			time_sum_ = 0.0;
+			time_cnt_ = 0;
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	現在のマシンの状態を積む（毎フレーム呼ぶ）
+			@return 失敗した場合「false」（カートリッジ無し等）
+		*/
+		//-------------------------------------------------------------//
+		bool push()
+		{
+			auto t0 = clock::now();
+
+			int size = state_snapshot_size();
+			if(size <= 0) return false;
+			if(cur_.size() != static_cast<size_t>(size)) {  // カートリッジが変わった
+				clear();
+				cur_.resize(size, 0);
+			}
+			tmp_.resize(size);
+			if(state_snapshot(&tmp_[0], size) != size) return false;
+
+			xor_(tmp_, cur_, delta_);
+			cur_.swap(tmp_);
+
+			buffer& dst = ring_[top_];
+			info_.bytes -= dst.size();
+			uLongf len = compressBound(delta_.size());
+			dst.resize(len);
+			if(compress2(&dst[0], &len, &delta_[0], delta_.size(), Z_BEST_SPEED) != Z_OK) {
+				dst.clear();
+				clear();
+				return false;
+			}
+			dst.resize(len);
+			info_.bytes += len;
+
+			top_ = (top_ + 1) % ring_.size();
+			if(num_ < ring_.size()) ++num_;
+
+			auto t = std::chrono::duration<double, std::micro>(clock::now() - t0).count();
+			info_.last_us = t;
+			if(info_.max_us < t) info_.max_us = t;
+			time_sum_ += t;
+			++time_cnt_;
+			info_.avg_us = time_sum_ / time_cnt_;
+			info_.frames = num_;
+			info_.raw = size;
+			return true;
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	１フレーム巻き戻し、マシンの状態を復元する
+			@return 戻れない場合「false」
+		*/
+		//-------------------------------------------------------------//
+		bool pop()
+		{
+			// 最新の差分の基準は、一つ前のフレーム
+			if(num_ < 2) return false;
+
+			uint32_t pos = newest_();
+			buffer& src = ring_[pos];
+			delta_.resize(cur_.size());
+			uLongf len = delta_.size();
+			if(uncompress(&delta_[0], &len, &src[0], src.size()) != Z_OK || len != delta_.size()) {
+				return false;
+			}
+			xor_(cur_, delta_, tmp_);
+			if(state_restore(&tmp_[0], tmp_.size()) != 0) {
+				return false;
+			}
+			cur_.swap(tmp_);
+
+			info_.bytes -= src.size();
+			src.clear();
+			top_ = pos;
+			--num_;
+			info_.frames = num_;
+			return true;
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	保持しているフレーム数を取得
+			@return フレーム数
+		*/
+		//-------------------------------------------------------------//
+		uint32_t size() const { return num_; }
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	統計情報を取得
+			@return 統計情報
+		*/
+		//-------------------------------------------------------------//
+		const info_t& get_info() const { return info_; }
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	ベンチマーク @n
+					作業用のリングに frames フレーム実行しながら積み、その後、@n
+					最初の状態に戻す。（利用中のリングには触れない）
+			@param[in]	frames	フレーム数
+			@return 統計情報
+		*/
+		//-------------------------------------------------------------//
+		static info_t benchmark(uint32_t frames)
+		{
+			info_t info;
+			int size = state_snapshot_size();
+			if(size <= 0) return info;
+			buffer save(size);
+			if(state_snapshot(&save[0], size) != size) return info;
+
+			nes_rewind work(frames);
+			for(uint32_t i = 0; i < frames; ++i) {
+				nes_emulate(1);
+				work.push();
+			}
+			info = work.get_info();
+
+			state_restore(&save[0], size);
+			return info;
+		}
+	};
+}
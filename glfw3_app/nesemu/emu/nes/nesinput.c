@@ -30,11 +30,11 @@
 **       can be removed if need be
 */
 
-static nesinput_t *nes_input[MAX_CONTROLLERS];
-static int active_entries = 0;
+static NES_TLS nesinput_t *nes_input[MAX_CONTROLLERS];
+static NES_TLS int active_entries = 0;
 
 /* read counters */
-static int pad0_readcount, pad1_readcount, ppad_readcount, ark_readcount;
+static NES_TLS int pad0_readcount, pad1_readcount, ppad_readcount, ark_readcount;
 
 
 static int retrieve_type(int type)
@@ -179,6 +179,23 @@ void input_strobe(void)
    ark_readcount = 0;
 }
 
+/* read counters, for in-memory snapshots */
+void input_getcounts(int *counts)
+{
+   counts[0] = pad0_readcount;
+   counts[1] = pad1_readcount;
+   counts[2] = ppad_readcount;
+   counts[3] = ark_readcount;
+}
+
+void input_setcounts(const int *counts)
+{
+   pad0_readcount = counts[0];
+   pad1_readcount = counts[1];
+   ppad_readcount = counts[2];
+   ark_readcount = counts[3];
+}
+
 /*
 ** $Log: nesinput.c,v $
 ** Revision 1.2  2001/04/27 14:37:11  neil
@@ -84,6 +84,8 @@ extern uint8 input_get(int type);
 extern void input_register(nesinput_t *input);
 extern void input_event(nesinput_t *input, int state, int value);
 extern void input_strobe(void);
+extern void input_getcounts(int *counts);
+extern void input_setcounts(const int *counts);
 
 #ifdef __cplusplus
 }
@@ -30,11 +30,12 @@
 #include "log.h"
 #include "libsnss.h"
 #include "nes6502.h"
+#include "nesinput.h"
 
 #define  FIRST_STATE_SLOT  0
 #define  LAST_STATE_SLOT   9
 
-static int state_slot = FIRST_STATE_SLOT;
+static NES_TLS int state_slot = FIRST_STATE_SLOT;
 
 /* Set the state-save slot to use (0 - 9) */
 void state_setslot(int slot)
@@ -473,6 +474,135 @@ _error:
 	return -1;
 }
 
+/* In-memory snapshots
+** The whole machine context is copied as-is, host pointers included, so
+** a snapshot can only be restored into the instance (and cart) that made it.
+** Mapper registers are carried by the mapper's own get_state/set_state,
+** followed by a raw copy of the variables the mapper registered with
+** mmc_addstate() (the SNSS block does not hold all of them).
+*/
+#define  SNAPSHOT_MAGIC    0x504E534E  /* 'NSNP' */
+#define  SNAPSHOT_RAMSIZE  0x800
+
+typedef struct snapshot_header_s
+{
+   uint32 magic;
+   int32 size;
+   const rominfo_t *cart;
+   int32 sram_length;
+   int32 vram_length;
+} snapshot_header_t;
+
+static int snapshot_sram_length(const nes_t *machine)
+{
+   if (NULL == machine->rominfo->sram)
+      return 0;
+   return machine->rominfo->sram_banks * SRAM_1K;
+}
+
+static int snapshot_vram_length(const nes_t *machine)
+{
+   if (NULL == machine->rominfo->vram)
+      return 0;
+   return machine->rominfo->vram_banks * VRAM_8K;
+}
+
+/* size of the snapshot of the current cart (0 if no cart inserted) */
+int state_snapshot_size(void)
+{
+   nes_t *machine = nes_getcontext();
+
+   if (NULL == machine->rominfo || NULL == machine->mmc)
+      return 0;
+
+   return sizeof(snapshot_header_t)
+          + sizeof(nes_t) + sizeof(nes6502_context) + sizeof(ppu_t) + sizeof(apu_t)
+          + SNAPSHOT_RAMSIZE + snapshot_sram_length(machine) + snapshot_vram_length(machine)
+          + sizeof(SnssMapperBlock) + sizeof(int) * 4 + mmc_statesize();
+}
+
+#define  SNAPSHOT_PUT(p, src, len)  { memcpy((p), (src), (len)); (p) += (len); }
+#define  SNAPSHOT_GET(dst, p, len)  { memcpy((dst), (p), (len)); (p) += (len); }
+
+/* take a snapshot, returns the number of bytes written or -1 */
+int state_snapshot(uint8 *buf, int size)
+{
+   snapshot_header_t hdr;
+   SnssMapperBlock mapper;
+   int counts[4];
+   nes_t *machine = nes_getcontext();
+   uint8 *p = buf;
+
+   hdr.size = state_snapshot_size();
+   if (0 == hdr.size || size < hdr.size)
+      return -1;
+
+   hdr.magic = SNAPSHOT_MAGIC;
+   hdr.cart = machine->rominfo;
+   hdr.sram_length = snapshot_sram_length(machine);
+   hdr.vram_length = snapshot_vram_length(machine);
+
+   memset(&mapper, 0, sizeof(mapper));
+   if (machine->mmc->intf->get_state)
+      machine->mmc->intf->get_state(&mapper);
+
+   input_getcounts(counts);
+
+   SNAPSHOT_PUT(p, &hdr, sizeof(hdr));
+   SNAPSHOT_PUT(p, machine, sizeof(nes_t));
+   SNAPSHOT_PUT(p, machine->cpu, sizeof(nes6502_context));
+   SNAPSHOT_PUT(p, machine->ppu, sizeof(ppu_t));
+   SNAPSHOT_PUT(p, machine->apu, sizeof(apu_t));
+   SNAPSHOT_PUT(p, machine->cpu->mem_page[0], SNAPSHOT_RAMSIZE);
+   SNAPSHOT_PUT(p, machine->rominfo->sram, hdr.sram_length);
+   SNAPSHOT_PUT(p, machine->rominfo->vram, hdr.vram_length);
+   SNAPSHOT_PUT(p, &mapper, sizeof(mapper));
+   SNAPSHOT_PUT(p, counts, sizeof(counts));
+   mmc_getstates(p);
+   p += mmc_statesize();
+
+   return (int) (p - buf);
+}
+
+/* restore a snapshot taken by state_snapshot(), returns 0 or -1 */
+int state_restore(const uint8 *buf, int size)
+{
+   snapshot_header_t hdr;
+   SnssMapperBlock mapper;
+   int counts[4];
+   nes_t *machine = nes_getcontext();
+   const uint8 *p;
+
+   if (size < (int) sizeof(hdr))
+      return -1;
+
+   memcpy(&hdr, buf, sizeof(hdr));
+   if (SNAPSHOT_MAGIC != hdr.magic || hdr.size != size
+       || hdr.size != state_snapshot_size() || hdr.cart != machine->rominfo)
+      return -1;
+
+   /* mapper first: set_state may bank-switch, the raw pages below win */
+   p = buf + size - mmc_statesize() - sizeof(counts) - sizeof(mapper);
+   SNAPSHOT_GET(&mapper, p, sizeof(mapper));
+   SNAPSHOT_GET(counts, p, sizeof(counts));
+   if (machine->mmc->intf->set_state)
+      machine->mmc->intf->set_state(&mapper);
+   mmc_setstates(p);
+
+   p = buf + sizeof(hdr);
+   SNAPSHOT_GET(machine, p, sizeof(nes_t));
+   SNAPSHOT_GET(machine->cpu, p, sizeof(nes6502_context));
+   SNAPSHOT_GET(machine->ppu, p, sizeof(ppu_t));
+   SNAPSHOT_GET(machine->apu, p, sizeof(apu_t));
+   SNAPSHOT_GET(machine->cpu->mem_page[0], p, SNAPSHOT_RAMSIZE);
+   SNAPSHOT_GET(machine->rominfo->sram, p, hdr.sram_length);
+   SNAPSHOT_GET(machine->rominfo->vram, p, hdr.vram_length);
+
+   input_setcounts(counts);
+
+   return 0;
+}
+
 /*
 ** $Log: nesstate.c,v $
 ** Revision 1.2  2001/04/27 14:37:11  neil
@@ -33,6 +33,10 @@ extern void state_setslot(int slot);
 extern int state_load();
 extern int state_save();
 
+extern int state_snapshot_size(void);
+extern int state_snapshot(uint8 *buf, int size);
+extern int state_restore(const uint8 *buf, int size);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -25,6 +25,19 @@
 #endif
 #endif
 
+/* Define NES_REENTRANT to keep the machine state per thread, so that
+** several emulators can run in parallel (one instance per thread)
+*/
+#ifdef NES_REENTRANT
+#ifdef _MSC_VER
+#define  NES_TLS     __declspec(thread)
+#else
+#define  NES_TLS     __thread
+#endif
+#else /* !NES_REENTRANT */
+#define  NES_TLS
+#endif /* !NES_REENTRANT */
+
 /* quell stupid compiler warnings */
 #define  UNUSED(x)   ((x) = (x))
 
@@ -34,7 +34,7 @@
 #define  APU_VOLUME_DECAY(x)  ((x) -= ((x) >> 7))
 
 /* active APU */
-static apu_t apu_;
+static NES_TLS apu_t apu_;
 
 /* the following seem to be the correct (empirically determined)
 ** relative volumes between the sound channels
@@ -46,14 +46,14 @@ static apu_t apu_;
 
 
 /* look up table madness */
-static int32 decay_lut[16];
-static int vbl_lut[32];
-static int trilength_lut[128];
+static NES_TLS int32 decay_lut[16];
+static NES_TLS int vbl_lut[32];
+static NES_TLS int trilength_lut[128];
 
 /* noise lookups for both modes */
 #ifndef REALTIME_NOISE
-static int8 noise_long_lut[APU_NOISE_32K];
-static int8 noise_short_lut[APU_NOISE_93];
+static NES_TLS int8 noise_long_lut[APU_NOISE_32K];
+static NES_TLS int8 noise_short_lut[APU_NOISE_93];
 #endif /* !REALTIME_NOISE */
 
 
@@ -121,7 +121,7 @@ void apu_setchan(int chan, bool enabled)
 #ifdef REALTIME_NOISE
 INLINE int8 shift_register15(uint8 xor_tap)
 {
-   static int sreg = 0x4000;
+   static NES_TLS int sreg = 0x4000;
    int bit0, tap, bit14;
 
    bit0 = sreg & 1;
@@ -134,7 +134,7 @@ INLINE int8 shift_register15(uint8 xor_tap)
 #else /* !REALTIME_NOISE */
 static void shift_register15(int8 *buf, int count)
 {
-   static int sreg = 0x4000;
+   static NES_TLS int sreg = 0x4000;
    int bit0, bit1, bit6, bit14;
 
    if (count == APU_NOISE_93)
@@ -869,8 +869,6 @@ uint8 apu_read(uint32 address)
 
 void apu_process(void *buffer, int num_samples)
 {
-   static int32 prev_sample = 0;
-
    int16 *buf16;
    uint8 *buf8;
 
@@ -906,13 +904,13 @@ void apu_process(void *buffer, int num_samples)
 
             if (APU_FILTER_LOWPASS == apu_.filter_type)
             {
-               accum += prev_sample;
+               accum += apu_.prev_sample;
                accum >>= 1;
             }
             else
-               accum = (accum + accum + accum + prev_sample) >> 2;
+               accum = (accum + accum + accum + apu_.prev_sample) >> 2;
 
-            prev_sample = next_sample;
+            apu_.prev_sample = next_sample;
          }
 
          /* do clipping */
@@ -209,6 +209,7 @@ typedef struct apu_s
 
    uint8_t mix_enable;
    int filter_type;
+   int32_t prev_sample; /* filter history, kept here so snapshots replay exactly */
 
    double base_freq;
    float cycle_rate;
@@ -62,7 +62,7 @@ typedef struct vrcvisnd_s
 } vrcvisnd_t;
 
 
-static vrcvisnd_t vrcvi;
+static NES_TLS vrcvisnd_t vrcvi;
 
 /* VRCVI rectangle wave generation */
 static int32 vrcvi_rectangle(vrcvirectangle_t *chan)
@@ -7,6 +7,7 @@
 //=====================================================================//
 #include "main.hpp"
 #include "nesemu.hpp"
+#include "nes_bench.hpp"
 
 typedef app::nesemu start_app;
 
@@ -18,6 +19,11 @@ static const vtx::spos limit_size_(256, 240);
 
 int main(int argc, char** argv)
 {
+	// ヘッドレスでコアの速度を計測
+	if(argc >= 2 && strcmp(argv[1], "-bench") == 0) {
+		return app::nes_bench::command(argc, argv);
+	}
+
 	gl::core& core = gl::core::get_instance();
 
 	if(!core.initialize(argc, argv)) {
@@ -0,0 +1,51 @@
+//=====================================================================//
+/*! @file
+	@brief  NES ベンチマーク
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2019 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/glfw3_app/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "nes_bench.hpp"
+#include "emu/nes/nes_core.hpp"
+#include "utils/emu_bench.hpp"
+
+namespace app {
+
+	int nes_bench::command(int argc, char** argv)
+	{
+		utils::emu_bench::param prm;
+		std::vector<std::string> files;
+		if(!utils::emu_bench::parse(argc, argv, 2, prm, files) || files.size() != 1) {
+			utils::format("Usage: %s -bench xxx.nes [-frames n] [-warmup n] [-input script]\n")
+				% argv[0];
+			return -1;
+		}
+
+		utils::emu_bench bench(prm);
+		if(!bench.load_script()) {
+			return -1;
+		}
+
+		emu::nes_core core;
+		if(!core.start()) {
+			utils::format("NES core start error\n");
+			return -1;
+		}
+		if(!core.open(files[0])) {
+			utils::format("Can't open NES file: '%s'\n") % files[0].c_str();
+			return -1;
+		}
+
+		// フレームの時間は、コア・スレッドとの受け渡しを含む
+		bench.run([&core](uint32_t pad) {
+			const auto& f = core.step_frame(pad & 0xff, (pad >> 8) & 0xff);
+			return f.cycles;
+		});
+		bench.report("nes6502 (nofrendo)", NES_REFRESH_RATE);
+
+		core.destroy();
+		return 0;
+	}
+}
@@ -0,0 +1,35 @@
+#pragma once
+//=====================================================================//
+/*! @file
+	@brief  NES ベンチマーク @n
+			ウィンドウ、オーディオ・デバイス無しで、emu::nes_core を全速で回す。@n
+			入力スクリプトのパッド値は、下位８ビットがパッド０、@n
+			次の８ビットがパッド１（INP_PAD_xxx）。@n
+			nesemu -bench xxx.nes [-frames n] [-warmup n] [-input script]
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2019 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/glfw3_app/blob/master/LICENSE
+*/
+//=====================================================================//
+
+namespace app {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  NES ベンチマーク・クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct nes_bench {
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コマンドライン・モード（argv[1] が「-bench」）
+			@param[in]	argc	引数の数
+			@param[in]	argv	引数
+			@return プロセスの終了コード
+		*/
+		//-----------------------------------------------------------------//
+		static int command(int argc, char** argv);
+	};
+}
@@ -11,6 +11,7 @@
 			「↓」： DOWN-DIR @n
 			「→」： RIGHT-DIR @n
 			「←」： LEFT-DIR @n
+			「BS」： Rewind @n
 			「F1」： Filer @n
 			「F4」： Log Terminal @n
 			Copyright 2017 Kunihito Hiramatsu
@@ -29,6 +30,7 @@
 #include "widgets/widget_button.hpp"
 #include "widgets/widget_slider.hpp"
 #include "gl_fw/gltexfb.hpp"
+#include "img_io/pixel_lut.hpp"
 #include "snd_io/pcm.hpp"
 #include "utils/fifo.hpp"
 #include "utils/input.hpp"
@@ -39,6 +41,7 @@
 #include "emu/nes/nesinput.h"
 #include "emu/nes/nesstate.h"
 #include "emu/nes/nes_pal.h"
+#include "emu/nes/nes_rewind.hpp"
 
 #include "emu/nsf/nsfplay.hpp"
 
@@ -80,7 +83,8 @@ namespace app {
 		bool			nes_play_;
 		bool			nsf_play_;
 
-		uint8_t			fb_[nes_width_ * nes_height_ * 4];
+		uint32_t		fb_[nes_width_ * nes_height_];
+		img::pixel_lut	lut_;
 
 		nesinput_t		inp_[2];
 
@@ -88,6 +92,8 @@ namespace app {
 
 		emu::tools		tools_;
 
+		emu::nes_rewind	rewind_;
+
 		emu::nsfplay	nsfplay_;
 
 		void pad_()
@@ -168,6 +174,21 @@ namespace app {
 			}
 		}
 
+		void rewind_info_()
+		{
+			if(!nes_play_) return;
+			char tmp[256];
+			const emu::nes_rewind::info_t& t = rewind_.get_info();
+			utils::sformat("Rewind: %d frames, %d bytes (raw %d)\n", tmp, sizeof(tmp))
+				% t.frames % t.bytes % t.raw;
+			emu::tools::put(tmp);
+			// UI スレッドで実行するので、短めにする
+			emu::nes_rewind::info_t b = emu::nes_rewind::benchmark(120);
+			utils::sformat("Bench: %d frames, avg %.1f us, max %.1f us, %d bytes\n", tmp, sizeof(tmp))
+				% b.frames % b.avg_us % b.max_us % b.bytes;
+			emu::tools::put(tmp);
+		}
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
@@ -216,7 +237,11 @@ namespace app {
 					widget_terminal::param wp_;
 					wp_.enter_func_ = [=] (const utils::lstring& inp) {
 						auto s = utils::utf32_to_utf8(inp);
-						tools_.command(s);
+						if(s == "rewind") {
+							rewind_info_();
+						} else {
+							tools_.command(s);
+						}
 					};
 					terminal_core_ = wd.add_widget<widget_terminal>(wp, wp_);
 
@@ -234,6 +259,7 @@ namespace app {
 						nes_play_ = false;
 						tools_.enable(false);
 					} else if(nes_insertcart(fn.c_str()) == 0) {
+						rewind_.clear();
 						nes_file_ = fn;
 						nes_play_ = true;
 						nsf_play_ = false;
@@ -295,6 +321,8 @@ namespace app {
 						} else if(state_load() != 0) {
 							dialog_->set_text("Load state error");
 							dialog_->enable();
+						} else {
+							rewind_.clear();
 						}
 					};
 				}
@@ -304,6 +332,7 @@ namespace app {
 					nes_reset_ = wd.add_widget<widget_button>(wp, wp_);
 					nes_reset_->at_local_param().select_func_ = [=](int id) {
 						nes_reset(HARD_RESET);
+						rewind_.clear();
 					};
 				}
 				{   // ボリューム
@@ -325,6 +354,7 @@ namespace app {
 
 			log_init();
 			nes_create(sample_rate_, 16);
+			lut_.set_palette(get_palette(), 64);
 
 			// regist input
 			inp_[0].type = INP_JOYPAD0;
@@ -388,7 +418,14 @@ namespace app {
 					if(!terminal_ && !menu_) { 
 						pad_();
 					}
+					// 巻き戻しは、２フレーム戻して１フレーム描画する
+					if(!terminal_ && !menu_ && dev.get_level(gl::device::key::BACKSPACE)
+						&& rewind_.size() > 2) {
+						rewind_.pop();
+						rewind_.pop();
+					}
 					nes_emulate(1);
+					rewind_.push();
 				}
 
 				if(nsf_play_) {
@@ -411,20 +448,8 @@ namespace app {
 				if(nes_play_) {
 					auto nes = nes_getcontext();
 					bitmap_t* v = nes->vidbuf;
-					const rgb_t* lut = get_palette();
-					if(v != nullptr && lut != nullptr) {
-						for(int h = 0; h < nes_height_; ++h) {
-							const uint8_t* src = &v->data[h * v->pitch];
-							uint8_t* dst = &fb_[h * nes_width_ * 4];
-							for(int w = 0; w < nes_width_; ++w) {
-								auto idx = *src++;
-								idx &= 63;
-								*dst++ = lut[idx].r;  // R
-								*dst++ = lut[idx].g;  // G
-								*dst++ = lut[idx].b;  // B
-								*dst++ = 255;  // alpha
-							}
-						}
+					if(v != nullptr) {
+						lut_.convert(v->data, v->pitch, fb_, nes_width_, nes_height_);
 						texfb_.rendering(gl::texfb::IMAGE::RGBA, (const char*)&fb_[0]);
 					}
 					texfb_.flip();
@@ -141,8 +141,8 @@ namespace app {
 		void setup_src_image_() noexcept
 		{
 			image_offset_.set(0.0f);
-			mobj_.destroy();
-			mobj_.initialize();
+			mobj_.erase(img_handle_);
+			mobj_.compact();
 			img_handle_ = mobj_.install(src_image_.get());
 			img_core_->at_local_param().mobj_ = mobj_;
 			img_core_->at_local_param().mobj_handle_ = img_handle_;
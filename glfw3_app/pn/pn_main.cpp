@@ -59,8 +59,8 @@ namespace app {
 
 	void pn_main::blend_()
 	{
-		mobj_.destroy();
-		mobj_.initialize();
+		mobj_.erase(img_handle_);
+		mobj_.compact();
 		bld_image_ = img::shared_img(img::copy_image(src_image_.get()));
 		img::img_rgba8* img = static_cast<img::img_rgba8*>(bld_image_.get());
 		img->blend(vtx::ipos(0), prn_image_, vtx::srect(vtx::ipos(0), prn_image_.get_size()));
@@ -6,6 +6,7 @@
 //=====================================================================//
 #include "main.hpp"
 #include "spinv.hpp"
+#include "spinv_bench.hpp"
 
 typedef app::spinv start_app;
 
@@ -17,6 +18,11 @@ static const vtx::spos limit_size_(512, 512);
 
 int main(int argc, char** argv)
 {
+	// ヘッドレスでコアの速度を計測
+	if(argc >= 2 && strcmp(argv[1], "-bench") == 0) {
+		return app::spinv_bench::command(argc, argv);
+	}
+
 	gl::core& core = gl::core::get_instance();
 
     if(!core.initialize(argc, argv)) {
@@ -8,6 +8,7 @@
 #include "spinv.hpp"
 #include "core/glcore.hpp"
 #include "gl_fw/glutils.hpp"
+#include "img_io/pixel_lut.hpp"
 #include "utils/unzip.hpp"
 #include "widgets/widget_dialog.hpp"
 
@@ -79,7 +80,7 @@ namespace app {
         	scan_line_color_.push_back(c);
     	}
 
-		fb_.reserve(InvadersMachine::ScreenWidth * InvadersMachine::ScreenHeight);
+		fb_.resize(InvadersMachine::ScreenWidth * InvadersMachine::ScreenHeight);
 
 		// invaders.zip 展開（ROM イメージ）
 		std::string romerr;
@@ -264,15 +265,9 @@ namespace app {
     	const unsigned char* video = spinv_.getVideo();
 		if(video) {
 			for(int y = 0; y < InvadersMachine::ScreenHeight; ++y) {
-				uint32_t c = scan_line_color_[y];
-				for(int x = 0; x < InvadersMachine::ScreenWidth; ++x) {
-					if( *video ) {
-						fb_[y * InvadersMachine::ScreenWidth + x] = c;
-					} else {
-						fb_[y * InvadersMachine::ScreenWidth + x] = 0;
-					}
-					++video;
-    	    	}
+				img::convert_mono(video, &fb_[y * InvadersMachine::ScreenWidth],
+					InvadersMachine::ScreenWidth, scan_line_color_[y]);
+				video += InvadersMachine::ScreenWidth;
     		}
 		}
 
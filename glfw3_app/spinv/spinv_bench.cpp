@@ -0,0 +1,98 @@
+//=====================================================================//
+/*! @file
+	@brief  Space Invader ベンチマーク
+	@author 平松邦仁 (hira@rvf-rc45.net)
+*/
+//=====================================================================//
+#include <memory>
+#include "spinv_bench.hpp"
+#include "side/arcade.h"
+#include "utils/unzip.hpp"
+#include "utils/emu_bench.hpp"
+
+namespace {
+
+	// パッドのビットと、押下／解放イベントの対応
+	struct key_t {
+		uint32_t	bit;
+		int			down;
+		int			up;
+	};
+
+	static const key_t keys_[] = {
+		{ 0x01, InvadersMachine::KeyLeftDown,       InvadersMachine::KeyLeftUp },
+		{ 0x02, InvadersMachine::KeyRightDown,      InvadersMachine::KeyRightUp },
+		{ 0x04, InvadersMachine::KeyFireDown,       InvadersMachine::KeyFireUp },
+		{ 0x08, InvadersMachine::KeyOnePlayerDown,  InvadersMachine::KeyOnePlayerUp },
+		{ 0x10, InvadersMachine::KeyTwoPlayersDown, InvadersMachine::KeyTwoPlayersUp },
+	};
+
+	static const uint32_t coin_bit_ = 0x20;
+
+
+	bool load_rom_(const std::string& romzip, std::vector<char>& rom)
+	{
+		utils::unzip zip;
+		if(!zip.open(romzip)) {
+			utils::format("Can't open ROM archive: '%s'\n") % romzip.c_str();
+			return false;
+		}
+		static const char* rom_files[] = {
+			"invaders.h", "invaders.g", "invaders.f", "invaders.e"
+		};
+		rom.assign(0x2000, 0);
+		for(int i = 0; i < 4; ++i) {
+			int h = zip.find(rom_files[i]);
+			if(h < 0 || zip.get_filesize(h) > 0x800) {
+				utils::format("Can't open ROM file: '%s'\n") % rom_files[i];
+				return false;
+			}
+			zip.get_file(h, &rom[i * 0x800]);
+		}
+		return true;
+	}
+}
+
+namespace app {
+
+	int spinv_bench::command(int argc, char** argv)
+	{
+		utils::emu_bench::param prm;
+		std::vector<std::string> files;
+		if(!utils::emu_bench::parse(argc, argv, 2, prm, files) || files.size() > 1) {
+			utils::format("Usage: %s -bench [invaders.zip] [-frames n] [-warmup n] [-input script]\n")
+				% argv[0];
+			return -1;
+		}
+
+		utils::emu_bench bench(prm);
+		if(!bench.load_script()) {
+			return -1;
+		}
+
+		std::vector<char> rom;
+		if(!load_rom_(files.empty() ? "invaders.zip" : files[0], rom)) {
+			return -1;
+		}
+
+		std::unique_ptr<InvadersMachine> spinv(new InvadersMachine());
+		spinv->setROM(&rom[0]);
+		spinv->reset(3, 0);
+
+		// 2MHz、１フレームで２回の割り込み
+		uint32_t cycles = 2000000 / spinv->getFrameRate();
+		uint32_t last = 0;
+		bench.run([&](uint32_t pad) {
+			uint32_t chg = pad ^ last;
+			for(const auto& k : keys_) {
+				if(chg & k.bit) spinv->fireEvent((pad & k.bit) ? k.down : k.up);
+			}
+			if((chg & pad) & coin_bit_) spinv->fireEvent(InvadersMachine::CoinInserted);
+			last = pad;
+			spinv->step();
+			return cycles;
+		});
+		bench.report("i8080 (Space Invaders)", spinv->getFrameRate());
+		return 0;
+	}
+}
@@ -0,0 +1,32 @@
+#pragma once
+//=====================================================================//
+/*! @file
+	@brief  Space Invader ベンチマーク @n
+			ウィンドウ、サウンド無しで、i8080 のコアを全速で回す。@n
+			入力スクリプトのパッド値：@n
+			bit0: LEFT, bit1: RIGHT, bit2: FIRE, bit3: 1P, bit4: 2P, bit5: COIN @n
+			spinv -bench [invaders.zip] [-frames n] [-warmup n] [-input script]
+	@author 平松邦仁 (hira@rvf-rc45.net)
+*/
+//=====================================================================//
+
+namespace app {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  Space Invader ベンチマーク・クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct spinv_bench {
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コマンドライン・モード（argv[1] が「-bench」）
+			@param[in]	argc	引数の数
+			@param[in]	argv	引数
+			@return プロセスの終了コード
+		*/
+		//-----------------------------------------------------------------//
+		static int command(int argc, char** argv);
+	};
+}
@@ -0,0 +1,171 @@
+//=====================================================================//
+/*! @file
+	@brief  波形キャプチャー・ファイルのテスト @n
+			複数チャンクのファイルを書いて読み戻し、範囲の読み出しと @n
+			エンベロープが元の波形と一致するか調べる。@n
+			波形バッファのセーブ、ロード（大きなキャプチャーの窓、旧形式）も見る。
+	@author 平松邦仁 (hira@rvf-rc45.net)
+*/
+//=====================================================================//
+#include <cstdio>
+#include <vector>
+#include "unit_test.hpp"
+#include "utils/capture_file.hpp"
+
+namespace {
+
+	bool round_trip_()
+	{
+		const char* file = "unit_test_cap.wcap";
+		static const uint32_t N = 200003;  // チャンクの端数が出る長さ
+		static const uint32_t CH = 3;
+		std::vector<int16_t> d[CH];
+		const int16_t* p[CH];
+		for(uint32_t c = 0; c < CH; ++c) {
+			for(uint32_t i = 0; i < N; ++i) {
+				d[c].push_back(static_cast<int16_t>((i * 7 + c * 1000) % 60000 - 30000));
+			}
+			p[c] = &d[c][0];
+		}
+		float g[CH] = { 1.5f, 2.0f, 3.0f };
+		UT_CHECK(utils::capture_file::save(file, p, CH, N, 1e-6, g, 4096));
+
+		utils::capture_file cf;
+		UT_CHECK(cf.open(file));
+		UT_CHECK(cf.match_unit<int16_t>());
+		UT_CHECK(!cf.match_unit<uint16_t>());
+		UT_CHECK(cf.get_header().samples_ == N);
+		UT_CHECK(cf.get_header().chunk_num_ == (N + 4095) / 4096);
+		UT_CHECK(cf.get_gain(2) == 3.0f);
+
+		for(uint32_t c = 0; c < CH; ++c) {
+			std::vector<int16_t> r(5000);
+			UT_CHECK(cf.read(c, N - 4000, &r[0], 5000) == 4000);  // 末尾で切れる
+			for(uint32_t i = 0; i < 4000; ++i) {
+				UT_CHECK(r[i] == d[c][N - 4000 + i]);
+			}
+			UT_CHECK(cf.read(c, 4000, &r[0], 5000) == 5000);  // チャンクをまたぐ
+			for(uint32_t i = 0; i < 5000; ++i) {
+				UT_CHECK(r[i] == d[c][4000 + i]);
+			}
+			// ファイルの外は base で埋める
+			UT_CHECK(cf.read_window(c, -100, &r[0], 300, static_cast<int16_t>(-1)) == 200);
+			UT_CHECK(r[99] == -1);
+			UT_CHECK(r[100] == d[c][0]);
+			UT_CHECK(r[299] == d[c][199]);
+
+			for(uint64_t o : { 0, 100, 4095, 12345 }) {
+				static const uint64_t len = 90000;
+				int32_t mn;
+				int32_t mx;
+				UT_CHECK(cf.envelope(c, o, len, mn, mx));
+				int32_t a = d[c][o];
+				int32_t b = d[c][o];
+				for(uint64_t i = o; i < (o + len); ++i) {
+					a = std::min<int32_t>(a, d[c][i]);
+					b = std::max<int32_t>(b, d[c][i]);
+				}
+				UT_CHECK(a == mn);
+				UT_CHECK(b == mx);
+			}
+		}
+		cf.close();
+
+		// 壊れたヘッダー、短いファイルは開かない
+		{
+			FILE* fp = std::fopen(file, "r+b");
+			UT_CHECK(fp != nullptr);
+			std::fputc('X', fp);
+			std::fclose(fp);
+		}
+		UT_CHECK(!cf.open(file));
+		{
+			FILE* fp = std::fopen(file, "wb");
+			UT_CHECK(fp != nullptr);
+			std::fwrite("WCAP", 1, 4, fp);
+			std::fclose(fp);
+		}
+		UT_CHECK(!cf.open(file));
+		std::remove(file);
+		return true;
+	}
+
+
+	bool buffers_()
+	{
+		const char* file = "unit_test_buf.wcap";
+		static const uint32_t SZ = 8192;
+		static const uint32_t CH = 4;
+		static const uint16_t BASE = 32768;
+		std::vector<uint16_t> w[CH];
+		std::vector<uint16_t> w2[CH];
+		const std::vector<uint16_t>* src[CH];
+		std::vector<uint16_t>* dst[CH];
+		for(uint32_t c = 0; c < CH; ++c) {
+			for(uint32_t i = 0; i < SZ; ++i) {
+				w[c].push_back(static_cast<uint16_t>(i * (c + 3) + c));
+			}
+			w2[c].resize(SZ, 0);
+			src[c] = &w[c];
+			dst[c] = &w2[c];
+		}
+		UT_CHECK(utils::capture_file::save_buffers(file, src, CH, 1e-6));
+		utils::capture_file cf;
+		UT_CHECK(cf.load_buffers(file, dst, CH, 0, BASE));
+		for(uint32_t c = 0; c < CH; ++c) {
+			UT_CHECK(w2[c] == w[c]);
+		}
+
+		// バッファより大きなキャプチャーは、org から前半、org より前を後半へ読む
+		std::vector<uint16_t> big(100000);
+		for(uint32_t i = 0; i < big.size(); ++i) big[i] = i & 0xffff;
+		const uint16_t* bp[1] = { &big[0] };
+		UT_CHECK(utils::capture_file::save(file, bp, 1, big.size(), 1e-6));
+		UT_CHECK(cf.load_buffers(file, dst, CH, 50000, BASE));
+		UT_CHECK(cf.is_open());  // 窓の外を読める様に開いたまま
+		for(uint32_t i = 0; i < SZ / 2; ++i) {
+			UT_CHECK(w2[0][i] == big[50000 + i]);
+			UT_CHECK(w2[0][SZ / 2 + i] == big[50000 - SZ / 2 + i]);
+		}
+		UT_CHECK(w2[1][0] == BASE);  // ファイルに無いチャネル
+		UT_CHECK(cf.load_buffers(file, dst, CH, 2000, BASE));
+		UT_CHECK(w2[0][10] == 2010);
+		UT_CHECK(w2[0][SZ - 2000] == 0);
+		UT_CHECK(w2[0][SZ - 2001] == BASE);
+
+		// 型の違うキャプチャーは読まない
+		const int16_t* sp[1] = { reinterpret_cast<const int16_t*>(&big[0]) };
+		UT_CHECK(utils::capture_file::save(file, sp, 1, 100, 1e-6));
+		UT_CHECK(!cf.load_buffers(file, dst, CH, 0, BASE));
+		UT_CHECK(!cf.is_open());
+
+		// 旧形式（ヘッダー無し）
+		{
+			FILE* fp = std::fopen(file, "wb");
+			UT_CHECK(fp != nullptr);
+			for(uint32_t c = 0; c < CH; ++c) {
+				for(uint32_t i = 0; i < SZ; ++i) {
+					uint16_t v = c * 100 + (i & 63);
+					std::fwrite(&v, 2, 1, fp);
+				}
+			}
+			std::fclose(fp);
+		}
+		UT_CHECK(cf.load_buffers(file, dst, CH, 0, BASE));
+		UT_CHECK(!cf.is_open());
+		UT_CHECK(w2[2][5] == 205);
+		UT_CHECK(w2[3][SZ - 1] == 363);
+		std::remove(file);
+		return true;
+	}
+}
+
+namespace test {
+
+	bool capture_file()
+	{
+		UT_CHECK(round_trip_());
+		UT_CHECK(buffers_());
+		return true;
+	}
+}
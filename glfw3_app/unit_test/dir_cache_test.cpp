@@ -0,0 +1,86 @@
+//=====================================================================//
+/*! @file
+	@brief  ディレクトリー・キャッシュのテスト @n
+			stat の取得中に inotify でファイルが変化した場合、古い stat を @n
+			反映せずに、取得待ちのまま残すか調べる。
+	@author 平松邦仁 (hira@rvf-rc45.net)
+*/
+//=====================================================================//
+#include <cstdio>
+#include "unit_test.hpp"
+#include "utils/dir_cache.hpp"
+
+namespace {
+
+#ifdef __linux__
+	bool write_(const std::string& file, const char* mode, size_t len)
+	{
+		FILE* fp = std::fopen(file.c_str(), mode);
+		if(fp == nullptr) return false;
+		for(size_t i = 0; i < len; ++i) std::fputc('x', fp);
+		std::fclose(fp);
+		return true;
+	}
+
+
+	int64_t size_(utils::dir_cache& dc, const std::string& path, const std::string& name)
+	{
+		utils::file_infos infos;
+		uint32_t rev;
+		if(!dc.get(path, "", infos, rev)) return -1;
+		for(const auto& fi : infos) {
+			if(fi.get_name() == name) return fi.get_size();
+		}
+		return -1;
+	}
+
+
+	bool stale_stat_()
+	{
+		const std::string path = "unit_test_dc";
+		const std::string file = path + "/a.bin";
+		mkdir(path.c_str(), 0755);
+		UT_CHECK(write_(file, "wb", 10));
+
+		utils::dir_cache dc;
+		time_t mt;
+		UT_CHECK(utils::dir_cache::dir_time(path, mt));
+		utils::dir_cache::entries list;
+		UT_CHECK(utils::dir_cache::scan(path, list));
+		dc.update(path, list, mt);
+
+		// stat を取った後、反映する前に書き換わる
+		std::string p;
+		UT_CHECK(dc.pending(p, list, 16));
+		UT_CHECK(p == path);
+		for(auto& e : list) utils::dir_cache::fill_stat(path, e);
+		UT_CHECK(write_(file, "ab", 10));
+		utils::strings touch;
+		dc.service(touch);
+		dc.apply_stat(path, list);
+		UT_CHECK(size_(dc, path, "a.bin") != 10);
+
+		// 取り直した stat は反映される
+		UT_CHECK(dc.pending(p, list, 16));
+		for(auto& e : list) utils::dir_cache::fill_stat(path, e);
+		dc.apply_stat(path, list);
+		UT_CHECK(size_(dc, path, "a.bin") == 20);
+		UT_CHECK(!dc.pending(p, list, 16));
+
+		std::remove(file.c_str());
+		rmdir(path.c_str());
+		return true;
+	}
+#endif
+}
+
+namespace test {
+
+	bool dir_cache()
+	{
+#ifdef __linux__
+		UT_CHECK(stale_stat_());
+#endif
+		return true;
+	}
+}
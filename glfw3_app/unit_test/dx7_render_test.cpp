@@ -0,0 +1,88 @@
+//=====================================================================//
+/*! @file
+	@brief  DX7 オフライン・レンダラーのテスト @n
+			チャネル２のピッチ・ベンド（中央値）を、ノートと同じティックに混ぜても、@n
+			ベンド無しと同じ WAV になるか調べる（ノートが捨てられない事）。
+	@author 平松邦仁 (hira@rvf-rc45.net)
+*/
+//=====================================================================//
+#include <cstdio>
+#include <vector>
+#include "unit_test.hpp"
+#include "dx7_render.hpp"
+#include "midi/MidiFile.h"
+
+namespace {
+
+	bool make_midi_(const char* file, bool bend)
+	{
+		smf::MidiFile mf;
+		mf.setTicksPerQuarterNote(480);
+		static const int keys[] = { 60, 64, 67, 72 };
+		int tick = 0;
+		for(int key : keys) {
+			// ベンドを先に置く（以前は、同じティックのノートごと捨てていた）
+			if(bend) mf.addPitchBend(0, tick, 1, 0.0);
+			mf.addNoteOn(0, tick, 0, key, 100);
+			mf.addNoteOn(0, tick, 1, key + 7, 100);
+			mf.addNoteOff(0, tick + 240, 0, key);
+			mf.addNoteOff(0, tick + 240, 1, key + 7);
+			tick += 240;
+		}
+		return mf.write(file);
+	}
+
+
+	bool read_(const char* file, std::vector<char>& out)
+	{
+		FILE* fp = std::fopen(file, "rb");
+		if(fp == nullptr) return false;
+		char tmp[4096];
+		size_t n;
+		while((n = std::fread(tmp, 1, sizeof(tmp), fp)) > 0) {
+			out.insert(out.end(), tmp, tmp + n);
+		}
+		std::fclose(fp);
+		return true;
+	}
+
+
+	bool render_(const char* mid, const char* wav, bool bend, app::dx7_render::info_t& info,
+		std::vector<char>& out)
+	{
+		UT_CHECK(make_midi_(mid, bend));
+		app::dx7_render::param prm;
+		prm.midi = mid;
+		prm.wav  = wav;
+		prm.tail = 0.5;
+		UT_CHECK(app::dx7_render::render(prm, info));
+		UT_CHECK(read_(wav, out));
+		std::remove(mid);
+		std::remove(wav);
+		return true;
+	}
+}
+
+namespace test {
+
+	bool dx7_render()
+	{
+		app::dx7_render::info_t a;
+		app::dx7_render::info_t b;
+		std::vector<char> wa;
+		std::vector<char> wb;
+		UT_CHECK(render_("unit_test_dx7a.mid", "unit_test_dx7a.wav", false, a, wa));
+		UT_CHECK(render_("unit_test_dx7b.mid", "unit_test_dx7b.wav", true,  b, wb));
+
+		UT_CHECK(b.events == a.events + 4);  // ベンドも送っている
+		UT_CHECK(a.samples == b.samples);
+		UT_CHECK(wa.size() > 44);
+		bool sound = false;
+		for(size_t i = 44; i < wa.size(); ++i) {
+			if(wa[i] != 0) { sound = true; break; }
+		}
+		UT_CHECK(sound);
+		UT_CHECK(wa == wb);
+		return true;
+	}
+}
@@ -0,0 +1,138 @@
+//=====================================================================//
+/*! @file
+	@brief  file_io のテスト @n
+			読み出し専用のオープン（小さなファイルは一括読み込み、大きなファイルは @n
+			メモリー・マップ）が、FILE* の場合と同じ読み出し、シーク、eof になるか調べる。
+	@author 平松邦仁 (hira@rvf-rc45.net)
+*/
+//=====================================================================//
+#include <cstdio>
+#include <vector>
+#include "unit_test.hpp"
+#include "utils/file_io.hpp"
+
+namespace {
+
+	bool write_(const char* file, const void* src, size_t len)
+	{
+		FILE* fp = std::fopen(file, "wb");
+		if(fp == nullptr) return false;
+		bool ok = std::fwrite(src, 1, len, fp) == len;
+		std::fclose(fp);
+		return ok;
+	}
+
+
+	int lines_(const char* file, const char* mode)
+	{
+		utils::file_io fio;
+		if(!fio.open(std::string(file), mode)) return -1;
+		int n = 0;
+		while(!fio.eof()) {
+			fio.get_line();
+			++n;
+		}
+		return n;
+	}
+
+
+	bool text_()
+	{
+		const char* file = "unit_test_fio.txt";
+		// 終端の改行の有無（行数は fgets で読んだ場合と同じ）
+		UT_CHECK(write_(file, "abc\r\ndef\nxyz\n", 13));
+		UT_CHECK(lines_(file, "rb") == 4);
+		UT_CHECK(lines_(file, "r+b") == 4);  // FILE* のまま
+		UT_CHECK(write_(file, "abc\ndef", 7));
+		UT_CHECK(lines_(file, "rb") == 2);
+		UT_CHECK(lines_(file, "r+b") == 2);
+		std::remove(file);
+		return true;
+	}
+
+
+	bool binary_(size_t size, const char* mode)
+	{
+		const char* file = "unit_test_fio.bin";
+		std::vector<uint32_t> v(size / 4);
+		for(size_t i = 0; i < v.size(); ++i) v[i] = i * 2654435761u;
+		UT_CHECK(write_(file, &v[0], v.size() * 4));
+
+		utils::file_io fio;
+		UT_CHECK(fio.open(std::string(file), mode));
+		UT_CHECK(fio.get_file_size() == size);
+		UT_CHECK(fio.tell() == 0);
+		uint32_t a;
+		UT_CHECK(fio.get(a));
+		UT_CHECK(a == v[0]);
+		std::vector<uint32_t> r;
+		UT_CHECK(fio.get_array(r, 10));
+		UT_CHECK(r[9] == v[10]);
+		auto p = static_cast<const uint32_t*>(fio.read_span(8));
+		UT_CHECK(p != nullptr);
+		UT_CHECK(p[1] == v[12]);
+		UT_CHECK(fio.tell() == 4 * 13);
+
+		// 終端をまたぐ読み出しは、読めた分だけ返して eof になる
+		UT_CHECK(fio.seek(4 * (v.size() - 2), utils::file_io::SEEK::SET));
+		UT_CHECK(!fio.eof());
+		uint32_t b[4];
+		UT_CHECK(fio.get_array(b, 4) == 2);
+		UT_CHECK(b[1] == v.back());
+		UT_CHECK(fio.eof());
+		UT_CHECK(fio.read_span(4) == nullptr);
+
+		UT_CHECK(fio.seek(0, utils::file_io::SEEK::SET));
+		UT_CHECK(!fio.eof());
+		char ch;
+		UT_CHECK(fio.get_char(ch));
+		UT_CHECK(ch == static_cast<char>(v[0] & 255));
+		UT_CHECK(fio.seek(4, utils::file_io::SEEK::CUR));
+		UT_CHECK(fio.tell() == 5);
+		fio.close();
+
+		UT_CHECK(fio.re_open());
+		UT_CHECK(fio.get(a));
+		UT_CHECK(a == v[0]);
+		fio.close();
+		std::remove(file);
+		return true;
+	}
+
+
+	bool write_read_()
+	{
+		const char* file = "unit_test_fio.bin";
+		utils::file_io fo;
+		UT_CHECK(fo.open(std::string(file), "wb"));
+		uint8_t z[5] = { 1, 2, 3, 4, 5 };
+		UT_CHECK(fo.write(z, 5) == 5);
+		UT_CHECK(fo.put_char(6));
+		fo.close();
+
+		utils::file_io fi;
+		UT_CHECK(fi.open(std::string(file), "rb"));
+		uint8_t y[6];
+		UT_CHECK(fi.read(y, 6) == 6);
+		UT_CHECK(y[0] == 1);
+		UT_CHECK(y[5] == 6);
+		fi.close();
+		std::remove(file);
+		return true;
+	}
+}
+
+namespace test {
+
+	bool file_io()
+	{
+		UT_CHECK(text_());
+		// 一括読み込みとマップ（map_threshold の前後）、FILE* で同じ結果になる事
+		for(size_t size : { size_t(1000), size_t(1 << 20) }) {
+			UT_CHECK(binary_(size, "rb"));
+			UT_CHECK(binary_(size, "r+b"));
+		}
+		UT_CHECK(write_read_());
+		return true;
+	}
+}
@@ -0,0 +1,203 @@
+//=====================================================================//
+/*! @file
+	@brief  イグナイター・クライアントのテスト @n
+			ループバック TCP 上にデバイスの代役を立て、テキストとバイナリ・@n
+			フレームの両方で送った波形が、そのまま受信できるか調べる。@n
+			壊れたフレームと、行の上限を超えるゴミも混ぜる。
+	@author 平松邦仁 (hira@rvf-rc45.net)
+*/
+//=====================================================================//
+#include <cmath>
+#include <chrono>
+#include <thread>
+#include "unit_test.hpp"
+#include "ign_client_tcp.hpp"
+#ifdef WIN32
+#include <ws2tcpip.h>
+#endif
+
+namespace {
+
+	typedef net::ign_client_tcp CLIENT;
+
+#ifdef WIN32
+	typedef SOCKET socket_t;
+	const socket_t BAD_SOCKET_ = INVALID_SOCKET;
+	const int SHUT_BOTH_ = SD_BOTH;
+	void close_(socket_t s) { closesocket(s); }
+#else
+	typedef int socket_t;
+	const socket_t BAD_SOCKET_ = -1;
+	const int SHUT_BOTH_ = SHUT_RDWR;
+	void close_(socket_t s) { close(s); }
+#endif
+
+	static const int ROUNDS = 20;
+
+	uint16_t wave_[4][CLIENT::WAVE_BUFF_SIZE];
+
+	void make_wave_()
+	{
+		for(int c = 0; c < 4; ++c) {
+			for(uint32_t i = 0; i < CLIENT::WAVE_BUFF_SIZE; ++i) {
+				wave_[c][i] = 32768 + 20000 * std::sin(i * 0.01 * (c + 1));
+			}
+		}
+	}
+
+	void text_wave_(int ch, std::string& out)
+	{
+		out += "WDCH" + std::to_string(ch) + "\n";
+		for(uint32_t o = 0; o < CLIENT::WAVE_BUFF_SIZE; o += 64) {
+			out += "WDMW";
+			for(int i = 0; i < 64; ++i) {
+				char t[8];
+				std::snprintf(t, sizeof(t), "%04X", wave_[ch][o + i]);
+				out += t;
+			}
+			out += "\n";
+		}
+	}
+
+
+	// デバイスの代役（要求を１つ受けて、用意した列を送って閉じる）
+	class device_ {
+		socket_t	listen_;
+		uint16_t	port_;
+		bool		accept_bin_;
+		std::thread	thread_;
+
+		void run_()
+		{
+			socket_t s = accept(listen_, nullptr, nullptr);
+			if(s == BAD_SOCKET_) return;
+
+			char buf[64];
+			int n = recv(s, buf, sizeof(buf), 0);
+			std::string req(buf, n > 0 ? n : 0);
+			bool bin = accept_bin_ && req.find("wbin 1") != std::string::npos;
+
+			std::string out;
+			if(bin) out += "WBIN1\n";
+			uint16_t seq = 0;
+			for(int r = 0; r < ROUNDS; ++r) {
+				out += "CRCD0000ABCD\n";
+				for(int c = 0; c < 4; ++c) {
+					if(bin) {
+						for(uint32_t o = 0; o < CLIENT::WAVE_BUFF_SIZE; o += 512) {
+							CLIENT::make_frame('W', c, seq++, o, &wave_[c][o], 512, out);
+						}
+					} else {
+						text_wave_(c, out);
+					}
+				}
+				if(r == 3) {
+					if(bin) {  // CRC の合わないフレーム
+						std::string bad;
+						CLIENT::make_frame('W', 0, seq++, 0, wave_[0], 512, bad);
+						bad[40] ^= 1;
+						out += bad;
+					} else {  // 行の上限を超えるゴミ
+						out.append(CLIENT::LINE_LIMIT + 100, 'x');
+						out += "\n";
+					}
+				}
+			}
+
+			size_t p = 0;
+			while(p < out.size()) {
+				auto k = send(s, out.data() + p, std::min<size_t>(3000, out.size() - p), 0);
+				if(k < 0) break;
+				p += k;
+			}
+			// クライアントが読み終わるまで閉じない
+			std::this_thread::sleep_for(std::chrono::milliseconds(500));
+			close_(s);
+		}
+
+	public:
+		device_(bool accept_bin) : listen_(BAD_SOCKET_), port_(0), accept_bin_(accept_bin) { }
+
+		~device_()
+		{
+			if(listen_ != BAD_SOCKET_) shutdown(listen_, SHUT_BOTH_);  // accept 待ちを解く
+			if(thread_.joinable()) thread_.join();
+			if(listen_ != BAD_SOCKET_) close_(listen_);
+#ifdef WIN32
+			WSACleanup();
+#endif
+		}
+
+		bool start()
+		{
+#ifdef WIN32
+			WSADATA wsa;
+			if(WSAStartup(MAKEWORD(2, 0), &wsa) != 0) return false;
+#endif
+			listen_ = socket(AF_INET, SOCK_STREAM, 0);
+			if(listen_ == BAD_SOCKET_) return false;
+			sockaddr_in a{ };
+			a.sin_family = AF_INET;
+			a.sin_port = 0;  // 空いているポート
+			a.sin_addr.s_addr = inet_addr("127.0.0.1");
+			if(bind(listen_, reinterpret_cast<sockaddr*>(&a), sizeof(a)) < 0) return false;
+			socklen_t len = sizeof(a);
+			if(getsockname(listen_, reinterpret_cast<sockaddr*>(&a), &len) < 0) return false;
+			port_ = ntohs(a.sin_port);
+			if(listen(listen_, 1) < 0) return false;
+			thread_ = std::thread([this] { run_(); });
+			return true;
+		}
+
+		uint16_t get_port() const { return port_; }
+	};
+
+
+	bool receive_(bool bin)
+	{
+		device_ dev(bin);
+		UT_CHECK(dev.start());
+
+		CLIENT cl;
+		UT_CHECK(cl.start("127.0.0.1", dev.get_port()));
+
+		auto t0 = std::chrono::steady_clock::now();
+		while(cl.get_mod_status().wdm_id_[3] < ROUNDS) {
+			cl.service();
+			UT_CHECK((std::chrono::steady_clock::now() - t0) < std::chrono::seconds(10));
+		}
+
+		const auto& m = cl.get_mod_status();
+		UT_CHECK(cl.probe_binary() == bin);
+		UT_CHECK(m.crcd_ == 0xABCD);
+		UT_CHECK(m.crcd_id_ == ROUNDS);
+		for(int c = 0; c < 4; ++c) {
+			UT_CHECK(m.wdm_id_[c] == ROUNDS);
+			for(uint32_t i = 0; i < CLIENT::WAVE_BUFF_SIZE; ++i) {
+				UT_CHECK(cl.get_wdm(c)[i] == wave_[c][i]);
+			}
+		}
+		if(bin) {
+			UT_CHECK(m.frame_id_ == ROUNDS * 4 * (CLIENT::WAVE_BUFF_SIZE / 512));
+			UT_CHECK(m.frame_err_ == 1);
+			UT_CHECK(m.frame_lost_ == 1);  // 壊れたフレームの番号が抜ける
+			UT_CHECK(m.line_err_ == 0);
+		} else {
+			UT_CHECK(m.frame_id_ == 0);
+			UT_CHECK(m.frame_err_ == 0);
+			UT_CHECK(m.line_err_ >= 1);  // 届き方により、途中で捨てる事がある
+		}
+		return true;
+	}
+}
+
+namespace test {
+
+	bool ign_client()
+	{
+		make_wave_();
+		UT_CHECK(receive_(false));
+		UT_CHECK(receive_(true));
+		return true;
+	}
+}
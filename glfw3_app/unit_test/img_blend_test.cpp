@@ -0,0 +1,109 @@
+//=====================================================================//
+/*! @file
+	@brief  スパン合成のテスト @n
+			SSE2、AVX2（CPU が対応している場合）と、スカラー版の結果が @n
+			全ての合成モードでビット単位に一致するか調べる。
+	@author 平松邦仁 (hira@rvf-rc45.net)
+*/
+//=====================================================================//
+#include <cstring>
+#include <vector>
+#include <random>
+#include "unit_test.hpp"
+#include "img_io/img_blend.hpp"
+
+namespace {
+
+	static const img::BLEND::type modes_[] = {
+		img::BLEND::COPY, img::BLEND::OVER, img::BLEND::OVER_DA,
+		img::BLEND::ADD, img::BLEND::MULTIPLY, img::BLEND::PREMUL
+	};
+
+	static const uint32_t LEN = 1003;  // ８、４で割り切れない長さ
+
+	std::vector<img::rgba8> random_(std::mt19937& r)
+	{
+		std::vector<img::rgba8> v(LEN);
+		for(auto& c : v) {
+			uint32_t x = r();
+			// アルファの両端（0, 255）を多めに
+			uint32_t a = (x >> 24) < 32 ? 0 : ((x >> 24) > 224 ? 255 : (x >> 24));
+			c.set(x & 255, (x >> 8) & 255, (x >> 16) & 255, a);
+		}
+		return v;
+	}
+
+
+	bool same_(const std::vector<img::rgba8>& a, const std::vector<img::rgba8>& b)
+	{
+		for(uint32_t i = 0; i < a.size(); ++i) {
+			if(a[i].r != b[i].r || a[i].g != b[i].g || a[i].b != b[i].b || a[i].a != b[i].a) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+
+	bool mode_(img::BLEND::type mode, const std::vector<img::rgba8>& dst, const std::vector<img::rgba8>& src)
+	{
+		auto ref = dst;
+		for(uint32_t i = 0; i < LEN; ++i) img::blend_::pixel(ref[i], src[i], mode);
+		auto fref = dst;
+		for(uint32_t i = 0; i < LEN; ++i) img::blend_::pixel(fref[i], src[5], mode);
+
+		auto d = dst;
+		img::blend_span(&d[0], &src[0], LEN, mode);
+		UT_CHECK(same_(d, ref));
+		d = dst;
+		img::blend_fill(&d[0], src[5], LEN, mode);
+		UT_CHECK(same_(d, fref));
+		if(mode == img::BLEND::COPY) return true;
+
+		uint32_t cv;
+		std::memcpy(&cv, &src[5], 4);
+#if defined(IMG_BLEND_SSE2)
+		d = dst;
+		uint32_t i = img::blend_::sse2_::span(&d[0], &src[0], 0, LEN, mode);
+		UT_CHECK(i == (LEN & ~3));
+		for(; i < LEN; ++i) img::blend_::pixel(d[i], src[i], mode);
+		UT_CHECK(same_(d, ref));
+		d = dst;
+		i = img::blend_::sse2_::fill(&d[0], cv, 0, LEN, mode);
+		for(; i < LEN; ++i) img::blend_::pixel(d[i], src[5], mode);
+		UT_CHECK(same_(d, fref));
+#endif
+#if defined(IMG_BLEND_AVX2)
+		if(img::blend_::has_avx2()) {
+			d = dst;
+			uint32_t i = img::blend_::avx2_::span(&d[0], &src[0], 0, LEN, mode);
+			UT_CHECK(i == (LEN & ~7));
+			for(; i < LEN; ++i) img::blend_::pixel(d[i], src[i], mode);
+			UT_CHECK(same_(d, ref));
+			d = dst;
+			i = img::blend_::avx2_::fill(&d[0], cv, 0, LEN, mode);
+			for(; i < LEN; ++i) img::blend_::pixel(d[i], src[5], mode);
+			UT_CHECK(same_(d, fref));
+		} else {
+			std::printf("  img_blend: no AVX2 on this CPU, AVX2 path skipped\n");
+		}
+#endif
+		return true;
+	}
+}
+
+namespace test {
+
+	bool img_blend()
+	{
+		std::mt19937 r(12345);
+		for(int n = 0; n < 4; ++n) {
+			auto dst = random_(r);
+			auto src = random_(r);
+			for(auto m : modes_) {
+				UT_CHECK(mode_(m, dst, src));
+			}
+		}
+		return true;
+	}
+}
@@ -0,0 +1,49 @@
+//=====================================================================//
+/*! @file
+	@brief  ユニット・テスト・メイン @n
+			引数無しの場合は全て、テスト名を指定した場合はそれだけを実行する。
+	@author 平松邦仁 (hira@rvf-rc45.net)
+*/
+//=====================================================================//
+#include <cstring>
+#include "unit_test.hpp"
+
+namespace {
+
+	struct test_t {
+		const char*	name;
+		bool		(*func)();
+	};
+
+	const test_t tests_[] = {
+		{ "nes_rewind",		test::nes_rewind },
+		{ "ign_client",		test::ign_client },
+		{ "capture_file",	test::capture_file },
+		{ "file_io",		test::file_io },
+		{ "dir_cache",		test::dir_cache },
+		{ "img_blend",		test::img_blend },
+		{ "dx7_render",		test::dx7_render },
+		{ "wave_pyramid",	test::wave_pyramid },
+	};
+
+	bool match_(int argc, char** argv, const char* name)
+	{
+		if(argc < 2) return true;
+		for(int i = 1; i < argc; ++i) {
+			if(std::strcmp(argv[i], name) == 0) return true;
+		}
+		return false;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	int err = 0;
+	for(const test_t& t : tests_) {
+		if(!match_(argc, argv, t.name)) continue;
+		bool ok = t.func();
+		std::printf("%s: %s\n", t.name, ok ? "OK" : "NG");
+		if(!ok) ++err;
+	}
+	return err;
+}
@@ -0,0 +1,131 @@
+//=====================================================================//
+/*! @file
+	@brief  NES 巻き戻しのテスト @n
+			MMC1 のシリアル書き込みをフレームをまたいで行うテスト ROM を生成し、@n
+			巻き戻した後の再実行が、最初の実行と映像、音声共に一致するか調べる。
+	@author 平松邦仁 (hira@rvf-rc45.net)
+*/
+//=====================================================================//
+#include <cstdio>
+#include <vector>
+#include "unit_test.hpp"
+#include "emu/nes/nes_core.hpp"
+#include "emu/nes/nes_rewind.hpp"
+
+extern "C" {
+
+	int emu_log(const char* text) { return 0; }
+
+};
+
+namespace {
+
+	// $C000 に置くプログラム（NMI 毎に１ビットずつ MMC1 の PRG バンク・レジスタへ書き、@n
+	// ８フレーム毎に CHR レジスタへ１ビットだけ書いて、書き込み途中の状態を残す。@n
+	// $8000 のバンクの内容を、音と背景色へ出す）
+	//
+	// reset:	sei / cld / ldx #$ff / txs
+	//			lda #$80 / sta $8000		; MMC1 リセット（$8000 を 16K 切り替え）
+	//			lda #$0f / sta $4015 / lda #$bf / sta $4000
+	//			lda #$00 / sta $00 / lda #$80 / sta $2000
+	// loop:	jmp loop
+	// nmi:		inc $00 / lda $00 / lsr / lsr / sta $e000
+	//			lda $00 / and #$07 / bne skip / sta $a000
+	// skip:	lda $8000 / sta $4002 / lda #$01 / sta $4003
+	//			lda #$3f / sta $2006 / lda #$00 / sta $2006
+	//			lda $8000 / and #$3f / sta $2007
+	//			rti
+	const uint8_t prog_[] = {
+		0x78, 0xD8, 0xA2, 0xFF, 0x9A, 0xA9, 0x80, 0x8D, 0x00, 0x80,
+		0xA9, 0x0F, 0x8D, 0x15, 0x40, 0xA9, 0xBF, 0x8D, 0x00, 0x40,
+		0xA9, 0x00, 0x85, 0x00, 0xA9, 0x80, 0x8D, 0x00, 0x20, 0x4C,
+		0x1D, 0xC0, 0xE6, 0x00, 0xA5, 0x00, 0x4A, 0x4A, 0x8D, 0x00,
+		0xE0, 0xA5, 0x00, 0x29, 0x07, 0xD0, 0x03, 0x8D, 0x00, 0xA0,
+		0xAD, 0x00, 0x80, 0x8D, 0x02, 0x40, 0xA9, 0x01, 0x8D, 0x03,
+		0x40, 0xA9, 0x3F, 0x8D, 0x06, 0x20, 0xA9, 0x00, 0x8D, 0x06,
+		0x20, 0xAD, 0x00, 0x80, 0x29, 0x3F, 0x8D, 0x07, 0x20, 0x40
+	};
+	const uint16_t nmi_vector_ = 0xC020;
+	const uint32_t prg_banks_ = 16;  // 16K 単位
+
+	bool make_rom_(const char* file)
+	{
+		std::vector<uint8_t> rom(16 + prg_banks_ * 0x4000, 0);
+		rom[0] = 'N'; rom[1] = 'E'; rom[2] = 'S'; rom[3] = 0x1A;
+		rom[4] = prg_banks_;
+		rom[5] = 0;		// CHR-RAM
+		rom[6] = 0x10;	// mapper 1
+		for(uint32_t i = 0; i < prg_banks_; ++i) {
+			rom[16 + i * 0x4000] = 0x20 + i * 0x13;  // バンク毎に異なる値
+		}
+		uint8_t* last = &rom[16 + (prg_banks_ - 1) * 0x4000];
+		std::copy(prog_, prog_ + sizeof(prog_), last);
+		last[0x3FFA] = nmi_vector_ & 0xff;
+		last[0x3FFB] = nmi_vector_ >> 8;
+		last[0x3FFC] = 0x00;
+		last[0x3FFD] = 0xC0;
+		last[0x3FFE] = 0x00;
+		last[0x3FFF] = 0xC0;
+
+		FILE* fp = std::fopen(file, "wb");
+		if(fp == nullptr) return false;
+		bool ok = std::fwrite(&rom[0], 1, rom.size(), fp) == rom.size();
+		std::fclose(fp);
+		return ok;
+	}
+
+	uint32_t hash_(const emu::nes_core::frame_t& f)
+	{
+		uint32_t h = 2166136261u;
+		for(uint32_t c : f.fb) h = (h ^ c) * 16777619u;
+		for(int16_t a : f.audio) h = (h ^ static_cast<uint16_t>(a)) * 16777619u;
+		return h;
+	}
+}
+
+namespace test {
+
+	bool nes_rewind()
+	{
+		const char* file = "unit_test_mmc1.nes";
+		UT_CHECK(make_rom_(file));
+
+		emu::nes_core core;
+		UT_CHECK(core.start());
+		bool open = core.open(file);
+		std::remove(file);
+		UT_CHECK(open);
+
+		static const int frames = 400;
+		static const int depth = 300;
+		emu::nes_rewind rw(depth);
+		std::vector<uint32_t> ref;
+		for(int i = 0; i < frames; ++i) {
+			ref.push_back(hash_(core.step_frame(0)));
+			bool ok = false;
+			core.exec([&] { ok = rw.push(); });
+			UT_CHECK(ok);
+		}
+		UT_CHECK(rw.size() == depth);
+
+		// ベンチマークは利用中のリングとマシンの状態を変えない
+		core.exec([&] { emu::nes_rewind::benchmark(30); });
+		UT_CHECK(rw.size() == depth);
+
+		// 戻る位置を変えて（マッパーの書き込み途中を含む）、戻しては再実行する
+		for(int back = 1; back <= 16; ++back) {
+			bool ok = true;
+			core.exec([&] {
+				for(int i = 0; i < back; ++i) ok &= rw.pop();
+			});
+			UT_CHECK(ok);
+			UT_CHECK(rw.size() == static_cast<uint32_t>(depth - back));
+			for(int i = frames - back; i < frames; ++i) {
+				UT_CHECK(hash_(core.step_frame(0)) == ref[i]);
+				core.exec([&] { ok = rw.push(); });
+				UT_CHECK(ok);
+			}
+		}
+		return true;
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	ユニット・テスト共通定義 @n
+			各テストは「bool test::xxx()」として定義し、main.cpp の表に登録する。
+	@author	平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2019, 2023 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/glfw3_app/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+
+//-----------------------------------------------------------------//
+/*!
+	@brief	条件が成り立たない場合、場所を表示して「false」を返す
+*/
+//-----------------------------------------------------------------//
+#define UT_CHECK(cond) \
+	if(!(cond)) { \
+		std::printf("  %s(%d): failed: %s\n", __FILE__, __LINE__, #cond); \
+		return false; \
+	}
+
+namespace test {
+
+	bool nes_rewind();
+
+	bool ign_client();
+
+	bool capture_file();
+
+	bool file_io();
+
+	bool dir_cache();
+
+	bool img_blend();
+
+	bool dx7_render();
+
+	bool wave_pyramid();
+
+}
@@ -0,0 +1,91 @@
+//=====================================================================//
+/*! @file
+	@brief  波形 min/max ピラミッドのテスト @n
+			任意の区間（循環、端数を含む）の min/max/平均が、全サンプルを @n
+			なめた結果と一致するか、部分更新の後も一致するか調べる。
+	@author 平松邦仁 (hira@rvf-rc45.net)
+*/
+//=====================================================================//
+#include <cmath>
+#include <vector>
+#include <random>
+#include "unit_test.hpp"
+#include "utils/wave_pyramid.hpp"
+
+namespace {
+
+	typedef utils::wave_pyramid<int16_t> PYRAMID;
+
+	bool check_(PYRAMID& py, const PYRAMID::UNITS& u, uint32_t org, uint32_t len)
+	{
+		PYRAMID::acc_t a;
+		py.envelope(u, org, len, a);
+
+		int16_t mi = u[org];
+		int16_t ma = u[org];
+		double sum = 0.0;
+		for(uint32_t i = 0; i < len; ++i) {
+			auto w = u[(org + i) % u.size()];
+			if(mi > w) mi = w;
+			if(ma < w) ma = w;
+			sum += w;
+		}
+		UT_CHECK(a.num_ == len);
+		UT_CHECK(a.min_ == mi);
+		UT_CHECK(a.max_ == ma);
+		// 平均は float で持っているので誤差を許す
+		UT_CHECK(std::fabs(a.sum_ / a.num_ - sum / len) < 0.05);
+		return true;
+	}
+
+
+	bool size_(std::mt19937& r, uint32_t size)
+	{
+		PYRAMID::UNITS u(size);
+		for(auto& w : u) w = static_cast<int16_t>(r() % 2001) - 1000;
+		PYRAMID py;
+		for(int n = 0; n < 200; ++n) {
+			uint32_t org = r() % size;
+			uint32_t len = r() % size + 1;
+			UT_CHECK(check_(py, u, org, len));
+		}
+		UT_CHECK(check_(py, u, 0, size));
+		UT_CHECK(check_(py, u, size - 1, size));
+
+		// 一部を書き換えて（スパイクを含む）部分更新
+		for(int n = 0; n < 20; ++n) {
+			uint32_t org = r() % size;
+			uint32_t end = std::min(size, org + static_cast<uint32_t>(r() % 37) + 1);
+			for(uint32_t i = org; i < end; ++i) {
+				u[i] = static_cast<int16_t>(r() % 2001) - 1000;
+			}
+			u[org] = (n & 1) ? 30000 : -30000;
+			py.update(u, org, end);
+			UT_CHECK(check_(py, u, org, 1));
+			for(int m = 0; m < 20; ++m) {
+				UT_CHECK(check_(py, u, r() % size, r() % size + 1));
+			}
+		}
+
+		// 無効化した後は作り直す
+		for(auto& w : u) w = -w;
+		py.invalidate();
+		UT_CHECK(!py.is_valid());
+		UT_CHECK(check_(py, u, r() % size, size));
+		UT_CHECK(py.is_valid());
+		return true;
+	}
+}
+
+namespace test {
+
+	bool wave_pyramid()
+	{
+		std::mt19937 r(4321);
+		static const uint32_t sizes[] = { 1, 2, 3, 4, 5, 17, 64, 1000, 4097, 8192 };
+		for(auto s : sizes) {
+			UT_CHECK(size_(r, s));
+		}
+		return true;
+	}
+}
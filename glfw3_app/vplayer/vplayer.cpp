@@ -107,6 +107,12 @@ namespace app {
 			dome_ = wd.add_widget<widget_check>(wp, wp_);
 		}
 
+		{ // シーク・スライダー（ドラッグでスクラブ）
+			widget::param wp(vtx::irect(10, 180, 180, 20), tools_frame_);
+			widget_slider::param wp_;
+			seek_ = wd.add_widget<widget_slider>(wp, wp_);
+		}
+
 #if 0
 		if(1) {	// ラジオボタンのテスト
 			widget::param wpr(vtx::irect(20, 20, 130, 130), 0);
@@ -131,6 +137,8 @@ namespace app {
 			widget::param wp(vtx::irect(10, 30, 300, 200));
 			widget_filer::param wp_(core.get_current_path());
 			wp_.select_file_func_ = [this] (const std::string& path) {
+				// YUV から RGB への変換は、texfb のシェーダーで行う
+				decoder_.set_output(av::decoder::output::YUV420);
 				bool open = decoder_.open(path);
 				if(open) {
 					decode_open_ = true;
@@ -160,8 +168,9 @@ namespace app {
 						s = "invalid";
 					}
 					output_term_("Audio format: " + s + '\n');
-					int depth = 24;
+					int depth = 32;
 					texfb_.initialize(x, y, depth);
+					texfb_.set_yuv_format(decoder_.is_bt709(), decoder_.is_full_range());
 				} else {
 					if(dialog_) {
 						dialog_->enable();
@@ -217,34 +226,47 @@ namespace app {
 
 		gui::widget_director& wd = director_.at().widget_director_;
 
-		// AV デコーダー更新
-		if(decode_open_ && !decode_pause_) {
-			frame_time_ += 1.0 / 60.0;
-			double vt = decoder_.get_video_time();
-			if(vt < frame_time_) { 
-				bool f = decoder_.update();
-				if(f) {
-					output_term_((boost::format("Total: %d Frames\n") % decoder_.get_frame_no()).str());
-					decoder_.close();
-					decode_open_ = false;
-				} else {
-					const void* img = decoder_.get_image();
-					if(img) {
-						texfb_.rendering(gl::texfb::IMAGE::RGB, img);
-						texfb_.flip();
+		// AV デコーダー更新（デコードは別スレッド、表示時間に合わせてフレームを取り出す）
+		if(decode_open_) {
+			bool scrub = false;
+			double len = decoder_.get_duration();
+			if(seek_ != nullptr && len > 0.0) {
+				if(seek_->get_select()) {  // ドラッグ中は、位置が変わったらシーク
+					scrub = true;
+					double t = seek_->get_position() * len;
+					double fps = decoder_.get_frame_rate();
+					if(std::abs(t - frame_time_) >= (fps > 0.0 ? 0.5 / fps : 0.0)) {
+						decoder_.seek(t);
+						frame_time_ = t;
 					}
+				} else {
+					seek_->at_position() = std::min(1.0, frame_time_ / len);
 				}
 			}
-			double at = decoder_.get_audio_time();
-//			if(at < frame_time_) {
-				av::decoder::audio_deque& a = decoder_.at_audio();
-				for(int i = 0; i < a.size(); ++i) {
-					al::audio ai = a.front();
-					if(director_.at().sound_.queue_audio(ai)) {
-						a.pop_front();
-					}
+			if(!decode_pause_ && !scrub) {
+				frame_time_ += 1.0 / 60.0;
+			}
+			bool f = decoder_.update(frame_time_);
+			if(f) {
+				output_term_((boost::format("Total: %d Frames\n") % decoder_.get_frame_no()).str());
+				auto info = decoder_.get_info();
+				output_term_((boost::format("Decoded: %d, Dropped: %d\n")
+					% info.decoded % info.dropped).str());
+				decoder_.close();
+				decode_open_ = false;
+			} else {
+				const void* img = decoder_.get_image();
+				if(img) {
+					texfb_.rendering(gl::texfb::IMAGE::YUV420, img);
+					texfb_.flip();
 				}
-//			}
+			}
+			av::decoder::audio_deque& a = decoder_.at_audio();
+			if(scrub) a.clear();
+			while(!decode_pause_ && !a.empty()) {
+				if(!director_.at().sound_.queue_audio(a.front())) break;
+				a.pop_front();
+			}
 		}
 
 		// ボタンの状態を設定
@@ -259,6 +281,9 @@ namespace app {
 		if(stop_) {
 			stop_->set_stall(!decode_open_);
 		}
+		if(seek_) {
+			seek_->set_stall(!decode_open_);
+		}
 
 		// GUI が操作されない場合、カメラ操作
 		if(!wd.update()) {
@@ -40,6 +40,7 @@ namespace app {
 		gui::widget_button*		play_pause_;
 		gui::widget_button*		stop_;
 		gui::widget_check*		dome_;
+		gui::widget_slider*		seek_;
 		
 		gui::widget_filer*		load_ctx_;
 
@@ -70,7 +71,7 @@ namespace app {
 			director_(d),
 			tools_frame_(nullptr),
 			open_file_(nullptr), volume_(nullptr), play_pause_(nullptr), stop_(nullptr),
-			dome_(nullptr),
+			dome_(nullptr), seek_(nullptr),
 			load_ctx_(nullptr), dialog_(nullptr),
 			terminal_frame_(nullptr), terminal_core_(nullptr),
 			frame_time_(0.0), decoder_(), decode_open_(false), decode_pause_(false)